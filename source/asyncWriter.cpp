@@ -0,0 +1,248 @@
+#include "asyncWriter.hpp"
+
+#define FILENAME "asyncWriter.cpp"
+
+using namespace std;
+
+
+// copy n values of size bytes each from src to dst in big-endian byte order,
+// which is the byte order of PETSc binary files
+static void copyBigEndian(char *dst, const void *src, const size_t size, const size_t n)
+{
+  const char *s = (const char*) src;
+  const int one = 1;
+  if (*(const char*) &one == 0) { // host is big-endian
+    memcpy(dst,s,size*n);
+    return;
+  }
+  for (size_t i = 0; i < n; i++) {
+    for (size_t b = 0; b < size; b++) { dst[i*size + b] = s[i*size + size - 1 - b]; }
+  }
+}
+
+
+AsyncWriter::AsyncWriter()
+: _enabled(0),_numBuffers(0),_stageTime(0),_waitTime(0),
+  _rank(0),_busy(0),_stop(false),_errorFile("")
+{ }
+
+
+AsyncWriter::~AsyncWriter()
+{
+  #if VERBOSE > 1
+    string funcName = "AsyncWriter::~AsyncWriter";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  // write out everything that is still queued, then free memory
+  stop();
+  for (size_t i = 0; i < _pool.size(); i++) { delete _pool[i]; }
+  for (map<string,Gather>::iterator it = _gathers.begin(); it != _gathers.end(); it++) {
+    VecScatterDestroy(&it->second._scatter);
+    VecDestroy(&it->second._seq);
+  }
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+}
+
+
+// Start the writer thread on rank 0. The thread makes no MPI calls, so MPI
+// does not need to have been initialized with thread support.
+PetscErrorCode AsyncWriter::setUp(const int enabled, const PetscInt numBuffers)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "AsyncWriter::setUp";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  assert(enabled == 0 || enabled == 1);
+  assert(_pool.empty());
+  _enabled = enabled;
+  _numBuffers = numBuffers;
+  if (_enabled == 0) { return ierr; }
+
+  assert(_numBuffers > 0);
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&_rank);CHKERRQ(ierr);
+  if (_rank == 0) {
+    for (PetscInt i = 0; i < _numBuffers; i++) { _pool.push_back(new vector<char>()); }
+    _free = _pool;
+    _thread = std::thread(&AsyncWriter::run,this);
+  }
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+
+// Collective. Gathers vec onto rank 0 and stages it for the writer thread.
+// vec may be changed or destroyed as soon as this returns.
+PetscErrorCode AsyncWriter::appendVec(const Vec& vec, pair<PetscViewer,string>& vw)
+{
+  PetscErrorCode ierr = 0;
+
+  if (_enabled == 0) {
+    ierr = VecView(vec,vw.first);CHKERRQ(ierr);
+    return ierr;
+  }
+  double startTime = MPI_Wtime();
+
+  // The writer thread appends with its own file handle, so the viewer that
+  // wrote the first record must not hold the file open as well. Destroying
+  // it writes out anything it still buffers and closes the file.
+  if (vw.first != NULL) {
+    ierr = PetscViewerDestroy(&vw.first);CHKERRQ(ierr);
+  }
+
+  // gather onto rank 0, reusing the scatter for this file
+  const string& filename = vw.second;
+  map<string,Gather>::iterator it = _gathers.find(filename);
+  if (it == _gathers.end()) {
+    Gather g;
+    ierr = VecScatterCreateToZero(vec,&g._scatter,&g._seq);CHKERRQ(ierr);
+    ierr = VecGetSize(vec,&g._N);CHKERRQ(ierr);
+    it = _gathers.insert(make_pair(filename,g)).first;
+  }
+  Gather& g = it->second;
+  PetscInt N = 0;
+  ierr = VecGetSize(vec,&N);CHKERRQ(ierr);
+  assert(N == g._N);
+  ierr = VecScatterBegin(g._scatter,vec,g._seq,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+  ierr = VecScatterEnd(g._scatter,vec,g._seq,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+
+  if (_rank == 0) {
+    // take a free staging buffer, waiting for the writer thread if there is none
+    vector<char> *buf = NULL;
+    {
+      double waitStart = MPI_Wtime();
+      std::unique_lock<std::mutex> lock(_mutex);
+      while (_free.empty() && _errorFile.empty()) { _workDone.wait(lock); }
+      _waitTime += MPI_Wtime() - waitStart;
+      if (_errorFile.empty()) {
+        buf = _free.back();
+        _free.pop_back();
+      }
+    }
+    if (buf == NULL) { return checkError(); }
+
+    // record as written by VecView: class id, size, then the values
+    PetscInt header[2] = {VEC_FILE_CLASSID, N};
+    const size_t headerBytes = sizeof(header), dataBytes = N*sizeof(PetscScalar);
+    buf->resize(headerBytes + dataBytes);
+    const PetscScalar *seqA;
+    ierr = VecGetArrayRead(g._seq,&seqA);CHKERRQ(ierr);
+    copyBigEndian(&(*buf)[0],header,sizeof(PetscInt),2);
+    copyBigEndian(&(*buf)[headerBytes],seqA,sizeof(PetscReal),dataBytes/sizeof(PetscReal));
+    ierr = VecRestoreArrayRead(g._seq,&seqA);CHKERRQ(ierr);
+
+    Job job;
+    job._buf = buf;
+    job._filename = filename;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _queue.push_back(job);
+    }
+    _workReady.notify_one();
+  }
+
+  _stageTime += MPI_Wtime() - startTime;
+  return ierr;
+}
+
+
+// Collective. Returns once everything queued so far has been written.
+PetscErrorCode AsyncWriter::flush()
+{
+  PetscErrorCode ierr = 0;
+  if (_enabled == 0) { return ierr; }
+
+  if (_rank == 0) {
+    double waitStart = MPI_Wtime();
+    std::unique_lock<std::mutex> lock(_mutex);
+    while ((!_queue.empty() || _busy > 0) && _errorFile.empty()) { _workDone.wait(lock); }
+    _waitTime += MPI_Wtime() - waitStart;
+    lock.unlock();
+    ierr = checkError();CHKERRQ(ierr);
+  }
+  ierr = MPI_Barrier(PETSC_COMM_WORLD);CHKERRQ(ierr);
+
+  return ierr;
+}
+
+
+// report a failed write from the writer thread
+PetscErrorCode AsyncWriter::checkError()
+{
+  PetscErrorCode ierr = 0;
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (!_errorFile.empty()) {
+    PetscPrintf(PETSC_COMM_SELF,"AsyncWriter: could not write to file %s\n",_errorFile.c_str());
+    assert(0);
+    ierr = 1;
+  }
+  return ierr;
+}
+
+
+// write out the remaining queue and end the writer thread
+PetscErrorCode AsyncWriter::stop()
+{
+  PetscErrorCode ierr = 0;
+  if (!_thread.joinable()) { return ierr; }
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _workReady.notify_one();
+  _thread.join();
+
+  return ierr;
+}
+
+
+// Body of the writer thread: append each staged record to its file, in
+// queue order, and return its buffer to the pool. The files were created by
+// a PETSc viewer, which also wrote their first record and was closed by
+// appendVec, so they are always opened for appending.
+void AsyncWriter::run()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (true) {
+    while (_queue.empty() && !_stop) { _workReady.wait(lock); }
+    if (_queue.empty()) { break; } // _stop is set and there is no work left
+
+    Job job = _queue.front();
+    _queue.pop_front();
+    _busy++;
+    lock.unlock();
+
+    bool ok = true;
+    FILE *fp = _files[job._filename];
+    if (fp == NULL) {
+      fp = fopen(job._filename.c_str(),"ab");
+      _files[job._filename] = fp;
+    }
+    if (fp == NULL) { ok = false; }
+    else {
+      const size_t bytes = job._buf->size();
+      if (fwrite(&(*job._buf)[0],1,bytes,fp) != bytes || fflush(fp) != 0) { ok = false; }
+    }
+
+    lock.lock();
+    if (!ok && _errorFile.empty()) { _errorFile = job._filename; }
+    _free.push_back(job._buf);
+    _busy--;
+    _workDone.notify_all();
+  }
+  lock.unlock();
+
+  for (map<string,FILE*>::iterator it = _files.begin(); it != _files.end(); it++) {
+    if (it->second != NULL) { fclose(it->second); }
+  }
+  _files.clear();
+}
@@ -0,0 +1,91 @@
+#ifndef ASYNCWRITER_HPP_INCLUDED
+#define ASYNCWRITER_HPP_INCLUDED
+
+#include <petscksp.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <assert.h>
+
+using namespace std;
+
+/*
+ * Appends Vecs to PETSc binary output files without making the time
+ * integration wait for the file system.
+ *
+ * appendVec gathers the Vec onto rank 0 and copies it, already in PETSc's
+ * binary format (header followed by big-endian values, exactly what VecView
+ * writes), into a staging buffer taken from a pool. A thread on rank 0 then
+ * appends the staged buffers to their files in the order they were queued,
+ * and returns the buffers to the pool. If every buffer is in use, appendVec
+ * waits for the thread, which bounds the memory used for staging. The thread
+ * makes no MPI or PETSc calls.
+ *
+ * The output files are created, and the first record written, by
+ * initiate_appendVecToOutput or io_initiateWriteAppend as before; appendVec
+ * takes the resulting viewer and filename pair, so it replaces
+ *   VecView(vec,_viewers[key].first)
+ * for the later records. The viewer is destroyed (and set to NULL) by the
+ * first appendVec, so that only the thread has the file open. If
+ * asynchronous output is turned off (the default) appendVec simply calls
+ * VecView.
+ *
+ */
+
+class AsyncWriter
+{
+public:
+
+  int              _enabled; // 1 to write in the background, 0 for VecView
+  PetscInt         _numBuffers; // max # of staged Vecs waiting to be written
+  double           _stageTime; // time spent gathering and copying into staging buffers
+  double           _waitTime; // time spent waiting for the writer thread
+
+  AsyncWriter();
+  ~AsyncWriter();
+
+  // start the writer thread (on rank 0) if enabled == 1
+  PetscErrorCode setUp(const int enabled, const PetscInt numBuffers);
+
+  // append vec to the binary file vw.second, which vw.first was opened on
+  // (destroys vw.first if enabled)
+  PetscErrorCode appendVec(const Vec& vec, pair<PetscViewer,string>& vw);
+
+  // wait until everything queued so far is on disk, e.g. before a checkpoint
+  PetscErrorCode flush();
+
+private:
+  // disable default copy constructor and assignment operator
+  AsyncWriter(const AsyncWriter& that);
+  AsyncWriter& operator=(const AsyncWriter& rhs);
+
+  // gathers the Vec written to each file onto rank 0
+  struct Gather { VecScatter _scatter; Vec _seq; PetscInt _N; };
+  map<string,Gather>      _gathers; // key = filename
+
+  struct Job { vector<char>* _buf; string _filename; };
+
+  PetscMPIInt             _rank;
+  vector<vector<char>* >  _pool,_free; // all staging buffers, and the unused ones
+  deque<Job>              _queue; // staged buffers waiting to be written
+  size_t                  _busy; // # of jobs taken by the thread but not finished
+  map<string,FILE*>       _files; // open output files (writer thread only)
+  bool                    _stop;
+  string                  _errorFile; // set by the thread if a write fails
+
+  std::thread             _thread;
+  std::mutex              _mutex;
+  std::condition_variable _workReady,_workDone;
+
+  void run(); // body of the writer thread
+  PetscErrorCode checkError();
+  PetscErrorCode stop();
+};
+
+#endif
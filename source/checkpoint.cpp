@@ -0,0 +1,470 @@
+#include "checkpoint.hpp"
+
+#define FILENAME "checkpoint.cpp"
+
+using namespace std;
+
+
+const int Checkpoint::_version = 1;
+
+static const char     ckptMagic[8] = "SCYCKPT";
+static const uint64_t fnvOffset = 14695981039346656037ULL;
+static const uint64_t fnvPrime = 1099511628211ULL;
+
+// last of SIGTERM and SIGUSR1 received, 0 if none
+static volatile sig_atomic_t ckptSignal = 0;
+
+static void ckptSignalHandler(int sig)
+{
+  ckptSignal = sig;
+}
+
+
+// 64-bit FNV-1a hash, updated with every block written or read
+static void updateChecksum(uint64_t& hash, const void *data, const size_t bytes)
+{
+  const unsigned char *p = (const unsigned char*) data;
+  for (size_t i = 0; i < bytes; i++) {
+    hash ^= p[i];
+    hash *= fnvPrime;
+  }
+}
+
+static bool writeBlock(FILE *fp, const void *data, const size_t bytes, uint64_t& hash)
+{
+  updateChecksum(hash,data,bytes);
+  return bytes == 0 || fwrite(data,1,bytes,fp) == bytes;
+}
+
+static bool readBlock(FILE *fp, void *data, const size_t bytes, uint64_t& hash)
+{
+  if (bytes > 0 && fread(data,1,bytes,fp) != bytes) { return false; }
+  updateChecksum(hash,data,bytes);
+  return true;
+}
+
+static bool writeName(FILE *fp, const string& name, uint64_t& hash)
+{
+  int64_t len = name.size();
+  return writeBlock(fp,&len,sizeof(len),hash) && writeBlock(fp,name.c_str(),len,hash);
+}
+
+static bool readName(FILE *fp, string& name, uint64_t& hash)
+{
+  int64_t len = 0;
+  if (!readBlock(fp,&len,sizeof(len),hash) || len < 0 || len > 4096) { return false; }
+  vector<char> buf(len + 1,'\0');
+  if (!readBlock(fp,&buf[0],len,hash)) { return false; }
+  name = string(&buf[0],len);
+  return true;
+}
+
+// write an ASCII file next to filename and rename it, so that readers see
+// either the old or the new contents
+static bool writeASCIIAtomic(const string& filename, const PetscInt val)
+{
+  const string tmp = filename + ".tmp";
+  FILE *fp = fopen(tmp.c_str(),"w");
+  if (fp == NULL) { return false; }
+  bool ok = fprintf(fp,"%i\n",(int) val) > 0 && fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+  ok = (fclose(fp) == 0) && ok;
+  return ok && rename(tmp.c_str(),filename.c_str()) == 0;
+}
+
+
+Checkpoint::Checkpoint()
+: _writeTime(0),_loadTime(0),_numWrites(0),_rank(0),
+  _wallInterval(-1),_keep(0),_onSignal(0),_lastWallTime(0),_loadedFile("")
+{
+  MPI_Comm_rank(PETSC_COMM_WORLD,&_rank);
+  _lastWallTime = MPI_Wtime();
+}
+
+
+Checkpoint::~Checkpoint()
+{ }
+
+
+string Checkpoint::filename(const string outputDir, const PetscInt ckptNumber)
+{
+  return outputDir + "checkpoint_" + to_string(ckptNumber);
+}
+
+
+PetscErrorCode Checkpoint::setUp(const PetscScalar wallInterval, const PetscInt keep, const int onSignal)
+{
+  PetscErrorCode ierr = 0;
+  assert(keep >= 0);
+  assert(onSignal == 0 || onSignal == 1);
+  _wallInterval = wallInterval;
+  _keep = keep;
+  _onSignal = onSignal;
+
+  // replaces PETSc's handler for these, which would abort the run
+  if (_onSignal) {
+    signal(SIGTERM,ckptSignalHandler);
+    signal(SIGUSR1,ckptSignalHandler);
+  }
+
+  return ierr;
+}
+
+
+// Collective. The wall time is rank 0's, and a signal received by any rank
+// counts, so that all ranks agree.
+PetscErrorCode Checkpoint::checkWrite(const PetscInt stepCount, const PetscInt interval, bool& write, bool& stop)
+{
+  PetscErrorCode ierr = 0;
+  write = false;
+  stop = false;
+
+  if (interval > 0 && stepCount % interval == 0) {
+    write = true;
+    stop = true;
+  }
+  if (_wallInterval <= 0 && !_onSignal) { return ierr; }
+
+  int flags[2] = {0,0}; // wall interval has passed, signal received
+  if (_rank == 0 && _wallInterval > 0) { flags[0] = (MPI_Wtime() - _lastWallTime >= _wallInterval); }
+  if (_onSignal) { flags[1] = (int) ckptSignal; }
+  ierr = MPI_Allreduce(MPI_IN_PLACE,flags,2,MPI_INT,MPI_MAX,PETSC_COMM_WORLD);CHKERRQ(ierr);
+
+  if (flags[0]) { write = true; }
+  if (flags[1]) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Note: received signal %i, writing a checkpoint and stopping\n",flags[1]);CHKERRQ(ierr);
+    write = true;
+    stop = true;
+  }
+
+  return ierr;
+}
+
+
+PetscErrorCode Checkpoint::setScalar(const string name, const PetscScalar val)
+{
+  assert(name.find('\n') == string::npos);
+  _scalars[name] = val;
+  return 0;
+}
+
+
+PetscErrorCode Checkpoint::setVec(const string name, const Vec& vec)
+{
+  assert(name.find('\n') == string::npos);
+  assert(vec != NULL);
+  _vecs[name] = vec;
+  return 0;
+}
+
+
+// Collective.
+PetscErrorCode Checkpoint::write(const string outputDir, const PetscInt ckptNumber)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "Checkpoint::write";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  double startTime = MPI_Wtime();
+
+  const string file = filename(outputDir,ckptNumber);
+  int ok = 1;
+  ierr = writeFile(file + ".tmp",ckptNumber,ok);CHKERRQ(ierr);
+
+  if (_rank == 0) {
+    // the checkpoint becomes visible only once it is complete, and only then
+    // is it made the one to restart from
+    if (ok) { ok = rename((file + ".tmp").c_str(),file.c_str()) == 0; }
+    if (ok) { ok = writeASCIIAtomic(outputDir + "ckptNumber",ckptNumber); }
+    if (!ok) { remove((file + ".tmp").c_str()); }
+    if (ok) { removeOld(outputDir,ckptNumber); }
+  }
+  ierr = MPI_Bcast(&ok,1,MPI_INT,0,PETSC_COMM_WORLD);CHKERRQ(ierr);
+  if (!ok) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"ERROR: could not write checkpoint %s\n",file.c_str());CHKERRQ(ierr);
+    assert(0);
+  }
+
+  _scalars.clear();
+  _vecs.clear();
+  _numWrites++;
+
+  _lastWallTime = MPI_Wtime();
+  _writeTime += _lastWallTime - startTime;
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+
+// Rank 0 only: delete the checkpoints older than the last _keep ones,
+// going back until one is missing, since earlier ones were deleted before.
+void Checkpoint::removeOld(const string outputDir, const PetscInt ckptNumber)
+{
+  if (_keep <= 0) { return; }
+  for (PetscInt n = ckptNumber - _keep; n > 0; n--) {
+    if (remove(filename(outputDir,n).c_str()) != 0) { break; }
+  }
+}
+
+
+// Collective. Rank 0 writes the file, and each Vec is gathered onto it in turn.
+// ok is only set on rank 0.
+PetscErrorCode Checkpoint::writeFile(const string filename, const PetscInt ckptNumber, int& ok)
+{
+  PetscErrorCode ierr = 0;
+  FILE *fp = NULL;
+  uint64_t hash = fnvOffset;
+
+  ok = 1;
+  if (_rank == 0) {
+    fp = fopen(filename.c_str(),"wb");
+    ok = (fp != NULL);
+  }
+
+  // header and scalars
+  if (_rank == 0 && ok) {
+    int32_t version = _version;
+    int64_t header[3] = {(int64_t) ckptNumber,(int64_t) _scalars.size(),(int64_t) _vecs.size()};
+    ok = writeBlock(fp,ckptMagic,sizeof(ckptMagic),hash)
+      && writeBlock(fp,&version,sizeof(version),hash)
+      && writeBlock(fp,header,sizeof(header),hash);
+    for (map<string,PetscScalar>::iterator it = _scalars.begin(); ok && it != _scalars.end(); it++) {
+      ok = writeName(fp,it->first,hash) && writeBlock(fp,&it->second,sizeof(PetscScalar),hash);
+    }
+  }
+
+  // Vecs, in the global ordering
+  for (map<string,Vec>::iterator it = _vecs.begin(); it != _vecs.end(); it++) {
+    PetscInt   N = 0;
+    VecScatter scatter;
+    Vec        seq;
+    ierr = VecGetSize(it->second,&N);CHKERRQ(ierr);
+    ierr = VecScatterCreateToZero(it->second,&scatter,&seq);CHKERRQ(ierr);
+    ierr = VecScatterBegin(scatter,it->second,seq,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+    ierr = VecScatterEnd(scatter,it->second,seq,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+    if (_rank == 0 && ok) {
+      const PetscScalar *x;
+      int64_t n = N;
+      ierr = VecGetArrayRead(seq,&x);CHKERRQ(ierr);
+      ok = writeName(fp,it->first,hash)
+        && writeBlock(fp,&n,sizeof(n),hash)
+        && writeBlock(fp,x,N*sizeof(PetscScalar),hash);
+      ierr = VecRestoreArrayRead(seq,&x);CHKERRQ(ierr);
+    }
+    ierr = VecScatterDestroy(&scatter);CHKERRQ(ierr);
+    ierr = VecDestroy(&seq);CHKERRQ(ierr);
+  }
+
+  // checksum, then make sure everything is on disk before the file is renamed
+  if (_rank == 0 && fp != NULL) {
+    ok = ok && fwrite(&hash,sizeof(hash),1,fp) == 1;
+    ok = ok && fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+    ok = (fclose(fp) == 0) && ok;
+  }
+
+  return ierr;
+}
+
+
+// Collective.
+PetscErrorCode Checkpoint::load(const string outputDir, const PetscInt ckptNumber)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "Checkpoint::load";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  double startTime = MPI_Wtime();
+
+  _loadedFile = filename(outputDir,ckptNumber);
+  _loadedScalars.clear();
+  _loadedSizes.clear();
+  _loadedVecs.clear();
+
+  int ok = 1;
+  if (_rank == 0) { ierr = readFile(_loadedFile,ok);CHKERRQ(ierr); }
+  ierr = MPI_Bcast(&ok,1,MPI_INT,0,PETSC_COMM_WORLD);CHKERRQ(ierr);
+  if (!ok) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"ERROR: could not load checkpoint %s\n",_loadedFile.c_str());CHKERRQ(ierr);
+    assert(0);
+  }
+  ierr = bcastLoaded();CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Note: Loaded checkpoint %s\n",_loadedFile.c_str());CHKERRQ(ierr);
+
+  _loadTime += MPI_Wtime() - startTime;
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+
+// Rank 0 only: read the whole file, and check its version and checksum.
+PetscErrorCode Checkpoint::readFile(const string filename, int& ok)
+{
+  PetscErrorCode ierr = 0;
+  uint64_t hash = fnvOffset;
+
+  FILE *fp = fopen(filename.c_str(),"rb");
+  ok = (fp != NULL);
+  if (!ok) { return ierr; }
+
+  char    magic[8];
+  int32_t version = 0;
+  int64_t header[3] = {0,0,0}; // checkpoint number, # of scalars, # of Vecs
+  ok = readBlock(fp,magic,sizeof(magic),hash)
+    && readBlock(fp,&version,sizeof(version),hash)
+    && readBlock(fp,header,sizeof(header),hash);
+  if (ok && (memcmp(magic,ckptMagic,sizeof(ckptMagic)) != 0 || version != _version)) {
+    ierr = PetscPrintf(PETSC_COMM_SELF,"ERROR: %s is not a checkpoint file of version %i\n",filename.c_str(),_version);CHKERRQ(ierr);
+    ok = 0;
+  }
+
+  string name;
+  for (int64_t i = 0; ok && i < header[1]; i++) {
+    PetscScalar val = 0;
+    ok = readName(fp,name,hash) && readBlock(fp,&val,sizeof(PetscScalar),hash);
+    if (ok) { _loadedScalars[name] = val; }
+  }
+  for (int64_t i = 0; ok && i < header[2]; i++) {
+    int64_t n = 0;
+    ok = readName(fp,name,hash) && readBlock(fp,&n,sizeof(n),hash) && n >= 0;
+    if (ok) {
+      vector<PetscScalar>& data = _loadedVecs[name];
+      data.resize(n);
+      ok = readBlock(fp,data.data(),n*sizeof(PetscScalar),hash);
+      _loadedSizes[name] = (PetscInt) n;
+    }
+  }
+
+  uint64_t stored = 0;
+  ok = ok && fread(&stored,sizeof(stored),1,fp) == 1;
+  if (ok && stored != hash) {
+    ierr = PetscPrintf(PETSC_COMM_SELF,"ERROR: checksum of %s does not match, the file is corrupt\n",filename.c_str());CHKERRQ(ierr);
+    ok = 0;
+  }
+  fclose(fp);
+
+  return ierr;
+}
+
+
+// Collective. Give every rank the scalars and the names and sizes of the
+// Vecs, which only rank 0 has after reading the file.
+PetscErrorCode Checkpoint::bcastLoaded()
+{
+  PetscErrorCode ierr = 0;
+
+  string              names; // one per line, scalars first
+  vector<PetscScalar> vals;
+  vector<PetscInt>    sizes;
+  int                 counts[3] = {0,0,0}; // # of scalars, # of Vecs, length of names
+  if (_rank == 0) {
+    for (map<string,PetscScalar>::iterator it = _loadedScalars.begin(); it != _loadedScalars.end(); it++) {
+      names += it->first + "\n";
+      vals.push_back(it->second);
+    }
+    for (map<string,PetscInt>::iterator it = _loadedSizes.begin(); it != _loadedSizes.end(); it++) {
+      names += it->first + "\n";
+      sizes.push_back(it->second);
+    }
+    counts[0] = vals.size(); counts[1] = sizes.size(); counts[2] = names.size();
+  }
+
+  ierr = MPI_Bcast(counts,3,MPI_INT,0,PETSC_COMM_WORLD);CHKERRQ(ierr);
+  names.resize(counts[2]);
+  vals.resize(counts[0]);
+  sizes.resize(counts[1]);
+  if (counts[2] > 0) { ierr = MPI_Bcast(&names[0],counts[2],MPI_CHAR,0,PETSC_COMM_WORLD);CHKERRQ(ierr); }
+  if (counts[0] > 0) { ierr = MPI_Bcast(vals.data(),counts[0],MPIU_SCALAR,0,PETSC_COMM_WORLD);CHKERRQ(ierr); }
+  if (counts[1] > 0) { ierr = MPI_Bcast(sizes.data(),counts[1],MPIU_INT,0,PETSC_COMM_WORLD);CHKERRQ(ierr); }
+
+  if (_rank != 0) {
+    size_t pos = 0, end = 0;
+    for (int i = 0; i < counts[0] + counts[1]; i++) {
+      end = names.find('\n',pos);
+      const string name = names.substr(pos,end - pos);
+      pos = end + 1;
+      if (i < counts[0]) { _loadedScalars[name] = vals[i]; }
+      else { _loadedSizes[name] = sizes[i - counts[0]]; }
+    }
+  }
+
+  return ierr;
+}
+
+
+bool Checkpoint::hasEntry(const string name) const
+{
+  return _loadedScalars.find(name) != _loadedScalars.end() || _loadedSizes.find(name) != _loadedSizes.end();
+}
+
+
+PetscErrorCode Checkpoint::getScalar(const string name, PetscScalar& val) const
+{
+  PetscErrorCode ierr = 0;
+  map<string,PetscScalar>::const_iterator it = _loadedScalars.find(name);
+  if (it == _loadedScalars.end()) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"ERROR: checkpoint %s does not contain %s\n",_loadedFile.c_str(),name.c_str());CHKERRQ(ierr);
+    assert(0);
+  }
+  val = it->second;
+  return ierr;
+}
+
+
+PetscErrorCode Checkpoint::getScalar(const string name, PetscInt& val) const
+{
+  PetscErrorCode ierr = 0;
+  PetscScalar temp = 0;
+  ierr = getScalar(name,temp);CHKERRQ(ierr);
+  val = (PetscInt) round(temp);
+  return ierr;
+}
+
+
+// Collective.
+PetscErrorCode Checkpoint::getVec(const string name, Vec& vec) const
+{
+  PetscErrorCode ierr = 0;
+  map<string,PetscInt>::const_iterator it = _loadedSizes.find(name);
+  if (it == _loadedSizes.end()) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"ERROR: checkpoint %s does not contain %s\n",_loadedFile.c_str(),name.c_str());CHKERRQ(ierr);
+    assert(0);
+  }
+
+  PetscInt N = 0;
+  ierr = VecGetSize(vec,&N);CHKERRQ(ierr);
+  if (N != it->second) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"ERROR: %s in checkpoint %s has size %i, expected %i\n",
+      name.c_str(),_loadedFile.c_str(),it->second,N);CHKERRQ(ierr);
+    assert(0);
+  }
+
+  VecScatter scatter;
+  Vec        seq;
+  ierr = VecScatterCreateToZero(vec,&scatter,&seq);CHKERRQ(ierr);
+  if (_rank == 0) {
+    const vector<PetscScalar>& data = _loadedVecs.find(name)->second;
+    PetscScalar *x;
+    ierr = VecGetArray(seq,&x);CHKERRQ(ierr);
+    for (PetscInt Ii = 0; Ii < N; Ii++) { x[Ii] = data[Ii]; }
+    ierr = VecRestoreArray(seq,&x);CHKERRQ(ierr);
+  }
+  ierr = VecScatterBegin(scatter,seq,vec,INSERT_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+  ierr = VecScatterEnd(scatter,seq,vec,INSERT_VALUES,SCATTER_REVERSE);CHKERRQ(ierr);
+  ierr = VecScatterDestroy(&scatter);CHKERRQ(ierr);
+  ierr = VecDestroy(&seq);CHKERRQ(ierr);
+
+  return ierr;
+}
+
+
+PetscErrorCode Checkpoint::releaseLoaded()
+{
+  _loadedSizes.clear();
+  _loadedVecs.clear();
+  return 0;
+}
@@ -0,0 +1,118 @@
+#ifndef CHECKPOINT_HPP_INCLUDED
+#define CHECKPOINT_HPP_INCLUDED
+
+#include <petscksp.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <stdint.h>
+#include <unistd.h>
+#include <signal.h>
+#include <assert.h>
+
+using namespace std;
+
+/*
+ * Writes and reads the checkpoint files used to restart a simulation.
+ *
+ * Each checkpoint is one binary file, outputDir/checkpoint_<ckptNumber>,
+ * holding every named scalar and Vec that the mediator, the integrator and
+ * the physics modules registered with setScalar and setVec. The file starts
+ * with a header (magic string, format version, checkpoint number, and the #
+ * of scalars and Vecs), followed by the scalars, then the Vecs as their
+ * global size and values in the global PETSc ordering, and ends with a
+ * checksum of everything before it. Vecs are gathered onto rank 0, which
+ * does all the file I/O.
+ *
+ * The file is written as checkpoint_<ckptNumber>.tmp and renamed only once
+ * it is complete and on disk, after which the ASCII file outputDir/ckptNumber
+ * is replaced the same way. A run that is killed while checkpointing
+ * therefore always leaves the previous checkpoint intact and pointed to.
+ *
+ * When restarting, Domain loads the checkpoint named in outputDir/ckptNumber,
+ * and each class copies its fields back out with getScalar and getVec. Files
+ * with a different format version, or whose checksum does not match, are
+ * rejected.
+ *
+ * checkWrite decides when the mediators write a checkpoint:
+ *   - every interval time steps, after which the run stops, as before
+ *     (interval = 0 turns this off),
+ *   - every checkpointWallInterval seconds of wall time since the last
+ *     checkpoint, after which the run continues (<= 0 turns this off),
+ *   - when any rank receives SIGTERM or SIGUSR1, after which the run stops,
+ *     so that a job being preempted by the batch scheduler can be resumed
+ *     from where it was (checkpointOnSignal = 0 turns this off, and leaves
+ *     PETSc's signal handling as is).
+ * Only the last checkpointKeep checkpoints are kept on disk, older ones are
+ * deleted after each write (checkpointKeep = 0 keeps them all).
+ *
+ */
+
+class Checkpoint
+{
+public:
+
+  static const int  _version; // file format version
+  double            _writeTime,_loadTime; // time spent writing and loading checkpoints
+  PetscInt          _numWrites;
+
+  Checkpoint();
+  ~Checkpoint();
+
+  // checkpoint file with number ckptNumber in outputDir
+  static string filename(const string outputDir, const PetscInt ckptNumber);
+
+  // set the checkpoint policy, and install the signal handlers if onSignal = 1
+  PetscErrorCode setUp(const PetscScalar wallInterval, const PetscInt keep, const int onSignal);
+
+  // whether to write a checkpoint at time step stepCount, and whether to
+  // stop integrating afterwards (collective)
+  PetscErrorCode checkWrite(const PetscInt stepCount, const PetscInt interval, bool& write, bool& stop);
+
+  // add an entry to the next checkpoint, vec must not be destroyed before write
+  PetscErrorCode setScalar(const string name, const PetscScalar val);
+  PetscErrorCode setVec(const string name, const Vec& vec);
+
+  // write every entry added since the last write (collective)
+  PetscErrorCode write(const string outputDir, const PetscInt ckptNumber);
+
+  // read checkpoint file with number ckptNumber (collective)
+  PetscErrorCode load(const string outputDir, const PetscInt ckptNumber);
+
+  // copy entries out of the loaded checkpoint, vec must already be allocated
+  // with the global size it was written with (getVec is collective)
+  bool hasEntry(const string name) const;
+  PetscErrorCode getScalar(const string name, PetscScalar& val) const;
+  PetscErrorCode getScalar(const string name, PetscInt& val) const;
+  PetscErrorCode getVec(const string name, Vec& vec) const;
+
+  // free the loaded Vecs, once every class has read its fields
+  PetscErrorCode releaseLoaded();
+
+private:
+  // disable default copy constructor and assignment operator
+  Checkpoint(const Checkpoint& that);
+  Checkpoint& operator=(const Checkpoint& rhs);
+
+  PetscMPIInt                       _rank;
+  PetscScalar                       _wallInterval; // (s) wall time between checkpoints
+  PetscInt                          _keep; // # of checkpoints kept on disk
+  int                               _onSignal;
+  double                            _lastWallTime; // wall time at the end of the last write
+  map<string,PetscScalar>           _scalars; // entries for the next write
+  map<string,Vec>                   _vecs;
+  string                            _loadedFile;
+  map<string,PetscScalar>           _loadedScalars; // entries of the loaded checkpoint
+  map<string,PetscInt>              _loadedSizes; // global size of each loaded Vec
+  map<string,vector<PetscScalar> >  _loadedVecs; // values of each loaded Vec (rank 0 only)
+
+  PetscErrorCode writeFile(const string filename, const PetscInt ckptNumber, int& ok);
+  PetscErrorCode readFile(const string filename, int& ok);
+  PetscErrorCode bcastLoaded();
+  void removeOld(const string outputDir, const PetscInt ckptNumber);
+};
+
+#endif
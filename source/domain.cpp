@@ -12,9 +12,12 @@ Domain::Domain(const char *file)
   _momentumBalanceType("quasidynamic"),
   _operatorType("matrix-based"),_sbpCompatibilityType("fullyCompatible"),
   _gridSpacingType("variableGridSpacing"),_isMMS(0),
+  _computeGreensFunction(0),_greensFunctionBlockSize(32),
   _order(4),_Ny(-1),_Nz(-1),_Ly(-1),_Lz(-1),_vL(1e-9),
   _q(NULL),_r(NULL),_y(NULL),_z(NULL),_y0(NULL),_z0(NULL),_dq(1),_dr(1),
-  _bCoordTrans(-1), _ckpt(0), _ckptNumber(0), _interval(1e4),_outFileMode(FILE_MODE_WRITE)
+  _bCoordTrans(-1), _ckpt(0), _ckptNumber(0), _interval(1e4),
+  _ckptWallInterval(-1),_ckptKeep(2),_ckptOnSignal(1),_outFileMode(FILE_MODE_WRITE),
+  _outputFormat("binary"),_hdf5Compress(0),_asyncOutput(0),_asyncOutputBuffers(64)
 {
   #if VERBOSE > 1
     string funcName = "Domain::Domain(const char *file)";
@@ -25,7 +28,10 @@ Domain::Domain(const char *file)
   loadSettings(_file);
   if (_ckpt > 0) {
     loadValueFromCheckpoint(_outputDir, "ckptNumber", _ckptNumber);
-    if (_ckptNumber > 0) { _outFileMode = FILE_MODE_APPEND; }
+    if (_ckptNumber > 0) {
+      _outFileMode = FILE_MODE_APPEND;
+      _checkpoint.load(_outputDir,_ckptNumber);
+    }
   }
 
   // grid spacing for logical coordinates
@@ -45,6 +51,13 @@ Domain::Domain(const char *file)
   checkInput(); // perform some basic value checking to prevent NaNs
   setFields();
   setScatters();
+  _asyncWriter.setUp(_asyncOutput,_asyncOutputBuffers);
+  if (_ckpt > 0) {
+    _checkpoint.setUp(_ckptWallInterval,_ckptKeep,_ckptOnSignal);
+  }
+  if (_outputFormat.compare("hdf5") == 0) {
+    _hdf5Writer.setUp(_outputDir + "output.h5",_outFileMode,_hdf5Compress);
+  }
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -59,9 +72,12 @@ Domain::Domain(const char *file,PetscInt Ny, PetscInt Nz)
   _bulkDeformationType("linearElastic"),_momentumBalanceType("quasidynamic"),
   _operatorType("matrix-based"),_sbpCompatibilityType("fullyCompatible"),
   _gridSpacingType("variableGridSpacing"),_isMMS(0),
+  _computeGreensFunction(0),_greensFunctionBlockSize(32),
   _order(4),_Ny(Ny),_Nz(Nz),_Ly(-1),_Lz(-1),_vL(1e-9),
   _q(NULL),_r(NULL),_y(NULL),_z(NULL),_y0(NULL),_z0(NULL),_dq(1),_dr(1),
-  _bCoordTrans(-1), _ckpt(0), _ckptNumber(0), _interval(500),_outFileMode(FILE_MODE_WRITE)
+  _bCoordTrans(-1), _ckpt(0), _ckptNumber(0), _interval(500),
+  _ckptWallInterval(-1),_ckptKeep(2),_ckptOnSignal(1),_outFileMode(FILE_MODE_WRITE),
+  _outputFormat("binary"),_hdf5Compress(0),_asyncOutput(0),_asyncOutputBuffers(64)
 {
   #if VERBOSE > 1
     string funcName = "Domain::Domain(const char *file,PetscInt Ny, PetscInt Nz)";
@@ -71,7 +87,10 @@ Domain::Domain(const char *file,PetscInt Ny, PetscInt Nz)
   loadSettings(_file);
   if (_ckpt > 0) {
     loadValueFromCheckpoint(_outputDir, "ckptNumber", _ckptNumber);
-    _outFileMode = FILE_MODE_APPEND;
+    if (_ckptNumber > 0) {
+      _outFileMode = FILE_MODE_APPEND;
+      _checkpoint.load(_outputDir,_ckptNumber);
+    }
   }
 
   _Ny = Ny;
@@ -94,6 +113,13 @@ Domain::Domain(const char *file,PetscInt Ny, PetscInt Nz)
   checkInput(); // perform some basic value checking to prevent NaNs
   setFields();
   setScatters();
+  _asyncWriter.setUp(_asyncOutput,_asyncOutputBuffers);
+  if (_ckpt > 0) {
+    _checkpoint.setUp(_ckptWallInterval,_ckptKeep,_ckptOnSignal);
+  }
+  if (_outputFormat.compare("hdf5") == 0) {
+    _hdf5Writer.setUp(_outputDir + "output.h5",_outFileMode,_hdf5Compress);
+  }
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -179,6 +205,8 @@ PetscErrorCode Domain::loadSettings(const char *file)
     else if (var.compare("bulkDeformationType")==0) { _bulkDeformationType = rhs; }
     else if (var.compare("momentumBalanceType")==0) { _momentumBalanceType = rhs; }
     else if (var.compare("isMMS") == 0) { _isMMS = atoi(rhs.c_str()); }
+    else if (var.compare("computeGreensFunction") == 0) { _computeGreensFunction = atoi(rhs.c_str()); }
+    else if (var.compare("greensFunctionBlockSize") == 0) { _greensFunctionBlockSize = atoi(rhs.c_str()); }
 
 
     else if (var.compare("bCoordTrans")==0) { _bCoordTrans = atof( rhs.c_str() ); }
@@ -186,6 +214,14 @@ PetscErrorCode Domain::loadSettings(const char *file)
 
     else if (var.compare("enableCheckpointing") == 0) { _ckpt = atoi(rhs.c_str()); }
     else if (var.compare("interval") == 0) { _interval = (int)atof(rhs.c_str()); }
+    else if (var.compare("checkpointWallInterval") == 0) { _ckptWallInterval = atof(rhs.c_str()); }
+    else if (var.compare("checkpointKeep") == 0) { _ckptKeep = atoi(rhs.c_str()); }
+    else if (var.compare("checkpointOnSignal") == 0) { _ckptOnSignal = atoi(rhs.c_str()); }
+
+    else if (var.compare("outputFormat") == 0) { _outputFormat = rhs; }
+    else if (var.compare("hdf5Compress") == 0) { _hdf5Compress = atoi(rhs.c_str()); }
+    else if (var.compare("asyncOutput") == 0) { _asyncOutput = atoi(rhs.c_str()); }
+    else if (var.compare("asyncOutputBuffers") == 0) { _asyncOutputBuffers = atoi(rhs.c_str()); }
   }
 
   #if VERBOSE > 1
@@ -219,6 +255,8 @@ PetscErrorCode Domain::view(PetscMPIInt rank)
     ierr = PetscPrintf(PETSC_COMM_SELF,"Lz = %e\n",_Lz);CHKERRQ(ierr);
     ierr = PetscPrintf(PETSC_COMM_SELF,"\n");CHKERRQ(ierr);
     ierr = PetscPrintf(PETSC_COMM_SELF,"isMMS = %i\n",_isMMS);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_SELF,"computeGreensFunction = %i\n",_computeGreensFunction);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_SELF,"greensFunctionBlockSize = %i\n",_greensFunctionBlockSize);CHKERRQ(ierr);
     ierr = PetscPrintf(PETSC_COMM_SELF,"momBalType = %s\n",_momentumBalanceType.c_str());CHKERRQ(ierr);
     ierr = PetscPrintf(PETSC_COMM_SELF,"bulkDeformationType = %s\n",_bulkDeformationType.c_str());CHKERRQ(ierr);
     ierr = PetscPrintf(PETSC_COMM_SELF,"operatorType = %s\n",_operatorType.c_str());CHKERRQ(ierr);
@@ -259,10 +297,27 @@ PetscErrorCode Domain::checkInput()
   assert(_gridSpacingType.compare("variableGridSpacing") == 0 ||
      _gridSpacingType.compare("constantGridSpacing") == 0);
 
+  // matrix-free operators are only implemented for constant grid spacing
+  assert(_operatorType.compare("matrix-based") == 0 ||
+    _operatorType.compare("matrix-free") == 0);
+  if (_operatorType.compare("matrix-free") == 0 && _gridSpacingType.compare("constantGridSpacing") != 0) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"ERROR: operatorType = matrix-free requires gridSpacingType = constantGridSpacing and bCoordTrans <= 0.\n");CHKERRQ(ierr);
+    assert(0);
+  }
+
   assert(_momentumBalanceType.compare("quasidynamic") == 0 ||
+    _momentumBalanceType.compare("quasidynamic_greensFunction") == 0 ||
+    _momentumBalanceType.compare("quasidynamic_hmatrix") == 0 ||
     _momentumBalanceType.compare("dynamic") == 0 ||
     _momentumBalanceType.compare("quasidynamic_and_dynamic") == 0 ||
     _momentumBalanceType.compare("steadyStateIts") == 0);
+  if (_momentumBalanceType.compare("quasidynamic_greensFunction") == 0 ||
+    _momentumBalanceType.compare("quasidynamic_hmatrix") == 0) {
+    assert(_bulkDeformationType.compare("linearElastic") == 0);
+  }
+
+  assert(_computeGreensFunction == 0 || _computeGreensFunction == 1);
+  assert(_greensFunctionBlockSize > 0);
 
   assert(_order == 2 || _order == 4);
   assert(_Ly > 0 && _Lz > 0);
@@ -271,6 +326,12 @@ PetscErrorCode Domain::checkInput()
 
   assert(_ckpt >= 0 && _ckptNumber >= 0);
   assert(_interval >= 0);
+  assert(_ckptKeep >= 0);
+  assert(_ckptOnSignal == 0 || _ckptOnSignal == 1);
+  assert(_outputFormat.compare("binary") == 0 || _outputFormat.compare("hdf5") == 0);
+  assert(_hdf5Compress == 0 || _hdf5Compress == 1);
+  assert(_asyncOutput == 0 || _asyncOutput == 1);
+  assert(_asyncOutputBuffers > 0);
 
   #if VERBOSE > 1
     ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -310,6 +371,8 @@ PetscErrorCode Domain::write()
   ierr = PetscViewerASCIIPrintf(viewer,"Lz = %g # (km)\n",_Lz);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"\n");CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"isMMS = %i\n",_isMMS);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"computeGreensFunction = %i\n",_computeGreensFunction);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"greensFunctionBlockSize = %i\n",_greensFunctionBlockSize);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"momBalType = %s\n",_momentumBalanceType.c_str());CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"bulkDeformationType = %s\n",_bulkDeformationType.c_str());CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"operatorType = %s\n",_operatorType.c_str());CHKERRQ(ierr);
@@ -325,6 +388,13 @@ PetscErrorCode Domain::write()
   ierr = PetscViewerASCIIPrintf(viewer,"checkpoint enabled = %i\n",_ckpt);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"checkpoint number = %i\n",_ckptNumber);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"checkpoint interval = %i\n",_interval);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"checkpointWallInterval = %g # (s)\n",_ckptWallInterval);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"checkpointKeep = %i\n",_ckptKeep);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"checkpointOnSignal = %i\n",_ckptOnSignal);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"outputFormat = %s\n",_outputFormat.c_str());CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"hdf5Compress = %i\n",_hdf5Compress);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"asyncOutput = %i\n",_asyncOutput);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"asyncOutputBuffers = %i\n",_asyncOutputBuffers);CHKERRQ(ierr);
 
   // get number of processors
   PetscMPIInt size;
@@ -565,3 +635,51 @@ PetscErrorCode Domain::testScatters() {
 
   return ierr;
 }
+
+
+// Start a time series: with outputFormat = binary, create the file filename
+// (or reopen it after a checkpoint) and write vec to it. With outputFormat =
+// hdf5, append vec to the dataset named after filename, leaving out the
+// output directory. vwL[key] then holds no viewer, only the dataset name.
+PetscErrorCode Domain::initiateTimeSeries(map<string,pair<PetscViewer,string> >& vwL, const string key, const Vec& vec, const string filename)
+{
+  PetscErrorCode ierr = 0;
+
+  if (_outputFormat.compare("hdf5") == 0) {
+    string name = filename;
+    if (name.compare(0,_outputDir.size(),_outputDir) == 0) { name = name.substr(_outputDir.size()); }
+    vwL[key].first = NULL;
+    vwL[key].second = name;
+    ierr = _hdf5Writer.appendVec(vec,name);CHKERRQ(ierr);
+  }
+  else {
+    ierr = initiate_appendVecToOutput(vwL,key,vec,filename,_outFileMode);CHKERRQ(ierr);
+  }
+
+  return ierr;
+}
+
+
+// Continue a time series started by initiateTimeSeries.
+PetscErrorCode Domain::appendTimeSeries(const Vec& vec, pair<PetscViewer,string>& vw)
+{
+  PetscErrorCode ierr = 0;
+
+  if (_outputFormat.compare("hdf5") == 0) {
+    ierr = _hdf5Writer.appendVec(vec,vw.second);CHKERRQ(ierr);
+  }
+  else {
+    ierr = _asyncWriter.appendVec(vec,vw);CHKERRQ(ierr);
+  }
+
+  return ierr;
+}
+
+
+PetscErrorCode Domain::flushTimeSeries()
+{
+  PetscErrorCode ierr = 0;
+  ierr = _asyncWriter.flush();CHKERRQ(ierr);
+  ierr = _hdf5Writer.flush();CHKERRQ(ierr);
+  return ierr;
+}
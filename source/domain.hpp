@@ -11,6 +11,9 @@
 #include <petscdmda.h>
 #include <petscdm.h>
 #include "genFuncs.hpp"
+#include "asyncWriter.hpp"
+#include "hdf5Writer.hpp"
+#include "checkpoint.hpp"
 
 /*
  * Class containing basic details of the domain and problem type which
@@ -35,12 +38,14 @@ public:
   string         _inputDir; // directory for optional input vectors
   string         _outputDir; // directory for output
   string         _bulkDeformationType; // options: linearElastic, powerLaw
-  string         _momentumBalanceType; // options: quasidynamic, dynamic, quasidynamic_and_dynamic, steadyStateIts
+  string         _momentumBalanceType; // options: quasidynamic, quasidynamic_greensFunction, quasidynamic_hmatrix, dynamic, quasidynamic_and_dynamic, steadyStateIts
   string         _sbpType; // matrix or matrix-free, compatible or fully compatible
-  string         _operatorType; // matrix-based or matrix-free
+  string         _operatorType; // matrix-based or matrix-free (constantGridSpacing only)
   string         _sbpCompatibilityType; // compatible or fullyCompatible
   string         _gridSpacingType; // variableGridSpacing or constantGridSpacing
   int            _isMMS; // run MMS test or not
+  int            _computeGreensFunction; // 1 to compute the Green's function for surface displacement instead of running a simulation
+  PetscInt       _greensFunctionBlockSize; // # of right-hand sides solved together when computing a Green's function (also for quasidynamic_greensFunction and quasidynamic_hmatrix)
 
   // domain properties
   PetscInt     _order; // accuracy of spatial operators
@@ -55,7 +60,29 @@ public:
 
   // checkpoint enabling
   PetscInt _ckpt, _ckptNumber, _interval;
+  PetscScalar _ckptWallInterval; // (s) wall time between checkpoints
+  PetscInt _ckptKeep; // # of checkpoints kept on disk, 0 to keep all
+  int _ckptOnSignal; // 1 to checkpoint and stop on SIGTERM or SIGUSR1
   PetscFileMode _outFileMode; // FILE_MODE_WRITE or FILE_MODE_APPEND
+  Checkpoint    _checkpoint; // holds checkpoint _ckptNumber when restarting, and writes the next one
+
+  // output of time series
+  string        _outputFormat; // binary (one PETSc binary file per field) or hdf5 (one file for all fields)
+  int           _hdf5Compress; // 1 to compress the HDF5 datasets, 0 otherwise
+  int           _asyncOutput; // 1 to write binary output files in the background, 0 to write with VecView
+  PetscInt      _asyncOutputBuffers; // max # of Vecs staged for writing at once
+  AsyncWriter   _asyncWriter; // writes the binary files
+  Hdf5Writer    _hdf5Writer; // writes <outputDir>output.h5
+
+  // time series output from all classes' writeStep functions goes through
+  // these, which write to the binary file filename, or to the HDF5 dataset
+  // named after it
+  // initiateTimeSeries creates vwL[key] and writes the first value
+  PetscErrorCode initiateTimeSeries(map<string,pair<PetscViewer,string> >& vwL, const string key, const Vec& vec, const string filename);
+  // appendTimeSeries writes each subsequent value, with vw = vwL[key]
+  PetscErrorCode appendTimeSeries(const Vec& vec, pair<PetscViewer,string>& vw);
+  // ensure all output so far is on disk, e.g. before a checkpoint
+  PetscErrorCode flushTimeSeries();
 
   // scatters to take values from body field(s) to 1D fields
   // naming convention for key (string): body2<boundary>, example: "body2L>"
@@ -13,6 +13,7 @@ Fault::Fault(Domain &D, VecScatter& scatter2fault, const int& faultTypeScale)
     _sigmaN_cap(1e14),_sigmaN_floor(0.),
     _fw(0.64),_Vw_const(0.12),_tau_c(3),_D_fh(5),
     _rootTol(1e-12),_rootIts(0),_maxNumIts(1e4),
+    _rootWarmStart(0),_rootWarmStartWidth(0.5),
     _computeVelTime(0),_stateLawTime(0), _scatterTime(0),
     _body2fault(&scatter2fault)
 {
@@ -82,6 +83,8 @@ PetscErrorCode Fault::loadSettings(const char *file)
 
     // tolerance for nonlinear solve
     else if (var.compare("rootTol")==0) { _rootTol = atof( rhs.c_str() ); }
+    else if (var.compare("rootWarmStart")==0) { _rootWarmStart = atoi( rhs.c_str() ); }
+    else if (var.compare("rootWarmStartWidth")==0) { _rootWarmStartWidth = atof( rhs.c_str() ); }
 
     // friction parameters
     else if (var.compare("f0")==0) { _f0 = atof( rhs.c_str() ); }
@@ -149,15 +152,17 @@ PetscErrorCode Fault::loadCheckpoint()
     ierr = PetscPrintf(PETSC_COMM_WORLD,"Starting Fault::loadCheckpoint in fault.cpp.\n");CHKERRQ(ierr);
   #endif
 
-  ierr = loadVecFromInputFile(_sN,_outputDir + "chkpt_","sN"); CHKERRQ(ierr);
-  ierr = loadVecFromInputFile(_sNEff,_outputDir + "chkpt_","sNEff"); CHKERRQ(ierr);
-  ierr = loadVecFromInputFile(_psi,_outputDir + "chkpt_","psi"); CHKERRQ(ierr);
-  ierr = loadVecFromInputFile(_slip,_outputDir + "chkpt_","slip"); CHKERRQ(ierr);
+  const Checkpoint& ckpt = _D->_checkpoint;
+  ierr = ckpt.getVec("fault_sN",_sN); CHKERRQ(ierr);
+  ierr = ckpt.getVec("fault_sNEff",_sNEff); CHKERRQ(ierr);
+  ierr = ckpt.getVec("fault_psi",_psi); CHKERRQ(ierr);
+  ierr = ckpt.getVec("fault_slip",_slip); CHKERRQ(ierr);
+  ierr = ckpt.getVec("fault_slipVel",_slipVel); CHKERRQ(ierr);
 
   // load shear stress: pre-stress, quasistatic, and full
-  ierr = loadVecFromInputFile(_tauQSP,_outputDir + "chkpt_","tauQS"); CHKERRQ(ierr);
-  ierr = loadVecFromInputFile(_tauP,_outputDir + "chkpt_","tau"); CHKERRQ(ierr);
-  ierr = loadVecFromInputFile(_prestress,_outputDir + "chkpt_","prestress"); CHKERRQ(ierr);
+  ierr = ckpt.getVec("fault_tauQS",_tauQSP); CHKERRQ(ierr);
+  ierr = ckpt.getVec("fault_tau",_tauP); CHKERRQ(ierr);
+  ierr = ckpt.getVec("fault_prestress",_prestress); CHKERRQ(ierr);
 
   // rate and state parameters
   ierr = loadVecFromInputFile(_a,_outputDir,"fault_a"); CHKERRQ(ierr);
@@ -201,6 +206,8 @@ PetscErrorCode Fault::checkInput()
   assert(_rhoVals.size() != 0 );
   assert(_muVals.size() != 0 );
   assert(_rootTol >= 1e-14);
+  assert(_rootWarmStart == 0 || _rootWarmStart == 1);
+  assert(_rootWarmStartWidth > 0);
 
   assert(_stateLaw.compare("agingLaw")==0
     || _stateLaw.compare("slipLaw")==0
@@ -472,6 +479,8 @@ PetscErrorCode Fault::writeContext(const string outputDir)
   PetscViewerFileSetName(viewer, str.c_str());
 
   ierr = PetscViewerASCIIPrintf(viewer,"rootTol = %.15e\n",_rootTol);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"rootWarmStart = %i\n",_rootWarmStart);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"rootWarmStartWidth = %.15e\n",_rootWarmStartWidth);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"f0 = %.15e\n",_f0);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"v0 = %.15e\n",_v0);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"stateEvolutionLaw = %s\n",_stateLaw.c_str());CHKERRQ(ierr);
@@ -521,31 +530,31 @@ PetscErrorCode Fault::writeStep(PetscInt stepCount, const string outputDir)
   // these files are initiated only for the first time step and when are checkpointing for the first time, since the files don't exist yet
   // writing vectors into binary files
   if (_viewers.empty()) {
-    ierr = initiate_appendVecToOutput(_viewers, "slip", _slip, outputDir + "slip", _D->_outFileMode); CHKERRQ(ierr);
-    ierr = initiate_appendVecToOutput(_viewers, "slipVel", _slipVel, outputDir + "slipVel", _D->_outFileMode); CHKERRQ(ierr);
-    ierr = initiate_appendVecToOutput(_viewers, "tauP", _tauP, outputDir + "tauP", _D->_outFileMode); CHKERRQ(ierr);
-    ierr = initiate_appendVecToOutput(_viewers, "tauQSP", _tauQSP, outputDir + "tauQSP", _D->_outFileMode); CHKERRQ(ierr);
-    ierr = initiate_appendVecToOutput(_viewers, "strength", _strength, outputDir + "strength", _D->_outFileMode); CHKERRQ(ierr);
-    ierr = initiate_appendVecToOutput(_viewers, "psi", _psi, outputDir + "psi", _D->_outFileMode); CHKERRQ(ierr);
-    ierr = initiate_appendVecToOutput(_viewers, "sNEff", _sNEff, outputDir + "sNEff", _D->_outFileMode); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "slip", _slip, outputDir + "slip"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "slipVel", _slipVel, outputDir + "slipVel"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "tauP", _tauP, outputDir + "tauP"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "tauQSP", _tauQSP, outputDir + "tauQSP"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "strength", _strength, outputDir + "strength"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "psi", _psi, outputDir + "psi"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "sNEff", _sNEff, outputDir + "sNEff"); CHKERRQ(ierr);
 
     if (_stateLaw.compare("flashHeating") == 0) {
-      ierr = initiate_appendVecToOutput(_viewers, "T", _T, outputDir + "fault_T", _D->_outFileMode); CHKERRQ(ierr);
-      ierr = initiate_appendVecToOutput(_viewers, "Vw", _Vw, outputDir + "Vw", _D->_outFileMode); CHKERRQ(ierr);
+      ierr = _D->initiateTimeSeries(_viewers, "T", _T, outputDir + "fault_T"); CHKERRQ(ierr);
+      ierr = _D->initiateTimeSeries(_viewers, "Vw", _Vw, outputDir + "Vw"); CHKERRQ(ierr);
     }
   }
   else {
-    ierr = VecView(_slip,_viewers["slip"].first); CHKERRQ(ierr);
-    ierr = VecView(_slipVel,_viewers["slipVel"].first); CHKERRQ(ierr);
-    ierr = VecView(_tauP,_viewers["tauP"].first); CHKERRQ(ierr);
-    ierr = VecView(_tauQSP,_viewers["tauQSP"].first); CHKERRQ(ierr);
-    ierr = VecView(_strength,_viewers["strength"].first); CHKERRQ(ierr);
-    ierr = VecView(_psi,_viewers["psi"].first); CHKERRQ(ierr);
-    ierr = VecView(_sNEff,_viewers["sNEff"].first); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_slip,_viewers["slip"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_slipVel,_viewers["slipVel"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_tauP,_viewers["tauP"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_tauQSP,_viewers["tauQSP"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_strength,_viewers["strength"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_psi,_viewers["psi"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_sNEff,_viewers["sNEff"]); CHKERRQ(ierr);
 
     if (_stateLaw.compare("flashHeating") == 0) {
-      ierr = VecView(_T,_viewers["T"].first); CHKERRQ(ierr);
-      ierr = VecView(_Vw,_viewers["Vw"].first); CHKERRQ(ierr);
+      ierr = _D->appendTimeSeries(_T,_viewers["T"]); CHKERRQ(ierr);
+      ierr = _D->appendTimeSeries(_Vw,_viewers["Vw"]); CHKERRQ(ierr);
     }
   }
 
@@ -557,7 +566,7 @@ PetscErrorCode Fault::writeStep(PetscInt stepCount, const string outputDir)
 }
 
 
-// writes out vector fields at each time step (specified by user using stepCount)
+// add fault fields to the next checkpoint
 PetscErrorCode Fault::writeCheckpoint()
 {
   PetscErrorCode ierr = 0;
@@ -567,14 +576,15 @@ PetscErrorCode Fault::writeCheckpoint()
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
 
-  ierr = writeVec(_slip, _outputDir + "chkpt_" + "slip"); CHKERRQ(ierr);
-  ierr = writeVec(_slipVel, _outputDir + "chkpt_" + "slipVel"); CHKERRQ(ierr);
-  ierr = writeVec(_psi, _outputDir + "chkpt_" + "psi"); CHKERRQ(ierr);
-  ierr = writeVec(_sNEff, _outputDir + "chkpt_" + "sNEff"); CHKERRQ(ierr);
-  ierr = writeVec(_sN, _outputDir + "chkpt_" + "sN"); CHKERRQ(ierr);
-  ierr = writeVec(_tauP, _outputDir + "chkpt_" + "tau"); CHKERRQ(ierr);
-  ierr = writeVec(_tauQSP, _outputDir + "chkpt_" + "tauQS"); CHKERRQ(ierr);
-  ierr = writeVec(_prestress, _outputDir + "chkpt_" + "prestress"); CHKERRQ(ierr);
+  Checkpoint& ckpt = _D->_checkpoint;
+  ierr = ckpt.setVec("fault_slip",_slip); CHKERRQ(ierr);
+  ierr = ckpt.setVec("fault_slipVel",_slipVel); CHKERRQ(ierr);
+  ierr = ckpt.setVec("fault_psi",_psi); CHKERRQ(ierr);
+  ierr = ckpt.setVec("fault_sNEff",_sNEff); CHKERRQ(ierr);
+  ierr = ckpt.setVec("fault_sN",_sN); CHKERRQ(ierr);
+  ierr = ckpt.setVec("fault_tau",_tauP); CHKERRQ(ierr);
+  ierr = ckpt.setVec("fault_tauQS",_tauQSP); CHKERRQ(ierr);
+  ierr = ckpt.setVec("fault_prestress",_prestress); CHKERRQ(ierr);
 
   #if VERBOSE > 1
      PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -715,13 +725,20 @@ PetscErrorCode Fault::computePsiSS(const PetscScalar vL)
 
 // constructor of derived class Fault_qd, initializes the same object as Fault
 Fault_qd::Fault_qd(Domain &D, VecScatter& scatter2fault, const int& faultTypeScale)
-: Fault(D,scatter2fault,faultTypeScale)
+: Fault(D,scatter2fault,faultTypeScale),
+  _stage(0),_velN(NULL),_velNm1(NULL),_tN(0),_tNm1(0),_numAccepted(0),
+  _velStage(NULL),_tStage(0),_haveStage(false)
 {
   #if VERBOSE > 1
     string funcName = "Fault_qd::Fault_qd";
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
 
+  // slip velocity history for warm starting computeVel
+  VecDuplicate(_slipVel,&_velN); VecSet(_velN,0.0);
+  VecDuplicate(_slipVel,&_velNm1); VecSet(_velNm1,0.0);
+  VecDuplicate(_slipVel,&_velStage); VecSet(_velStage,0.0);
+
   if (_D->_ckpt > 0 && _D->_ckptNumber > 0) { // load from previous checkpoint
     loadCheckpoint();
   }
@@ -751,10 +768,64 @@ Fault_qd::~Fault_qd()
   #endif
 
   VecDestroy(&_eta_rad);
+  VecDestroy(&_velN);
+  VecDestroy(&_velNm1);
+  VecDestroy(&_velStage);
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+}
+
+
+// load a checkpoint, including the slip velocity history so that the slip
+// velocity solve is warm started exactly as it would have been without the restart
+PetscErrorCode Fault_qd::loadCheckpoint()
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "Fault_qd::loadCheckpoint";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  ierr = Fault::loadCheckpoint(); CHKERRQ(ierr);
+
+  const Checkpoint& ckpt = _D->_checkpoint;
+  ierr = ckpt.getScalar("fault_numAccepted",_numAccepted); CHKERRQ(ierr);
+  ierr = ckpt.getScalar("fault_tN",_tN); CHKERRQ(ierr);
+  ierr = ckpt.getScalar("fault_tNm1",_tNm1); CHKERRQ(ierr);
+  ierr = ckpt.getVec("fault_velN",_velN); CHKERRQ(ierr);
+  ierr = ckpt.getVec("fault_velNm1",_velNm1); CHKERRQ(ierr);
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
   #endif
+  return ierr;
+}
+
+
+// add fault fields and the slip velocity history to the next checkpoint
+PetscErrorCode Fault_qd::writeCheckpoint()
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "Fault_qd::writeCheckpoint";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  ierr = Fault::writeCheckpoint(); CHKERRQ(ierr);
+
+  Checkpoint& ckpt = _D->_checkpoint;
+  ierr = ckpt.setScalar("fault_numAccepted",_numAccepted); CHKERRQ(ierr);
+  ierr = ckpt.setScalar("fault_tN",_tN); CHKERRQ(ierr);
+  ierr = ckpt.setScalar("fault_tNm1",_tNm1); CHKERRQ(ierr);
+  ierr = ckpt.setVec("fault_velN",_velN); CHKERRQ(ierr);
+  ierr = ckpt.setVec("fault_velNm1",_velNm1); CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
 }
 
 
@@ -837,7 +908,9 @@ PetscErrorCode Fault_qd::computeVel()
 
   // create ComputeVel_qd struct
   ComputeVel_qd temp(N,etaA,tauQSA,sNA,psiA,aA,bA,_v0,_D->_vL,lockedA,Co);
-  ierr = temp.computeVel(slipVelA, _rootTol, _rootIts, _maxNumIts); CHKERRQ(ierr);
+  PetscScalar bracketWidth = 0.;
+  if (_rootWarmStart == 1) { bracketWidth = _rootWarmStartWidth; }
+  ierr = temp.computeVel(slipVelA, _rootTol, _rootIts, _maxNumIts, bracketWidth); CHKERRQ(ierr);
 
   ierr = VecRestoreArray(_slipVel,&slipVelA); CHKERRQ(ierr);
   ierr = VecRestoreArrayRead(_eta_rad,&etaA); CHKERRQ(ierr);
@@ -871,7 +944,16 @@ PetscErrorCode Fault_qd::d_dt(const PetscScalar time, const map<string,Vec>& var
 
   // compute slip velocity
   double startTime = MPI_Wtime();
+  if (_rootWarmStart == 1) { ierr = predictVel(time);CHKERRQ(ierr); }
+  const PetscInt rootIts0 = _rootIts;
   ierr = computeVel();CHKERRQ(ierr);
+  if ((PetscInt) _stageRootIts.size() <= _stage) {
+    _stageRootIts.resize(_stage+1,0);
+    _stageSolves.resize(_stage+1,0);
+  }
+  _stageRootIts[_stage] += _rootIts - rootIts0;
+  _stageSolves[_stage]++;
+  if (_rootWarmStart == 1) { ierr = updateVelHistory(time);CHKERRQ(ierr); }
   VecCopy(_slipVel,dvarEx["slip"]);
   _computeVelTime += MPI_Wtime() - startTime;
 
@@ -918,6 +1000,127 @@ PetscErrorCode Fault_qd::d_dt(const PetscScalar time, const map<string,Vec>& var
 }
 
 
+// Set the Runge-Kutta stage that the next call to d_dt evaluates.
+// Stage 0 is the rate at an accepted solution, which is added to the slip
+// velocity history. A stage index that does not increase means that the
+// integrator has started a new attempt at the step, so the stage history
+// from the previous attempt is discarded.
+PetscErrorCode Fault_qd::setStage(const PetscInt stage)
+{
+  PetscErrorCode ierr = 0;
+  assert(stage >= 0);
+  if (stage > 0 && stage <= _stage) { _haveStage = false; }
+  _stage = stage;
+  return ierr;
+}
+
+
+// Initial guess for slip velocity at time, placed in _slipVel.
+// Linearly extrapolates from the most recently accepted solution, using the
+// slope to the latest stage of the current step if there is one, and
+// otherwise the slope between the last 2 accepted solutions. If there is no
+// history, or time is far outside the interval the slope was computed
+// over (e.g. after a switch from the fully dynamic regime), _slipVel
+// is left holding the previous solution.
+PetscErrorCode Fault_qd::predictVel(const PetscScalar time)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "Fault_qd::predictVel";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  if (_numAccepted == 0 || time < _tN) { return ierr; }
+
+  Vec velRef = NULL;
+  PetscScalar tRef = _tN;
+  if (_haveStage && _tStage > _tN) { velRef = _velStage; tRef = _tStage; }
+  else if (_numAccepted > 1 && _tNm1 < _tN) { velRef = _velNm1; tRef = _tNm1; }
+
+  // no slope available, or extrapolating too far: use last accepted solution
+  if (velRef == NULL || time - _tN > 10.*abs(tRef - _tN)) {
+    ierr = VecCopy(_velN,_slipVel);CHKERRQ(ierr);
+    return ierr;
+  }
+
+  // V = V_n + (time - t_n) * (V_ref - V_n)/(t_ref - t_n)
+  const PetscScalar w = (time - _tN) / (tRef - _tN);
+  PetscScalar *v;
+  const PetscScalar *vN,*vRef;
+  PetscInt N;
+  ierr = VecGetLocalSize(_slipVel,&N);CHKERRQ(ierr);
+  ierr = VecGetArray(_slipVel,&v);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_velN,&vN);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(velRef,&vRef);CHKERRQ(ierr);
+  for (PetscInt Jj = 0; Jj < N; Jj++) {
+    v[Jj] = vN[Jj] + w*(vRef[Jj] - vN[Jj]);
+  }
+  ierr = VecRestoreArray(_slipVel,&v);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(_velN,&vN);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(velRef,&vRef);CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+
+// add the slip velocity just computed at time to the history
+PetscErrorCode Fault_qd::updateVelHistory(const PetscScalar time)
+{
+  PetscErrorCode ierr = 0;
+
+  if (_stage == 0) {
+    // a repeated evaluation at the same accepted time replaces the old one
+    if (_numAccepted == 0 || time != _tN) {
+      ierr = VecCopy(_velN,_velNm1);CHKERRQ(ierr);
+      _tNm1 = _tN;
+      _numAccepted = min(_numAccepted + 1,(PetscInt) 2);
+    }
+    ierr = VecCopy(_slipVel,_velN);CHKERRQ(ierr);
+    _tN = time;
+    _haveStage = false;
+  }
+  else {
+    ierr = VecCopy(_slipVel,_velStage);CHKERRQ(ierr);
+    _tStage = time;
+    _haveStage = true;
+  }
+
+  return ierr;
+}
+
+
+// print runtime summary, including root finding iterations per stage
+PetscErrorCode Fault_qd::view(const double totRunTime)
+{
+  PetscErrorCode ierr = 0;
+
+  ierr = Fault::view(totRunTime);CHKERRQ(ierr);
+
+  // iteration counts are per processor, solve counts are the same on all processors
+  PetscInt totIts = _rootIts;
+  vector<PetscInt> stageIts(_stageRootIts);
+  ierr = MPI_Allreduce(MPI_IN_PLACE,&totIts,1,MPIU_INT,MPI_SUM,PETSC_COMM_WORLD);CHKERRQ(ierr);
+  if (stageIts.size() > 0) {
+    ierr = MPI_Allreduce(MPI_IN_PLACE,&stageIts[0],(int) stageIts.size(),MPIU_INT,MPI_SUM,PETSC_COMM_WORLD);CHKERRQ(ierr);
+  }
+
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"Fault slip velocity solve:\n");CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   warm start: %i\n",_rootWarmStart);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   total root finding iterations: %i\n",totIts);CHKERRQ(ierr);
+  for (size_t stage = 0; stage < stageIts.size(); stage++) {
+    if (_stageSolves[stage] == 0) { continue; }
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   stage %i: %i solves, %g iterations per node per solve\n",
+      (int) stage,_stageSolves[stage],(double) stageIts[stage]/((double) _stageSolves[stage]*_N));CHKERRQ(ierr);
+  }
+
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"\n");CHKERRQ(ierr);
+  return ierr;
+}
+
+
 // output vector fields into file, and calls writeContext function in Fault
 PetscErrorCode Fault_qd::writeContext(const string outputDir)
 {
@@ -950,8 +1153,25 @@ ComputeVel_qd::ComputeVel_qd(const PetscInt N, const PetscScalar* eta,const Pets
 { }
 
 
+// residual a*sN*asinh(B*V) + eta*V - tauQS for ComputeVel_qd::computeVel
+static inline PetscScalar residVel_qd(const PetscScalar A,const PetscScalar B,const PetscScalar eta,const PetscScalar tau,const PetscScalar V)
+{
+  const PetscScalar z = B*V;
+  const PetscScalar as = log(abs(z) + sqrt(z*z + 1.));
+  return A*(z < 0. ? -as : as) + eta*V - tau;
+}
+
 // compute slip velocity for quasidynamic setting
-PetscErrorCode ComputeVel_qd::computeVel(PetscScalar *slipVelA, const PetscScalar rootTol, PetscInt &rootIts, const PetscInt maxNumIts)
+// Solves strength(V) = tauQS - eta*V for all unlocked fault nodes at once,
+// using bracketed Newton (same iteration as BracketedNewton) on
+// structure-of-arrays work arrays. Each pass evaluates the residual for all
+// active nodes in a single loop, then the converged nodes are removed from
+// the active set so later passes only touch the nodes that still need work.
+// If bracketWidth > 0, the initial guess in slipVelA is assumed to be a
+// prediction, and on the first pass the side of the bracket that the
+// residual points to is narrowed to x +/- bracketWidth*|x| when the residual
+// changes sign there.
+PetscErrorCode ComputeVel_qd::computeVel(PetscScalar *slipVelA, const PetscScalar rootTol, PetscInt &rootIts, const PetscInt maxNumIts, const PetscScalar bracketWidth)
 {
   PetscErrorCode ierr = 0;
 
@@ -960,50 +1180,127 @@ PetscErrorCode ComputeVel_qd::computeVel(PetscScalar *slipVelA, const PetscScala
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
 
-  PetscScalar left, right, out;
-  PetscInt Jj;
-  for (Jj = 0; Jj < _N; Jj++) {
-    // hold slip velocity at 0
-    if (_locked[Jj] > 0.5) {
-      slipVelA[Jj] = 0.;
+  // set locked nodes, and collect the rest into the active set
+  vector<PetscInt> ind;
+  ind.reserve(_N);
+  for (PetscInt Jj = 0; Jj < _N; Jj++) {
+    if (_locked[Jj] > 0.5) { slipVelA[Jj] = 0.; } // hold slip velocity at 0
+    else if (_locked[Jj] < -0.5) { slipVelA[Jj] = _vL; } // force fault to creep at loading velocity
+    else {
+      const PetscScalar right = _tauQS[Jj] / _eta[Jj];
+      if (isnan(right)) {
+        PetscPrintf(PETSC_COMM_WORLD,"\n\nError in ComputeVel_qd::computeVel: right bound evaluated to NaN.\n");
+        PetscPrintf(PETSC_COMM_WORLD,"tauQS = %g, eta = %g, right = %g\n",_tauQS[Jj],_eta[Jj],right);
+        assert(0);
+      }
+      if (abs(right) < 1e-14) { slipVelA[Jj] = 0.; }
+      else { ind.push_back(Jj); }
     }
-    // force fault to creep at loading velocity
-    else if (_locked[Jj] < -0.5) {
-      slipVelA[Jj] = _vL;
+  }
+
+  // structure-of-arrays work space for the active set
+  PetscInt nAct = ind.size();
+  vector<PetscScalar> A(nAct),B(nAct),eta(nAct),tau(nAct);
+  vector<PetscScalar> lo(nAct),hi(nAct),x(nAct),f(nAct),fp(nAct),dx(nAct),dxOld(nAct);
+  for (PetscInt Kk = 0; Kk < nAct; Kk++) {
+    const PetscInt Jj = ind[Kk];
+    A[Kk] = _a[Jj]*_sN[Jj];
+    B[Kk] = exp(_psi[Jj]/_a[Jj]) / (2.*_v0);
+    eta[Kk] = _eta[Jj];
+    tau[Kk] = _tauQS[Jj];
+
+    // residual is increasing in V, so root lies in [min(0,tauQS/eta), max(0,tauQS/eta)]
+    const PetscScalar right = _tauQS[Jj] / _eta[Jj];
+    lo[Kk] = min(0.,right);
+    hi[Kk] = max(0.,right);
+
+    // use previous slip velocity as initial guess if it lies within the bounds
+    x[Kk] = slipVelA[Jj];
+    if (!(x[Kk] >= lo[Kk] && x[Kk] <= hi[Kk])) { x[Kk] = 0.5*(lo[Kk] + hi[Kk]); }
+    dxOld[Kk] = hi[Kk] - lo[Kk];
+    dx[Kk] = dxOld[Kk];
+  }
+
+  PetscInt numIts = 0;
+  while (nAct > 0) {
+    // residual and Jacobian for all active nodes
+    // f = a*sN*asinh(B*V) + eta*V - tauQS, with asinh(z) = sign(z)*log(|z| + sqrt(z^2+1))
+    for (PetscInt Kk = 0; Kk < nAct; Kk++) {
+      const PetscScalar z = B[Kk]*x[Kk];
+      const PetscScalar r = sqrt(z*z + 1.);
+      const PetscScalar as = log(abs(z) + r);
+      f[Kk] = A[Kk]*(z < 0. ? -as : as) + eta[Kk]*x[Kk] - tau[Kk];
+      fp[Kk] = A[Kk]*B[Kk]/r + eta[Kk];
     }
-    else {
-      left = 0.;
-      right = _tauQS[Jj] / _eta[Jj];
 
-      // check bounds
-      if (isnan(left)) {
-  PetscPrintf(PETSC_COMM_WORLD,"\n\nError in ComputeVel_qd::computeVel: left bound evaluated to NaN.\n");
-  PetscPrintf(PETSC_COMM_WORLD,"tauQS = %g, eta = %g, left = %g\n",_tauQS[Jj],_eta[Jj],left);
-  assert(0);
+    // as in ComputeVel_qd::getResid, a NaN or Inf iterate or residual is an error
+    for (PetscInt Kk = 0; Kk < nAct; Kk++) {
+      if (isnan(x[Kk]) || isinf(x[Kk]) || isnan(f[Kk]) || isinf(f[Kk]) || isnan(fp[Kk]) || isinf(fp[Kk])) {
+        PetscPrintf(PETSC_COMM_WORLD,"\n\nError in ComputeVel_qd::computeVel: slip velocity or residual evaluated to NaN or Inf.\n");
+        PetscPrintf(PETSC_COMM_WORLD,"ind = %i, slipVel = %g, residual = %g, Jacobian = %g\n",ind[Kk],x[Kk],f[Kk],fp[Kk]);
+        assert(0);
+        return 1;
       }
-      if (isnan(right)) {
-  PetscPrintf(PETSC_COMM_WORLD,"\n\nError in ComputeVel_qd::computeVel: right bound evaluated to NaN.\n");
-  PetscPrintf(PETSC_COMM_WORLD,"tauQS = %g, eta = %g, right = %g\n",_tauQS[Jj],_eta[Jj],right);
-  assert(0);
+    }
+
+    // remove converged nodes from the active set, and take a step for the rest
+    PetscInt nNext = 0;
+    for (PetscInt Kk = 0; Kk < nAct; Kk++) {
+      if (abs(f[Kk]) < rootTol) {
+        slipVelA[ind[Kk]] = x[Kk];
+        continue;
       }
 
-      out = slipVelA[Jj];
+      // update bounds
+      if (f[Kk] < 0.) { lo[Kk] = x[Kk]; }
+      else { hi[Kk] = x[Kk]; }
+
+      // narrow the other bound around the predicted guess
+      if (numIts == 0 && bracketWidth > 0.) {
+        const PetscScalar d = bracketWidth*abs(x[Kk]);
+        const PetscScalar xb = (f[Kk] < 0.) ? x[Kk] + d : x[Kk] - d;
+        if (xb > lo[Kk] && xb < hi[Kk]) {
+          const PetscScalar fb = residVel_qd(A[Kk],B[Kk],eta[Kk],tau[Kk],xb);
+          if (f[Kk] < 0. && fb > 0.) { hi[Kk] = xb; }
+          else if (f[Kk] > 0. && fb < 0.) { lo[Kk] = xb; }
+          dx[Kk] = hi[Kk] - lo[Kk];
+          dxOld[Kk] = dx[Kk];
+        }
+      }
 
-      if (abs(left-right)<1e-14) {
-  out = left;
+      // use bisection if Newton out of range or not converging quickly enough
+      PetscScalar xNew, dxNew;
+      if ( ((x[Kk]-hi[Kk])*fp[Kk]-f[Kk])*((x[Kk]-lo[Kk])*fp[Kk]-f[Kk]) > 0.0
+        || abs(2.0*f[Kk]) > abs(dxOld[Kk]*fp[Kk]) ) {
+        dxNew = 0.5*(hi[Kk] - lo[Kk]);
+        xNew = lo[Kk] + dxNew;
       }
       else {
-  //Bisect rootFinder(maxNumIts,rootTol);
-        //ierr = rootFinder.setBounds(left,right); CHKERRQ(ierr);
-  //ierr = rootFinder.findRoot(this,Jj,&out); assert(ierr == 0); CHKERRQ(ierr);
-  //rootIts += rootFinder.getNumIts();
-  PetscScalar x0 = slipVelA[Jj];
-  BracketedNewton rootFinder(maxNumIts,rootTol);
-  ierr = rootFinder.setBounds(left,right);CHKERRQ(ierr);
-  ierr = rootFinder.findRoot(this,Jj,x0,&out); CHKERRQ(ierr);
-  rootIts += rootFinder.getNumIts();
+        dxNew = f[Kk]/fp[Kk];
+        xNew = x[Kk] - dxNew;
       }
-      slipVelA[Jj] = out;
+
+      // compact in place (nNext <= Kk)
+      ind[nNext] = ind[Kk];
+      A[nNext] = A[Kk]; B[nNext] = B[Kk]; eta[nNext] = eta[Kk]; tau[nNext] = tau[Kk];
+      lo[nNext] = lo[Kk]; hi[nNext] = hi[Kk];
+      dxOld[nNext] = dx[Kk]; dx[nNext] = dxNew;
+      x[nNext] = xNew;
+      nNext++;
+    }
+    // count Newton and bisection updates only, as BracketedNewton does
+    rootIts += nNext;
+    nAct = nNext;
+
+    numIts++;
+    if (numIts > maxNumIts && nAct > 0) {
+      // f is indexed by the active set before compaction, so evaluate the
+      // residual of the first node that did not converge at its latest iterate
+      const PetscScalar resid = residVel_qd(A[0],B[0],eta[0],tau[0],x[0]);
+      PetscPrintf(PETSC_COMM_WORLD,"rootFinder BracketedNewton did not converge in %i iterations\n",numIts);
+      PetscPrintf(PETSC_COMM_WORLD,"ind = %i, slipVel = %g, residual = %g\n",ind[0],x[0],resid);
+      assert(0);
+      return 1;
     }
   }
 
@@ -1048,7 +1345,7 @@ PetscErrorCode ComputeVel_qd::getResid(const PetscInt Jj,const PetscScalar vel,P
   PetscScalar B = exp(_psi[Jj]/_a[Jj]) / (2.*_v0);
 
   // derivative with respect to slipVel
-  *J = A*vel/sqrt(B*B*vel*vel + 1.) + _eta[Jj];
+  *J = A*B/sqrt(B*B*vel*vel + 1.) + _eta[Jj];
 
   assert(!isnan(*out));
   assert(!isinf(*out));
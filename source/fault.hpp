@@ -85,6 +85,8 @@ public:
   // tolerances for linear and nonlinear (for vel) solve
   PetscScalar      _rootTol;
   PetscInt         _rootIts,_maxNumIts; // total number of iterations
+  int              _rootWarmStart; // 1 to extrapolate the initial guess for slip velocity (qd only)
+  PetscScalar      _rootWarmStartWidth; // relative half-width of the narrowed bracket around the guess
 
   // viewers:
   // 1st string = key naming relevant field, e.g. "slip"
@@ -145,6 +147,16 @@ private:
 public:
   Vec _eta_rad; // radiation damping term
 
+  // slip velocity history, used to warm start the slip velocity solve
+  PetscInt          _stage; // Runge-Kutta stage being evaluated (0 = accepted solution)
+  Vec               _velN,_velNm1; // slip velocity at the 2 most recently accepted times
+  PetscScalar       _tN,_tNm1;
+  PetscInt          _numAccepted; // # of accepted times stored in the history (max 2)
+  Vec               _velStage; // slip velocity at the latest stage of the current step
+  PetscScalar       _tStage;
+  bool              _haveStage;
+  vector<PetscInt>  _stageRootIts,_stageSolves; // root finding iterations and solves per stage
+
   Fault_qd(Domain& D,VecScatter& scatter2fault, const int& faultTypeScale);
   ~Fault_qd();
 
@@ -157,6 +169,16 @@ public:
   PetscErrorCode getResid(const PetscInt ind,const PetscScalar vel,PetscScalar* out);
   PetscErrorCode computeVel();
   PetscErrorCode writeContext(const string outputDir);
+  PetscErrorCode view(const double totRunTime);
+
+  // checkpointing, including the slip velocity history
+  PetscErrorCode loadCheckpoint();
+  PetscErrorCode writeCheckpoint();
+
+  // warm start for computeVel
+  PetscErrorCode setStage(const PetscInt stage);
+  PetscErrorCode predictVel(const PetscScalar time); // extrapolate slip velocity from history into _slipVel
+  PetscErrorCode updateVelHistory(const PetscScalar time); // record the solution from computeVel
 };
 
 
@@ -210,7 +232,9 @@ struct ComputeVel_qd : public RootFinderContext
   ComputeVel_qd(const PetscInt N, const PetscScalar* eta,const PetscScalar* tauQS,const PetscScalar* sN,const PetscScalar* psi,const PetscScalar* a,const PetscScalar* b,const PetscScalar& v0,const PetscScalar& vL,const PetscScalar *locked,const PetscScalar *Co);
 
   // command to perform root-finding process, once contextual variables have been set
-  PetscErrorCode computeVel(PetscScalar* slipVelA, const PetscScalar rootTol, PetscInt& rootIts, const PetscInt maxNumIts);
+  // slipVelA holds the initial guess; if bracketWidth > 0 the bracket is also
+  // narrowed to within bracketWidth*|guess| of the guess where possible
+  PetscErrorCode computeVel(PetscScalar* slipVelA, const PetscScalar rootTol, PetscInt& rootIts, const PetscInt maxNumIts, const PetscScalar bracketWidth);
 
   // function that matches root finder template
   PetscErrorCode getResid(const PetscInt Jj,const PetscScalar vel,PetscScalar* out);
@@ -22,6 +22,7 @@ GrainSizeEvolution::GrainSizeEvolution(Domain& D)
   allocateFields(); // initialize fields
   setMaterialParameters();
   loadFieldsFromFiles(); // load from previous simulation
+  if (_D->_ckptNumber > 0) { loadCheckpoint(); }
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -526,12 +527,12 @@ PetscErrorCode GrainSizeEvolution::writeStep(const PetscInt stepCount, const Pet
   //~ double startTime = MPI_Wtime();
 
   if (_viewers.empty()) {
-    ierr = io_initiateWriteAppend(_viewers, "grainSizeEv_d", _d, outputDir + "grainSizeEv_d"); CHKERRQ(ierr);
-    ierr = io_initiateWriteAppend(_viewers, "grainSizeEv_d_t", _d_t, outputDir + "grainSizeEv_d_t"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "grainSizeEv_d", _d, outputDir + "grainSizeEv_d"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "grainSizeEv_d_t", _d_t, outputDir + "grainSizeEv_d_t"); CHKERRQ(ierr);
   }
   else {
-    ierr = VecView(_d,_viewers["grainSizeEv_d"].first); CHKERRQ(ierr);
-    ierr = VecView(_d_t,_viewers["grainSizeEv_d_t"].first); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_d,_viewers["grainSizeEv_d"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_d_t,_viewers["grainSizeEv_d_t"]); CHKERRQ(ierr);
   }
 
   //~ _writeTime += MPI_Wtime() - startTime;
@@ -633,7 +634,39 @@ PetscErrorCode AustinEvans2007::getResid(const PetscInt Jj,const PetscScalar dne
 }
 
 
+// load grain size from a checkpoint
+PetscErrorCode GrainSizeEvolution::loadCheckpoint()
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    std::string funcName = "GrainSizeEvolution::loadCheckpoint";
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);CHKERRQ(ierr);
+  #endif
+
+  ierr = _D->_checkpoint.getVec("grainSizeEv_d",_d); CHKERRQ(ierr);
+  ierr = _D->_checkpoint.getVec("grainSizeEv_d_t",_d_t); CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);CHKERRQ(ierr);
+  #endif
+  return ierr;
+}
 
 
+// add grain size to the next checkpoint
+PetscErrorCode GrainSizeEvolution::writeCheckpoint()
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    std::string funcName = "GrainSizeEvolution::writeCheckpoint";
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);CHKERRQ(ierr);
+  #endif
 
+  ierr = _D->_checkpoint.setVec("grainSizeEv_d",_d); CHKERRQ(ierr);
+  ierr = _D->_checkpoint.setVec("grainSizeEv_d_t",_d_t); CHKERRQ(ierr);
 
+  #if VERBOSE > 1
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);CHKERRQ(ierr);
+  #endif
+  return ierr;
+}
@@ -91,6 +91,10 @@ class GrainSizeEvolution
     PetscErrorCode writeContext(const std::string outputDir);
     PetscErrorCode writeStep(const PetscInt stepCount, const PetscScalar time,const std::string outputDir);
 
+    // checkpointing
+    PetscErrorCode loadCheckpoint();
+    PetscErrorCode writeCheckpoint();
+
 };
 
 // struct for root-finding pieces
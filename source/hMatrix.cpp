@@ -0,0 +1,263 @@
+#include "hMatrix.hpp"
+
+#define FILENAME "hMatrix.cpp"
+
+using namespace std;
+
+
+HMatrix::HMatrix(const PetscScalar tol, const PetscInt leafSize, const PetscScalar eta)
+: _N(0),_tol(tol),_leafSize(leafSize),_eta(eta),_buildTime(0),_multTime(0),_multCount(0),
+  _rowStart(0),_rowEnd(0),_scatter(NULL),_xAll(NULL)
+{
+  assert(_tol > 0);
+  assert(_leafSize >= 1);
+  assert(_eta > 0);
+}
+
+
+HMatrix::~HMatrix()
+{
+  VecScatterDestroy(&_scatter);
+  VecDestroy(&_xAll);
+}
+
+
+PetscErrorCode HMatrix::compress(const vector<PetscScalar>& z, const PetscInt rowStart, const PetscInt rowEnd,
+  const vector<PetscScalar>& dense)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "HMatrix::compress";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  double startTime = MPI_Wtime();
+
+  _N = (PetscInt) z.size();
+  _rowStart = rowStart;
+  _rowEnd = rowEnd;
+  assert(_rowStart <= _rowEnd && _rowEnd <= _N);
+  assert((PetscInt) dense.size() == (_rowEnd - _rowStart) * _N);
+
+  _blocks.clear();
+  buildBlocks(z,dense,_rowStart,_rowEnd,0,_N);
+
+  _buildTime += MPI_Wtime() - startTime;
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+
+// whether rows [r0,r1) and columns [c0,c1) are far enough apart, relative
+// to their size, for the block to be approximated by a low-rank product
+bool HMatrix::isAdmissible(const vector<PetscScalar>& z, const PetscInt r0, const PetscInt r1,
+  const PetscInt c0, const PetscInt c1) const
+{
+  PetscScalar rMin = z[r0], rMax = z[r0], cMin = z[c0], cMax = z[c0];
+  for (PetscInt i = r0; i < r1; i++) { rMin = min(rMin,z[i]); rMax = max(rMax,z[i]); }
+  for (PetscInt j = c0; j < c1; j++) { cMin = min(cMin,z[j]); cMax = max(cMax,z[j]); }
+
+  const PetscScalar dist = max(rMin - cMax, cMin - rMax);
+  if (dist <= 0) { return false; }
+  return min(rMax - rMin, cMax - cMin) <= _eta * dist;
+}
+
+
+// recursively split rows [r0,r1) and columns [c0,c1) until each block is
+// either admissible or small enough to store dense
+void HMatrix::buildBlocks(const vector<PetscScalar>& z, const vector<PetscScalar>& dense,
+  const PetscInt r0, const PetscInt r1, const PetscInt c0, const PetscInt c1)
+{
+  if (r0 >= r1 || c0 >= c1) { return; }
+
+  if (isAdmissible(z,r0,r1,c0,c1)) {
+    Block b;
+    b.r0 = r0; b.r1 = r1; b.c0 = c0; b.c1 = c1;
+    if (aca(dense,b)) { _blocks.push_back(b); }
+    else { addDenseBlock(dense,r0,r1,c0,c1); }
+    return;
+  }
+
+  if (r1 - r0 <= _leafSize && c1 - c0 <= _leafSize) {
+    addDenseBlock(dense,r0,r1,c0,c1);
+    return;
+  }
+
+  const PetscInt rMid = (r1 - r0 > _leafSize) ? (r0 + r1)/2 : r1;
+  const PetscInt cMid = (c1 - c0 > _leafSize) ? (c0 + c1)/2 : c1;
+  buildBlocks(z,dense,r0,rMid,c0,cMid);
+  buildBlocks(z,dense,r0,rMid,cMid,c1);
+  buildBlocks(z,dense,rMid,r1,c0,cMid);
+  buildBlocks(z,dense,rMid,r1,cMid,c1);
+}
+
+
+void HMatrix::addDenseBlock(const vector<PetscScalar>& dense, const PetscInt r0, const PetscInt r1,
+  const PetscInt c0, const PetscInt c1)
+{
+  Block b;
+  b.r0 = r0; b.r1 = r1; b.c0 = c0; b.c1 = c1;
+  b.rank = min(r1 - r0,c1 - c0);
+  b.isLowRank = false;
+  for (PetscInt i = r0; i < r1; i++) {
+    const PetscScalar *row = &dense[(i - _rowStart)*_N];
+    b.U.insert(b.U.end(),row + c0,row + c1);
+  }
+  _blocks.push_back(b);
+}
+
+
+// Adaptive cross approximation with partial pivoting: build U*V^T one
+// rank-1 term at a time from a residual row and column of the block, until
+// the newest term is below _tol relative to the Frobenius norm of the
+// approximation. Returns false if that takes too many terms for the
+// low-rank form to be smaller than the dense block.
+bool HMatrix::aca(const vector<PetscScalar>& dense, Block& b) const
+{
+  const PetscInt m = b.r1 - b.r0, n = b.c1 - b.c0;
+  const PetscInt maxRank = (m*n)/(m + n);
+  b.isLowRank = true;
+  b.rank = 0;
+  b.U.clear();
+  b.V.clear();
+
+  vector<bool> usedRow(m,false);
+  vector<PetscScalar> u(m),v(n);
+  PetscScalar normS2 = 0; // squared Frobenius norm of U*V^T
+  PetscInt iPiv = 0;
+  while (b.rank < maxRank) {
+    usedRow[iPiv] = true;
+
+    // residual of row iPiv, and the column of its largest entry
+    const PetscScalar *row = &dense[(b.r0 + iPiv - _rowStart)*_N + b.c0];
+    PetscInt jPiv = 0;
+    for (PetscInt j = 0; j < n; j++) {
+      v[j] = row[j];
+      for (PetscInt l = 0; l < b.rank; l++) { v[j] -= b.U[l*m + iPiv] * b.V[l*n + j]; }
+      if (abs(v[j]) > abs(v[jPiv])) { jPiv = j; }
+    }
+
+    // row is already represented exactly: try the next unused row
+    if (v[jPiv] == 0) {
+      iPiv = -1;
+      for (PetscInt i = 0; i < m; i++) { if (!usedRow[i]) { iPiv = i; break; } }
+      if (iPiv < 0) { return true; }
+      continue;
+    }
+
+    // residual of column jPiv
+    const PetscScalar pivot = v[jPiv];
+    for (PetscInt j = 0; j < n; j++) { v[j] /= pivot; }
+    for (PetscInt i = 0; i < m; i++) {
+      u[i] = dense[(b.r0 + i - _rowStart)*_N + b.c0 + jPiv];
+      for (PetscInt l = 0; l < b.rank; l++) { u[i] -= b.V[l*n + jPiv] * b.U[l*m + i]; }
+    }
+
+    // ||S_k||^2 = ||S_k-1||^2 + 2 sum_l (u.U_l)(v.V_l) + ||u||^2 ||v||^2
+    PetscScalar normU2 = 0, normV2 = 0, cross = 0;
+    for (PetscInt i = 0; i < m; i++) { normU2 += u[i]*u[i]; }
+    for (PetscInt j = 0; j < n; j++) { normV2 += v[j]*v[j]; }
+    for (PetscInt l = 0; l < b.rank; l++) {
+      PetscScalar uU = 0, vV = 0;
+      for (PetscInt i = 0; i < m; i++) { uU += u[i] * b.U[l*m + i]; }
+      for (PetscInt j = 0; j < n; j++) { vV += v[j] * b.V[l*n + j]; }
+      cross += uU * vV;
+    }
+    normS2 += 2.0*cross + normU2*normV2;
+
+    b.U.insert(b.U.end(),u.begin(),u.end());
+    b.V.insert(b.V.end(),v.begin(),v.end());
+    b.rank++;
+
+    if (sqrt(normU2*normV2) <= _tol * sqrt(abs(normS2))) { return true; }
+
+    // next pivot row: largest entry of the new column among the unused rows
+    iPiv = -1;
+    for (PetscInt i = 0; i < m; i++) {
+      if (!usedRow[i] && (iPiv < 0 || abs(u[i]) > abs(u[iPiv]))) { iPiv = i; }
+    }
+    if (iPiv < 0) { return true; }
+  }
+
+  return false;
+}
+
+
+PetscErrorCode HMatrix::mult(const Vec& x, Vec& y)
+{
+  PetscErrorCode ierr = 0;
+  double startTime = MPI_Wtime();
+
+  if (_scatter == NULL) { ierr = VecScatterCreateToAll(x,&_scatter,&_xAll);CHKERRQ(ierr); }
+  ierr = VecScatterBegin(_scatter,x,_xAll,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+  ierr = VecScatterEnd(_scatter,x,_xAll,INSERT_VALUES,SCATTER_FORWARD);CHKERRQ(ierr);
+
+  PetscInt Istart,Iend;
+  ierr = VecGetOwnershipRange(y,&Istart,&Iend);CHKERRQ(ierr);
+  assert(Istart == _rowStart && Iend == _rowEnd);
+
+  const PetscScalar *xa;
+  PetscScalar *ya;
+  ierr = VecGetArrayRead(_xAll,&xa);CHKERRQ(ierr);
+  ierr = VecGetArray(y,&ya);CHKERRQ(ierr);
+  for (PetscInt i = 0; i < _rowEnd - _rowStart; i++) { ya[i] = 0.0; }
+
+  for (size_t k = 0; k < _blocks.size(); k++) {
+    const Block& b = _blocks[k];
+    const PetscInt m = b.r1 - b.r0, n = b.c1 - b.c0;
+    PetscScalar *yb = ya + (b.r0 - _rowStart);
+    const PetscScalar *xb = xa + b.c0;
+    if (b.isLowRank) {
+      for (PetscInt l = 0; l < b.rank; l++) {
+        PetscScalar t = 0;
+        for (PetscInt j = 0; j < n; j++) { t += b.V[l*n + j] * xb[j]; }
+        for (PetscInt i = 0; i < m; i++) { yb[i] += b.U[l*m + i] * t; }
+      }
+    }
+    else {
+      for (PetscInt i = 0; i < m; i++) {
+        PetscScalar t = 0;
+        for (PetscInt j = 0; j < n; j++) { t += b.U[i*n + j] * xb[j]; }
+        yb[i] += t;
+      }
+    }
+  }
+
+  ierr = VecRestoreArrayRead(_xAll,&xa);CHKERRQ(ierr);
+  ierr = VecRestoreArray(y,&ya);CHKERRQ(ierr);
+
+  _multTime += MPI_Wtime() - startTime;
+  _multCount++;
+  return ierr;
+}
+
+
+PetscErrorCode HMatrix::view()
+{
+  PetscErrorCode ierr = 0;
+
+  // stored entries, # of low-rank and dense blocks, and the max rank
+  PetscScalar counts[3] = {0,0,0};
+  PetscInt maxRank = 0;
+  for (size_t k = 0; k < _blocks.size(); k++) {
+    counts[0] += _blocks[k].U.size() + _blocks[k].V.size();
+    if (_blocks[k].isLowRank) { counts[1]++; maxRank = max(maxRank,_blocks[k].rank); }
+    else { counts[2]++; }
+  }
+  ierr = MPI_Allreduce(MPI_IN_PLACE,counts,3,MPIU_SCALAR,MPI_SUM,PETSC_COMM_WORLD);CHKERRQ(ierr);
+  ierr = MPI_Allreduce(MPI_IN_PLACE,&maxRank,1,MPIU_INT,MPI_MAX,PETSC_COMM_WORLD);CHKERRQ(ierr);
+
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"H-matrix summary:\n");CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   size: %i x %i\n",_N,_N);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   tolerance, leaf size, eta: %g, %i, %g\n",_tol,_leafSize,_eta);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   low-rank blocks: %g, max rank %i\n",counts[1],maxRank);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   dense blocks: %g\n",counts[2]);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   stored entries / dense entries: %g\n",counts[0]/((PetscScalar) _N*_N));CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   compression time (s): %g\n",_buildTime);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   mat-vec time (s): %g\n",_multTime);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   # of mat-vecs: %i\n",_multCount);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"\n");CHKERRQ(ierr);
+
+  return ierr;
+}
@@ -0,0 +1,87 @@
+#ifndef HMATRIX_HPP_INCLUDED
+#define HMATRIX_HPP_INCLUDED
+
+#include <petscvec.h>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <assert.h>
+
+using namespace std;
+
+/*
+ * Hierarchical matrix (H-matrix) approximation of a dense N x N matrix
+ * whose rows and columns are both associated with points along the fault,
+ * such as the Green's function mapping slip to quasi-static shear stress.
+ *
+ * Each processor stores the rows it owns in the parallel layout of the
+ * fault Vecs. The row and column index sets are split recursively in half
+ * (the fault points are ordered by depth, so this is also a geometric
+ * bisection), down to blocks of at most leafSize rows and columns. A block
+ * whose row and column points are well separated,
+ *   min(diam(rows), diam(cols)) <= eta * dist(rows, cols),
+ * is stored as a low-rank product U*V^T, computed by adaptive cross
+ * approximation (ACA) with partial pivoting to relative accuracy tol.
+ * The remaining blocks, near the diagonal, are stored dense.
+ *
+ * For a kernel that decays smoothly away from the diagonal this takes
+ * O(N log N) storage and work per mat-vec instead of O(N^2).
+ *
+ */
+
+class HMatrix
+{
+public:
+
+  PetscInt      _N; // global # of rows and columns
+  PetscScalar   _tol; // relative accuracy of each low-rank block
+  PetscInt      _leafSize; // max # of rows and columns in a dense block
+  PetscScalar   _eta; // admissibility parameter
+  double        _buildTime,_multTime;
+  PetscInt      _multCount;
+
+  HMatrix(const PetscScalar tol, const PetscInt leafSize, const PetscScalar eta);
+  ~HMatrix();
+
+  // approximate the matrix from its locally owned rows [rowStart,rowEnd),
+  // stored row major in dense, where z holds the coordinates of all N points
+  PetscErrorCode compress(const vector<PetscScalar>& z, const PetscInt rowStart, const PetscInt rowEnd,
+    const vector<PetscScalar>& dense);
+
+  // y = H*x, where x and y have the parallel layout of the rows (collective)
+  PetscErrorCode mult(const Vec& x, Vec& y);
+
+  // # of stored entries compared to a dense matrix, and the max block rank (collective)
+  PetscErrorCode view();
+
+private:
+  // disable default copy constructor and assignment operator
+  HMatrix(const HMatrix& that);
+  HMatrix& operator=(const HMatrix& rhs);
+
+  // block of rows [r0,r1) and columns [c0,c1)
+  // low-rank blocks store U (m x rank) and V (n x rank) column major,
+  // dense blocks store the entries row major in U
+  struct Block
+  {
+    PetscInt             r0,r1,c0,c1,rank;
+    bool                 isLowRank;
+    vector<PetscScalar>  U,V;
+  };
+
+  PetscInt         _rowStart,_rowEnd;
+  vector<Block>    _blocks;
+  VecScatter       _scatter; // gathers x onto every processor
+  Vec              _xAll;
+
+  bool isAdmissible(const vector<PetscScalar>& z, const PetscInt r0, const PetscInt r1,
+    const PetscInt c0, const PetscInt c1) const;
+  void buildBlocks(const vector<PetscScalar>& z, const vector<PetscScalar>& dense,
+    const PetscInt r0, const PetscInt r1, const PetscInt c0, const PetscInt c1);
+  void addDenseBlock(const vector<PetscScalar>& dense, const PetscInt r0, const PetscInt r1,
+    const PetscInt c0, const PetscInt c1);
+  bool aca(const vector<PetscScalar>& dense, Block& b) const;
+};
+
+#endif
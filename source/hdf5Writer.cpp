@@ -0,0 +1,162 @@
+#include "hdf5Writer.hpp"
+
+#define FILENAME "hdf5Writer.cpp"
+
+using namespace std;
+
+
+Hdf5Writer::Hdf5Writer()
+: _filename(""),_compress(0),_writeTime(0),
+  _viewer(NULL),_mode(FILE_MODE_WRITE),_scalar(NULL)
+{ }
+
+
+Hdf5Writer::~Hdf5Writer()
+{
+  #if VERBOSE > 1
+    string funcName = "Hdf5Writer::~Hdf5Writer";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  PetscViewerDestroy(&_viewer);
+  VecDestroy(&_scalar);
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+}
+
+
+PetscErrorCode Hdf5Writer::setUp(const string filename, const PetscFileMode mode, const int compress)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "Hdf5Writer::setUp";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  assert(_viewer == NULL);
+  assert(compress == 0 || compress == 1);
+  _filename = filename;
+  _mode = mode;
+  _compress = compress;
+
+#if defined(PETSC_HAVE_HDF5)
+  ierr = PetscViewerHDF5Open(PETSC_COMM_WORLD,_filename.c_str(),_mode,&_viewer);CHKERRQ(ierr);
+  ierr = PetscViewerSetFromOptions(_viewer);CHKERRQ(ierr);
+
+  // set on this viewer only, so other HDF5 viewers (checkpoints, G.h5) are not affected
+  if (_compress == 1) {
+  #if PETSC_VERSION_GE(3,11,0)
+    ierr = PetscViewerHDF5SetCompress(_viewer,PETSC_TRUE);CHKERRQ(ierr);
+  #else
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Warning: HDF5 compression requires PETSc 3.11 or later, writing %s uncompressed.\n",_filename.c_str());CHKERRQ(ierr);
+  #endif
+  }
+  #if PETSC_VERSION_GE(3,15,0)
+    ierr = PetscViewerHDF5PushTimestepping(_viewer);CHKERRQ(ierr);
+  #endif
+
+  // one entry, owned by rank 0
+  PetscMPIInt rank;
+  ierr = MPI_Comm_rank(PETSC_COMM_WORLD,&rank);CHKERRQ(ierr);
+  ierr = VecCreateMPI(PETSC_COMM_WORLD,rank == 0 ? 1 : 0,1,&_scalar);CHKERRQ(ierr);
+#else
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"ERROR: HDF5 output requires PETSc to be configured with HDF5.\n");CHKERRQ(ierr);
+  assert(0);
+#endif
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+
+// Collective. VecView writes to the dataset named after the Vec, so vec is
+// renamed for the call and its name restored afterwards.
+PetscErrorCode Hdf5Writer::appendVec(const Vec& vec, const string name)
+{
+  PetscErrorCode ierr = 0;
+  assert(_viewer != NULL);
+  double startTime = MPI_Wtime();
+
+#if defined(PETSC_HAVE_HDF5)
+  map<string,PetscInt>::iterator it = _steps.find(name);
+  if (it == _steps.end()) {
+    PetscInt steps = 0;
+    ierr = getNumSteps(name,steps);CHKERRQ(ierr);
+    it = _steps.insert(make_pair(name,steps)).first;
+  }
+
+  const char *vecName;
+  ierr = PetscObjectGetName((PetscObject) vec,&vecName);CHKERRQ(ierr);
+  const string oldName(vecName);
+  ierr = PetscObjectSetName((PetscObject) vec,name.c_str());CHKERRQ(ierr);
+  ierr = PetscViewerHDF5SetTimestep(_viewer,it->second);CHKERRQ(ierr);
+  ierr = VecView(vec,_viewer);CHKERRQ(ierr);
+  ierr = PetscObjectSetName((PetscObject) vec,oldName.c_str());CHKERRQ(ierr);
+  it->second++;
+#endif
+
+  _writeTime += MPI_Wtime() - startTime;
+  return ierr;
+}
+
+
+// Collective.
+PetscErrorCode Hdf5Writer::appendScalar(const PetscScalar val, const string name)
+{
+  PetscErrorCode ierr = 0;
+  assert(_scalar != NULL);
+  ierr = VecSet(_scalar,val);CHKERRQ(ierr);
+  ierr = appendVec(_scalar,name);CHKERRQ(ierr);
+  return ierr;
+}
+
+
+// Collective.
+PetscErrorCode Hdf5Writer::flush()
+{
+  PetscErrorCode ierr = 0;
+  if (_viewer == NULL) { return ierr; }
+
+#if defined(PETSC_HAVE_HDF5)
+  hid_t fileId;
+  ierr = PetscViewerHDF5GetFileId(_viewer,&fileId);CHKERRQ(ierr);
+  if (H5Fflush(fileId,H5F_SCOPE_GLOBAL) < 0) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"ERROR: could not flush %s\n",_filename.c_str());CHKERRQ(ierr);
+    assert(0);
+  }
+#endif
+
+  return ierr;
+}
+
+
+// # of rows already in dataset name: 0 for a new file, otherwise the size of
+// its time dimension if the dataset exists
+PetscErrorCode Hdf5Writer::getNumSteps(const string name, PetscInt& steps)
+{
+  PetscErrorCode ierr = 0;
+  steps = 0;
+  if (_mode != FILE_MODE_APPEND) { return ierr; }
+
+#if defined(PETSC_HAVE_HDF5)
+  hid_t fileId;
+  ierr = PetscViewerHDF5GetFileId(_viewer,&fileId);CHKERRQ(ierr);
+  if (H5Lexists(fileId,name.c_str(),H5P_DEFAULT) <= 0) { return ierr; }
+
+  hid_t dset = H5Dopen2(fileId,name.c_str(),H5P_DEFAULT);
+  hid_t space = H5Dget_space(dset);
+  hsize_t dims[4];
+  int ndims = H5Sget_simple_extent_ndims(space);
+  assert(ndims >= 1 && ndims <= 4);
+  H5Sget_simple_extent_dims(space,dims,NULL);
+  steps = (PetscInt) dims[0];
+  H5Sclose(space);
+  H5Dclose(dset);
+#endif
+
+  return ierr;
+}
@@ -0,0 +1,70 @@
+#ifndef HDF5WRITER_HPP_INCLUDED
+#define HDF5WRITER_HPP_INCLUDED
+
+#include <petscksp.h>
+#if defined(PETSC_HAVE_HDF5)
+  #include <petscviewerhdf5.h>
+#endif
+#include <string>
+#include <map>
+#include <assert.h>
+
+using namespace std;
+
+/*
+ * Writes all time series output of a run to one HDF5 file, instead of one
+ * PETSc binary file per field.
+ *
+ * Each field is a dataset in the root group of the file, named after the
+ * binary file it replaces (e.g. "slip", "momBal_bcL", "med_time1D"), whose
+ * first dimension is time: appendVec adds one row per call. PETSc creates
+ * the datasets with time as an unlimited dimension and one time step per
+ * chunk, so reading a few steps, or a part of every step, does not require
+ * reading the whole dataset. If compression is turned on, PETSc's gzip
+ * filter is applied to each chunk (PETSc 3.11 or later). Compression is set
+ * on this writer's viewer only.
+ *
+ * When restarting from a checkpoint, the file is opened for appending, and
+ * each dataset is continued after its last row.
+ *
+ * Requires PETSc to have been configured with HDF5.
+ *
+ */
+
+class Hdf5Writer
+{
+public:
+
+  string           _filename; // HDF5 file, empty if this writer is not used
+  int              _compress; // 1 to compress the datasets, 0 otherwise
+  double           _writeTime; // time spent writing
+
+  Hdf5Writer();
+  ~Hdf5Writer();
+
+  // open (mode = FILE_MODE_WRITE) or reopen (FILE_MODE_APPEND) filename
+  PetscErrorCode setUp(const string filename, const PetscFileMode mode, const int compress);
+
+  // append vec as the next row of dataset name (collective)
+  PetscErrorCode appendVec(const Vec& vec, const string name);
+
+  // append a single value as the next row of dataset name (collective)
+  PetscErrorCode appendScalar(const PetscScalar val, const string name);
+
+  // push everything written so far to disk, e.g. before a checkpoint
+  PetscErrorCode flush();
+
+private:
+  // disable default copy constructor and assignment operator
+  Hdf5Writer(const Hdf5Writer& that);
+  Hdf5Writer& operator=(const Hdf5Writer& rhs);
+
+  PetscViewer          _viewer;
+  PetscFileMode        _mode;
+  map<string,PetscInt> _steps; // # of rows in each dataset written so far
+  Vec                  _scalar; // holds the value for appendScalar
+
+  PetscErrorCode getNumSteps(const string name, PetscInt& steps);
+};
+
+#endif
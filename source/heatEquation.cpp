@@ -16,9 +16,10 @@ HeatEquation::HeatEquation(Domain& D)
   _linSolver("CG"),_kspTol(1e-11),
   _kspSS(NULL),_kspTrans(NULL),_pc(NULL),
   _I(NULL),_rcInv(NULL),_B(NULL),_pcMat(NULL),_D2ath(NULL),
+  _dtCacheSize(0),_dtCacheRatio(1.2),_dtCacheSnap(0),_dtCacheUses(0),_dtCacheMisses(0),
   _MapV(NULL),_Gw(NULL),_w(NULL),
   _linSolveTime(0),_factorTime(0),_beTime(0),_writeTime(0),_miscTime(0),
-  _linSolveCount(0),_ckpt(D._ckpt),_ckptNumber(D._ckptNumber),
+  _linSolveCount(0),_work("HeatEquation"),_ckpt(D._ckpt),_ckptNumber(D._ckptNumber),
   _Tamb(NULL),_dT(NULL),_T(NULL),
   _k(NULL),_rho(NULL),_c(NULL),_Qrad(NULL),_Qfric(NULL),_Qvisc(NULL),_Q(NULL)
 {
@@ -35,6 +36,7 @@ HeatEquation::HeatEquation(Domain& D)
   setFields(); // sets material parameters
 
   loadFieldsFromFiles();
+  if (_ckptNumber > 0) { loadCheckpoint(); }
   if (_loadICs == 0 && _isMMS == 0 && _ckptNumber == 0) { computeInitialSteadyStateTemp(); }
   if (_heatEquationType.compare("transient")==0 ) { setUpTransientProblem(); }
   else if (_heatEquationType.compare("steadyState")==0 ) { setUpSteadyStateProblem(); }
@@ -48,6 +50,7 @@ HeatEquation::~HeatEquation()
 {
   KSPDestroy(&_kspSS);
   KSPDestroy(&_kspTrans);
+  clearDtCache();
   MatDestroy(&_B);
   MatDestroy(&_rcInv);
   MatDestroy(&_I);
@@ -173,6 +176,9 @@ PetscErrorCode HeatEquation::loadSettings(const char *file)
     // linear solver settings
     else if (var.compare("linSolver_heateq")==0) { _linSolver = rhs.c_str(); }
     else if (var.compare("kspTol_heateq")==0) { _kspTol = atof( rhs.c_str() ); }
+    else if (var.compare("dtCacheSize_heateq")==0) { _dtCacheSize = atoi( rhs.c_str() ); }
+    else if (var.compare("dtCacheRatio_heateq")==0) { _dtCacheRatio = atof( rhs.c_str() ); }
+    else if (var.compare("dtCacheSnap_heateq")==0) { _dtCacheSnap = atoi( rhs.c_str() ); }
 
     // if values are set by vector
     else if (var.compare("rhoVals")==0) { loadVectorFromInputFile(rhsFull,_rhoVals); }
@@ -388,6 +394,9 @@ PetscErrorCode HeatEquation::checkInput()
   assert(_TVals.size() == _TDepths.size() );
   assert(_Nz_lab <= _Nz);
   assert(_Lz_lab <= _Lz);
+  assert(_dtCacheSize >= 0);
+  assert(_dtCacheRatio > 1);
+  assert(_dtCacheSnap == 0 || _dtCacheSnap == 1);
 
   if (_wRadioHeatGen.compare("yes") == 0) {
     assert(_A0Vals.size() == _A0Depths.size() );
@@ -763,7 +772,10 @@ PetscErrorCode HeatEquation::setupKSP_SS(Mat& A)
 
 
 // set up KSP for transient problem
-PetscErrorCode HeatEquation::setupKSP(Mat& A)
+// if cached, the preconditioner is built from A once and then kept, while the
+// operator passed to KSPSetOperators before each solve may differ slightly
+// from A, so the direct solvers are used as preconditioners for GMRES
+PetscErrorCode HeatEquation::setupKSP(KSP& ksp, Mat& A, const bool cached)
 {
   PetscErrorCode ierr = 0;
   #if VERBOSE > 1
@@ -771,54 +783,62 @@ PetscErrorCode HeatEquation::setupKSP(Mat& A)
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
 
-  ierr = KSPCreate(PETSC_COMM_WORLD,&_kspTrans); CHKERRQ(ierr);
+  ierr = KSPCreate(PETSC_COMM_WORLD,&ksp); CHKERRQ(ierr);
   if (_linSolver.compare("AMG")==0) { // algebraic multigrid from HYPRE
     // uses HYPRE's solver AMG (not HYPRE's preconditioners)
-    ierr = KSPSetType(_kspTrans,KSPRICHARDSON); CHKERRQ(ierr);
-    ierr = KSPSetOperators(_kspTrans,A,A); CHKERRQ(ierr);
-    ierr = KSPSetReusePreconditioner(_kspTrans,PETSC_FALSE); CHKERRQ(ierr);
-    ierr = KSPGetPC(_kspTrans,&_pc); CHKERRQ(ierr);
+    ierr = KSPSetType(ksp,KSPRICHARDSON); CHKERRQ(ierr);
+    ierr = KSPSetOperators(ksp,A,A); CHKERRQ(ierr);
+    ierr = KSPSetReusePreconditioner(ksp,cached ? PETSC_TRUE : PETSC_FALSE); CHKERRQ(ierr);
+    ierr = KSPGetPC(ksp,&_pc); CHKERRQ(ierr);
     ierr = PCSetType(_pc,PCHYPRE); CHKERRQ(ierr);
     ierr = PCHYPRESetType(_pc,"boomeramg"); CHKERRQ(ierr);
-    ierr = KSPSetTolerances(_kspTrans,_kspTol,_kspTol,PETSC_DEFAULT,PETSC_DEFAULT); CHKERRQ(ierr);
+    ierr = KSPSetTolerances(ksp,_kspTol,_kspTol,PETSC_DEFAULT,PETSC_DEFAULT); CHKERRQ(ierr);
     ierr = PCFactorSetLevels(_pc,4); CHKERRQ(ierr);
-    ierr = KSPSetInitialGuessNonzero(_kspTrans,PETSC_TRUE); CHKERRQ(ierr);
+    ierr = KSPSetInitialGuessNonzero(ksp,PETSC_TRUE); CHKERRQ(ierr);
   }
   else if (_linSolver.compare("MUMPSLU")==0) { // direct LU from MUMPS
     // use direct LU from MUMPS
-    ierr = KSPSetType(_kspTrans,KSPPREONLY); CHKERRQ(ierr);
-    ierr = KSPSetOperators(_kspTrans,A,A); CHKERRQ(ierr);
-    ierr = KSPSetReusePreconditioner(_kspTrans,PETSC_TRUE); CHKERRQ(ierr);
-    ierr = KSPGetPC(_kspTrans,&_pc); CHKERRQ(ierr);
+    if (cached) {
+      ierr = KSPSetType(ksp,KSPGMRES); CHKERRQ(ierr);
+      ierr = KSPSetTolerances(ksp,_kspTol,_kspTol,PETSC_DEFAULT,PETSC_DEFAULT); CHKERRQ(ierr);
+    }
+    else { ierr = KSPSetType(ksp,KSPPREONLY); CHKERRQ(ierr); }
+    ierr = KSPSetOperators(ksp,A,A); CHKERRQ(ierr);
+    ierr = KSPSetReusePreconditioner(ksp,PETSC_TRUE); CHKERRQ(ierr);
+    ierr = KSPGetPC(ksp,&_pc); CHKERRQ(ierr);
     ierr = PCSetType(_pc,PCLU); CHKERRQ(ierr);
     //~ ierr = PCFactorSetMatSolverType(pc,MATSOLVERMUMPS);                 CHKERRQ(ierr); // new PETSc
     //~ ierr = PCFactorSetUpMatSolverType(pc);                              CHKERRQ(ierr); // new PETSc
     ierr = PCFactorSetMatSolverPackage(_pc,MATSOLVERMUMPS);              CHKERRQ(ierr); // old PETSc
     ierr = PCFactorSetUpMatSolverPackage(_pc);                           CHKERRQ(ierr); // old PETSc
-    ierr = KSPSetInitialGuessNonzero(_kspTrans,PETSC_TRUE); CHKERRQ(ierr);
+    ierr = KSPSetInitialGuessNonzero(ksp,PETSC_TRUE); CHKERRQ(ierr);
   }
   else if (_linSolver.compare("MUMPSCHOLESKY")==0) { // direct Cholesky (RR^T) from MUMPS
     // use direct LL^T (Cholesky factorization) from MUMPS
-    ierr = KSPSetType(_kspTrans,KSPPREONLY); CHKERRQ(ierr);
-    ierr = KSPSetOperators(_kspTrans,A,A); CHKERRQ(ierr);
-    ierr = KSPSetReusePreconditioner(_kspTrans,PETSC_TRUE); CHKERRQ(ierr);
-    ierr = KSPGetPC(_kspTrans,&_pc); CHKERRQ(ierr);
+    if (cached) {
+      ierr = KSPSetType(ksp,KSPGMRES); CHKERRQ(ierr);
+      ierr = KSPSetTolerances(ksp,_kspTol,_kspTol,PETSC_DEFAULT,PETSC_DEFAULT); CHKERRQ(ierr);
+    }
+    else { ierr = KSPSetType(ksp,KSPPREONLY); CHKERRQ(ierr); }
+    ierr = KSPSetOperators(ksp,A,A); CHKERRQ(ierr);
+    ierr = KSPSetReusePreconditioner(ksp,PETSC_TRUE); CHKERRQ(ierr);
+    ierr = KSPGetPC(ksp,&_pc); CHKERRQ(ierr);
     ierr = PCSetType(_pc,PCCHOLESKY); CHKERRQ(ierr);
     //~ ierr = PCFactorSetMatSolverType(pc,MATSOLVERMUMPS);                 CHKERRQ(ierr); // new PETSc
     //~ ierr = PCFactorSetUpMatSolverType(pc);                              CHKERRQ(ierr); // new PETSc
     ierr = PCFactorSetMatSolverPackage(_pc,MATSOLVERMUMPS);              CHKERRQ(ierr); // old PETSc
     ierr = PCFactorSetUpMatSolverPackage(_pc);                           CHKERRQ(ierr); // old PETSc
-    ierr = KSPSetInitialGuessNonzero(_kspTrans,PETSC_TRUE); CHKERRQ(ierr);
+    ierr = KSPSetInitialGuessNonzero(ksp,PETSC_TRUE); CHKERRQ(ierr);
   }
   else if (_linSolver.compare("CG")==0) { // conjugate gradient
-    ierr = KSPSetType(_kspTrans,KSPCG); CHKERRQ(ierr);
-    ierr = KSPSetOperators(_kspTrans,A,A); CHKERRQ(ierr);
-    ierr = KSPSetReusePreconditioner(_kspTrans,PETSC_FALSE); CHKERRQ(ierr);
-    ierr = KSPGetPC(_kspTrans,&_pc); CHKERRQ(ierr);
-    ierr = KSPSetTolerances(_kspTrans,_kspTol,_kspTol,PETSC_DEFAULT,PETSC_DEFAULT); CHKERRQ(ierr);
+    ierr = KSPSetType(ksp,KSPCG); CHKERRQ(ierr);
+    ierr = KSPSetOperators(ksp,A,A); CHKERRQ(ierr);
+    ierr = KSPSetReusePreconditioner(ksp,cached ? PETSC_TRUE : PETSC_FALSE); CHKERRQ(ierr);
+    ierr = KSPGetPC(ksp,&_pc); CHKERRQ(ierr);
+    ierr = KSPSetTolerances(ksp,_kspTol,_kspTol,PETSC_DEFAULT,PETSC_DEFAULT); CHKERRQ(ierr);
     ierr = PCSetType(_pc,PCHYPRE); CHKERRQ(ierr);
     ierr = PCFactorSetShiftType(_pc,MAT_SHIFT_POSITIVE_DEFINITE); CHKERRQ(ierr);
-    ierr = KSPSetInitialGuessNonzero(_kspTrans,PETSC_TRUE); CHKERRQ(ierr);
+    ierr = KSPSetInitialGuessNonzero(ksp,PETSC_TRUE); CHKERRQ(ierr);
   }
   else {
     ierr = PetscPrintf(PETSC_COMM_WORLD,"ERROR: linSolver type not understood\n");
@@ -826,11 +846,11 @@ PetscErrorCode HeatEquation::setupKSP(Mat& A)
   }
 
   // accept command line options
-  ierr = KSPSetFromOptions(_kspTrans);CHKERRQ(ierr);
+  ierr = KSPSetFromOptions(ksp);CHKERRQ(ierr);
 
   // perform computation of preconditioners now, rather than on first use
   double startTime = MPI_Wtime();
-  ierr = KSPSetUp(_kspTrans);CHKERRQ(ierr);
+  ierr = KSPSetUp(ksp);CHKERRQ(ierr);
   _factorTime += MPI_Wtime() - startTime;
 
   #if VERBOSE > 1
@@ -1015,17 +1035,18 @@ PetscErrorCode HeatEquation::d_dt(const PetscScalar time,const Vec slipVel,const
   }
 
   // rhs = -H*J*(SAT bc terms) + H*J*Q
-  Vec rhs; VecDuplicate(_k,&rhs); VecSet(rhs,0.0);
+  Vec rhs,temp1;
+  ierr = _work.get("d_dt_rhs",_k,rhs); CHKERRQ(ierr);
+  ierr = _work.get("d_dt_temp1",_k,temp1); CHKERRQ(ierr);
+  VecSet(rhs,0.0);
   ierr = _sbp->setRhs(rhs,_bcL,_bcR,_bcT,_bcB);CHKERRQ(ierr); // put SAT terms in temp
   VecScale(rhs,-1.); // sign convention in setRhs is opposite of what's needed for explicit time stepping
   if (_D->_gridSpacingType.compare("variableGridSpacing")==0) {
-    Vec temp1; VecDuplicate(_Q,&temp1);
     Mat J,Jinv,qy,rz,yq,zr;
     ierr = _sbp->getCoordTrans(J,Jinv,qy,rz,yq,zr); CHKERRQ(ierr);
     ierr = MatMult(J,_Q,temp1);
     Mat H; _sbp->getH(H);
     ierr = MatMultAdd(H,temp1,rhs,rhs); CHKERRQ(ierr); // rhs = H*temp1 + temp
-    VecDestroy(&temp1);
   }
   else {
     Mat H; _sbp->getH(H);
@@ -1040,19 +1061,15 @@ PetscErrorCode HeatEquation::d_dt(const PetscScalar time,const Vec slipVel,const
   VecPointwiseDivide(rhs,rhs,_rho);
   VecPointwiseDivide(rhs,rhs,_c);
   if (_D->_gridSpacingType.compare("variableGridSpacing")==0) {
-    Vec temp1; VecDuplicate(_Q,&temp1);
     Mat J,Jinv,qy,rz,yq,zr;
     ierr = _sbp->getCoordTrans(J,Jinv,qy,rz,yq,zr); CHKERRQ(ierr);
     ierr = MatMult(Jinv,rhs,temp1);
     _sbp->Hinv(temp1,dTdt);
-    VecDestroy(&temp1);
   }
   else {
     _sbp->Hinv(rhs,dTdt);
   }
 
-  VecDestroy(&rhs);
-
   computeHeatFlux();
 
   #if VERBOSE > 1
@@ -1156,20 +1173,29 @@ PetscErrorCode HeatEquation::be_transient(const PetscScalar time,const Vec slipV
   VecCopy(Tn,_T);
 
   // set up matrix
-  MatCopy(_D2ath,_B,SAME_NONZERO_PATTERN);
-  MatScale(_B,-dt);
-  MatAXPY(_B,1.0,_I,SUBSET_NONZERO_PATTERN);
-  if (_kspTrans == NULL) {
+  KSP ksp = NULL;
+  if (_dtCacheSize > 0) {
     KSPDestroy(&_kspSS);
-    setupKSP(_B);
+    ierr = getCachedKSP(dt,ksp);CHKERRQ(ierr);
+  }
+  else {
+    MatCopy(_D2ath,_B,SAME_NONZERO_PATTERN);
+    MatScale(_B,-dt);
+    MatAXPY(_B,1.0,_I,SUBSET_NONZERO_PATTERN);
+    if (_kspTrans == NULL) {
+      KSPDestroy(&_kspSS);
+      setupKSP(_kspTrans,_B,false);
+    }
+    ierr = KSPSetOperators(_kspTrans,_B,_B);CHKERRQ(ierr);
+    ksp = _kspTrans;
   }
-  ierr = KSPSetOperators(_kspTrans,_B,_B);CHKERRQ(ierr);
 
   // set up boundary conditions and source terms: Q = Qfric + Qvisc
   // Note: there is no Qrad because radioactive heat generation is already included in Tamb
-  Vec rhs,temp;
-  VecDuplicate(_k,&rhs);
-  VecDuplicate(_k,&temp);
+  Vec rhs,temp,temp1;
+  ierr = _work.get("be_rhs",_k,rhs); CHKERRQ(ierr);
+  ierr = _work.get("be_temp",_k,temp); CHKERRQ(ierr);
+  ierr = _work.get("be_temp1",_k,temp1); CHKERRQ(ierr);
   VecSet(rhs,0.0);
   VecSet(temp,0.0);
   VecSet(_Q,0.); // radioactive heat generation is already included in Tamb
@@ -1188,16 +1214,17 @@ PetscErrorCode HeatEquation::be_transient(const PetscScalar time,const Vec slipV
   }
 
   ierr = _sbp->setRhs(temp,_bcL,_bcR,_bcT,_bcB);CHKERRQ(ierr);
-  Vec temp1; VecDuplicate(_Q,&temp1);
   if (_D->_gridSpacingType.compare("variableGridSpacing")==0) {
     Mat J,Jinv,qy,rz,yq,zr;
     ierr = _sbp->getCoordTrans(J,Jinv,qy,rz,yq,zr); CHKERRQ(ierr);
     ierr = MatMult(J,_Q,temp1);
   }
+  else {
+    VecCopy(_Q,temp1);
+  }
 
   Mat H; _sbp->getH(H);
   ierr = MatMultAdd(H,temp1,temp,temp); CHKERRQ(ierr);
-  VecDestroy(&temp1);
   MatMult(_rcInv,temp,rhs);
   VecScale(rhs,dt);
 
@@ -1209,20 +1236,16 @@ PetscErrorCode HeatEquation::be_transient(const PetscScalar time,const Vec slipV
   if (_D->_gridSpacingType.compare("variableGridSpacing")==0) {
     Mat J,Jinv,qy,rz,yq,zr;
     ierr = _sbp->getCoordTrans(J,Jinv,qy,rz,yq,zr); CHKERRQ(ierr);
-    Vec temp1; VecDuplicate(temp,&temp1);
     MatMult(J,temp,temp1);
     VecCopy(temp1,temp);
-    VecDestroy(&temp1);
   }
   VecAXPY(rhs,1.0,temp);
-  VecDestroy(&temp);
 
   // solve for temperature and record run time required
   double startTime = MPI_Wtime();
-  KSPSolve(_kspTrans,rhs,_dT);
+  KSPSolve(ksp,rhs,_dT);
   _linSolveTime += MPI_Wtime() - startTime;
   _linSolveCount++;
-  VecDestroy(&rhs);
 
   // update total temperature: _T (internal variable) and T (output)
   VecWAXPY(_T,1.0,_Tamb,_dT); // T = dT + Tamb
@@ -1237,6 +1260,74 @@ PetscErrorCode HeatEquation::be_transient(const PetscScalar time,const Vec slipV
 }
 
 
+// KSP for the Backward Euler operator with time step dt, from the cache
+PetscErrorCode HeatEquation::getCachedKSP(const PetscScalar dt, KSP& ksp)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "HeatEquation::getCachedKSP";
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);CHKERRQ(ierr);
+  #endif
+
+  assert(dt > 0);
+  const PetscInt bucket = (PetscInt) round(log(dt) / log(_dtCacheRatio));
+  const PetscScalar dtBucket = pow(_dtCacheRatio,(PetscScalar) bucket);
+
+  map<PetscInt,BeOperator>::iterator it = _dtCache.find(bucket);
+  if (it == _dtCache.end()) {
+    _dtCacheMisses++;
+
+    // evict the least recently used operator
+    if ((PetscInt) _dtCache.size() >= _dtCacheSize) {
+      map<PetscInt,BeOperator>::iterator lru = _dtCache.begin();
+      for (map<PetscInt,BeOperator>::iterator jt = _dtCache.begin(); jt != _dtCache.end(); jt++) {
+        if (jt->second.lastUse < lru->second.lastUse) { lru = jt; }
+      }
+      KSPDestroy(&lru->second.ksp);
+      MatDestroy(&lru->second.B);
+      _dtCache.erase(lru);
+    }
+
+    BeOperator op;
+    ierr = MatDuplicate(_D2ath,MAT_COPY_VALUES,&op.B);CHKERRQ(ierr);
+    ierr = MatScale(op.B,-dtBucket);CHKERRQ(ierr);
+    ierr = MatAXPY(op.B,1.0,_I,SUBSET_NONZERO_PATTERN);CHKERRQ(ierr);
+    ierr = setupKSP(op.ksp,op.B,true);CHKERRQ(ierr);
+    it = _dtCache.insert(make_pair(bucket,op)).first;
+  }
+  it->second.lastUse = ++_dtCacheUses;
+  ksp = it->second.ksp;
+
+  // solve with the bucket's operator if dt is the bucket value, otherwise
+  // with B(dt), preconditioned by the bucket's operator
+  if (fabs(dt - dtBucket) <= 1e-12 * dtBucket) {
+    ierr = KSPSetOperators(ksp,it->second.B,it->second.B);CHKERRQ(ierr);
+  }
+  else {
+    ierr = MatCopy(_D2ath,_B,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+    ierr = MatScale(_B,-dt);CHKERRQ(ierr);
+    ierr = MatAXPY(_B,1.0,_I,SUBSET_NONZERO_PATTERN);CHKERRQ(ierr);
+    ierr = KSPSetOperators(ksp,_B,it->second.B);CHKERRQ(ierr);
+  }
+
+  #if VERBOSE > 1
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);CHKERRQ(ierr);
+  #endif
+  return ierr;
+}
+
+
+PetscErrorCode HeatEquation::clearDtCache()
+{
+  for (map<PetscInt,BeOperator>::iterator it = _dtCache.begin(); it != _dtCache.end(); it++) {
+    KSPDestroy(&it->second.ksp);
+    MatDestroy(&it->second.B);
+  }
+  _dtCache.clear();
+  return 0;
+}
+
+
 // for thermomechanical problem when solving only the steady-state heat equation
 // Note: This function uses the KSP algorithm to solve for dT, where T = Tamb + dT
 PetscErrorCode HeatEquation::be_steadyState(const PetscScalar time,const Vec slipVel,const Vec& tau,
@@ -1254,12 +1345,15 @@ PetscErrorCode HeatEquation::be_steadyState(const PetscScalar time,const Vec sli
 
   if (_kspSS == NULL) {
     KSPDestroy(&_kspTrans);
+    clearDtCache();
     Mat A; _sbp->getA(A);
     setupKSP_SS(A);
   }
 
   // set up boundary conditions and source terms: Q = Qrad + Qfric + Qvisc
-  Vec rhs; VecDuplicate(_k,&rhs); VecSet(rhs,0.0);
+  Vec rhs;
+  ierr = _work.get("be_rhs",_k,rhs); CHKERRQ(ierr);
+  VecSet(rhs,0.0);
 
   // compute heat source terms
   // Note: this does not include Qrad because that is included in the ambient geotherm
@@ -1282,13 +1376,13 @@ PetscErrorCode HeatEquation::be_steadyState(const PetscScalar time,const Vec sli
   // rhs = J*H*Q + (SAT BC terms)
   ierr = _sbp->setRhs(rhs,_bcL,_bcR,_bcT,_bcB);CHKERRQ(ierr);
   if (_D->_gridSpacingType.compare("variableGridSpacing")==0) {
-    Vec temp1; VecDuplicate(_Q,&temp1);
+    Vec temp1;
+    ierr = _work.get("be_temp1",_k,temp1); CHKERRQ(ierr);
     Mat J,Jinv,qy,rz,yq,zr;
     ierr = _sbp->getCoordTrans(J,Jinv,qy,rz,yq,zr); CHKERRQ(ierr);
     ierr = MatMult(J,_Q,temp1);
     Mat H; _sbp->getH(H);
     ierr = MatMultAdd(H,temp1,rhs,rhs);
-    VecDestroy(&temp1);
   }
   else{
     Mat H; _sbp->getH(H);
@@ -1301,7 +1395,6 @@ PetscErrorCode HeatEquation::be_steadyState(const PetscScalar time,const Vec sli
   KSPSolve(_kspSS,rhs,_dT);
   _linSolveTime += MPI_Wtime() - startTime;
   _linSolveCount++;
-  VecDestroy(&rhs);
 
   // update total temperature: _T (internal variable) and T (output)
   VecWAXPY(_T,1.0,_Tamb,_dT);
@@ -1445,6 +1538,7 @@ PetscErrorCode HeatEquation::computeSteadyStateTemp(const PetscScalar time,const
 
   if (_kspSS == NULL) {
     KSPDestroy(&_kspTrans);
+    clearDtCache();
     Mat A; _sbp->getA(A);
     setupKSP_SS(A);
   }
@@ -1523,10 +1617,9 @@ PetscErrorCode HeatEquation::computeViscousShearHeating(const Vec& sdev, const V
   // compute dgv
   VecPointwiseMult(_Qvisc,dgxy,dgxy);
   Vec temp;
-  VecDuplicate(sdev,&temp);
+  ierr = _work.get("computeViscousShearHeating_temp",sdev,temp); CHKERRQ(ierr);
   VecPointwiseMult(temp,dgxz,dgxz);
   VecAXPY(_Qvisc,1.0,temp);
-  VecDestroy(&temp);
   VecSqrtAbs(_Qvisc);
 
   // multiply by deviatoric stress
@@ -1749,21 +1842,21 @@ PetscErrorCode HeatEquation::writeStep1D(const PetscInt stepCount, const PetscSc
   VecMax(_dT, NULL, &_maxTemp); // compute max T for output
 
   if (stepCount == 0) {
-    ierr = io_initiateWriteAppend(_viewers, "kTz_y0", _kTz_z0, outputDir + "he_kTz_y0"); CHKERRQ(ierr);
-    ierr = io_initiateWriteAppend(_viewers, "he_bcR", _bcR, outputDir + "he_bcR"); CHKERRQ(ierr);
-    ierr = io_initiateWriteAppend(_viewers, "he_bcT", _bcT, outputDir + "he_bcT"); CHKERRQ(ierr);
-    ierr = io_initiateWriteAppend(_viewers, "he_bcB", _bcB, outputDir + "he_bcB"); CHKERRQ(ierr);
-    ierr = io_initiateWriteAppend(_viewers, "he_bcL", _bcL, outputDir + "he_bcL"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "kTz_y0", _kTz_z0, outputDir + "he_kTz_y0"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "he_bcR", _bcR, outputDir + "he_bcR"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "he_bcT", _bcT, outputDir + "he_bcT"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "he_bcB", _bcB, outputDir + "he_bcB"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "he_bcL", _bcL, outputDir + "he_bcL"); CHKERRQ(ierr);
 
     ierr = PetscViewerASCIIOpen(PETSC_COMM_WORLD,(outputDir+"he_maxT.txt").c_str(),&_maxTempV);CHKERRQ(ierr);
     ierr = PetscViewerASCIIPrintf(_maxTempV, "%.15e\n",_maxTemp); CHKERRQ(ierr);
   }
   else {
-    ierr = VecView(_kTz_z0,_viewers["kTz_y0"].first); CHKERRQ(ierr);
-    ierr = VecView(_bcL,_viewers["he_bcL"].first); CHKERRQ(ierr);
-    ierr = VecView(_bcR,_viewers["he_bcR"].first); CHKERRQ(ierr);
-    ierr = VecView(_bcT,_viewers["he_bcT"].first); CHKERRQ(ierr);
-    ierr = VecView(_bcB,_viewers["he_bcB"].first); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_kTz_z0,_viewers["kTz_y0"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_bcL,_viewers["he_bcL"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_bcR,_viewers["he_bcR"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_bcT,_viewers["he_bcT"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_bcB,_viewers["he_bcB"]); CHKERRQ(ierr);
     ierr = PetscViewerASCIIPrintf(_maxTempV, "%.15e\n",_maxTemp); CHKERRQ(ierr);
   }
 
@@ -1788,20 +1881,20 @@ PetscErrorCode HeatEquation::writeStep2D(const PetscInt stepCount, const PetscSc
   double startTime = MPI_Wtime();
 
   if (stepCount == 0) {
-    ierr = io_initiateWriteAppend(_viewers, "T", _T, outputDir + "he_T"); CHKERRQ(ierr);
-    ierr = io_initiateWriteAppend(_viewers, "dT", _dT, outputDir + "he_dT"); CHKERRQ(ierr);
-    ierr = io_initiateWriteAppend(_viewers, "kTz", _kTz, outputDir + "he_kTz"); CHKERRQ(ierr);
-    ierr = io_initiateWriteAppend(_viewers, "Qfric", _Qfric, outputDir + "he_Qfric"); CHKERRQ(ierr);
-    ierr = io_initiateWriteAppend(_viewers, "Qvisc", _Qvisc, outputDir + "he_Qvisc"); CHKERRQ(ierr);
-    ierr = io_initiateWriteAppend(_viewers, "Q", _Q, outputDir + "he_Q"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "T", _T, outputDir + "he_T"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "dT", _dT, outputDir + "he_dT"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "kTz", _kTz, outputDir + "he_kTz"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "Qfric", _Qfric, outputDir + "he_Qfric"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "Qvisc", _Qvisc, outputDir + "he_Qvisc"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "Q", _Q, outputDir + "he_Q"); CHKERRQ(ierr);
   }
   else {
-    ierr = VecView(_T,_viewers["T"].first); CHKERRQ(ierr);
-    ierr = VecView(_dT,_viewers["dT"].first); CHKERRQ(ierr);
-    ierr = VecView(_kTz,_viewers["kTz"].first); CHKERRQ(ierr);
-    ierr = VecView(_Qfric,_viewers["Qfric"].first); CHKERRQ(ierr);
-    ierr = VecView(_Qvisc,_viewers["Qvisc"].first); CHKERRQ(ierr);
-    ierr = VecView(_Q,_viewers["Q"].first); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_T,_viewers["T"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_dT,_viewers["dT"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_kTz,_viewers["kTz"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_Qfric,_viewers["Qfric"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_Qvisc,_viewers["Qvisc"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_Q,_viewers["Q"]); CHKERRQ(ierr);
   }
 
   _writeTime += MPI_Wtime() - startTime;
@@ -1813,6 +1906,43 @@ PetscErrorCode HeatEquation::writeStep2D(const PetscInt stepCount, const PetscSc
 }
 
 
+// load temperature from a checkpoint
+PetscErrorCode HeatEquation::loadCheckpoint()
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "HeatEquation::loadCheckpoint";
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);CHKERRQ(ierr);
+  #endif
+
+  ierr = _D->_checkpoint.getVec("he_T",_T); CHKERRQ(ierr);
+  ierr = VecWAXPY(_dT,-1.0,_Tamb,_T); CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);CHKERRQ(ierr);
+  #endif
+  return ierr;
+}
+
+
+// add temperature to the next checkpoint
+PetscErrorCode HeatEquation::writeCheckpoint()
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "HeatEquation::writeCheckpoint";
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);CHKERRQ(ierr);
+  #endif
+
+  ierr = _D->_checkpoint.setVec("he_T",_T); CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);CHKERRQ(ierr);
+  #endif
+  return ierr;
+}
+
+
 PetscErrorCode HeatEquation::view()
 {
   PetscErrorCode ierr = 0;
@@ -1823,6 +1953,11 @@ PetscErrorCode HeatEquation::view()
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   number of times linear system was solved: %i\n",_linSolveCount);CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent solving linear system (s): %g\n",_linSolveTime);CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   %% be time spent solving linear system: %g\n",_linSolveTime/_beTime*100.);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent setting up preconditioners (s): %g\n",_factorTime);CHKERRQ(ierr);
+  if (_dtCacheSize > 0) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   Backward Euler operators set up (cache misses): %i of %i solves\n",_dtCacheMisses,_dtCacheUses);CHKERRQ(ierr);
+  }
+  ierr = _work.view();CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"\n");CHKERRQ(ierr);
 
   return ierr;
@@ -1855,6 +1990,9 @@ PetscErrorCode HeatEquation::writeDomain(const string outputDir)
   ierr = PetscViewerASCIIPrintf(viewer,"withRadioHeatGeneration = %s\n",_wRadioHeatGen.c_str());CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"linSolver_heateq = %s\n",_linSolver.c_str());CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"kspTol_heateq = %.15e\n",_kspTol);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"dtCacheSize_heateq = %i\n",_dtCacheSize);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"dtCacheRatio_heateq = %.15e\n",_dtCacheRatio);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"dtCacheSnap_heateq = %i\n",_dtCacheSnap);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"\n");CHKERRQ(ierr);
 
   ierr = PetscViewerASCIIPrintf(viewer,"Nz_lab = %i\n",_Nz_lab);CHKERRQ(ierr);
@@ -15,6 +15,7 @@
 #include "integratorContextImex.hpp"
 #include "odeSolver.hpp"
 #include "odeSolverImex.hpp"
+#include "workspace.hpp"
 
 using namespace std;
 
@@ -94,6 +95,19 @@ public:
   Mat             _I,_rcInv,_B,_pcMat; // intermediates for Backward Euler
   Mat             _D2ath;
 
+  // cache of Backward Euler operators B = I - dt*_D2ath with their
+  // preconditioners (e.g. factorizations) set up, one per time step bucket
+  // dt_k = _dtCacheRatio^k, evicting the least recently used beyond
+  // _dtCacheSize entries. Each solve uses the bucket nearest to dt: directly
+  // if dt is the bucket value (see OdeSolverImex::setStepSizeBuckets), and
+  // otherwise as the preconditioner for a Krylov solve with B(dt).
+  struct BeOperator { Mat B; KSP ksp; PetscInt lastUse; };
+  map<PetscInt,BeOperator> _dtCache;
+  PetscInt        _dtCacheSize; // max # of cached operators, 0 to turn the cache off
+  PetscScalar     _dtCacheRatio; // ratio between neighboring buckets
+  int             _dtCacheSnap; // 1 to have the IMEX integrator only take time steps dt_k
+  PetscInt        _dtCacheUses,_dtCacheMisses;
+
   // scatters to take values from body field(s) to 1D fields
   // naming convention for key (string): body2<boundary>, example: "body2L>"
   map <string, VecScatter>  _scatters;
@@ -113,6 +127,9 @@ public:
   double          _linSolveTime,_factorTime,_beTime,_writeTime,_miscTime;
   PetscInt        _linSolveCount;
 
+  // scratch Vecs for the functions called every time step
+  Workspace       _work;
+
   // checkpoint settings
   PetscInt _ckpt, _ckptNumber;
 
@@ -131,7 +148,9 @@ public:
   PetscErrorCode setUpTransientProblem();
   PetscErrorCode computeViscousShearHeating(const Vec& sdev, const Vec& dgxy, const Vec& dgxz);
   PetscErrorCode computeFrictionalShearHeating(const Vec& tau, const Vec& slipVel);
-  PetscErrorCode setupKSP(Mat& A);
+  PetscErrorCode setupKSP(KSP& ksp, Mat& A, const bool cached);
+  PetscErrorCode getCachedKSP(const PetscScalar dt, KSP& ksp);
+  PetscErrorCode clearDtCache();
   PetscErrorCode setupKSP_SS(Mat& A);
   PetscErrorCode computeHeatFlux();
 
@@ -173,6 +192,10 @@ public:
   PetscErrorCode writeStep1D(const PetscInt stepCount, const PetscScalar time,const string outputDir);
   PetscErrorCode writeStep2D(const PetscInt stepCount, const PetscScalar time,const string outputDir);
 
+  // checkpointing
+  PetscErrorCode loadCheckpoint();
+  PetscErrorCode writeCheckpoint();
+
 
   // MMS functions
   PetscErrorCode measureMMSError(const PetscScalar time);
@@ -24,6 +24,12 @@ class IntegratorContextEx
   // for output and monitoring as time integration progresses
   // this function is not required
   virtual PetscErrorCode timeMonitor(const PetscReal time,const PetscScalar deltaT, const PetscInt stepCount,int& stopIntegration){return 1;};
+
+  // called by the integrator before each call to d_dt, with the Runge-Kutta
+  // stage about to be evaluated (0 for the rate at an accepted solution or
+  // the initial condition), so that work can be reused between stages
+  // this function is not required
+  virtual PetscErrorCode setStage(const PetscInt stage){return 0;};
 };
 
 #include "odeSolver.hpp"
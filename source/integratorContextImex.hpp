@@ -28,6 +28,18 @@ class IntegratorContextImex
     // this function is not required
     virtual PetscErrorCode timeMonitor(const PetscReal time,const PetscScalar deltaT, const PetscInt stepCount,int& stopIntegration){return 1;};
 
+    // called by the integrator before each call to d_dt, with the Runge-Kutta
+    // stage about to be evaluated (0 for the rate at an accepted solution or
+    // the initial condition), so that work can be reused between stages
+    // this function is not required
+    virtual PetscErrorCode setStage(const PetscInt stage){return 0;};
+
+    // for exponential integrators: rates lambda >= 0 of the linear relaxation
+    // in the most recent d_dt, i.e. dvarEx = -lambda*varEx + (non-stiff part),
+    // for each entry of varEx (entries are 0 on input, and may be left as is)
+    // this function is not required
+    virtual PetscErrorCode getLinearRelaxationRates(map<string,Vec>& lambda){return 0;};
+
 };
 
 #include "odeSolver.hpp"
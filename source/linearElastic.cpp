@@ -13,7 +13,7 @@ LinearElastic::LinearElastic(Domain&D,string bcRTtype,string bcTTtype,string bcL
     _mu(NULL),_rho(NULL),_cs(NULL),_bcRShift(NULL),_surfDisp(NULL),
     _rhs(NULL),_u(NULL),_sxy(NULL),_sxz(NULL),_computeSxz(0),_computeSdev(0),
     _linSolver("MUMPSCHOLESKY"),_ksp(NULL),_pc(NULL),_kspTol(1e-10),
-    _sbp(NULL),
+    _sbp(NULL),_muDyFault(NULL),_bcKey(bcRTtype + "_" + bcTTtype + "_" + bcLTtype + "_" + bcBTtype),
     _writeTime(0),_linSolveTime(0),_factorTime(0),_startTime(MPI_Wtime()),
     _miscTime(0), _matrixTime(0), _linSolveCount(0),
     _bcRType(bcRTtype),_bcTType(bcTTtype),_bcLType(bcLTtype),_bcBType(bcBTtype),
@@ -77,10 +77,17 @@ LinearElastic::~LinearElastic()
   VecDestroy(&_sxz);
   VecDestroy(&_surfDisp);
 
+  // once the boundary conditions have been changed, _sbp and _ksp are in _bcContexts
+  if (!_bcContexts.empty()) { _sbp = NULL; _ksp = NULL; }
+  for (map<string,pair<SbpOps*,KSP> >::iterator it = _bcContexts.begin(); it != _bcContexts.end(); it++) {
+    delete it->second.first;
+    KSPDestroy(&it->second.second);
+  }
   KSPDestroy(&_ksp);
 
   delete _sbp;
   _sbp = NULL;
+  MatDestroy(&_muDyFault);
 
   for (map<string,pair<PetscViewer,string> >::iterator it=_viewers1D.begin(); it !=_viewers1D.end(); it++) {
     PetscViewerDestroy(&_viewers1D[it->first].first);
@@ -167,6 +174,11 @@ PetscErrorCode LinearElastic::checkInput()
     assert(_kspTol >= 1e-14);
   }
 
+  // matrix-free operators can only be used with an iterative solver
+  if (_D->_operatorType.compare("matrix-free")==0) {
+    assert(_linSolver.compare("CG") == 0);
+  }
+
   assert(_muVals.size() == _muDepths.size());
   assert(_muVals.size() != 0);
   assert(_rhoVals.size() == _rhoDepths.size());
@@ -266,8 +278,14 @@ PetscErrorCode LinearElastic::setupKSP(KSP& ksp,PC& pc,Mat& A)
     ierr = KSPSetReusePreconditioner(ksp,PETSC_TRUE);                   CHKERRQ(ierr);
     ierr = KSPGetPC(ksp,&pc);                                           CHKERRQ(ierr);
     ierr = KSPSetTolerances(ksp,_kspTol,_kspTol,PETSC_DEFAULT,PETSC_DEFAULT); CHKERRQ(ierr);
-    ierr = PCSetType(pc,PCHYPRE);                                       CHKERRQ(ierr);
-    ierr = PCFactorSetShiftType(pc,MAT_SHIFT_POSITIVE_DEFINITE); CHKERRQ(ierr);
+    if (_D->_operatorType.compare("matrix-free")==0) {
+      // HYPRE needs an assembled matrix, so use the diagonal of A
+      ierr = PCSetType(pc,PCJACOBI);                                    CHKERRQ(ierr);
+    }
+    else {
+      ierr = PCSetType(pc,PCHYPRE);                                     CHKERRQ(ierr);
+      ierr = PCFactorSetShiftType(pc,MAT_SHIFT_POSITIVE_DEFINITE);      CHKERRQ(ierr);
+    }
   }
 
   // undefined linear solver
@@ -402,11 +420,12 @@ PetscErrorCode LinearElastic::loadCheckpoint()
   #endif
 
   // boundary conditions
-  ierr = loadVecFromInputFile(_bcRShift, _outputDir + "chkpt_", "momBal_bcRShift"); CHKERRQ(ierr);
-  ierr = loadVecFromInputFile(_bcR, _outputDir + "chkpt_", "momBal_bcR"); CHKERRQ(ierr);
-  ierr = loadVecFromInputFile(_bcT, _outputDir + "chkpt_", "momBal_bcT"); CHKERRQ(ierr);
-  ierr = loadVecFromInputFile(_bcL, _outputDir + "chkpt_", "momBal_bcL"); CHKERRQ(ierr);
-  ierr = loadVecFromInputFile(_bcB, _outputDir + "chkpt_", "momBal_bcB"); CHKERRQ(ierr);
+  const Checkpoint& ckpt = _D->_checkpoint;
+  ierr = ckpt.getVec("momBal_bcRShift",_bcRShift); CHKERRQ(ierr);
+  ierr = ckpt.getVec("momBal_bcR",_bcR); CHKERRQ(ierr);
+  ierr = ckpt.getVec("momBal_bcT",_bcT); CHKERRQ(ierr);
+  ierr = ckpt.getVec("momBal_bcL",_bcL); CHKERRQ(ierr);
+  ierr = ckpt.getVec("momBal_bcB",_bcB); CHKERRQ(ierr);
 
 
   // material parameters
@@ -433,26 +452,48 @@ PetscErrorCode LinearElastic::setUpSBPContext()
 
   delete _sbp;
   KSPDestroy(&_ksp);
+  MatDestroy(&_muDyFault);
+
+  ierr = createSbpOps(_sbp,_bcRType,_bcTType,_bcLType,_bcBType); CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
 
-  if (_D->_gridSpacingType.compare("constantGridSpacing")==0) {
-    _sbp = new SbpOps_m_constGrid(_order,_Ny,_Nz,_Ly,_Lz,_mu);
+// create SBP operators for the given boundary condition types
+PetscErrorCode LinearElastic::createSbpOps(SbpOps*& sbp,const string& bcR,const string& bcT,const string& bcL,const string& bcB)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "LinearElastic::createSbpOps";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  if (_D->_operatorType.compare("matrix-free")==0) {
+    sbp = new SbpOps_mf_constGrid(_order,_Ny,_Nz,_Ly,_Lz,_mu);
+  }
+  else if (_D->_gridSpacingType.compare("constantGridSpacing")==0) {
+    sbp = new SbpOps_m_constGrid(_order,_Ny,_Nz,_Ly,_Lz,_mu);
   }
   else if (_D->_gridSpacingType.compare("variableGridSpacing")==0) {
-    _sbp = new SbpOps_m_varGrid(_order,_Ny,_Nz,_Ly,_Lz,_mu);
-    if (_Ny > 1 && _Nz > 1) { _sbp->setGrid(_y,_z); }
-    else if (_Ny == 1 && _Nz > 1) { _sbp->setGrid(NULL,_z); }
-    else if (_Ny > 1 && _Nz == 1) { _sbp->setGrid(_y,NULL); }
+    sbp = new SbpOps_m_varGrid(_order,_Ny,_Nz,_Ly,_Lz,_mu);
+    if (_Ny > 1 && _Nz > 1) { sbp->setGrid(_y,_z); }
+    else if (_Ny == 1 && _Nz > 1) { sbp->setGrid(NULL,_z); }
+    else if (_Ny > 1 && _Nz == 1) { sbp->setGrid(_y,NULL); }
   }
   else {
     PetscPrintf(PETSC_COMM_WORLD,"ERROR: SBP type type not understood\n");
     assert(0); // automatically fail
   }
-  _sbp->setCompatibilityType(_D->_sbpCompatibilityType);
-  _sbp->setBCTypes(_bcRType,_bcTType,_bcLType,_bcBType);
-  _sbp->setMultiplyByH(1);
-  _sbp->setLaplaceType("yz");
-  _sbp->setDeleteIntermediateFields(1);
-  _sbp->computeMatrices(); // actually create the matrices
+  sbp->setCompatibilityType(_D->_sbpCompatibilityType);
+  sbp->setBCTypes(bcR,bcT,bcL,bcB);
+  sbp->setMultiplyByH(1);
+  sbp->setLaplaceType("yz");
+  sbp->setDeleteIntermediateFields(1);
+  sbp->computeMatrices(); // actually create the matrices
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -489,6 +530,216 @@ PetscErrorCode LinearElastic::computeU()
 }
 
 
+// compute the Green's function G mapping displacement on the left boundary
+// to surface displacement, G(i,j) = surfDisp(i) for bcL = e_j, with the other
+// boundary conditions set to 0
+// G is created here, with the parallel layout of _surfDisp for its rows.
+PetscErrorCode LinearElastic::computeGreensFunction(Mat& G, const PetscInt blockSize)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "LinearElastic::computeGreensFunction";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  ierr = computeBcLResponse(G,blockSize,_surfDisp,NULL); CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  return ierr;
+}
+
+
+// compute the Green's function G mapping displacement on the left boundary
+// to shear stress on the fault, G(i,j) = tauFault(i) for bcL = e_j, with the
+// other boundary conditions set to 0
+// G is created here, with the parallel layout of tauFault for its rows.
+// tauFault is used as work space, and body2fault maps the body to the fault.
+PetscErrorCode LinearElastic::computeFaultGreensFunction(Mat& G, const PetscInt blockSize, Vec& tauFault, VecScatter& body2fault)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "LinearElastic::computeFaultGreensFunction";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  ierr = computeBcLResponse(G,blockSize,tauFault,&body2fault); CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  return ierr;
+}
+
+
+// response of out to unit displacement at each point of the left boundary,
+// one column of G per point, where out is _surfDisp if body2fault is NULL and
+// the shear stress on the fault otherwise
+// The columns are computed blockSize at a time, each block of right-hand
+// sides solved together against the same factorization of A, so _ksp must
+// already be set up. Each solve is distributed over all processors, so every
+// processor takes part in every block. The boundary conditions are restored
+// afterwards.
+PetscErrorCode LinearElastic::computeBcLResponse(Mat& G, const PetscInt blockSize, Vec& out, VecScatter* body2fault)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "LinearElastic::computeBcLResponse";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  assert(blockSize > 0);
+
+  PetscInt N = 0, n = 0, nG = 0, mG = 0, nBody = 0, NBody = 0;
+  ierr = VecGetSize(_bcL,&N); CHKERRQ(ierr);
+  ierr = VecGetLocalSize(_bcL,&n); CHKERRQ(ierr);
+  ierr = VecGetSize(out,&mG); CHKERRQ(ierr);
+  ierr = VecGetLocalSize(out,&nG); CHKERRQ(ierr);
+  ierr = VecGetSize(_rhs,&NBody); CHKERRQ(ierr);
+  ierr = VecGetLocalSize(_rhs,&nBody); CHKERRQ(ierr);
+  const PetscInt nb = PetscMin(blockSize,N);
+  PetscInt bcLStart,bcLEnd;
+  ierr = VecGetOwnershipRange(_bcL,&bcLStart,&bcLEnd); CHKERRQ(ierr);
+
+  // save boundary conditions so they can be restored afterwards
+  Vec bcL,bcR,bcT,bcB;
+  VecDuplicate(_bcL,&bcL); VecCopy(_bcL,bcL);
+  VecDuplicate(_bcR,&bcR); VecCopy(_bcR,bcR);
+  VecDuplicate(_bcT,&bcT); VecCopy(_bcT,bcT);
+  VecDuplicate(_bcB,&bcB); VecCopy(_bcB,bcB);
+  VecSet(_bcR,0.0);
+  VecSet(_bcT,0.0);
+  VecSet(_bcB,0.0);
+
+  // each processor owns the rows of G matching its part of out, so the
+  // columns can be filled in directly, without communication, and the
+  // columns have the layout of _bcL, so G can multiply boundary Vecs
+  ierr = MatCreateDense(PETSC_COMM_WORLD,nG,n,mG,N,NULL,&G); CHKERRQ(ierr);
+  ierr = PetscObjectSetName((PetscObject) G, "G"); CHKERRQ(ierr);
+
+  // block of right-hand sides and solutions, with the layout of _rhs and _u
+  Mat B,X;
+  ierr = MatCreateDense(PETSC_COMM_WORLD,nBody,PETSC_DECIDE,NBody,nb,NULL,&B); CHKERRQ(ierr);
+  ierr = MatDuplicate(B,MAT_DO_NOT_COPY_VALUES,&X); CHKERRQ(ierr);
+
+  PetscScalar *g,*b,*x;
+  const PetscScalar *r,*s;
+  double startTime = MPI_Wtime();
+  for (PetscInt j0 = 0; j0 < N; j0 += nb) {
+    const PetscInt nCols = PetscMin(nb,N-j0);
+
+    // right-hand sides for unit displacement at each boundary point in the block
+    // (columns past the end of the boundary are left 0 in the last block)
+    ierr = MatZeroEntries(B); CHKERRQ(ierr);
+    ierr = MatDenseGetArray(B,&b); CHKERRQ(ierr);
+    for (PetscInt c = 0; c < nCols; c++) {
+      VecSet(_bcL,0.0);
+      if (j0+c >= bcLStart && j0+c < bcLEnd) { VecSetValue(_bcL,j0+c,1.0,INSERT_VALUES); }
+      VecAssemblyBegin(_bcL);
+      VecAssemblyEnd(_bcL);
+      ierr = setRHS(); CHKERRQ(ierr);
+
+      VecGetArrayRead(_rhs,&r);
+      for (PetscInt i = 0; i < nBody; i++) { b[c*nBody + i] = r[i]; }
+      VecRestoreArrayRead(_rhs,&r);
+    }
+    ierr = MatDenseRestoreArray(B,&b); CHKERRQ(ierr);
+
+    // solve for the displacement for every column in the block
+    ierr = computeUBlock(B,X,nCols); CHKERRQ(ierr);
+
+    // extract out into the columns of G
+    ierr = MatDenseGetArray(X,&x); CHKERRQ(ierr);
+    ierr = MatDenseGetArray(G,&g); CHKERRQ(ierr);
+    for (PetscInt c = 0; c < nCols; c++) {
+      VecPlaceArray(_u,x + c*nBody);
+      if (body2fault == NULL) { ierr = setSurfDisp(); CHKERRQ(ierr); }
+      else { ierr = computeFaultShearStress(out,*body2fault); CHKERRQ(ierr); }
+      VecResetArray(_u);
+
+      VecGetArrayRead(out,&s);
+      for (PetscInt i = 0; i < nG; i++) { g[(j0+c)*nG + i] = s[i]; }
+      VecRestoreArrayRead(out,&s);
+    }
+    ierr = MatDenseRestoreArray(G,&g); CHKERRQ(ierr);
+    ierr = MatDenseRestoreArray(X,&x); CHKERRQ(ierr);
+
+    #if VERBOSE > 0
+      ierr = PetscPrintf(PETSC_COMM_WORLD,"computed columns %i-%i of %i of the Green's function\n",j0,j0+nCols-1,N); CHKERRQ(ierr);
+    #endif
+  }
+  _linSolveTime += MPI_Wtime() - startTime;
+
+  ierr = MatAssemblyBegin(G,MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(G,MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+
+  // restore boundary conditions and the fields that depend on them
+  VecCopy(bcL,_bcL);
+  VecCopy(bcR,_bcR);
+  VecCopy(bcT,_bcT);
+  VecCopy(bcB,_bcB);
+  ierr = setRHS(); CHKERRQ(ierr);
+  ierr = setSurfDisp(); CHKERRQ(ierr);
+
+  MatDestroy(&B);
+  MatDestroy(&X);
+  VecDestroy(&bcL);
+  VecDestroy(&bcR);
+  VecDestroy(&bcT);
+  VecDestroy(&bcB);
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  return ierr;
+}
+
+
+// solve A*X = B for the first nCols columns of the dense matrices B and X,
+// which have the parallel layout of _rhs and _u for their rows
+// All columns are solved together against the same factorization of A where
+// PETSc supports it, so _ksp must already be set up.
+PetscErrorCode LinearElastic::computeUBlock(Mat& B, Mat& X, const PetscInt nCols)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "LinearElastic::computeUBlock";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  #if PETSC_VERSION_GE(3,14,0)
+    ierr = KSPMatSolve(_ksp,B,X); CHKERRQ(ierr);
+  #else
+    // no block solve in older PETSc, so solve one column at a time
+    PetscInt nBody = 0;
+    PetscScalar *b,*x;
+    ierr = VecGetLocalSize(_rhs,&nBody); CHKERRQ(ierr);
+    ierr = MatDenseGetArray(B,&b); CHKERRQ(ierr);
+    ierr = MatDenseGetArray(X,&x); CHKERRQ(ierr);
+    for (PetscInt c = 0; c < nCols; c++) {
+      VecPlaceArray(_rhs,b + c*nBody);
+      VecPlaceArray(_u,x + c*nBody);
+      ierr = KSPSolve(_ksp,_rhs,_u); CHKERRQ(ierr);
+      VecResetArray(_rhs);
+      VecResetArray(_u);
+    }
+    ierr = MatDenseRestoreArray(X,&x); CHKERRQ(ierr);
+    ierr = MatDenseRestoreArray(B,&b); CHKERRQ(ierr);
+  #endif
+  _linSolveCount += nCols;
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  return ierr;
+}
+
+
 // set the right-hand side vector for linear solve
 PetscErrorCode LinearElastic::setRHS()
 {
@@ -518,13 +769,32 @@ PetscErrorCode LinearElastic::changeBCTypes(string bcRTtype,string bcTTtype,stri
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
 
-  // destroy current KSP context to reset
-  KSPDestroy(&_ksp);
-  _sbp->changeBCTypes(bcRTtype,bcTTtype,bcLTtype,bcBTtype);
+  const string key = bcRTtype + "_" + bcTTtype + "_" + bcLTtype + "_" + bcBTtype;
+  if (key.compare(_bcKey)==0) { return ierr; }
 
-  Mat A;
-  _sbp->getA(A);
-  setupKSP(_ksp,_pc,A);
+  // keep the current SBP operators and KSP context
+  _bcContexts[_bcKey] = make_pair(_sbp,_ksp);
+
+  // switch to those for the new boundary condition types, setting them up
+  // (and factoring A) only the first time these types are used
+  map<string,pair<SbpOps*,KSP> >::iterator it = _bcContexts.find(key);
+  if (it != _bcContexts.end()) {
+    _sbp = it->second.first;
+    _ksp = it->second.second;
+  }
+  else {
+    double startMatrix = MPI_Wtime();
+    _sbp = NULL;
+    ierr = createSbpOps(_sbp,bcRTtype,bcTTtype,bcLTtype,bcBTtype); CHKERRQ(ierr);
+    _matrixTime += MPI_Wtime() - startMatrix;
+
+    Mat A;
+    ierr = _sbp->getA(A); CHKERRQ(ierr);
+    _ksp = NULL;
+    ierr = setupKSP(_ksp,_pc,A); CHKERRQ(ierr);
+    _bcContexts[key] = make_pair(_sbp,_ksp);
+  }
+  _bcKey = key;
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -568,6 +838,7 @@ PetscErrorCode LinearElastic::view(const double totRunTime)
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   %% time spent solving linear system: %g\n",_linSolveTime/totRunTime*100.); CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   %% integration time spent solving linear system: %g\n",_linSolveTime/totRunTime*100.); CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   %% integration time spent creating matrices: %g\n",_matrixTime/totRunTime*100.); CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   # of boundary condition sets with resident SBP operators and KSP: %i\n",_bcContexts.empty() ? 1 : (int) _bcContexts.size()); CHKERRQ(ierr);
 
   ierr = PetscPrintf(PETSC_COMM_WORLD,"\n");CHKERRQ(ierr);
 
@@ -630,20 +901,20 @@ PetscErrorCode LinearElastic::writeStep1D(PetscInt stepCount, const string outpu
   double startTime = MPI_Wtime();
 
   if (_viewers1D.empty()) {
-    initiate_appendVecToOutput(_viewers1D, "surfDisp", _surfDisp, outputDir + "surfDisp", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers1D, "bcR", _bcR, outputDir + "momBal_bcR", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers1D, "bcT", _bcT, outputDir + "momBal_bcT", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers1D, "bcL", _bcL, outputDir + "momBal_bcL", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers1D, "bcB", _bcB, outputDir + "momBal_bcB", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers1D, "bcRShift", _bcRShift, outputDir + "momBal_bcRShift", _D->_outFileMode);
+    _D->initiateTimeSeries(_viewers1D, "surfDisp", _surfDisp, outputDir + "surfDisp");
+    _D->initiateTimeSeries(_viewers1D, "bcR", _bcR, outputDir + "momBal_bcR");
+    _D->initiateTimeSeries(_viewers1D, "bcT", _bcT, outputDir + "momBal_bcT");
+    _D->initiateTimeSeries(_viewers1D, "bcL", _bcL, outputDir + "momBal_bcL");
+    _D->initiateTimeSeries(_viewers1D, "bcB", _bcB, outputDir + "momBal_bcB");
+    _D->initiateTimeSeries(_viewers1D, "bcRShift", _bcRShift, outputDir + "momBal_bcRShift");
   }
   else {
-    ierr = VecView(_surfDisp,_viewers1D["surfDisp"].first); CHKERRQ(ierr);
-    ierr = VecView(_bcL,_viewers1D["bcL"].first); CHKERRQ(ierr);
-    ierr = VecView(_bcR,_viewers1D["bcR"].first); CHKERRQ(ierr);
-    ierr = VecView(_bcB,_viewers1D["bcB"].first); CHKERRQ(ierr);
-    ierr = VecView(_bcT,_viewers1D["bcT"].first); CHKERRQ(ierr);
-    ierr = VecView(_bcR,_viewers1D["bcRShift"].first); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_surfDisp,_viewers1D["surfDisp"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_bcL,_viewers1D["bcL"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_bcR,_viewers1D["bcR"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_bcB,_viewers1D["bcB"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_bcT,_viewers1D["bcT"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_bcRShift,_viewers1D["bcRShift"]); CHKERRQ(ierr);
   }
 
   _writeTime += MPI_Wtime() - startTime;
@@ -667,14 +938,14 @@ PetscErrorCode LinearElastic::writeStep2D(PetscInt stepCount, const string outpu
   double startTime = MPI_Wtime();
 
   if (_viewers2D.empty()) {
-    initiate_appendVecToOutput(_viewers2D, "u", _u, outputDir + "momBal_u", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers2D, "sxy", _sxy, outputDir + "momBal_sxy", _D->_outFileMode);
-    if (_computeSxz) { initiate_appendVecToOutput(_viewers2D, "sxz", _sxz, outputDir + "momBal_sxz", _D->_outFileMode); }
+    _D->initiateTimeSeries(_viewers2D, "u", _u, outputDir + "momBal_u");
+    _D->initiateTimeSeries(_viewers2D, "sxy", _sxy, outputDir + "momBal_sxy");
+    if (_computeSxz) { _D->initiateTimeSeries(_viewers2D, "sxz", _sxz, outputDir + "momBal_sxz"); }
   }
   else {
-    ierr = VecView(_u,_viewers2D["u"].first); CHKERRQ(ierr);
-    ierr = VecView(_sxy,_viewers2D["sxy"].first); CHKERRQ(ierr);
-    if (_computeSxz) { ierr = VecView(_sxz,_viewers2D["sxz"].first); CHKERRQ(ierr); }
+    ierr = _D->appendTimeSeries(_u,_viewers2D["u"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_sxy,_viewers2D["sxy"]); CHKERRQ(ierr);
+    if (_computeSxz) { ierr = _D->appendTimeSeries(_sxz,_viewers2D["sxz"]); CHKERRQ(ierr); }
   }
 
   _writeTime += MPI_Wtime() - startTime;
@@ -685,7 +956,7 @@ PetscErrorCode LinearElastic::writeStep2D(PetscInt stepCount, const string outpu
   return ierr;
 }
 
-// writes out fields of length Ny or Nz at each time step
+// add the boundary conditions to the next checkpoint
 PetscErrorCode LinearElastic::writeCheckpoint()
 {
   PetscErrorCode ierr = 0;
@@ -694,11 +965,12 @@ PetscErrorCode LinearElastic::writeCheckpoint()
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
 
-  ierr = writeVec(_bcR, _outputDir + "chkpt_" +"momBal_bcR"); CHKERRQ(ierr);
-  ierr = writeVec(_bcRShift, _outputDir + "chkpt_" + "momBal_bcRShift"); CHKERRQ(ierr);
-  ierr = writeVec(_bcT, _outputDir + "chkpt_" + "momBal_bcT"); CHKERRQ(ierr);
-  ierr = writeVec(_bcL, _outputDir + "chkpt_" +"momBal_bcL"); CHKERRQ(ierr);
-  ierr = writeVec(_bcB, _outputDir + "chkpt_" +"momBal_bcB"); CHKERRQ(ierr);
+  Checkpoint& ckpt = _D->_checkpoint;
+  ierr = ckpt.setVec("momBal_bcR",_bcR); CHKERRQ(ierr);
+  ierr = ckpt.setVec("momBal_bcRShift",_bcRShift); CHKERRQ(ierr);
+  ierr = ckpt.setVec("momBal_bcT",_bcT); CHKERRQ(ierr);
+  ierr = ckpt.setVec("momBal_bcL",_bcL); CHKERRQ(ierr);
+  ierr = ckpt.setVec("momBal_bcB",_bcB); CHKERRQ(ierr);
 
   #if VERBOSE > 1
      PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -738,6 +1010,69 @@ PetscErrorCode LinearElastic::computeStresses()
 }
 
 
+// shear stress on the fault only, tauFault = mu*Dy*u at y = 0, for right-hand
+// side evaluations that do not need the stresses in the rest of the body
+// (sxy, sxz and sdev are left as they are). tauFault must have the parallel
+// layout of the fault Vecs, and body2fault maps the body to the fault.
+// With assembled SBP operators this is a mat-vec with the Nz fault rows of
+// mu*Dy; the matrix-free operators fall back to computing sxy everywhere.
+PetscErrorCode LinearElastic::computeFaultShearStress(Vec& tauFault, VecScatter& body2fault)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "LinearElastic::computeFaultShearStress";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  if (_D->_operatorType.compare("matrix-free")==0) {
+    ierr = _sbp->muxDy(_u,_sxy); CHKERRQ(ierr);
+    ierr = VecScatterBegin(body2fault, _sxy, tauFault, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+    ierr = VecScatterEnd(body2fault, _sxy, tauFault, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+    return ierr;
+  }
+
+  // fault point Ii is body point Ii (y = 0), so restrict mu*Dy to its first Nz rows
+  if (_muDyFault == NULL) {
+    double startMatrix = MPI_Wtime();
+    PetscInt nFault,NFault,nBody,NBody,Istart,Iend;
+    ierr = VecGetLocalSize(tauFault,&nFault); CHKERRQ(ierr);
+    ierr = VecGetSize(tauFault,&NFault); CHKERRQ(ierr);
+    ierr = VecGetLocalSize(_u,&nBody); CHKERRQ(ierr);
+    ierr = VecGetSize(_u,&NBody); CHKERRQ(ierr);
+    ierr = VecGetOwnershipRange(tauFault,&Istart,&Iend); CHKERRQ(ierr);
+
+    Mat R;
+    ierr = MatCreate(PETSC_COMM_WORLD,&R); CHKERRQ(ierr);
+    ierr = MatSetSizes(R,nFault,nBody,NFault,NBody); CHKERRQ(ierr);
+    ierr = MatSetFromOptions(R); CHKERRQ(ierr);
+    ierr = MatMPIAIJSetPreallocation(R,1,NULL,1,NULL); CHKERRQ(ierr);
+    ierr = MatSeqAIJSetPreallocation(R,1,NULL); CHKERRQ(ierr);
+    ierr = MatSetUp(R); CHKERRQ(ierr);
+    for (PetscInt Ii = Istart; Ii < Iend; Ii++) {
+      ierr = MatSetValue(R,Ii,Ii,1.0,INSERT_VALUES); CHKERRQ(ierr);
+    }
+    ierr = MatAssemblyBegin(R,MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+    ierr = MatAssemblyEnd(R,MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+
+    Mat mu,muqy,murz,Dy,Dz,Rmu;
+    ierr = _sbp->getMus(mu,muqy,murz); CHKERRQ(ierr);
+    ierr = _sbp->getDs(Dy,Dz); CHKERRQ(ierr);
+    ierr = MatMatMult(R,mu,MAT_INITIAL_MATRIX,PETSC_DEFAULT,&Rmu); CHKERRQ(ierr);
+    ierr = MatMatMult(Rmu,Dy,MAT_INITIAL_MATRIX,PETSC_DEFAULT,&_muDyFault); CHKERRQ(ierr);
+    MatDestroy(&Rmu);
+    MatDestroy(&R);
+    _matrixTime += MPI_Wtime() - startMatrix;
+  }
+
+  ierr = MatMult(_muDyFault,_u,tauFault); CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+
 // computes sigmadev = sqrt(sigmaxy^2 + sigmaxz^2)
 PetscErrorCode LinearElastic::computeSDev()
 {
@@ -13,6 +13,7 @@
 #include "sbpOps.hpp"
 #include "sbpOps_m_constGrid.hpp"
 #include "sbpOps_m_varGrid.hpp"
+#include "sbpOps_mf_constGrid.hpp"
 
 using namespace std;
 
@@ -24,6 +25,9 @@ private:
   LinearElastic(const LinearElastic &that);
   LinearElastic& operator=(const LinearElastic &rhs);
 
+  // shared by the Green's functions: response of out to unit bcL at each point
+  PetscErrorCode computeBcLResponse(Mat& G, const PetscInt blockSize, Vec& out, VecScatter* body2fault);
+
 public:
   // domain properties
   Domain         *_D; // shallow copy of domain
@@ -49,6 +53,13 @@ public:
   PetscScalar     _kspTol;
   SbpOps         *_sbp;
   string          _sbpType;
+  Mat             _muDyFault; // rows of mu*Dy at the fault, built on first use
+
+  // SBP operators and KSP context set up for each set of boundary condition
+  // types used so far, so that changeBCTypes only switches the _sbp and _ksp
+  // handles, without rebuilding A or re-factoring it (key: bcR_bcT_bcL_bcB types)
+  map<string,pair<SbpOps*,KSP> >  _bcContexts;
+  string          _bcKey; // key of the boundary condition types _sbp and _ksp are set up for
 
   // viewers for 1D and 2D fields
   // 1st string = key naming relevant field, e.g. "slip"
@@ -76,15 +87,20 @@ public:
   PetscErrorCode setMaterialParameters();
   PetscErrorCode loadICsFromFiles();
   PetscErrorCode setUpSBPContext();
+  PetscErrorCode createSbpOps(SbpOps*& sbp,const string& bcR,const string& bcT,const string& bcL,const string& bcB);
   PetscErrorCode setupKSP(KSP& ksp,PC& pc,Mat& A);
 
   // time stepping function
   PetscErrorCode getStresses(Vec& sxy, Vec& sxz, Vec& sdev);
   PetscErrorCode computeStresses();
   PetscErrorCode computeSDev();
+  PetscErrorCode computeFaultShearStress(Vec& tauFault, VecScatter& body2fault);
   PetscErrorCode setSurfDisp();
   PetscErrorCode setRHS();
   PetscErrorCode computeU();
+  PetscErrorCode computeUBlock(Mat& B, Mat& X, const PetscInt nCols); // block of right-hand sides
+  PetscErrorCode computeGreensFunction(Mat& G, const PetscInt blockSize); // to surface displacement
+  PetscErrorCode computeFaultGreensFunction(Mat& G, const PetscInt blockSize, Vec& tauFault, VecScatter& body2fault); // to shear stress on the fault
   PetscErrorCode changeBCTypes(string bcRTtype,string bcTTtype,string bcLTtype,string bcBTtype);
 
   // IO functions
@@ -120,99 +120,68 @@ for (PetscInt Ny = 11; Ny < 82; Ny = (Ny - 1) * 2 + 1)
 }
 
 
-// calculate Green's functions and write to file "G"
-// also write bcL and surfDisp into file
-int computeGreensFunction(const char * inputFile)
+// calculate the Green's function mapping displacement on the left boundary
+// (the fault) to surface displacement, and write it to file "G"
+int computeGreensFunction(Domain& d)
 {
   PetscErrorCode ierr = 0;
 
-  // create domain object and write scalar fields into file
-  Domain d(inputFile);
-  d.write();
+  double startTime = MPI_Wtime();
+  ierr = d.write(); CHKERRQ(ierr);
 
   // create linear elastic object using domain (includes material properties) specifications
   LinearElastic le(d,"Dirichlet","Neumann","Dirichlet","Neumann");
 
-  // set up boundaries
-  VecSet(le._bcT,0.0);
-  VecSet(le._bcB,0.0);
-  VecSet(le._bcR,0.0);
+  // factor the matrix once, all columns are solved against it
+  Mat A;
+  ierr = le._sbp->getA(A); CHKERRQ(ierr);
+  ierr = le.setupKSP(le._ksp,le._pc,A); CHKERRQ(ierr);
 
-  // prepare matrix to hold greens function
   Mat G;
-  MatCreateDense(PETSC_COMM_WORLD,PETSC_DECIDE,PETSC_DECIDE,d._Ny,d._Nz,NULL,&G);
-  MatSetUp(G);
-
-  PetscInt *rows,*cols;
-  PetscMalloc1(d._Ny,&rows);
-  PetscMalloc1(d._Ny,&cols);
-  PetscScalar *si;
-
-  // loop over elements of bcL and compute corresponding entry of G
-  PetscScalar v = 1.0;
-  PetscInt Istart,Iend;
-  VecGetOwnershipRange(le._bcL,&Istart,&Iend);
-
-  for(PetscInt Ii = Istart;Ii < Iend;Ii++) {
-    PetscPrintf(PETSC_COMM_WORLD,"Ii = %i\n",Ii);
-    VecSet(le._bcL,0.0);
-    VecSetValue(le._bcL,Ii,v,INSERT_VALUES);
-
-    // solve for displacement
-    ierr = le._sbp->setRhs(le._rhs,le._bcL,le._bcR,le._bcT,le._bcB); CHKERRQ(ierr);
-    ierr = KSPSolve(le._ksp,le._rhs,le._u); CHKERRQ(ierr);
-    ierr = le.setSurfDisp();
-
-    // assign values to G
-    VecGetArray(le._surfDisp,&si);
-    for(PetscInt ind = 0; ind < d._Ny; ind++) {
-      rows[ind]=ind;
-    }
-    for(PetscInt ind = 0; ind < d._Ny; ind++) {
-      cols[ind]=Ii;
-    }
-    MatSetValues(G,d._Ny,rows,1,&Ii,si,INSERT_VALUES);
-    MatAssemblyBegin(G,MAT_FINAL_ASSEMBLY);
-    MatAssemblyEnd(G,MAT_FINAL_ASSEMBLY);
-    VecRestoreArray(le._bcL,&si);
-  }
+  ierr = le.computeGreensFunction(G,d._greensFunctionBlockSize); CHKERRQ(ierr);
 
-  // output greens function
-  string filename;
-  filename =  d._outputDir + "G";
-  writeMat(G, filename);
-
-/*
-  // output testing stuff
+  // surface displacement for unit displacement at the last boundary point
+  // (the last column of G), written out below with bcL as a check
+  PetscInt N,Istart,Iend;
+  ierr = VecGetSize(le._bcL,&N); CHKERRQ(ierr);
+  ierr = VecGetOwnershipRange(le._bcL,&Istart,&Iend); CHKERRQ(ierr);
   VecSet(le._bcL,0.0);
-  VecSet(le._bcR,5.0);
-  for(PetscInt Ii = Istart; Ii < Iend; Ii++) {
-    v = ((PetscScalar) Ii+1)/((PetscScalar) d._Nz);
-    VecSetValue(le._bcL,Ii,v,INSERT_VALUES);
-  }
-
-  // solve for displacement
-  ierr = le._sbp->setRhs(le._rhs,le._bcL,le._bcR,le._bcT,le._bcB);CHKERRQ(ierr);
-  ierr = KSPSolve(le._ksp,le._rhs,le._u);CHKERRQ(ierr);
-  ierr = le.setSurfDisp();
-
-  str =  d._outputDir + "bcL";
-  writeVec(le._bcL,str.c_str());
+  VecSet(le._bcR,0.0);
+  VecSet(le._bcT,0.0);
+  VecSet(le._bcB,0.0);
+  if (N-1 >= Istart && N-1 < Iend) { VecSetValue(le._bcL,N-1,1.0,INSERT_VALUES); }
+  VecAssemblyBegin(le._bcL);
+  VecAssemblyEnd(le._bcL);
+  ierr = le.setRHS(); CHKERRQ(ierr);
+  ierr = le.computeU(); CHKERRQ(ierr);
 
-  str =  d._outputDir + "surfDisp";
-  writeVec(le._surfDisp,str.c_str());
-  */
+  // output greens function
+  double startWrite = MPI_Wtime();
+  if (d._outputFormat.compare("hdf5") == 0) {
+    #if defined(PETSC_HAVE_HDF5)
+      PetscViewer viewer;
+      string filename = d._outputDir + "G.h5";
+      ierr = PetscViewerHDF5Open(PETSC_COMM_WORLD,filename.c_str(),FILE_MODE_WRITE,&viewer); CHKERRQ(ierr);
+      ierr = MatView(G,viewer); CHKERRQ(ierr);
+      ierr = PetscViewerDestroy(&viewer); CHKERRQ(ierr);
+    #else
+      ierr = PetscPrintf(PETSC_COMM_WORLD,"ERROR: HDF5 output requires PETSc to be configured with HDF5.\n");CHKERRQ(ierr);
+      assert(0);
+    #endif
+  }
+  else {
+    ierr = writeMat(G, d._outputDir + "G"); CHKERRQ(ierr);
+  }
 
   // write left boundary condition and surface displacement into file
-  filename =  d._outputDir + "bcL";
-  writeVec(le._bcL, filename);
-  filename =  d._outputDir + "surfDisp";
-  writeVec(le._surfDisp, filename);
+  ierr = writeVec(le._bcL, d._outputDir + "bcL"); CHKERRQ(ierr);
+  ierr = writeVec(le._surfDisp, d._outputDir + "surfDisp"); CHKERRQ(ierr);
+  le._writeTime += MPI_Wtime() - startWrite;
+
+  ierr = le.view(MPI_Wtime() - startTime); CHKERRQ(ierr);
 
   // free memory
   MatDestroy(&G);
-  PetscFree(rows);
-  PetscFree(cols);
   return ierr;
 }
 
@@ -224,7 +193,12 @@ int runEqCycle(Domain& d)
 
   // quasi-dynamic earthquake cycle simulation
   // with a vertical strike-slip fault, and linear elastic off-fault material
-  if (d._bulkDeformationType.compare("linearElastic") == 0 && d._momentumBalanceType.compare("quasidynamic") == 0) {
+  // (quasidynamic_greensFunction, quasidynamic_hmatrix: shear stress on the
+  // fault from a dense or compressed Green's function)
+  if (d._bulkDeformationType.compare("linearElastic") == 0 &&
+    (d._momentumBalanceType.compare("quasidynamic") == 0 ||
+    d._momentumBalanceType.compare("quasidynamic_greensFunction") == 0 ||
+    d._momentumBalanceType.compare("quasidynamic_hmatrix") == 0)) {
     StrikeSlip_LinearElastic_qd m(d);
     if (d._ckptNumber < 1) { ierr = m.writeContext(); CHKERRQ(ierr); }
     PetscPrintf(PETSC_COMM_WORLD,"\n\n\n");
@@ -302,8 +276,8 @@ int main(int argc,char **args)
   {
     Domain d(inputFile);
     if (d._isMMS) { runMMSTests(inputFile); }
+    else if (d._computeGreensFunction) { computeGreensFunction(d); }
     else { runEqCycle(d); }
-    //computeGreensFunction(inputFile);
     //runTests(inputFile);
   }
 
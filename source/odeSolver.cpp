@@ -91,6 +91,92 @@ PetscErrorCode OdeSolver::setToleranceType(const string normType)
   return 0;
 }
 
+// build default _errInds and _scale if they haven't been defined already,
+// check that _errInds is valid, and find the position of each entry in _y
+PetscErrorCode OdeSolver::setUpErrFields(const string& name)
+{
+  // build default errInds if it hasn't been defined already
+  if (_errInds.size()==0) {
+    for (map<string,Vec>::iterator it = _var.begin(); it!=_var.end(); it++ ) {
+      _errInds.push_back(it->first);
+    }
+  }
+
+  // check that errInds is valid
+  _errFields.clear();
+  for(vector<int>::size_type i = 0; i != _errInds.size(); i++) {
+    PetscInt ind = _y.fieldIndex(_errInds[i]);
+    if (ind < 0) {
+      PetscPrintf(PETSC_COMM_WORLD,"%s ERROR: %s is not an element of explicitly integrated variable!\n",name.c_str(),_errInds[i].c_str());
+    }
+    assert(ind >= 0);
+    _errFields.push_back(ind);
+  }
+
+  // set up scaling for elements in errInds
+  if (_scale.size() == 0) { // if 0 entries, set all to 1
+    for(vector<int>::size_type i = 0; i != _errInds.size(); i++) {
+      _scale.push_back(1.0);
+    }
+  }
+  assert(_scale.size() == _errInds.size());
+
+  return 0;
+}
+
+
+// add the state after the latest accepted time step to ckpt
+PetscErrorCode OdeSolver::writeCheckpoint(Checkpoint& ckpt)
+{
+  PetscErrorCode ierr = 0;
+  ierr = ckpt.setScalar("ode_stepCount",_stepCount);CHKERRQ(ierr);
+  ierr = ckpt.setScalar("ode_deltaT",_newDeltaT);CHKERRQ(ierr);
+  for (size_t i = 0; i < _errA.size(); i++) {
+    ierr = ckpt.setScalar("ode_errA" + to_string(i),_errA[i]);CHKERRQ(ierr);
+  }
+  return ierr;
+}
+
+
+// continue from the state saved by writeCheckpoint
+PetscErrorCode OdeSolver::loadCheckpoint(const Checkpoint& ckpt)
+{
+  PetscErrorCode ierr = 0;
+  ierr = ckpt.getScalar("ode_stepCount",_stepCount);CHKERRQ(ierr);
+  ierr = ckpt.getScalar("ode_deltaT",_deltaT);CHKERRQ(ierr);
+  _newDeltaT = _deltaT;
+  for (size_t i = 0; i < _errA.size(); i++) {
+    ierr = ckpt.getScalar("ode_errA" + to_string(i),_errA[i]);CHKERRQ(ierr);
+  }
+  return ierr;
+}
+
+
+// take one time step of size deltaT from time, continuing from step count
+// stepCount. setInitialConds must be called first, and the solver can be kept
+// for later calls, which reuse its stage Vecs.
+PetscErrorCode OdeSolver::step(IntegratorContextEx *obj, const PetscReal time, const PetscInt stepCount, const PetscReal deltaT)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Starting OdeSolver::step in odeSolver.cpp.\n");
+  #endif
+
+  ierr = setTimeRange(time,time + deltaT);CHKERRQ(ierr);
+  ierr = setTimeStepBounds(deltaT,deltaT);CHKERRQ(ierr);
+  ierr = setStepSize(deltaT);CHKERRQ(ierr);
+  _newDeltaT = deltaT;
+  _stepCount = stepCount;
+  _maxNumSteps = stepCount + 1;
+
+  ierr = integrate(obj);CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending OdeSolver::step in odeSolver.cpp.\n");
+  #endif
+  return ierr;
+}
+
 
 
 //================= FEuler child class functions =======================
@@ -107,8 +193,7 @@ FEuler::~FEuler() {
     PetscPrintf(PETSC_COMM_WORLD,"Starting FEuler::destructor in odeSolver.cpp.\n");
   #endif
 
-  // destruct temporary container
-  destroyVector(_dvar);
+  // packed containers are freed by their own destructors
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending FEuler::destructor in odeSolver.cpp.\n");
@@ -154,13 +239,17 @@ PetscErrorCode FEuler::setInitialConds(map<string,Vec>& var)
   PetscErrorCode ierr = 0;
   _var = var; // shallow copy
 
-  for (map<string,Vec>::iterator it = _var.begin(); it!=_var.end(); it++) {
-    Vec dvar;
-    ierr = VecDuplicate(_var[it->first],&dvar); CHKERRQ(ierr);
-    ierr = VecSet(dvar,0.0); CHKERRQ(ierr);
-    // initialize _dvar to be a zero vector
-    _dvar[it->first] = dvar;
+  // packed copy of var, and rate initialized to zero
+  // (the Vecs from an earlier call are reused if the fields are the same)
+  if (_y.hasLayout(_var)) {
+    ierr = VecSet(_dy._vec,0.0); CHKERRQ(ierr);
+    ierr = _dy.packedChanged(); CHKERRQ(ierr);
+  }
+  else {
+    ierr = _y.create(_var); CHKERRQ(ierr);
+    ierr = _dy.duplicate(_y); CHKERRQ(ierr);
   }
+  ierr = _y.copyFrom(_var); CHKERRQ(ierr);
 
   _runTime += MPI_Wtime() - startTime;
 
@@ -186,15 +275,20 @@ PetscErrorCode FEuler::integrate(IntegratorContextEx *obj)
   else if (_deltaT==0) { _deltaT = (_finalT-_initT)/_maxNumSteps; }
 
   // set initial condition
-  ierr = obj->d_dt(_currT,_var,_dvar);CHKERRQ(ierr);
+  ierr = _y.copyFrom(_var);CHKERRQ(ierr);
+  ierr = obj->setStage(0);CHKERRQ(ierr);
+  ierr = obj->d_dt(_currT,_var,_dy._views);CHKERRQ(ierr);
+  ierr = _dy.fieldsChanged();CHKERRQ(ierr);
   ierr = obj->timeMonitor(_currT,_deltaT,_stepCount,stopIntegration); CHKERRQ(ierr); // write first step
 
   while (_stepCount<_maxNumSteps && _currT<_finalT) {
 
-    ierr = obj->d_dt(_currT,_var,_dvar);CHKERRQ(ierr);
-    for (map<string,Vec>::iterator it = _var.begin(); it!=_var.end(); it++ ) {
-      ierr = VecAXPY(_var[it->first],_deltaT,_dvar[it->first]);CHKERRQ(ierr); // var = var + deltaT*dvar
-    }
+    ierr = obj->setStage(0);CHKERRQ(ierr);
+    ierr = obj->d_dt(_currT,_var,_dy._views);CHKERRQ(ierr);
+    ierr = _dy.fieldsChanged();CHKERRQ(ierr);
+    ierr = VecAXPY(_y._vec,_deltaT,_dy._vec);CHKERRQ(ierr); // var = var + deltaT*dvar
+    ierr = _y.packedChanged();CHKERRQ(ierr);
+    ierr = _y.copyTo(_var);CHKERRQ(ierr);
 
     _currT = _currT + _deltaT;
     if (_currT>_finalT) { _currT = _finalT; }
@@ -248,14 +342,7 @@ RK32::~RK32()
     PetscPrintf(PETSC_COMM_WORLD,"Starting RK32::destructor in odeSolver.cpp.\n");
   #endif
 
-  // destruct temporary containers
-  destroyVector(_dvar);
-  destroyVector(_k1);
-  destroyVector(_f1);
-  destroyVector(_k2);
-  destroyVector(_f2);
-  destroyVector(_y2);
-  destroyVector(_y3);
+  // packed containers are freed by their own destructors
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending RK32::destructor in odeSolver.cpp.\n");
@@ -307,43 +394,24 @@ PetscErrorCode RK32::setInitialConds(map<string,Vec>& var)
   PetscErrorCode ierr = 0;
   _var = var; // shallow copy
 
-  // initialize RK vectors to zero
-  for (map<string,Vec>::iterator it=var.begin(); it!=var.end(); it++ ) {
-    Vec dvar;
-    ierr = VecDuplicate(_var[it->first],&dvar); CHKERRQ(ierr);
-    ierr = VecSet(dvar,0.0); CHKERRQ(ierr);
-    _dvar[it->first] = dvar;
-
-    Vec varHalfdT;
-    ierr = VecDuplicate(_var[it->first],&varHalfdT); CHKERRQ(ierr);
-    ierr = VecSet(varHalfdT,0.0); CHKERRQ(ierr);
-    _k1[it->first] = varHalfdT;
-
-    Vec dvarHalfdT;
-    ierr = VecDuplicate(_var[it->first],&dvarHalfdT); CHKERRQ(ierr);
-    ierr = VecSet(dvarHalfdT,0.0); CHKERRQ(ierr);
-    _f1[it->first] = dvarHalfdT;
-
-    Vec vardT;
-    ierr = VecDuplicate(_var[it->first],&vardT); CHKERRQ(ierr);
-    ierr = VecSet(vardT,0.0); CHKERRQ(ierr);
-    _k2[it->first] = vardT;
-
-    Vec dvardT;
-    ierr = VecDuplicate(_var[it->first],&dvardT); CHKERRQ(ierr);
-    ierr = VecSet(dvardT,0.0); CHKERRQ(ierr);
-    _f2[it->first] = dvardT;
-
-    Vec y2;
-    ierr = VecDuplicate(_var[it->first],&y2); CHKERRQ(ierr);
-    ierr = VecSet(y2,0.0); CHKERRQ(ierr);
-    _y2[it->first] = y2;
-
-    Vec y3;
-    ierr = VecDuplicate(_var[it->first],&y3); CHKERRQ(ierr);
-    ierr = VecSet(y3,0.0); CHKERRQ(ierr);
-    _y3[it->first] = y3;
+  // packed copy of var, and RK vectors initialized to zero
+  // (the Vecs from an earlier call are reused if the fields are the same,
+  // and only the rate needs to be reset, since the stages are overwritten)
+  if (_y.hasLayout(_var)) {
+    ierr = VecSet(_dy._vec,0.0); CHKERRQ(ierr);
+    ierr = _dy.packedChanged(); CHKERRQ(ierr);
+  }
+  else {
+    ierr = _y.create(_var); CHKERRQ(ierr);
+    ierr = _dy.duplicate(_y); CHKERRQ(ierr);
+    ierr = _k1.duplicate(_y); CHKERRQ(ierr);
+    ierr = _f1.duplicate(_y); CHKERRQ(ierr);
+    ierr = _k2.duplicate(_y); CHKERRQ(ierr);
+    ierr = _f2.duplicate(_y); CHKERRQ(ierr);
+    ierr = _y2.duplicate(_y); CHKERRQ(ierr);
+    ierr = _y3.duplicate(_y); CHKERRQ(ierr);
   }
+  ierr = _y.copyFrom(_var); CHKERRQ(ierr);
 
   _runTime += MPI_Wtime() - startTime;
 
@@ -451,46 +519,22 @@ PetscReal RK32::computeError()
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Starting RK32::computeError in odeSolver.cpp.\n");
   #endif
-
   PetscErrorCode ierr = 0;
-  PetscScalar err = 0, _totErr = 0;
+  PetscReal _totErr = 0;
 
+  // error: the difference between the 2nd and 3rd order solutions in the fields
+  // _errInds, computed together in one pass and one reduction
   // if using absolute error for control
-  // error: the absolute L2 error, weighted by N and a user-inputted scale factor
-  // tolerance: the absolute tolerance
+  //   the L2 error of each field, weighted by N and a user-inputted scale factor
+  //   tolerance: the absolute tolerance
+  // if using relative error for control
+  //   the L2 error of each field, scaled by the L2 norm of the solution and a user-inputted scale factor
+  //   tolerance: the relative tolerance
   if (_normType.compare("L2_absolute")==0) {
-    for(vector<int>::size_type i = 0; i != _errInds.size(); i++) {
-      string key = _errInds[i];
-      Vec errVec;
-      VecDuplicate(_y3[key],&errVec);
-      VecSet(errVec,0.0);
-      ierr = VecWAXPY(errVec,-1.0,_y3[key],_y2[key]); CHKERRQ(ierr);
-      VecNorm(errVec,NORM_2,&err);
-      VecDestroy(&errVec);
-
-      PetscInt N = 0;
-      VecGetSize(_y3[key],&N);
-      _totErr += err / (sqrt(N) * _scale[i]);
-    }
+    ierr = PackedVec::errorNorm(_y2,_y3,_errFields,_scale,"L2_absolute",_totErr); CHKERRQ(ierr);
   }
-
-  // if using relative error for control
-  // error: the absolute L2 error, scaled by the L2 norm of the solution and a user-inputted scale factor
-  // tolerance: the relative tolerance
   if (_normType.compare("L2_relative")==0) {
-    for(vector<int>::size_type i = 0; i != _errInds.size(); i++) {
-      string key = _errInds[i];
-      Vec errVec;
-      VecDuplicate(_y3[key],&errVec);
-      VecSet(errVec,0.0);
-      ierr = VecWAXPY(errVec,-1.0,_y3[key],_y2[key]); CHKERRQ(ierr);
-      VecNorm(errVec,NORM_2,&err);
-      VecDestroy(&errVec);
-
-      PetscReal s = 0;
-      VecNorm(_y3[key],NORM_2,&s);
-      _totErr += err / (s * _scale[i]);
-    }
+    ierr = PackedVec::errorNorm(_y2,_y3,_errFields,_scale,"L2_relative",_totErr); CHKERRQ(ierr);
   }
 
   #if VERBOSE > 1
@@ -513,37 +557,21 @@ PetscErrorCode RK32::integrate(IntegratorContextEx *obj)
   PetscScalar    _totErr = 0;
   PetscInt       attemptCount = 0;
   int            stopIntegration = 0;
+  PetscScalar    alpha[2];
+  Vec            x[2];
 
-  // build default errInds if it hasn't been defined already
-  if (_errInds.size()==0) {
-    for (map<string,Vec>::iterator it = _var.begin(); it!=_var.end(); it++ ) {
-      _errInds.push_back(it->first);
-    }
-  }
-
-  // check that errInds is valid
-  for(vector<int>::size_type i = 0; i != _errInds.size(); i++) {
-    string key = _errInds[i];
-    if (_var.find(key) == _var.end()) {
-      PetscPrintf(PETSC_COMM_WORLD,"RK32 ERROR: %s is not an element of explicitly integrated variable!\n",key.c_str());
-    }
-    assert(_var.find(key) != _var.end());
-  }
-
-  // set up scaling for elements in errInds
-  if (_scale.size() == 0) { // if 0 entries, set all to 1
-    for(vector<int>::size_type i = 0; i != _errInds.size(); i++) {
-      _scale.push_back(1.0);
-    }
-  }
-  assert(_scale.size() == _errInds.size());
+  // build default errInds and scale if they haven't been defined already
+  ierr = setUpErrFields("RK32");CHKERRQ(ierr);
 
   if (_finalT==_initT) { return ierr; }
   else if (_deltaT==0) { _deltaT = (_finalT-_initT)/_maxNumSteps; }
   if (_maxNumSteps == 0) { return ierr; }
 
   // set initial condition
-  ierr = obj->d_dt(_currT,_var,_dvar);CHKERRQ(ierr);
+  ierr = _y.copyFrom(_var);CHKERRQ(ierr);
+  ierr = obj->setStage(0);CHKERRQ(ierr);
+  ierr = obj->d_dt(_currT,_var,_dy._views);CHKERRQ(ierr);
+  ierr = _dy.fieldsChanged();CHKERRQ(ierr);
   //~ ierr = obj->timeMonitor(_currT,_deltaT,_stepCount,stopIntegration); CHKERRQ(ierr);
 
   // perform time stepping routine and calling d_dt
@@ -557,35 +585,33 @@ PetscErrorCode RK32::integrate(IntegratorContextEx *obj)
       //~ierr = PetscPrintf(PETSC_COMM_WORLD,"   attemptCount=%i\n",attemptCount);CHKERRQ(ierr);
       if (_currT+_deltaT>_finalT) { _deltaT=_finalT-_currT; }
 
-      for (map<string,Vec>::iterator it = _var.begin(); it!=_var.end(); it++ ) {
-        VecSet(_k1[it->first],0.0); VecSet(_f1[it->first],0.0);
-        VecSet(_k2[it->first],0.0);     VecSet(_f2[it->first],0.0);
-        VecSet(_y2[it->first],0.0);
-        VecSet(_y3[it->first],0.0);
-      }
-
       // stage 1: integrate fields to _currT + 0.5*deltaT
-      for (map<string,Vec>::iterator it = _var.begin(); it!=_var.end(); it++ ) {
-        ierr = VecWAXPY(_k1[it->first],0.5*_deltaT,_dvar[it->first],_var[it->first]);CHKERRQ(ierr);
-      }
-      ierr = obj->d_dt(_currT+0.5*_deltaT,_k1,_f1);CHKERRQ(ierr);
+      ierr = VecWAXPY(_k1._vec,0.5*_deltaT,_dy._vec,_y._vec);CHKERRQ(ierr);
+      ierr = _k1.packedChanged();CHKERRQ(ierr);
+      ierr = VecSet(_f1._vec,0.0);CHKERRQ(ierr);
+      ierr = _f1.packedChanged();CHKERRQ(ierr);
+      ierr = obj->setStage(1);CHKERRQ(ierr);
+      ierr = obj->d_dt(_currT+0.5*_deltaT,_k1._views,_f1._views);CHKERRQ(ierr);
+      ierr = _f1.fieldsChanged();CHKERRQ(ierr);
 
       // stage 2: integrate fields to _currT + _deltaT
-      for (map<string,Vec>::iterator it = _var.begin(); it!=_var.end(); it++ ) {
-        ierr = VecWAXPY(_k2[it->first],-_deltaT,_dvar[it->first],_var[it->first]);CHKERRQ(ierr);
-        ierr = VecAXPY(_k2[it->first],2*_deltaT,_f1[it->first]);CHKERRQ(ierr);
-      }
-      ierr = obj->d_dt(_currT+_deltaT,_k2,_f2);CHKERRQ(ierr);
+      ierr = VecWAXPY(_k2._vec,-_deltaT,_dy._vec,_y._vec);CHKERRQ(ierr);
+      ierr = VecAXPY(_k2._vec,2*_deltaT,_f1._vec);CHKERRQ(ierr);
+      ierr = _k2.packedChanged();CHKERRQ(ierr);
+      ierr = VecSet(_f2._vec,0.0);CHKERRQ(ierr);
+      ierr = _f2.packedChanged();CHKERRQ(ierr);
+      ierr = obj->setStage(2);CHKERRQ(ierr);
+      ierr = obj->d_dt(_currT+_deltaT,_k2._views,_f2._views);CHKERRQ(ierr);
+      ierr = _f2.fieldsChanged();CHKERRQ(ierr);
 
       // 2nd and 3rd order update
-      for (map<string,Vec>::iterator it = _var.begin(); it!=_var.end(); it++ ) {
-        ierr = VecWAXPY(_y2[it->first],0.5*_deltaT,_dvar[it->first],_var[it->first]);CHKERRQ(ierr);
-        ierr = VecAXPY(_y2[it->first],0.5*_deltaT,_f2[it->first]);CHKERRQ(ierr);
+      ierr = VecWAXPY(_y2._vec,0.5*_deltaT,_dy._vec,_y._vec);CHKERRQ(ierr);
+      ierr = VecAXPY(_y2._vec,0.5*_deltaT,_f2._vec);CHKERRQ(ierr);
 
-        ierr = VecWAXPY(_y3[it->first],_deltaT/6.0,_dvar[it->first],_var[it->first]);CHKERRQ(ierr);
-        ierr = VecAXPY(_y3[it->first],2*_deltaT/3.0,_f1[it->first]);CHKERRQ(ierr);
-        ierr = VecAXPY(_y3[it->first],_deltaT/6.0,_f2[it->first]);CHKERRQ(ierr);
-      }
+      ierr = VecWAXPY(_y3._vec,_deltaT/6.0,_dy._vec,_y._vec);CHKERRQ(ierr);
+      alpha[0] = 2*_deltaT/3.0; x[0] = _f1._vec;
+      alpha[1] = _deltaT/6.0;   x[1] = _f2._vec;
+      ierr = VecMAXPY(_y3._vec,2,alpha,x);CHKERRQ(ierr);
 
       // calculate error
       _totErr = computeError();
@@ -598,11 +624,14 @@ PetscErrorCode RK32::integrate(IntegratorContextEx *obj)
 
     // accept 3rd order solution as update
     _currT = _currT+_deltaT;
-    for (map<string,Vec>::iterator it = _var.begin(); it!=_var.end(); it++ ) {
-      ierr = VecCopy(_y3[it->first],_var[it->first]);CHKERRQ(ierr);
-      VecSet(_dvar[it->first],0.0);
-    }
-    ierr = obj->d_dt(_currT,_var,_dvar);CHKERRQ(ierr);
+    ierr = VecCopy(_y3._vec,_y._vec);CHKERRQ(ierr);
+    ierr = _y.packedChanged();CHKERRQ(ierr);
+    ierr = _y.copyTo(_var);CHKERRQ(ierr);
+    ierr = VecSet(_dy._vec,0.0);CHKERRQ(ierr);
+    ierr = _dy.packedChanged();CHKERRQ(ierr);
+    ierr = obj->setStage(0);CHKERRQ(ierr);
+    ierr = obj->d_dt(_currT,_var,_dy._views);CHKERRQ(ierr);
+    ierr = _dy.fieldsChanged();CHKERRQ(ierr);
 
     // compute new deltaT for next time step
     // but timeMonitor before updating to newDeltaT, to keep output consistent while allowing for checkpointing
@@ -663,20 +692,7 @@ RK43::~RK43()
   PetscPrintf(PETSC_COMM_WORLD,"Starting RK43::destructor in odeSolver.cpp.\n");
 #endif
 
-  // destruct temporary containers
-  destroyVector(_f1);
-  destroyVector(_f2);
-  destroyVector(_f3);
-  destroyVector(_f4);
-  destroyVector(_f5);
-  destroyVector(_f6);
-  destroyVector(_k2);
-  destroyVector(_k3);
-  destroyVector(_k4);
-  destroyVector(_k5);
-  destroyVector(_k6);
-  destroyVector(_y4);
-  destroyVector(_y3);
+  // packed containers are freed by their own destructors
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending RK43::destructor in odeSolver.cpp.\n");
@@ -727,74 +743,30 @@ PetscErrorCode RK43::setInitialConds(map<string,Vec>& var)
   PetscErrorCode ierr = 0;
   _var = var;
 
-  // initialize _dvar and various RK43 intermediate vectors to zero
-  // only doing shallow copies
-  for (map<string,Vec>::iterator it=var.begin(); it!=var.end(); it++ ) {
-    Vec dvar;
-    ierr = VecDuplicate(_var[it->first],&dvar); CHKERRQ(ierr);
-    ierr = VecSet(dvar,0.0); CHKERRQ(ierr);
-    _dvar[it->first] = dvar;
-
-    Vec f2;
-    ierr = VecDuplicate(_var[it->first],&f2); CHKERRQ(ierr);
-    ierr = VecSet(f2,0.0); CHKERRQ(ierr);
-    _f2[it->first] = f2;
-
-    Vec f3;
-    ierr = VecDuplicate(_var[it->first],&f3); CHKERRQ(ierr);
-    ierr = VecSet(f3,0.0); CHKERRQ(ierr);
-    _f3[it->first] = f3;
-
-    Vec f4;
-    ierr = VecDuplicate(_var[it->first],&f4); CHKERRQ(ierr);
-    ierr = VecSet(f4,0.0); CHKERRQ(ierr);
-    _f4[it->first] = f4;
-
-    Vec f5;
-    ierr = VecDuplicate(_var[it->first],&f5); CHKERRQ(ierr);
-    ierr = VecSet(f5,0.0); CHKERRQ(ierr);
-    _f5[it->first] = f5;
-
-    Vec f6;
-    ierr = VecDuplicate(_var[it->first],&f6); CHKERRQ(ierr);
-    ierr = VecSet(f6,0.0); CHKERRQ(ierr);
-    _f6[it->first] = f6;
-
-    Vec k2;
-    ierr = VecDuplicate(_var[it->first],&k2); CHKERRQ(ierr);
-    ierr = VecSet(k2,0.0); CHKERRQ(ierr);
-    _k2[it->first] = k2;
-
-    Vec k3;
-    ierr = VecDuplicate(_var[it->first],&k3); CHKERRQ(ierr);
-    ierr = VecSet(k3,0.0); CHKERRQ(ierr);
-    _k3[it->first] = k3;
-
-    Vec k4;
-    ierr = VecDuplicate(_var[it->first],&k4); CHKERRQ(ierr);
-    ierr = VecSet(k4,0.0); CHKERRQ(ierr);
-    _k4[it->first] = k4;
-
-    Vec k5;
-    ierr = VecDuplicate(_var[it->first],&k5); CHKERRQ(ierr);
-    ierr = VecSet(k5,0.0); CHKERRQ(ierr);
-    _k5[it->first] = k5;
-
-    Vec k6;
-    ierr = VecDuplicate(_var[it->first],&k6); CHKERRQ(ierr);
-    ierr = VecSet(k6,0.0); CHKERRQ(ierr);
-    _k6[it->first] = k6;
-
-    Vec y3;
-    ierr = VecDuplicate(_var[it->first],&y3); CHKERRQ(ierr);
-    ierr = VecSet(y3,0.0); CHKERRQ(ierr);
-    _y3[it->first] = y3;
-
-    Vec y4;
-    ierr = VecDuplicate(_var[it->first],&y4); CHKERRQ(ierr);
-    ierr = VecSet(y4,0.0); CHKERRQ(ierr);
-    _y4[it->first] = y4;
+  // packed copy of var, and various RK43 intermediate vectors initialized to zero
+  // (the Vecs from an earlier call are reused if the fields are the same,
+  // and only the rate needs to be reset, since the stages are overwritten)
+  if (_y.hasLayout(_var)) {
+    ierr = VecSet(_dy._vec,0.0); CHKERRQ(ierr);
+    ierr = _dy.packedChanged(); CHKERRQ(ierr);
+  }
+  else {
+    ierr = _y.create(_var); CHKERRQ(ierr);
+    ierr = _dy.duplicate(_y); CHKERRQ(ierr);
+    ierr = _f2.duplicate(_y); CHKERRQ(ierr);
+    ierr = _f3.duplicate(_y); CHKERRQ(ierr);
+    ierr = _f4.duplicate(_y); CHKERRQ(ierr);
+    ierr = _f5.duplicate(_y); CHKERRQ(ierr);
+    ierr = _f6.duplicate(_y); CHKERRQ(ierr);
+    ierr = _k2.duplicate(_y); CHKERRQ(ierr);
+    ierr = _k3.duplicate(_y); CHKERRQ(ierr);
+    ierr = _k4.duplicate(_y); CHKERRQ(ierr);
+    ierr = _k5.duplicate(_y); CHKERRQ(ierr);
+    ierr = _k6.duplicate(_y); CHKERRQ(ierr);
+    ierr = _y3.duplicate(_y); CHKERRQ(ierr);
+    ierr = _y4.duplicate(_y); CHKERRQ(ierr);
   }
+  ierr = _y.copyFrom(_var); CHKERRQ(ierr);
 
   _runTime += MPI_Wtime() - startTime;
 
@@ -904,61 +876,22 @@ PetscReal RK43::computeError()
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Starting RK43::computeError in odeSolver.cpp.\n");
   #endif
-
   PetscErrorCode ierr = 0;
-  PetscScalar err = 0, _totErr = 0;
+  PetscReal _totErr = 0;
 
+  // error: the difference between the 3rd and 4th order solutions in the fields
+  // _errInds, computed together in one pass and one reduction
   // if using absolute error for control
-  // error: the absolute L2 error, weighted by N and a user-inputted scale factor
-  // tolerance: the absolute tolerance
+  //   the L2 error of each field, weighted by N and a user-inputted scale factor
+  //   tolerance: the absolute tolerance
+  // if using relative error for control
+  //   the max pointwise error |y3 - y4| / y4 of each field, scaled by a user-inputted scale factor
+  //   tolerance: the relative tolerance
   if (_normType.compare("L2_absolute")==0) {
-    for(vector<int>::size_type i = 0; i != _errInds.size(); i++) {
-      string key = _errInds[i];
-      Vec errVec;
-      VecDuplicate(_y3[key],&errVec);
-      VecSet(errVec,0.0);
-      ierr = VecWAXPY(errVec,-1.0,_y4[key],_y3[key]); CHKERRQ(ierr);
-      VecNorm(errVec,NORM_2,&err);
-      VecDestroy(&errVec);
-
-      PetscInt N = 0;
-      VecGetSize(_y4[key],&N);
-      _totErr += err / (sqrt(N) * _scale[i]);
-    }
+    ierr = PackedVec::errorNorm(_y3,_y4,_errFields,_scale,"L2_absolute",_totErr); CHKERRQ(ierr);
   }
-
-  // if using relative error for control
-  // error: the absolute L2 error, scaled by the L2 norm of the solution and a user-inputted scale factor
-  // tolerance: the relative tolerance
-  //~ if (_normType.compare("L2_relative")==0) {
-    //~ for(vector<int>::size_type i = 0; i != _errInds.size(); i++) {
-      //~ string key = _errInds[i];
-      //~ Vec errVec;
-      //~ VecDuplicate(_y3[key],&errVec);
-      //~ VecSet(errVec,0.0);
-      //~ ierr = VecWAXPY(errVec,-1.0,_y4[key],_y3[key]); CHKERRQ(ierr);
-      //~ VecNorm(errVec,NORM_2,&err);
-      //~ VecDestroy(&errVec);
-      //~ PetscReal s = 0;
-      //~ VecNorm(_y4[key],NORM_2,&s);
-      //~ _totErr += err / (s * _scale[i]);
-    //~ }
-  //~ }
-
   if (_normType.compare("L2_relative")==0) {
-    for(vector<int>::size_type i = 0; i != _errInds.size(); i++) {
-      string key = _errInds[i];
-      Vec errVec;
-      VecDuplicate(_y3[key],&errVec);
-      VecSet(errVec,0.0);
-      ierr = VecWAXPY(errVec,-1.0,_y4[key],_y3[key]); CHKERRQ(ierr);
-      VecAbs(errVec);
-      VecPointwiseDivide(errVec,errVec,_y4[key]);
-      PetscReal maxV = 0;
-      VecMax(errVec,NULL,&err);
-      assert(!isinf(err));
-      _totErr += err / (_scale[i]);
-    }
+    ierr = PackedVec::errorNorm(_y3,_y4,_errFields,_scale,"max_relative",_totErr); CHKERRQ(ierr);
   }
 
   #if VERBOSE > 1
@@ -1022,38 +955,26 @@ PetscErrorCode RK43::integrate(IntegratorContextEx *obj)
   PetscScalar a64 = 3354512671639./8306763924573.;
   PetscScalar a65 = 4040./17871.;
 
-  // build default errInds
-  if (_errInds.size()==0) {
-    for (map<string,Vec>::iterator it = _var.begin(); it!=_var.end(); it++ ) {
-      _errInds.push_back(it->first);
-    }
-  }
-
-  // check that errInds is valid
-  for(vector<int>::size_type i = 0; i != _errInds.size(); i++) {
-    string key = _errInds[i];
-    if (_var.find(key) == _var.end()) {
-      PetscPrintf(PETSC_COMM_WORLD,"RK43 ERROR: %s is not an element of explicitly integrated variable!\n",key.c_str());
-    }
-    assert(_var.find(key) != _var.end());
-  }
-
-  // set up scaling for elements in errInds
-  if (_scale.size() == 0) { // if 0 entries, set all to 1
-    for(vector<int>::size_type i = 0; i != _errInds.size(); i++) {
-      _scale.push_back(1.0);
-    }
-  }
-  assert(_scale.size() == _errInds.size());
+  // build default errInds and scale if they haven't been defined already
+  ierr = setUpErrFields("RK43");CHKERRQ(ierr);
 
   if (_finalT == _initT) { return ierr; }
   if (_deltaT == 0) { _deltaT = (_finalT - _initT) / _maxNumSteps; }
   if (_maxNumSteps == 0) { return ierr; }
 
   // set initial condition
-  ierr = obj->d_dt(_currT,_var,_dvar);CHKERRQ(ierr);
+  ierr = _y.copyFrom(_var);CHKERRQ(ierr);
+  ierr = obj->setStage(0);CHKERRQ(ierr);
+  ierr = obj->d_dt(_currT,_var,_dy._views);CHKERRQ(ierr);
+  ierr = _dy.fieldsChanged();CHKERRQ(ierr);
   //~ ierr = obj->timeMonitor(_currT,_deltaT,_stepCount,stopIntegration); CHKERRQ(ierr);
 
+  // stage 1: k1 = var, f1 = f(k1) = dvar
+  // each later stage and update is var + deltaT * sum_j a_ij * f_j, computed
+  // on the packed Vecs as one VecWAXPY followed by one VecMAXPY
+  Vec         F[6] = {_dy._vec,_f2._vec,_f3._vec,_f4._vec,_f5._vec,_f6._vec};
+  PetscScalar alpha[5];
+
   // perform time stepping
   while (_stepCount < _maxNumSteps && _currT < _finalT) {
     _stepCount++;
@@ -1064,75 +985,66 @@ PetscErrorCode RK43::integrate(IntegratorContextEx *obj)
 
       if (_currT + _deltaT > _finalT) { _deltaT = _finalT - _currT; }
 
-      for (map<string,Vec>::iterator it = _var.begin(); it!=_var.end(); it++ ) {
-        VecSet(_k2[it->first],0.0);
-        VecSet(_k3[it->first],0.0); VecSet(_k4[it->first],0.0);
-        VecSet(_k5[it->first],0.0); VecSet(_k6[it->first],0.0);
-        VecSet(_f2[it->first],0.0);
-        VecSet(_f3[it->first],0.0); VecSet(_f4[it->first],0.0);
-        VecSet(_f5[it->first],0.0); VecSet(_f6[it->first],0.0);
-      }
-
-      // stage 1: k1 = var, compute f1 = f(k1) = dvar
-      _f1 = _dvar;
-
       // stage 2: compute k2
-      for (map<string,Vec>::iterator it = _var.begin(); it!=_var.end(); it++ ) {
-        ierr = VecWAXPY(_k2[it->first],a21*_deltaT,_f1[it->first],_var[it->first]); CHKERRQ(ierr);
-      }
-      ierr = obj->d_dt(_currT+c2*_deltaT,_k2,_f2);CHKERRQ(ierr);
+      ierr = VecWAXPY(_k2._vec,a21*_deltaT,F[0],_y._vec); CHKERRQ(ierr);
+      ierr = _k2.packedChanged();CHKERRQ(ierr);
+      ierr = VecSet(_f2._vec,0.0);CHKERRQ(ierr);
+      ierr = _f2.packedChanged();CHKERRQ(ierr);
+      ierr = obj->setStage(2);CHKERRQ(ierr);
+      ierr = obj->d_dt(_currT+c2*_deltaT,_k2._views,_f2._views);CHKERRQ(ierr);
+      ierr = _f2.fieldsChanged();CHKERRQ(ierr);
 
       // stage 3: compute k3
-      for (map<string,Vec>::iterator it = _var.begin(); it!=_var.end(); it++ ) {
-        ierr = VecWAXPY(_k3[it->first],a31*_deltaT,_f1[it->first],_var[it->first]); CHKERRQ(ierr);
-        ierr = VecAXPY(_k3[it->first],a32*_deltaT,_f2[it->first]); CHKERRQ(ierr);
-      }
-      ierr = obj->d_dt(_currT+c3*_deltaT,_k3,_f3);CHKERRQ(ierr);
+      ierr = VecWAXPY(_k3._vec,a31*_deltaT,F[0],_y._vec); CHKERRQ(ierr);
+      ierr = VecAXPY(_k3._vec,a32*_deltaT,F[1]); CHKERRQ(ierr);
+      ierr = _k3.packedChanged();CHKERRQ(ierr);
+      ierr = VecSet(_f3._vec,0.0);CHKERRQ(ierr);
+      ierr = _f3.packedChanged();CHKERRQ(ierr);
+      ierr = obj->setStage(3);CHKERRQ(ierr);
+      ierr = obj->d_dt(_currT+c3*_deltaT,_k3._views,_f3._views);CHKERRQ(ierr);
+      ierr = _f3.fieldsChanged();CHKERRQ(ierr);
 
       // stage 4
-      for (map<string,Vec>::iterator it = _var.begin(); it!=_var.end(); it++ ) {
-        ierr = VecWAXPY(_k4[it->first],a41*_deltaT,_f1[it->first],_var[it->first]); CHKERRQ(ierr);
-        ierr =  VecAXPY(_k4[it->first],a42*_deltaT,_f2[it->first]); CHKERRQ(ierr);
-        ierr =  VecAXPY(_k4[it->first],a43*_deltaT,_f3[it->first]); CHKERRQ(ierr);
-      }
-      ierr = obj->d_dt(_currT+c4*_deltaT,_k4,_f4);CHKERRQ(ierr);
+      ierr = VecWAXPY(_k4._vec,a41*_deltaT,F[0],_y._vec); CHKERRQ(ierr);
+      alpha[0] = a42*_deltaT; alpha[1] = a43*_deltaT;
+      ierr = VecMAXPY(_k4._vec,2,alpha,&F[1]); CHKERRQ(ierr);
+      ierr = _k4.packedChanged();CHKERRQ(ierr);
+      ierr = VecSet(_f4._vec,0.0);CHKERRQ(ierr);
+      ierr = _f4.packedChanged();CHKERRQ(ierr);
+      ierr = obj->setStage(4);CHKERRQ(ierr);
+      ierr = obj->d_dt(_currT+c4*_deltaT,_k4._views,_f4._views);CHKERRQ(ierr);
+      ierr = _f4.fieldsChanged();CHKERRQ(ierr);
 
       // stage 5
-      for (map<string,Vec>::iterator it = _var.begin(); it!=_var.end(); it++ ) {
-        ierr = VecWAXPY(_k5[it->first],a51*_deltaT,_f1[it->first],_var[it->first]); CHKERRQ(ierr);
-        ierr =  VecAXPY(_k5[it->first],a52*_deltaT,_f2[it->first]); CHKERRQ(ierr);
-        ierr =  VecAXPY(_k5[it->first],a53*_deltaT,_f3[it->first]); CHKERRQ(ierr);
-        ierr =  VecAXPY(_k5[it->first],a54*_deltaT,_f4[it->first]); CHKERRQ(ierr);
-      }
-      ierr = obj->d_dt(_currT+c5*_deltaT,_k5,_f5);CHKERRQ(ierr);
+      ierr = VecWAXPY(_k5._vec,a51*_deltaT,F[0],_y._vec); CHKERRQ(ierr);
+      alpha[0] = a52*_deltaT; alpha[1] = a53*_deltaT; alpha[2] = a54*_deltaT;
+      ierr = VecMAXPY(_k5._vec,3,alpha,&F[1]); CHKERRQ(ierr);
+      ierr = _k5.packedChanged();CHKERRQ(ierr);
+      ierr = VecSet(_f5._vec,0.0);CHKERRQ(ierr);
+      ierr = _f5.packedChanged();CHKERRQ(ierr);
+      ierr = obj->setStage(5);CHKERRQ(ierr);
+      ierr = obj->d_dt(_currT+c5*_deltaT,_k5._views,_f5._views);CHKERRQ(ierr);
+      ierr = _f5.fieldsChanged();CHKERRQ(ierr);
 
       // stage 6
-      for (map<string,Vec>::iterator it = _var.begin(); it!=_var.end(); it++ ) {
-        ierr = VecWAXPY(_k6[it->first],a61*_deltaT,_f1[it->first],_var[it->first]); CHKERRQ(ierr);
-        ierr =  VecAXPY(_k6[it->first],a62*_deltaT,_f2[it->first]); CHKERRQ(ierr);
-        ierr =  VecAXPY(_k6[it->first],a63*_deltaT,_f3[it->first]); CHKERRQ(ierr);
-        ierr =  VecAXPY(_k6[it->first],a64*_deltaT,_f4[it->first]); CHKERRQ(ierr);
-        ierr =  VecAXPY(_k6[it->first],a65*_deltaT,_f5[it->first]); CHKERRQ(ierr);
-      }
-      ierr = obj->d_dt(_currT+c6*_deltaT,_k6,_f6);CHKERRQ(ierr);
-
-      // 3rd and 4th order updates
-      for (map<string,Vec>::iterator it = _var.begin(); it!=_var.end(); it++ ) {
-        ierr = VecWAXPY(_y3[it->first],hb1*_deltaT,_f1[it->first],_var[it->first]); CHKERRQ(ierr);
-        //~ ierr = VecAXPY(_y3[it->first],hb2*_deltaT,_f2[it->first]); CHKERRQ(ierr); // hb2 = 0
-        ierr = VecAXPY(_y3[it->first],hb3*_deltaT,_f3[it->first]); CHKERRQ(ierr);
-        ierr = VecAXPY(_y3[it->first],hb4*_deltaT,_f4[it->first]); CHKERRQ(ierr);
-        ierr = VecAXPY(_y3[it->first],hb5*_deltaT,_f5[it->first]); CHKERRQ(ierr);
-        ierr = VecAXPY(_y3[it->first],hb6*_deltaT,_f6[it->first]); CHKERRQ(ierr);
-
-
-        ierr = VecWAXPY(_y4[it->first],b1*_deltaT,_f1[it->first],_var[it->first]); CHKERRQ(ierr);
-        //~ ierr = VecAXPY(_y4[it->first],b2*_deltaT,_f2[it->first]); CHKERRQ(ierr); // b2 = 0
-        ierr = VecAXPY(_y4[it->first],b3*_deltaT,_f3[it->first]); CHKERRQ(ierr);
-        ierr = VecAXPY(_y4[it->first],b4*_deltaT,_f4[it->first]); CHKERRQ(ierr);
-        ierr = VecAXPY(_y4[it->first],b5*_deltaT,_f5[it->first]); CHKERRQ(ierr);
-        ierr = VecAXPY(_y4[it->first],b6*_deltaT,_f6[it->first]); CHKERRQ(ierr);
-      }
+      ierr = VecWAXPY(_k6._vec,a61*_deltaT,F[0],_y._vec); CHKERRQ(ierr);
+      alpha[0] = a62*_deltaT; alpha[1] = a63*_deltaT; alpha[2] = a64*_deltaT; alpha[3] = a65*_deltaT;
+      ierr = VecMAXPY(_k6._vec,4,alpha,&F[1]); CHKERRQ(ierr);
+      ierr = _k6.packedChanged();CHKERRQ(ierr);
+      ierr = VecSet(_f6._vec,0.0);CHKERRQ(ierr);
+      ierr = _f6.packedChanged();CHKERRQ(ierr);
+      ierr = obj->setStage(6);CHKERRQ(ierr);
+      ierr = obj->d_dt(_currT+c6*_deltaT,_k6._views,_f6._views);CHKERRQ(ierr);
+      ierr = _f6.fieldsChanged();CHKERRQ(ierr);
+
+      // 3rd and 4th order updates (hb2 = b2 = 0)
+      ierr = VecWAXPY(_y3._vec,hb1*_deltaT,F[0],_y._vec); CHKERRQ(ierr);
+      alpha[0] = hb3*_deltaT; alpha[1] = hb4*_deltaT; alpha[2] = hb5*_deltaT; alpha[3] = hb6*_deltaT;
+      ierr = VecMAXPY(_y3._vec,4,alpha,&F[2]); CHKERRQ(ierr);
+
+      ierr = VecWAXPY(_y4._vec,b1*_deltaT,F[0],_y._vec); CHKERRQ(ierr);
+      alpha[0] = b3*_deltaT; alpha[1] = b4*_deltaT; alpha[2] = b5*_deltaT; alpha[3] = b6*_deltaT;
+      ierr = VecMAXPY(_y4._vec,4,alpha,&F[2]); CHKERRQ(ierr);
 
       // calculate error
       _totErr = computeError();
@@ -1145,11 +1057,14 @@ PetscErrorCode RK43::integrate(IntegratorContextEx *obj)
 
     // accept 4th order solution as update
     _currT = _currT+_deltaT;
-    for (map<string,Vec>::iterator it = _var.begin(); it!=_var.end(); it++ ) {
-      ierr = VecCopy(_y4[it->first],_var[it->first]);CHKERRQ(ierr);
-      VecSet(_dvar[it->first],0.0);
-    }
-    ierr = obj->d_dt(_currT,_var,_dvar);CHKERRQ(ierr);
+    ierr = VecCopy(_y4._vec,_y._vec);CHKERRQ(ierr);
+    ierr = _y.packedChanged();CHKERRQ(ierr);
+    ierr = _y.copyTo(_var);CHKERRQ(ierr);
+    ierr = VecSet(_dy._vec,0.0);CHKERRQ(ierr);
+    ierr = _dy.packedChanged();CHKERRQ(ierr);
+    ierr = obj->setStage(0);CHKERRQ(ierr);
+    ierr = obj->d_dt(_currT,_var,_dy._views);CHKERRQ(ierr);
+    ierr = _dy.fieldsChanged();CHKERRQ(ierr);
 
     // compute new deltaT for next time step
     // but call timeMonitor before updating to newDeltaT, to keep output
@@ -1173,3 +1088,4 @@ PetscErrorCode RK43::integrate(IntegratorContextEx *obj)
 
   return ierr;
 }
+
@@ -10,6 +10,8 @@
 #include <boost/circular_buffer.hpp>
 #include "integratorContextEx.hpp"
 #include "genFuncs.hpp"
+#include "checkpoint.hpp"
+#include "packedVec.hpp"
 
 using namespace std;
 /*
@@ -25,6 +27,10 @@ using namespace std;
  * in the routine f(t,y).
  *
  * y is represented as an array of one or more Vecs (PETSc data type).
+ * Internally, y and all intermediate stages are stored packed into one
+ * contiguous Vec each (see PackedVec), so each stage update is one
+ * VecWAXPY/VecMAXPY call for all fields, and the error norm is one
+ * reduction.
  *
  * At minimum, the user must specify:
  *     QUANTITY               FUNCTION
@@ -61,8 +67,10 @@ public:
   PetscReal          _initT,_finalT,_currT,_deltaT;
   PetscReal          _newDeltaT; // stores future deltaT for access by outside classes, primarily for checkpointing
   PetscInt           _maxNumSteps,_stepCount;
-  map<string,Vec>    _var,_dvar; // integration variable and rate
+  map<string,Vec>    _var; // integration variable
+  PackedVec          _y,_dy; // packed copy of _var, and its rate
   vector<string>     _errInds; // which keys of _var to use for error control
+  vector<PetscInt>   _errFields; // index of each entry of _errInds in _y
   vector<double>     _scale; // scale factor for entries in _errInds
   double             _runTime;
   string             _controlType;
@@ -70,7 +78,6 @@ public:
 
   // for PID error control
   boost::circular_buffer<double> _errA;
-  map<string,Vec> _y2,_y3,_y4;
 
   OdeSolver(PetscInt maxNumSteps,PetscReal finalT,PetscReal deltaT,string controlType);
   virtual ~OdeSolver() {};
@@ -79,6 +86,15 @@ public:
   PetscErrorCode setInitialStepCount(const PetscReal stepCount);
   PetscErrorCode setStepSize(const PetscReal deltaT);
   PetscErrorCode setToleranceType(const string normType); // type of norm used for error control
+  PetscErrorCode setUpErrFields(const string& name); // check _errInds and _scale, and fill _errFields
+
+  // checkpointing: step count, next step size and error history, i.e. everything
+  // needed to continue the time step sequence exactly after a restart
+  PetscErrorCode writeCheckpoint(Checkpoint& ckpt);
+  PetscErrorCode loadCheckpoint(const Checkpoint& ckpt); // call after setTimeRange
+
+  // single time step of size deltaT (see odeSolver.cpp)
+  PetscErrorCode step(IntegratorContextEx *obj, const PetscReal time, const PetscInt stepCount, const PetscReal deltaT);
 
   virtual PetscErrorCode setTolerance(const PetscReal tol) = 0;
   virtual PetscErrorCode setTimeStepBounds(const PetscReal minDeltaT, const PetscReal maxDeltaT) = 0;
@@ -120,7 +136,7 @@ public:
 
   PetscReal   _totErr;
 
-  map<string,Vec> _k1,_f1,_k2,_f2,_y2,_y3;
+  PackedVec   _k1,_f1,_k2,_f2,_y2,_y3;
 
   PetscReal computeStepSize(const PetscReal totErr);
   PetscReal computeError();
@@ -155,8 +171,8 @@ public:
   PetscInt    _numRejectedSteps,_numMinSteps,_numMaxSteps;
   PetscReal   _totErr;
 
-  map<string,Vec> _k1,_k2,_k3,_k4,_k5,_k6,_y3,_y4;
-  map<string,Vec> _f1,_f2,_f3,_f4,_f5,_f6;
+  PackedVec   _k2,_k3,_k4,_k5,_k6,_y3,_y4;
+  PackedVec   _f2,_f3,_f4,_f5,_f6; // f1 is _dy
 
   PetscReal computeStepSize(const PetscReal totErr);
   PetscReal computeError();
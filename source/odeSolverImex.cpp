@@ -6,7 +6,7 @@ OdeSolverImex::OdeSolverImex(PetscInt maxNumSteps,PetscReal finalT,PetscReal del
 : _initT(0),_finalT(finalT),_currT(0),_deltaT(deltaT),
   _maxNumSteps(maxNumSteps),_stepCount(0),
   _runTime(0),_controlType(controlType),_normType("L2_absolute"),
-  _minDeltaT(0),_maxDeltaT(finalT),
+  _minDeltaT(0),_maxDeltaT(finalT),_bucketRatio(0),
   _totTol(1e-9),
   _numRejectedSteps(0),_numMinSteps(0),_numMaxSteps(0)
 {
@@ -46,6 +46,109 @@ PetscErrorCode OdeSolverImex::setToleranceType(const string normType)
   return 0;
 }
 
+// build default _errInds and _scale if they haven't been defined already,
+// check that _errInds is valid, and find the position of each entry in _y
+PetscErrorCode OdeSolverImex::setUpErrFields(const string& name)
+{
+  // build default errInds if it hasn't been defined already
+  if (_errInds.size()==0) {
+    for (map<string,Vec>::iterator it = _varEx.begin(); it!=_varEx.end(); it++ ) {
+      _errInds.push_back(it->first);
+    }
+  }
+
+  // check that errInds is valid
+  _errFields.clear();
+  for(std::vector<int>::size_type i = 0; i != _errInds.size(); i++) {
+    PetscInt ind = _y.fieldIndex(_errInds[i]);
+    if (ind < 0) {
+      PetscPrintf(PETSC_COMM_WORLD,"%s ERROR: %s is not an element of explicitly integrated variable!\n",name.c_str(),_errInds[i].c_str());
+    }
+    assert(ind >= 0);
+    _errFields.push_back(ind);
+  }
+
+  // set up scaling for elements in errInds
+  if (_scale.size() == 0) { // if 0 entries, set all to 1
+    for(std::vector<int>::size_type i = 0; i != _errInds.size(); i++) {
+      _scale.push_back(1.0);
+    }
+  }
+  assert(_scale.size() == _errInds.size());
+
+  return 0;
+}
+
+
+PetscErrorCode OdeSolverImex::setStepSizeBuckets(const PetscReal ratio)
+{
+  assert(ratio > 1);
+  _bucketRatio = ratio;
+  return 0;
+}
+
+
+// round deltaT down to the nearest ratio^k, allowing for round-off in the log
+PetscReal OdeSolverImex::snapStepSize(const PetscReal deltaT) const
+{
+  if (_bucketRatio <= 1 || deltaT <= 0) { return deltaT; }
+  const PetscReal k = floor(log(deltaT) / log(_bucketRatio) + 1e-9);
+  return pow(_bucketRatio,k);
+}
+
+
+// add the state after the latest accepted time step to ckpt
+PetscErrorCode OdeSolverImex::writeCheckpoint(Checkpoint& ckpt)
+{
+  PetscErrorCode ierr = 0;
+  ierr = ckpt.setScalar("ode_stepCount",_stepCount);CHKERRQ(ierr);
+  ierr = ckpt.setScalar("ode_deltaT",_newDeltaT);CHKERRQ(ierr);
+  for (size_t i = 0; i < _errA.size(); i++) {
+    ierr = ckpt.setScalar("ode_errA" + to_string(i),_errA[i]);CHKERRQ(ierr);
+  }
+  return ierr;
+}
+
+
+// continue from the state saved by writeCheckpoint
+PetscErrorCode OdeSolverImex::loadCheckpoint(const Checkpoint& ckpt)
+{
+  PetscErrorCode ierr = 0;
+  ierr = ckpt.getScalar("ode_stepCount",_stepCount);CHKERRQ(ierr);
+  ierr = ckpt.getScalar("ode_deltaT",_deltaT);CHKERRQ(ierr);
+  _newDeltaT = _deltaT;
+  for (size_t i = 0; i < _errA.size(); i++) {
+    ierr = ckpt.getScalar("ode_errA" + to_string(i),_errA[i]);CHKERRQ(ierr);
+  }
+  return ierr;
+}
+
+
+// take one time step of size deltaT from time, continuing from step count
+// stepCount. setInitialConds must be called first, and the solver can be kept
+// for later calls, which reuse its stage Vecs.
+PetscErrorCode OdeSolverImex::step(IntegratorContextImex *obj, const PetscReal time, const PetscInt stepCount, const PetscReal deltaT)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Starting OdeSolverImex::step in odeSolverImex.cpp.\n");
+  #endif
+
+  ierr = setTimeRange(time,time + deltaT);CHKERRQ(ierr);
+  ierr = setTimeStepBounds(deltaT,deltaT);CHKERRQ(ierr);
+  ierr = setStepSize(deltaT);CHKERRQ(ierr);
+  _newDeltaT = deltaT;
+  _stepCount = stepCount;
+  _maxNumSteps = stepCount + 1;
+
+  ierr = integrate(obj);CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending OdeSolverImex::step in odeSolverImex.cpp.\n");
+  #endif
+  return ierr;
+}
+
 
 RK32_WBE::RK32_WBE(PetscInt maxNumSteps,PetscReal finalT,PetscReal deltaT,string controlType)
 : OdeSolverImex(maxNumSteps,finalT,deltaT,controlType),
@@ -72,15 +175,8 @@ RK32_WBE::~RK32_WBE()
   PetscPrintf(PETSC_COMM_WORLD,"Starting RK32_WBE destructor in odeSolverImex.cpp.\n");
 #endif
 
-  // destruct temporary containers
-  destroyVector(_dvar);
-  destroyVector(_k1);
-  destroyVector(_f1);
-  destroyVector(_k2);
-  destroyVector(_f2);
-  destroyVector(_y2);
-  destroyVector(_y3);
-
+  // destruct temporary containers (packed containers are freed by their own destructors)
+  destroyVector(_vardTIm);
 
 #if VERBOSE > 1
   PetscPrintf(PETSC_COMM_WORLD,"Ending RK32_WBE destructor in odeSolverImex.cpp.\n");
@@ -135,6 +231,9 @@ PetscErrorCode RK32_WBE::view()
 
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   time interval: %g to %g\n",_initT,_finalT);CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   permitted step size range: [%g,%g]\n",_minDeltaT,_maxDeltaT);CHKERRQ(ierr);
+  if (_bucketRatio > 1) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   step sizes rounded down to powers of: %g\n",_bucketRatio);CHKERRQ(ierr);
+  }
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   total number of steps taken: %i/%i\n",_stepCount,_maxNumSteps);CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   final time reached: %g\n",_currT);CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   tolerance: %g\n",_totTol);CHKERRQ(ierr);
@@ -161,48 +260,33 @@ PetscErrorCode RK32_WBE::setInitialConds(map<string,Vec>& varEx,map<string,Vec>&
   double startTime = MPI_Wtime();
   PetscErrorCode ierr = 0;
 
-  // explicit part
+  // explicit part: packed copy of varEx, and RK vectors initialized to zero
+  // (the Vecs from an earlier call are reused if the fields are the same,
+  // and only the rate needs to be reset, since the stages are overwritten)
   _varEx = varEx;
-  for (map<string,Vec>::iterator it=_varEx.begin(); it!=_varEx.end(); it++ ) {
-    Vec dvar;
-    ierr = VecDuplicate(_varEx[it->first],&dvar); CHKERRQ(ierr);
-    ierr = VecSet(dvar,0.0); CHKERRQ(ierr);
-    _dvar[it->first] = dvar;
-
-    Vec varHalfdT;
-    ierr = VecDuplicate(_varEx[it->first],&varHalfdT); CHKERRQ(ierr);
-    ierr = VecSet(varHalfdT,0.0); CHKERRQ(ierr);
-    _k1[it->first] = varHalfdT;
-
-    Vec dvarHalfdT;
-    ierr = VecDuplicate(_varEx[it->first],&dvarHalfdT); CHKERRQ(ierr);
-    ierr = VecSet(dvarHalfdT,0.0); CHKERRQ(ierr);
-    _f1[it->first] = dvarHalfdT;
-
-    Vec vardT;
-    ierr = VecDuplicate(_varEx[it->first],&vardT); CHKERRQ(ierr);
-    ierr = VecSet(vardT,0.0); CHKERRQ(ierr);
-    _k2[it->first] = vardT;
-
-    Vec dvardT;
-    ierr = VecDuplicate(_varEx[it->first],&dvardT); CHKERRQ(ierr);
-    ierr = VecSet(dvardT,0.0); CHKERRQ(ierr);
-    _f2[it->first] = dvardT;
-
-    Vec var2nd;
-    ierr = VecDuplicate(_varEx[it->first],&var2nd); CHKERRQ(ierr);
-    ierr = VecSet(var2nd,0.0); CHKERRQ(ierr);
-    _y2[it->first] = var2nd;
-
-    Vec var3rd;
-    ierr = VecDuplicate(_varEx[it->first],&var3rd); CHKERRQ(ierr);
-    ierr = VecSet(var3rd,0.0); CHKERRQ(ierr);
-    _y3[it->first] = var3rd;
+  if (_y.hasLayout(_varEx)) {
+    ierr = VecSet(_dy._vec,0.0); CHKERRQ(ierr);
+    ierr = _dy.packedChanged(); CHKERRQ(ierr);
+  }
+  else {
+    ierr = _y.create(_varEx); CHKERRQ(ierr);
+    ierr = _dy.duplicate(_y); CHKERRQ(ierr);
+    ierr = _k1.duplicate(_y); CHKERRQ(ierr);
+    ierr = _f1.duplicate(_y); CHKERRQ(ierr);
+    ierr = _k2.duplicate(_y); CHKERRQ(ierr);
+    ierr = _f2.duplicate(_y); CHKERRQ(ierr);
+    ierr = _y2.duplicate(_y); CHKERRQ(ierr);
+    ierr = _y3.duplicate(_y); CHKERRQ(ierr);
   }
+  ierr = _y.copyFrom(_varEx); CHKERRQ(ierr);
 
   // implicit part, computed once per time step
   _varIm = varIm;
   for (map<string,Vec>::iterator it=_varIm.begin(); it!=_varIm.end(); it++ ) {
+    if (_vardTIm.find(it->first) != _vardTIm.end()) {
+      ierr = VecSet(_vardTIm[it->first],0.0); CHKERRQ(ierr);
+      continue;
+    }
     Vec vardTIm;
     ierr = VecDuplicate(_varIm[it->first],&vardTIm); CHKERRQ(ierr);
     ierr = VecSet(vardTIm,0.0); CHKERRQ(ierr);
@@ -281,6 +365,7 @@ PetscReal RK32_WBE::computeStepSize(const PetscReal totErr)
   // respect bounds on min and max possible step size
   deltaT = min(_deltaT*5.0,deltaT); // cap growth rate of step size
   deltaT=min(_maxDeltaT,deltaT); // absolute max
+  deltaT = snapStepSize(deltaT);
   deltaT = max(_minDeltaT,deltaT);
 
   if (_minDeltaT == deltaT) { _numMinSteps++; }
@@ -300,45 +385,21 @@ PetscReal RK32_WBE::computeError()
   PetscPrintf(PETSC_COMM_WORLD,"Starting RK32_WBE::computeError in odeSolverImex.cpp.\n");
 #endif
   PetscErrorCode ierr = 0;
-  PetscScalar err = 0, _totErr = 0;
+  PetscReal _totErr = 0;
 
+  // error: the difference between the 2nd and 3rd order solutions in the fields
+  // _errInds, computed together in one pass and one reduction
   // if using absolute error for control
-  // error: the absolute L2 error, weighted by N and a user-inputted scale factor
-  // tolerance: the absolute tolerance
+  //   the L2 error of each field, weighted by N and a user-inputted scale factor
+  //   tolerance: the absolute tolerance
+  // if using relative error for control
+  //   the L2 error of each field, scaled by the L2 norm of the solution and a user-inputted scale factor
+  //   tolerance: the relative tolerance
   if (_normType.compare("L2_absolute")==0) {
-    for(vector<int>::size_type i = 0; i != _errInds.size(); i++) {
-      string key = _errInds[i];
-      Vec errVec;
-      VecDuplicate(_y3[key],&errVec);
-      VecSet(errVec,0.0);
-      ierr = VecWAXPY(errVec,-1.0,_y3[key],_y2[key]); CHKERRQ(ierr);
-      VecNorm(errVec,NORM_2,&err);
-      VecDestroy(&errVec);
-
-      PetscInt N = 0;
-      VecGetSize(_y3[key],&N);
-      _totErr += err / (sqrt(N) * _scale[i]);
-    }
+    ierr = PackedVec::errorNorm(_y2,_y3,_errFields,_scale,"L2_absolute",_totErr); CHKERRQ(ierr);
   }
-
-  // if using relative error for control
-  // error: the absolute L2 error, scaled by the L2 norm of the solution
-  // and a user-inputted scale factor
-  // tolerance: the relative tolerance
   if (_normType.compare("L2_relative")==0) {
-    for(vector<int>::size_type i = 0; i != _errInds.size(); i++) {
-      string key = _errInds[i];
-      Vec errVec;
-      VecDuplicate(_y3[key],&errVec);
-      VecSet(errVec,0.0);
-      ierr = VecWAXPY(errVec,-1.0,_y3[key],_y2[key]); CHKERRQ(ierr);
-      VecNorm(errVec,NORM_2,&err);
-      VecDestroy(&errVec);
-
-      PetscReal s = 0;
-      VecNorm(_y3[key],NORM_2,&s);
-      _totErr += err / (s * _scale[i]);
-    }
+    ierr = PackedVec::errorNorm(_y2,_y3,_errFields,_scale,"L2_relative",_totErr); CHKERRQ(ierr);
   }
 
 #if VERBOSE > 1
@@ -360,37 +421,21 @@ PetscErrorCode RK32_WBE::integrate(IntegratorContextImex *obj)
   PetscReal      _totErr=0.0;
   PetscInt       attemptCount = 0;
   int            stopIntegration = 0;
+  PetscScalar    alpha[2];
+  Vec            x[2];
 
-  // build default errInds if it hasn't been defined already
-  if (_errInds.size()==0) {
-    for (map<string,Vec>::iterator it = _varEx.begin(); it!=_varEx.end(); it++ ) {
-      _errInds.push_back(it->first);
-    }
-  }
-
-    // check that errInds is valid
-  for(std::vector<int>::size_type i = 0; i != _errInds.size(); i++) {
-    std::string key = _errInds[i];
-    if (_varEx.find(key) == _varEx.end()) {
-      PetscPrintf(PETSC_COMM_WORLD,"RK32_WBE ERROR: %s is not an element of explicitly integrated variable!\n",key.c_str());
-    }
-    assert(_varEx.find(key) != _varEx.end());
-  }
-
-  // set up scaling for elements in errInds
-  if (_scale.size() == 0) { // if 0 entries, set all to 1
-    for(std::vector<int>::size_type i = 0; i != _errInds.size(); i++) {
-      _scale.push_back(1.0);
-    }
-  }
-  assert(_scale.size() == _errInds.size());
+  // build default errInds and scale if they haven't been defined already
+  ierr = setUpErrFields("RK32_WBE");CHKERRQ(ierr);
 
   if (_finalT==_initT) { return ierr; }
   else if (_deltaT==0) { _deltaT = (_finalT-_initT)/_maxNumSteps; }
   if (_maxNumSteps == 0) { return ierr; }
 
   // set initial condition
-  ierr = obj->d_dt(_currT,_varEx,_dvar);CHKERRQ(ierr);
+  ierr = _y.copyFrom(_varEx);CHKERRQ(ierr);
+  ierr = obj->setStage(0);CHKERRQ(ierr);
+  ierr = obj->d_dt(_currT,_varEx,_dy._views);CHKERRQ(ierr);
+  ierr = _dy.fieldsChanged();CHKERRQ(ierr);
   //~ ierr = obj->timeMonitor(_currT,_deltaT,_stepCount,stopIntegration); CHKERRQ(ierr);// write first step
 
   while (_stepCount<_maxNumSteps && _currT<_finalT) {
@@ -403,35 +448,33 @@ PetscErrorCode RK32_WBE::integrate(IntegratorContextImex *obj)
       //~ierr = PetscPrintf(PETSC_COMM_WORLD,"   attemptCount=%i\n",attemptCount);CHKERRQ(ierr);
       if (_currT+_deltaT>_finalT) { _deltaT=_finalT-_currT; }
 
-      for (map<string,Vec>::iterator it = _varEx.begin(); it!=_varEx.end(); it++ ) {
-        VecSet(_k1[it->first],0.0); VecSet(_f1[it->first],0.0);
-        VecSet(_k2[it->first],0.0); VecSet(_f2[it->first],0.0);
-        VecSet(_y2[it->first],0.0);
-        VecSet(_y3[it->first],0.0);
-      }
-
       // stage 1: integrate fields to _currT + 0.5*deltaT
-      for (map<string,Vec>::iterator it = _varEx.begin(); it!=_varEx.end(); it++ ) {
-        ierr = VecWAXPY(_k1[it->first],0.5*_deltaT,_dvar[it->first],_varEx[it->first]);CHKERRQ(ierr);
-      }
-      ierr = obj->d_dt(_currT+0.5*_deltaT,_k1,_f1);CHKERRQ(ierr);
+      ierr = VecWAXPY(_k1._vec,0.5*_deltaT,_dy._vec,_y._vec);CHKERRQ(ierr);
+      ierr = _k1.packedChanged();CHKERRQ(ierr);
+      ierr = VecSet(_f1._vec,0.0);CHKERRQ(ierr);
+      ierr = _f1.packedChanged();CHKERRQ(ierr);
+      ierr = obj->setStage(1);CHKERRQ(ierr);
+      ierr = obj->d_dt(_currT+0.5*_deltaT,_k1._views,_f1._views);CHKERRQ(ierr);
+      ierr = _f1.fieldsChanged();CHKERRQ(ierr);
 
       // stage 2: integrate fields to _currT + _deltaT
-      for (map<string,Vec>::iterator it = _varEx.begin(); it!=_varEx.end(); it++ ) {
-        ierr = VecWAXPY(_k2[it->first],-_deltaT,_dvar[it->first],_varEx[it->first]);CHKERRQ(ierr);
-        ierr = VecAXPY(_k2[it->first],2*_deltaT,_f1[it->first]);CHKERRQ(ierr);
-      }
-      ierr = obj->d_dt(_currT+_deltaT,_k2,_f2);CHKERRQ(ierr);
+      ierr = VecWAXPY(_k2._vec,-_deltaT,_dy._vec,_y._vec);CHKERRQ(ierr);
+      ierr = VecAXPY(_k2._vec,2*_deltaT,_f1._vec);CHKERRQ(ierr);
+      ierr = _k2.packedChanged();CHKERRQ(ierr);
+      ierr = VecSet(_f2._vec,0.0);CHKERRQ(ierr);
+      ierr = _f2.packedChanged();CHKERRQ(ierr);
+      ierr = obj->setStage(2);CHKERRQ(ierr);
+      ierr = obj->d_dt(_currT+_deltaT,_k2._views,_f2._views);CHKERRQ(ierr);
+      ierr = _f2.fieldsChanged();CHKERRQ(ierr);
 
       // 2nd and 3rd order update
-      for (map<string,Vec>::iterator it = _varEx.begin(); it!=_varEx.end(); it++ ) {
-        ierr = VecWAXPY(_y2[it->first],0.5*_deltaT,_dvar[it->first],_varEx[it->first]);CHKERRQ(ierr);
-        ierr = VecAXPY(_y2[it->first],0.5*_deltaT,_f2[it->first]);CHKERRQ(ierr);
+      ierr = VecWAXPY(_y2._vec,0.5*_deltaT,_dy._vec,_y._vec);CHKERRQ(ierr);
+      ierr = VecAXPY(_y2._vec,0.5*_deltaT,_f2._vec);CHKERRQ(ierr);
 
-        ierr = VecWAXPY(_y3[it->first],_deltaT/6.0,_dvar[it->first],_varEx[it->first]);CHKERRQ(ierr);
-        ierr = VecAXPY(_y3[it->first],2*_deltaT/3.0,_f1[it->first]);CHKERRQ(ierr);
-        ierr = VecAXPY(_y3[it->first],_deltaT/6.0,_f2[it->first]);CHKERRQ(ierr);
-      }
+      ierr = VecWAXPY(_y3._vec,_deltaT/6.0,_dy._vec,_y._vec);CHKERRQ(ierr);
+      alpha[0] = 2*_deltaT/3.0; x[0] = _f1._vec;
+      alpha[1] = _deltaT/6.0;   x[1] = _f2._vec;
+      ierr = VecMAXPY(_y3._vec,2,alpha,x);CHKERRQ(ierr);
 
       // calculate error
       _totErr = computeError();
@@ -444,14 +487,16 @@ PetscErrorCode RK32_WBE::integrate(IntegratorContextImex *obj)
 
     // accept 3rd order solution as update
     _currT = _currT+_deltaT;
-    for (map<string,Vec>::iterator it = _varEx.begin(); it!=_varEx.end(); it++ ) {
-      VecSet(_varEx[it->first],0.0);
-      ierr = VecCopy(_y3[it->first],_varEx[it->first]);CHKERRQ(ierr);
-      VecSet(_dvar[it->first],0.0);
-    }
+    ierr = VecCopy(_y3._vec,_y._vec);CHKERRQ(ierr);
+    ierr = _y.packedChanged();CHKERRQ(ierr);
+    ierr = _y.copyTo(_varEx);CHKERRQ(ierr);
+    ierr = VecSet(_dy._vec,0.0);CHKERRQ(ierr);
+    ierr = _dy.packedChanged();CHKERRQ(ierr);
 
     // update rates for explicit variables, and compute updated state for implicit variables
-    ierr = obj->d_dt(_currT,_varEx,_dvar,_vardTIm,_varIm,_deltaT);CHKERRQ(ierr);
+    ierr = obj->setStage(0);CHKERRQ(ierr);
+    ierr = obj->d_dt(_currT,_varEx,_dy._views,_vardTIm,_varIm,_deltaT);CHKERRQ(ierr);
+    ierr = _dy.fieldsChanged();CHKERRQ(ierr);
 
     // accept updated state for implicit variables
     for (map<string,Vec>::iterator it = _vardTIm.begin(); it!=_vardTIm.end(); it++ ) {
@@ -510,20 +555,8 @@ RK43_WBE::~RK43_WBE()
   PetscPrintf(PETSC_COMM_WORLD,"Starting RK43_WBE destructor in odeSolverImex.cpp.\n");
 #endif
 
-  // free temporary containers
-  destroyVector(_f1);
-  destroyVector(_f2);
-  destroyVector(_f3);
-  destroyVector(_f4);
-  destroyVector(_f5);
-  destroyVector(_f6);
-  destroyVector(_k2);
-  destroyVector(_k3);
-  destroyVector(_k4);
-  destroyVector(_k5);
-  destroyVector(_k6);
-  destroyVector(_y4);
-  destroyVector(_y3);
+  // free temporary containers (packed containers are freed by their own destructors)
+  destroyVector(_vardTIm);
 
 #if VERBOSE > 1
   PetscPrintf(PETSC_COMM_WORLD,"Ending RK43_WBE destructor in odeSolverImex.cpp.\n");
@@ -578,6 +611,9 @@ PetscErrorCode RK43_WBE::view()
 
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   time interval: %g to %g\n",_initT,_finalT);CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   permitted step size range: [%g,%g]\n",_minDeltaT,_maxDeltaT);CHKERRQ(ierr);
+  if (_bucketRatio > 1) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   step sizes rounded down to powers of: %g\n",_bucketRatio);CHKERRQ(ierr);
+  }
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   total number of steps taken: %i/%i\n",_stepCount,_maxNumSteps);CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   final time reached: %g\n",_currT);CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   tolerance: %g\n",_totTol);CHKERRQ(ierr);
@@ -599,84 +635,44 @@ PetscErrorCode RK43_WBE::setTolerance(const PetscReal tol)
 PetscErrorCode RK43_WBE::setInitialConds(map<string,Vec>& varEx,map<string,Vec>& varIm)
 {
 #if VERBOSE > 1
-  PetscPrintf(PETSC_COMM_WORLD,"Starting RK43_WBE::setInitialConds in RK43_WBE.cpp.\n");
+  PetscPrintf(PETSC_COMM_WORLD,"Starting RK43_WBE::setInitialConds in odeSolverImex.cpp.\n");
 #endif
   double startTime = MPI_Wtime();
   PetscErrorCode ierr = 0;
 
-  // explicit part
+  // explicit part: packed copy of varEx, and RK vectors initialized to zero
+  // (the Vecs from an earlier call are reused if the fields are the same,
+  // and only the rate needs to be reset, since the stages are overwritten)
   _varEx = varEx;
-  for (map<string,Vec>::iterator it=varEx.begin(); it!=varEx.end(); it++ ) {
-    Vec dvar;
-    ierr = VecDuplicate(_varEx[it->first],&dvar); CHKERRQ(ierr);
-    ierr = VecSet(dvar,0.0); CHKERRQ(ierr);
-    _dvar[it->first] = dvar;
-
-    Vec f2;
-    ierr = VecDuplicate(_varEx[it->first],&f2); CHKERRQ(ierr);
-    ierr = VecSet(f2,0.0); CHKERRQ(ierr);
-    _f2[it->first] = f2;
-
-    Vec f3;
-    ierr = VecDuplicate(_varEx[it->first],&f3); CHKERRQ(ierr);
-    ierr = VecSet(f3,0.0); CHKERRQ(ierr);
-    _f3[it->first] = f3;
-
-    Vec f4;
-    ierr = VecDuplicate(_varEx[it->first],&f4); CHKERRQ(ierr);
-    ierr = VecSet(f4,0.0); CHKERRQ(ierr);
-    _f4[it->first] = f4;
-
-    Vec f5;
-    ierr = VecDuplicate(_varEx[it->first],&f5); CHKERRQ(ierr);
-    ierr = VecSet(f5,0.0); CHKERRQ(ierr);
-    _f5[it->first] = f5;
-
-    Vec f6;
-    ierr = VecDuplicate(_varEx[it->first],&f6); CHKERRQ(ierr);
-    ierr = VecSet(f6,0.0); CHKERRQ(ierr);
-    _f6[it->first] = f6;
-
-    Vec k2;
-    ierr = VecDuplicate(_varEx[it->first],&k2); CHKERRQ(ierr);
-    ierr = VecSet(k2,0.0); CHKERRQ(ierr);
-    _k2[it->first] = k2;
-
-    Vec k3;
-    ierr = VecDuplicate(_varEx[it->first],&k3); CHKERRQ(ierr);
-    ierr = VecSet(k3,0.0); CHKERRQ(ierr);
-    _k3[it->first] = k3;
-
-    Vec k4;
-    ierr = VecDuplicate(_varEx[it->first],&k4); CHKERRQ(ierr);
-    ierr = VecSet(k4,0.0); CHKERRQ(ierr);
-    _k4[it->first] = k4;
-
-    Vec k5;
-    ierr = VecDuplicate(_varEx[it->first],&k5); CHKERRQ(ierr);
-    ierr = VecSet(k5,0.0); CHKERRQ(ierr);
-    _k5[it->first] = k5;
-
-    Vec k6;
-    ierr = VecDuplicate(_varEx[it->first],&k6); CHKERRQ(ierr);
-    ierr = VecSet(k6,0.0); CHKERRQ(ierr);
-    _k6[it->first] = k6;
-
-
-    Vec y3;
-    ierr = VecDuplicate(_varEx[it->first],&y3); CHKERRQ(ierr);
-    ierr = VecSet(y3,0.0); CHKERRQ(ierr);
-    _y3[it->first] = y3;
-
-    Vec y4;
-    ierr = VecDuplicate(_varEx[it->first],&y4); CHKERRQ(ierr);
-    ierr = VecSet(y4,0.0); CHKERRQ(ierr);
-    _y4[it->first] = y4;
+  if (_y.hasLayout(_varEx)) {
+    ierr = VecSet(_dy._vec,0.0); CHKERRQ(ierr);
+    ierr = _dy.packedChanged(); CHKERRQ(ierr);
   }
+  else {
+    ierr = _y.create(_varEx); CHKERRQ(ierr);
+    ierr = _dy.duplicate(_y); CHKERRQ(ierr);
+    ierr = _f2.duplicate(_y); CHKERRQ(ierr);
+    ierr = _f3.duplicate(_y); CHKERRQ(ierr);
+    ierr = _f4.duplicate(_y); CHKERRQ(ierr);
+    ierr = _f5.duplicate(_y); CHKERRQ(ierr);
+    ierr = _f6.duplicate(_y); CHKERRQ(ierr);
+    ierr = _k2.duplicate(_y); CHKERRQ(ierr);
+    ierr = _k3.duplicate(_y); CHKERRQ(ierr);
+    ierr = _k4.duplicate(_y); CHKERRQ(ierr);
+    ierr = _k5.duplicate(_y); CHKERRQ(ierr);
+    ierr = _k6.duplicate(_y); CHKERRQ(ierr);
+    ierr = _y3.duplicate(_y); CHKERRQ(ierr);
+    ierr = _y4.duplicate(_y); CHKERRQ(ierr);
+  }
+  ierr = _y.copyFrom(_varEx); CHKERRQ(ierr);
 
   // implicit part, computed once per time step
   _varIm = varIm;
   for (map<string,Vec>::iterator it=_varIm.begin(); it!=_varIm.end(); it++ ) {
+    if (_vardTIm.find(it->first) != _vardTIm.end()) {
+      ierr = VecSet(_vardTIm[it->first],0.0); CHKERRQ(ierr);
+      continue;
+    }
     Vec vardTIm;
     ierr = VecDuplicate(_varIm[it->first],&vardTIm); CHKERRQ(ierr);
     ierr = VecSet(vardTIm,0.0); CHKERRQ(ierr);
@@ -685,7 +681,7 @@ PetscErrorCode RK43_WBE::setInitialConds(map<string,Vec>& varEx,map<string,Vec>&
 
   _runTime += MPI_Wtime() - startTime;
 #if VERBOSE > 1
-  PetscPrintf(PETSC_COMM_WORLD,"Ending RK32_WBE::setInitialConds in odeSolverImex.cpp.\n");
+  PetscPrintf(PETSC_COMM_WORLD,"Ending RK43_WBE::setInitialConds in odeSolverImex.cpp.\n");
 #endif
   return ierr;
 }
@@ -767,6 +763,7 @@ PetscReal RK43_WBE::computeStepSize(const PetscReal totErr)
   // respect bounds on min and max possible step size
   deltaT = min(_deltaT*5.0,deltaT); // cap growth rate of step size
   deltaT= min(_maxDeltaT,deltaT); // absolute max
+  deltaT = snapStepSize(deltaT);
   deltaT = max(_minDeltaT,deltaT);
 
   if (_minDeltaT == deltaT) { _numMinSteps++; }
@@ -786,50 +783,27 @@ PetscReal RK43_WBE::computeError()
   PetscPrintf(PETSC_COMM_WORLD,"Starting RK43_WBE::computeError in odeSolverImex.cpp.\n");
 #endif
   PetscErrorCode ierr = 0;
-  PetscScalar err = 0, _totErr = 0;
+  PetscReal _totErr = 0;
 
+  // error: the difference between the 3rd and 4th order solutions in the fields
+  // _errInds, computed together in one pass and one reduction
   // if using absolute error for control
-  // error: the absolute L2 error, weighted by N and a user-inputted scale factor
-  // tolerance: the absolute tolerance
+  //   the L2 error of each field, weighted by N and a user-inputted scale factor
+  //   tolerance: the absolute tolerance
+  // if using relative error for control
+  //   the L2 error of each field, scaled by the L2 norm of the solution and a user-inputted scale factor
+  //   tolerance: the relative tolerance
   if (_normType.compare("L2_absolute")==0) {
-    for(vector<int>::size_type i = 0; i != _errInds.size(); i++) {
-      string key = _errInds[i];
-      Vec errVec;
-      VecDuplicate(_y3[key],&errVec);
-      VecSet(errVec,0.0);
-      ierr = VecWAXPY(errVec,-1.0,_y4[key],_y3[key]); CHKERRQ(ierr);
-      VecNorm(errVec,NORM_2,&err);
-      VecDestroy(&errVec);
-
-      PetscInt N = 0;
-      VecGetSize(_y4[key],&N);
-      _totErr += err / (sqrt(N) * _scale[i]);
-    }
+    ierr = PackedVec::errorNorm(_y3,_y4,_errFields,_scale,"L2_absolute",_totErr); CHKERRQ(ierr);
   }
-
-  // if using relative error for control
-  // error: the absolute L2 error, scaled by the L2 norm of the solution
-  // and a user-inputted scale factor
-  // tolerance: the relative tolerance
   if (_normType.compare("L2_relative")==0) {
-    for(vector<int>::size_type i = 0; i != _errInds.size(); i++) {
-      string key = _errInds[i];
-      Vec errVec;
-      VecDuplicate(_y3[key],&errVec);
-      VecSet(errVec,0.0);
-      ierr = VecWAXPY(errVec,-1.0,_y4[key],_y3[key]); CHKERRQ(ierr);
-      VecNorm(errVec,NORM_2,&err);
-      VecDestroy(&errVec);
-
-      PetscReal s = 0;
-      VecNorm(_y4[key],NORM_2,&s);
-      _totErr += err / (s * _scale[i]);
-    }
+    ierr = PackedVec::errorNorm(_y3,_y4,_errFields,_scale,"L2_relative",_totErr); CHKERRQ(ierr);
   }
 
 #if VERBOSE > 1
   PetscPrintf(PETSC_COMM_WORLD,"Ending RK43_WBE::computeError in odeSolverImex.cpp.\n");
 #endif
+
   return _totErr;
 }
 
@@ -890,118 +864,96 @@ PetscErrorCode RK43_WBE::integrate(IntegratorContextImex *obj)
   PetscScalar a65 = 4040./17871.;
 
 
-  // if necessary, build default errInds
-  if (_errInds.size()==0) {
-    for (map<string,Vec>::iterator it = _varEx.begin(); it!=_varEx.end(); it++ ) {
-      _errInds.push_back(it->first);
-    }
-  }
+  // build default errInds and scale if they haven't been defined already
+  ierr = setUpErrFields("RK43_WBE");CHKERRQ(ierr);
 
-  // check that errInds is valid
-  for(std::vector<int>::size_type i = 0; i != _errInds.size(); i++) {
-    std::string key = _errInds[i];
-    if (_varEx.find(key) == _varEx.end()) {
-      PetscPrintf(PETSC_COMM_WORLD,"RK43_WBE ERROR: %s is not an explicitly integrated variable!\n",key.c_str());
-    }
-    assert(_varEx.find(key) != _varEx.end());
-  }
-
-  // set up scaling for elements in errInds
-  if (_scale.size() == 0) { // if 0 entries, set all to 1
-    for(std::vector<int>::size_type i = 0; i != _errInds.size(); i++) {
-      _scale.push_back(1.0);
-    }
-  }
-  assert(_scale.size() == _errInds.size());
-
-  if (_finalT==_initT) { return ierr; }
-  if (_deltaT==0) { _deltaT = (_finalT-_initT)/_maxNumSteps; }
+  if (_finalT == _initT) { return ierr; }
+  if (_deltaT == 0) { _deltaT = (_finalT - _initT) / _maxNumSteps; }
   if (_maxNumSteps == 0) { return ierr; }
 
-
   // set initial condition
-  ierr = obj->d_dt(_currT,_varEx,_dvar);CHKERRQ(ierr);
-  _f1 = _dvar;
+  ierr = _y.copyFrom(_varEx);CHKERRQ(ierr);
+  ierr = obj->setStage(0);CHKERRQ(ierr);
+  ierr = obj->d_dt(_currT,_varEx,_dy._views);CHKERRQ(ierr);
+  ierr = _dy.fieldsChanged();CHKERRQ(ierr);
   //~ ierr = obj->timeMonitor(_currT,_deltaT,_stepCount,stopIntegration); CHKERRQ(ierr); // write first step
 
-  while (_stepCount<_maxNumSteps && _currT<_finalT) {
+  // stage 1: k1 = var, f1 = f(k1) = dvar
+  // each later stage and update is var + deltaT * sum_j a_ij * f_j, computed
+  // on the packed Vecs as one VecWAXPY followed by one VecMAXPY
+  Vec         F[6] = {_dy._vec,_f2._vec,_f3._vec,_f4._vec,_f5._vec,_f6._vec};
+  PetscScalar alpha[5];
+
+  // perform time stepping
+  while (_stepCount < _maxNumSteps && _currT < _finalT) {
     _stepCount++;
     attemptCount = 0;
-    while (attemptCount<100) { // repeat until time step is acceptable
+    while (attemptCount < 100) {
       attemptCount++;
-      if (attemptCount>=100) {PetscPrintf(PETSC_COMM_WORLD,"   RK43_WBE WARNING: maximum number of attempts reached\n"); }
-
-      if (_currT+_deltaT>_finalT) { _deltaT=_finalT-_currT; }
-
-      for (map<string,Vec>::iterator it = _varEx.begin(); it!=_varEx.end(); it++ ) {
-        VecSet(_k2[it->first],0.0);
-        VecSet(_k3[it->first],0.0); VecSet(_k4[it->first],0.0);
-        VecSet(_k5[it->first],0.0); VecSet(_k6[it->first],0.0);
-        VecSet(_f2[it->first],0.0);
-        VecSet(_f3[it->first],0.0); VecSet(_f4[it->first],0.0);
-        VecSet(_f5[it->first],0.0); VecSet(_f6[it->first],0.0);
-      }
+      if (attemptCount >= 100) { PetscPrintf(PETSC_COMM_WORLD,"   RK43_WBE WARNING: maximum number of attempts reached\n"); }
 
-      // stage 1: k1 = var, compute f1 = f(k1)
-      _f1 = _dvar;
+      if (_currT + _deltaT > _finalT) { _deltaT = _finalT - _currT; }
 
       // stage 2: compute k2
-      for (map<string,Vec>::iterator it = _varEx.begin(); it!=_varEx.end(); it++ ) {
-        ierr = VecWAXPY(_k2[it->first],a21*_deltaT,_f1[it->first],_varEx[it->first]); CHKERRQ(ierr);
-      }
-      ierr = obj->d_dt(_currT+c2*_deltaT,_k2,_f2);CHKERRQ(ierr); // compute f2
+      ierr = VecWAXPY(_k2._vec,a21*_deltaT,F[0],_y._vec); CHKERRQ(ierr);
+      ierr = _k2.packedChanged();CHKERRQ(ierr);
+      ierr = VecSet(_f2._vec,0.0);CHKERRQ(ierr);
+      ierr = _f2.packedChanged();CHKERRQ(ierr);
+      ierr = obj->setStage(2);CHKERRQ(ierr);
+      ierr = obj->d_dt(_currT+c2*_deltaT,_k2._views,_f2._views);CHKERRQ(ierr);
+      ierr = _f2.fieldsChanged();CHKERRQ(ierr);
 
       // stage 3: compute k3
-      for (map<string,Vec>::iterator it = _varEx.begin(); it!=_varEx.end(); it++ ) {
-        ierr = VecWAXPY(_k3[it->first],a31*_deltaT,_f1[it->first],_varEx[it->first]); CHKERRQ(ierr);
-        ierr = VecAXPY(_k3[it->first],a32*_deltaT,_f2[it->first]); CHKERRQ(ierr);
-      }
-      ierr = obj->d_dt(_currT+c3*_deltaT,_k3,_f3);CHKERRQ(ierr); // compute f3
+      ierr = VecWAXPY(_k3._vec,a31*_deltaT,F[0],_y._vec); CHKERRQ(ierr);
+      ierr = VecAXPY(_k3._vec,a32*_deltaT,F[1]); CHKERRQ(ierr);
+      ierr = _k3.packedChanged();CHKERRQ(ierr);
+      ierr = VecSet(_f3._vec,0.0);CHKERRQ(ierr);
+      ierr = _f3.packedChanged();CHKERRQ(ierr);
+      ierr = obj->setStage(3);CHKERRQ(ierr);
+      ierr = obj->d_dt(_currT+c3*_deltaT,_k3._views,_f3._views);CHKERRQ(ierr);
+      ierr = _f3.fieldsChanged();CHKERRQ(ierr);
 
       // stage 4
-      for (map<string,Vec>::iterator it = _varEx.begin(); it!=_varEx.end(); it++ ) {
-        ierr = VecWAXPY(_k4[it->first],a41*_deltaT,_f1[it->first],_varEx[it->first]); CHKERRQ(ierr);
-        ierr =  VecAXPY(_k4[it->first],a42*_deltaT,_f2[it->first]); CHKERRQ(ierr);
-        ierr =  VecAXPY(_k4[it->first],a43*_deltaT,_f3[it->first]); CHKERRQ(ierr);
-      }
-      ierr = obj->d_dt(_currT+c4*_deltaT,_k4,_f4);CHKERRQ(ierr); // compute f4
+      ierr = VecWAXPY(_k4._vec,a41*_deltaT,F[0],_y._vec); CHKERRQ(ierr);
+      alpha[0] = a42*_deltaT; alpha[1] = a43*_deltaT;
+      ierr = VecMAXPY(_k4._vec,2,alpha,&F[1]); CHKERRQ(ierr);
+      ierr = _k4.packedChanged();CHKERRQ(ierr);
+      ierr = VecSet(_f4._vec,0.0);CHKERRQ(ierr);
+      ierr = _f4.packedChanged();CHKERRQ(ierr);
+      ierr = obj->setStage(4);CHKERRQ(ierr);
+      ierr = obj->d_dt(_currT+c4*_deltaT,_k4._views,_f4._views);CHKERRQ(ierr);
+      ierr = _f4.fieldsChanged();CHKERRQ(ierr);
 
       // stage 5
-      for (map<string,Vec>::iterator it = _varEx.begin(); it!=_varEx.end(); it++ ) {
-        ierr = VecWAXPY(_k5[it->first],a51*_deltaT,_f1[it->first],_varEx[it->first]); CHKERRQ(ierr);
-        ierr =  VecAXPY(_k5[it->first],a52*_deltaT,_f2[it->first]); CHKERRQ(ierr);
-        ierr =  VecAXPY(_k5[it->first],a53*_deltaT,_f3[it->first]); CHKERRQ(ierr);
-        ierr =  VecAXPY(_k5[it->first],a54*_deltaT,_f4[it->first]); CHKERRQ(ierr);
-      }
-      ierr = obj->d_dt(_currT+c5*_deltaT,_k5,_f5);CHKERRQ(ierr); // compute f5
+      ierr = VecWAXPY(_k5._vec,a51*_deltaT,F[0],_y._vec); CHKERRQ(ierr);
+      alpha[0] = a52*_deltaT; alpha[1] = a53*_deltaT; alpha[2] = a54*_deltaT;
+      ierr = VecMAXPY(_k5._vec,3,alpha,&F[1]); CHKERRQ(ierr);
+      ierr = _k5.packedChanged();CHKERRQ(ierr);
+      ierr = VecSet(_f5._vec,0.0);CHKERRQ(ierr);
+      ierr = _f5.packedChanged();CHKERRQ(ierr);
+      ierr = obj->setStage(5);CHKERRQ(ierr);
+      ierr = obj->d_dt(_currT+c5*_deltaT,_k5._views,_f5._views);CHKERRQ(ierr);
+      ierr = _f5.fieldsChanged();CHKERRQ(ierr);
 
       // stage 6
-      for (map<string,Vec>::iterator it = _varEx.begin(); it!=_varEx.end(); it++ ) {
-        ierr = VecWAXPY(_k6[it->first],a61*_deltaT,_f1[it->first],_varEx[it->first]); CHKERRQ(ierr);
-        ierr =  VecAXPY(_k6[it->first],a62*_deltaT,_f2[it->first]); CHKERRQ(ierr);
-        ierr =  VecAXPY(_k6[it->first],a63*_deltaT,_f3[it->first]); CHKERRQ(ierr);
-        ierr =  VecAXPY(_k6[it->first],a64*_deltaT,_f4[it->first]); CHKERRQ(ierr);
-        ierr =  VecAXPY(_k6[it->first],a65*_deltaT,_f5[it->first]); CHKERRQ(ierr);
-      }
-      ierr = obj->d_dt(_currT+c6*_deltaT,_k6,_f6);CHKERRQ(ierr); // compute f6
-
-      // 3rd and 4th order updates
-      for (map<string,Vec>::iterator it = _varEx.begin(); it!=_varEx.end(); it++ ) {
-        ierr = VecWAXPY(_y3[it->first],hb1*_deltaT,_f1[it->first],_varEx[it->first]); CHKERRQ(ierr);
-        //~ ierr = VecAXPY(_y3[it->first],hb2*_deltaT,_f2[it->first]); CHKERRQ(ierr); // hb2 = 0
-        ierr = VecAXPY(_y3[it->first],hb3*_deltaT,_f3[it->first]); CHKERRQ(ierr);
-        ierr = VecAXPY(_y3[it->first],hb4*_deltaT,_f4[it->first]); CHKERRQ(ierr);
-        ierr = VecAXPY(_y3[it->first],hb5*_deltaT,_f5[it->first]); CHKERRQ(ierr);
-        ierr = VecAXPY(_y3[it->first],hb6*_deltaT,_f6[it->first]); CHKERRQ(ierr);
-
-
-        ierr = VecWAXPY(_y4[it->first],b1*_deltaT,_f1[it->first],_varEx[it->first]); CHKERRQ(ierr);
-        //~ ierr = VecAXPY(_y4[it->first],b2*_deltaT,_f2[it->first]); CHKERRQ(ierr); // b2 = 0
-        ierr = VecAXPY(_y4[it->first],b3*_deltaT,_f3[it->first]); CHKERRQ(ierr);
-        ierr = VecAXPY(_y4[it->first],b4*_deltaT,_f4[it->first]); CHKERRQ(ierr);
-        ierr = VecAXPY(_y4[it->first],b5*_deltaT,_f5[it->first]); CHKERRQ(ierr);
-        ierr = VecAXPY(_y4[it->first],b6*_deltaT,_f6[it->first]); CHKERRQ(ierr);
-      }
+      ierr = VecWAXPY(_k6._vec,a61*_deltaT,F[0],_y._vec); CHKERRQ(ierr);
+      alpha[0] = a62*_deltaT; alpha[1] = a63*_deltaT; alpha[2] = a64*_deltaT; alpha[3] = a65*_deltaT;
+      ierr = VecMAXPY(_k6._vec,4,alpha,&F[1]); CHKERRQ(ierr);
+      ierr = _k6.packedChanged();CHKERRQ(ierr);
+      ierr = VecSet(_f6._vec,0.0);CHKERRQ(ierr);
+      ierr = _f6.packedChanged();CHKERRQ(ierr);
+      ierr = obj->setStage(6);CHKERRQ(ierr);
+      ierr = obj->d_dt(_currT+c6*_deltaT,_k6._views,_f6._views);CHKERRQ(ierr);
+      ierr = _f6.fieldsChanged();CHKERRQ(ierr);
+
+      // 3rd and 4th order updates (hb2 = b2 = 0)
+      ierr = VecWAXPY(_y3._vec,hb1*_deltaT,F[0],_y._vec); CHKERRQ(ierr);
+      alpha[0] = hb3*_deltaT; alpha[1] = hb4*_deltaT; alpha[2] = hb5*_deltaT; alpha[3] = hb6*_deltaT;
+      ierr = VecMAXPY(_y3._vec,4,alpha,&F[2]); CHKERRQ(ierr);
+
+      ierr = VecWAXPY(_y4._vec,b1*_deltaT,F[0],_y._vec); CHKERRQ(ierr);
+      alpha[0] = b3*_deltaT; alpha[1] = b4*_deltaT; alpha[2] = b5*_deltaT; alpha[3] = b6*_deltaT;
+      ierr = VecMAXPY(_y4._vec,4,alpha,&F[2]); CHKERRQ(ierr);
 
       // calculate error
       _totErr = computeError();
@@ -1011,37 +963,445 @@ PetscErrorCode RK43_WBE::integrate(IntegratorContextImex *obj)
 
       _numRejectedSteps++;
     }
-    _currT = _currT+_deltaT;
 
     // accept 4th order solution as update
-    for (map<string,Vec>::iterator it = _varEx.begin(); it!=_varEx.end(); it++ ) {
-      ierr = VecCopy(_y4[it->first],_varEx[it->first]);CHKERRQ(ierr);
-      VecSet(_dvar[it->first],0.0);
-    }
+    _currT = _currT+_deltaT;
+    ierr = VecCopy(_y4._vec,_y._vec);CHKERRQ(ierr);
+    ierr = _y.packedChanged();CHKERRQ(ierr);
+    ierr = _y.copyTo(_varEx);CHKERRQ(ierr);
+    ierr = VecSet(_dy._vec,0.0);CHKERRQ(ierr);
+    ierr = _dy.packedChanged();CHKERRQ(ierr);
+
     // update rates for explicit variables, and compute updated state for implicit variables
-    ierr = obj->d_dt(_currT,_varEx,_dvar,_vardTIm,_varIm,_deltaT);CHKERRQ(ierr);
+    ierr = obj->setStage(0);CHKERRQ(ierr);
+    ierr = obj->d_dt(_currT,_varEx,_dy._views,_vardTIm,_varIm,_deltaT);CHKERRQ(ierr);
+    ierr = _dy.fieldsChanged();CHKERRQ(ierr);
 
     // accept updated state for implicit variables
     for (map<string,Vec>::iterator it = _vardTIm.begin(); it!=_vardTIm.end(); it++ ) {
       VecCopy(_vardTIm[it->first],_varIm[it->first]);
       VecSet(_vardTIm[it->first],0.);
     }
+
     // compute new deltaT for next time step
-    // but timeMonitor before updating to newDeltaT, to keep output consistent while allowing for checkpointing
+    // but call timeMonitor before updating to newDeltaT, to keep output
+    // consistent while allowing for checkpointing
     if (_totErr!=0.0) { _newDeltaT = computeStepSize(_totErr); }
     _errA.push_front(_totErr); // record error for use when estimating time step
 
-
     ierr = obj->timeMonitor(_currT,_deltaT,_stepCount,stopIntegration); CHKERRQ(ierr);
     if (stopIntegration > 0) { PetscPrintf(PETSC_COMM_WORLD,"RK32: Detected stop time integration request.\n"); break; }
 
     // now update deltaT
     _deltaT = _newDeltaT;
+
   }
 
   _runTime += MPI_Wtime() - startTime;
+
 #if VERBOSE > 1
   PetscPrintf(PETSC_COMM_WORLD,"Ending RK43_WBE::integrate in odeSolver.cpp.\n");
 #endif
+
+  return ierr;
+}
+
+
+
+//======================================================================
+//======================================================================
+
+// phi functions for exponential time differencing, for z = -deltaT*lambda <= 0
+//   phi1(z) = (e^z - 1)/z
+//   phi2(z) = (e^z - 1 - z)/z^2
+// using their Taylor series for small |z| to avoid cancellation
+static PetscScalar etdPhi1(const PetscScalar z)
+{
+  if (abs(z) < 1e-3) { return 1.0 + z*(1.0/2.0 + z/6.0); }
+  return expm1(z)/z;
+}
+
+static PetscScalar etdPhi2(const PetscScalar z)
+{
+  if (abs(z) < 1e-3) { return 1.0/2.0 + z*(1.0/6.0 + z*(1.0/24.0 + z/120.0)); }
+  return (expm1(z) - z)/(z*z);
+}
+
+
+ETD2_WBE::ETD2_WBE(PetscInt maxNumSteps,PetscReal finalT,PetscReal deltaT,string controlType)
+: OdeSolverImex(maxNumSteps,finalT,deltaT,controlType),
+  _kappa(0.9),_ord(2.0)
+{
+#if VERBOSE > 1
+  PetscPrintf(PETSC_COMM_WORLD,"Starting ETD2_WBE constructor in odeSolverImex.cpp.\n");
+#endif
+  double startTime = MPI_Wtime();
+
+  _errA.resize(2);
+  _errA.push_front(0);
+  _errA.push_front(0);
+
+  _runTime += MPI_Wtime() - startTime;
+#if VERBOSE > 1
+  PetscPrintf(PETSC_COMM_WORLD,"Ending ETD2_WBE constructor in odeSolverImex.cpp.\n");
+#endif
+}
+
+ETD2_WBE::~ETD2_WBE()
+{
+#if VERBOSE > 1
+  PetscPrintf(PETSC_COMM_WORLD,"Starting ETD2_WBE destructor in odeSolverImex.cpp.\n");
+#endif
+
+  // destruct temporary containers (packed containers are freed by their own destructors)
+  destroyVector(_vardTIm);
+
+#if VERBOSE > 1
+  PetscPrintf(PETSC_COMM_WORLD,"Ending ETD2_WBE destructor in odeSolverImex.cpp.\n");
+#endif
+}
+
+
+PetscErrorCode ETD2_WBE::setTimeRange(const PetscReal initT,const PetscReal finalT)
+{
+  _initT = initT;
+  _currT = initT;
+  _finalT = finalT;
+  return 0;
+}
+
+PetscErrorCode ETD2_WBE::setStepSize(const PetscReal deltaT)
+{
+  _deltaT = deltaT;
+  return 0;
+}
+
+
+PetscErrorCode ETD2_WBE::view()
+{
+  PetscErrorCode ierr = 0;
+
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"-------------------------------\n\n");CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"\nTime Integration summary:\n");CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   integration algorithm: IMEX exponential time differencing (2,1)\n");CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   control scheme: %s\n",_controlType.c_str());CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   norm type used to measure error: %s\n",_normType.c_str());CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   variables used in determining time step = %s\n",vector2str(_errInds).c_str());CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   scale factors = %s\n",vector2str(_scale).c_str());CHKERRQ(ierr);
+
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   time interval: %g to %g\n",_initT,_finalT);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   permitted step size range: [%g,%g]\n",_minDeltaT,_maxDeltaT);CHKERRQ(ierr);
+  if (_bucketRatio > 1) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   step sizes rounded down to powers of: %g\n",_bucketRatio);CHKERRQ(ierr);
+  }
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   total number of steps taken: %i/%i\n",_stepCount,_maxNumSteps);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   final time reached: %g\n",_currT);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   tolerance: %g\n",_totTol);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   number of rejected steps: %i\n",_numRejectedSteps);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   number of times min step size enforced: %i\n",_numMinSteps);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   number of times max step size enforced: %i\n",_numMaxSteps);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   total run time: %g\n",_runTime);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"\n");CHKERRQ(ierr);
+
+  return 0;
+}
+
+PetscErrorCode ETD2_WBE::setTolerance(const PetscReal tol)
+{
+  _totTol = tol;
+  return 0;
+}
+
+PetscErrorCode ETD2_WBE::setInitialConds(map<string,Vec>& varEx,map<string,Vec>& varIm)
+{
+#if VERBOSE > 1
+  PetscPrintf(PETSC_COMM_WORLD,"Starting ETD2_WBE::setInitialConds in odeSolverImex.cpp.\n");
+#endif
+  double startTime = MPI_Wtime();
+  PetscErrorCode ierr = 0;
+
+  // explicit part: packed copy of varEx, and ETD vectors initialized to zero
+  // (the Vecs from an earlier call are reused if the fields are the same,
+  // and only the rate needs to be reset, since the stages and the relaxation
+  // rates are overwritten)
+  _varEx = varEx;
+  if (_y.hasLayout(_varEx)) {
+    ierr = VecSet(_dy._vec,0.0); CHKERRQ(ierr);
+    ierr = _dy.packedChanged(); CHKERRQ(ierr);
+  }
+  else {
+    ierr = _y.create(_varEx); CHKERRQ(ierr);
+    ierr = _dy.duplicate(_y); CHKERRQ(ierr);
+    ierr = _lambda.duplicate(_y); CHKERRQ(ierr);
+    ierr = _y1.duplicate(_y); CHKERRQ(ierr);
+    ierr = _f1.duplicate(_y); CHKERRQ(ierr);
+    ierr = _y2.duplicate(_y); CHKERRQ(ierr);
+  }
+  ierr = _y.copyFrom(_varEx); CHKERRQ(ierr);
+
+  // implicit part, computed once per time step
+  _varIm = varIm;
+  for (map<string,Vec>::iterator it=_varIm.begin(); it!=_varIm.end(); it++ ) {
+    if (_vardTIm.find(it->first) != _vardTIm.end()) {
+      ierr = VecSet(_vardTIm[it->first],0.0); CHKERRQ(ierr);
+      continue;
+    }
+    Vec vardTIm;
+    ierr = VecDuplicate(_varIm[it->first],&vardTIm); CHKERRQ(ierr);
+    ierr = VecSet(vardTIm,0.0); CHKERRQ(ierr);
+    _vardTIm[it->first] = vardTIm;
+  }
+
+  _runTime += MPI_Wtime() - startTime;
+#if VERBOSE > 1
+  PetscPrintf(PETSC_COMM_WORLD,"Ending ETD2_WBE::setInitialConds in odeSolverImex.cpp.\n");
+#endif
+  return ierr;
+}
+
+PetscErrorCode ETD2_WBE::setErrInds(vector<string>& errInds) {
+  _errInds = errInds;
+  return 0;
+}
+
+PetscErrorCode ETD2_WBE::setErrInds(vector<string>& errInds, vector<double> scale)
+{
+  _errInds = errInds;
+  _scale = scale;
+  return 0;
+}
+
+PetscErrorCode ETD2_WBE::setTimeStepBounds(const PetscReal minDeltaT, const PetscReal maxDeltaT)
+{
+  _minDeltaT = minDeltaT;
+  _maxDeltaT = maxDeltaT;
+  return 0;
+}
+
+PetscReal ETD2_WBE::computeStepSize(const PetscReal totErr)
+{
+#if VERBOSE > 1
+  PetscPrintf(PETSC_COMM_WORLD,"Starting ETD2_WBE::computeStepSize in odeSolverImex.cpp.\n");
+#endif
+  PetscReal stepRatio;
+
+  // if using integral feedback controller (I)
+  if (_controlType.compare("P") == 0) {
+    PetscReal alpha = 1./(1.+_ord);
+    stepRatio = _kappa*pow(_totTol/totErr,alpha);
+  }
+  //if using proportional-integral-derivative feedback (PID)
+  else if (_controlType.compare("PID") == 0) {
+    PetscReal alpha = 0.49/_ord;
+    PetscReal beta  = 0.34/_ord;
+    PetscReal gamma = 0.1/_ord;
+
+    // only do this for the first simulation when _errA is empty
+    if (_stepCount < 4) {
+      stepRatio = _kappa*pow(_totTol/totErr,1./(1.+_ord));
+    }
+    else {
+      stepRatio = _kappa * pow(_totTol/totErr,alpha)
+                         * pow(_errA[0]/_totTol,beta)
+                         * pow(_totTol/_errA[1],gamma);
+    }
+  }
+  else {
+    PetscPrintf(PETSC_COMM_WORLD,"ERROR: timeControlType not understood\n");
+    assert(0>1); // automatically fail
+  }
+
+  PetscReal deltaT = stepRatio*_deltaT;
+
+  // respect bounds on min and max possible step size
+  deltaT = min(_deltaT*5.0,deltaT); // cap growth rate of step size
+  deltaT = min(_maxDeltaT,deltaT); // absolute max
+  deltaT = snapStepSize(deltaT);
+  deltaT = max(_minDeltaT,deltaT);
+
+  if (_minDeltaT == deltaT) { _numMinSteps++; }
+  else if (_maxDeltaT == deltaT) { _numMaxSteps++; }
+
+#if VERBOSE > 1
+  PetscPrintf(PETSC_COMM_WORLD,"Ending ETD2_WBE::computeStepSize in odeSolverImex.cpp.\n");
+#endif
+
+  return deltaT;
+}
+
+
+PetscReal ETD2_WBE::computeError()
+{
+  PetscErrorCode ierr = 0;
+  PetscReal _totErr = 0;
+
+  // error: the difference between the 1st order (exponential Euler) and
+  // 2nd order solutions in the fields _errInds, as for RK32_WBE
+  ierr = PackedVec::errorNorm(_y1,_y2,_errFields,_scale,_normType,_totErr); CHKERRQ(ierr);
+
+  return _totErr;
+}
+
+
+// relaxation rates at the current solution, from the most recent call to obj->d_dt
+PetscErrorCode ETD2_WBE::updateRelaxationRates(IntegratorContextImex *obj)
+{
+  PetscErrorCode ierr = 0;
+  ierr = VecSet(_lambda._vec,0.0);CHKERRQ(ierr);
+  ierr = _lambda.packedChanged();CHKERRQ(ierr);
+  ierr = obj->getLinearRelaxationRates(_lambda._views);CHKERRQ(ierr);
+  ierr = _lambda.fieldsChanged();CHKERRQ(ierr);
+  return ierr;
+}
+
+
+// exponential Euler stage: y1 = y + deltaT*phi1(-deltaT*lambda)*dy
+PetscErrorCode ETD2_WBE::takeStage()
+{
+  PetscErrorCode ierr = 0;
+
+  PetscInt nLocal = 0;
+  const PetscScalar *y,*dy,*lambda;
+  PetscScalar *y1;
+  ierr = VecGetLocalSize(_y._vec,&nLocal);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_y._vec,&y);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_dy._vec,&dy);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_lambda._vec,&lambda);CHKERRQ(ierr);
+  ierr = VecGetArray(_y1._vec,&y1);CHKERRQ(ierr);
+  for (PetscInt Ii = 0; Ii < nLocal; Ii++) {
+    y1[Ii] = y[Ii] + _deltaT * etdPhi1(-_deltaT*lambda[Ii]) * dy[Ii];
+  }
+  ierr = VecRestoreArrayRead(_y._vec,&y);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(_dy._vec,&dy);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(_lambda._vec,&lambda);CHKERRQ(ierr);
+  ierr = VecRestoreArray(_y1._vec,&y1);CHKERRQ(ierr);
+  ierr = _y1.packedChanged();CHKERRQ(ierr);
+
+  return ierr;
+}
+
+
+// 2nd order update: y2 = y1 + deltaT*phi2(-deltaT*lambda)*(N(y1) - N(y)),
+// where N(y) = dy + lambda*y is the non-stiff part of the rate
+PetscErrorCode ETD2_WBE::takeUpdate()
+{
+  PetscErrorCode ierr = 0;
+
+  PetscInt nLocal = 0;
+  const PetscScalar *y,*dy,*lambda,*y1,*f1;
+  PetscScalar *y2;
+  ierr = VecGetLocalSize(_y._vec,&nLocal);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_y._vec,&y);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_dy._vec,&dy);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_lambda._vec,&lambda);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_y1._vec,&y1);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_f1._vec,&f1);CHKERRQ(ierr);
+  ierr = VecGetArray(_y2._vec,&y2);CHKERRQ(ierr);
+  for (PetscInt Ii = 0; Ii < nLocal; Ii++) {
+    const PetscScalar dN = f1[Ii] - dy[Ii] + lambda[Ii]*(y1[Ii] - y[Ii]);
+    y2[Ii] = y1[Ii] + _deltaT * etdPhi2(-_deltaT*lambda[Ii]) * dN;
+  }
+  ierr = VecRestoreArrayRead(_y._vec,&y);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(_dy._vec,&dy);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(_lambda._vec,&lambda);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(_y1._vec,&y1);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(_f1._vec,&f1);CHKERRQ(ierr);
+  ierr = VecRestoreArray(_y2._vec,&y2);CHKERRQ(ierr);
+  ierr = _y2.packedChanged();CHKERRQ(ierr);
+
+  return ierr;
+}
+
+
+PetscErrorCode ETD2_WBE::integrate(IntegratorContextImex *obj)
+{
+#if VERBOSE > 1
+  PetscPrintf(PETSC_COMM_WORLD,"Starting ETD2_WBE::integrate in odeSolverImex.cpp.\n");
+#endif
+  double startTime = MPI_Wtime();
+
+  PetscErrorCode ierr=0;
+  PetscReal      _totErr=0.0;
+  PetscInt       attemptCount = 0;
+  int            stopIntegration = 0;
+
+  // build default errInds and scale if they haven't been defined already
+  ierr = setUpErrFields("ETD2_WBE");CHKERRQ(ierr);
+
+  if (_finalT==_initT) { return ierr; }
+  else if (_deltaT==0) { _deltaT = (_finalT-_initT)/_maxNumSteps; }
+  if (_maxNumSteps == 0) { return ierr; }
+
+  // set initial condition
+  ierr = _y.copyFrom(_varEx);CHKERRQ(ierr);
+  ierr = obj->setStage(0);CHKERRQ(ierr);
+  ierr = obj->d_dt(_currT,_varEx,_dy._views);CHKERRQ(ierr);
+  ierr = _dy.fieldsChanged();CHKERRQ(ierr);
+  ierr = updateRelaxationRates(obj);CHKERRQ(ierr);
+
+  while (_stepCount<_maxNumSteps && _currT<_finalT) {
+
+    _stepCount++;
+    attemptCount = 0;
+    while (attemptCount<100) { // repeat until time step is acceptable
+      attemptCount++;
+      if (attemptCount>=100) {PetscPrintf(PETSC_COMM_WORLD,"   ETD2_WBE WARNING: maximum number of attempts reached\n"); }
+      if (_currT+_deltaT>_finalT) { _deltaT=_finalT-_currT; }
+
+      // stage 1: exponential Euler to _currT + _deltaT
+      ierr = takeStage();CHKERRQ(ierr);
+      ierr = VecSet(_f1._vec,0.0);CHKERRQ(ierr);
+      ierr = _f1.packedChanged();CHKERRQ(ierr);
+      ierr = obj->setStage(1);CHKERRQ(ierr);
+      ierr = obj->d_dt(_currT+_deltaT,_y1._views,_f1._views);CHKERRQ(ierr);
+      ierr = _f1.fieldsChanged();CHKERRQ(ierr);
+
+      // 2nd order update
+      ierr = takeUpdate();CHKERRQ(ierr);
+
+      // calculate error
+      _totErr = computeError();
+      if (_totErr<_totTol) { break; }
+      _deltaT = computeStepSize(_totErr);
+      if (_minDeltaT == _deltaT) { break; }
+
+      _numRejectedSteps++;
+    }
+
+    // accept 2nd order solution as update
+    _currT = _currT+_deltaT;
+    ierr = VecCopy(_y2._vec,_y._vec);CHKERRQ(ierr);
+    ierr = _y.packedChanged();CHKERRQ(ierr);
+    ierr = _y.copyTo(_varEx);CHKERRQ(ierr);
+    ierr = VecSet(_dy._vec,0.0);CHKERRQ(ierr);
+    ierr = _dy.packedChanged();CHKERRQ(ierr);
+
+    // update rates for explicit variables, and compute updated state for implicit variables
+    ierr = obj->setStage(0);CHKERRQ(ierr);
+    ierr = obj->d_dt(_currT,_varEx,_dy._views,_vardTIm,_varIm,_deltaT);CHKERRQ(ierr);
+    ierr = _dy.fieldsChanged();CHKERRQ(ierr);
+    ierr = updateRelaxationRates(obj);CHKERRQ(ierr);
+
+    // accept updated state for implicit variables
+    for (map<string,Vec>::iterator it = _vardTIm.begin(); it!=_vardTIm.end(); it++ ) {
+      VecCopy(_vardTIm[it->first],_varIm[it->first]);
+    }
+
+    // compute new deltaT for next time step
+    // but timeMonitor before updating to newDeltaT, to keep output consistent while allowing for checkpointing
+    if (_totErr!=0.0) { _newDeltaT = computeStepSize(_totErr); }
+    _errA.push_front(_totErr); // record error for use when estimating time step
+
+    ierr = obj->timeMonitor(_currT,_deltaT,_stepCount,stopIntegration); CHKERRQ(ierr);
+    if (stopIntegration > 0) { PetscPrintf(PETSC_COMM_WORLD,"ETD2: Detected stop time integration request.\n"); break; }
+
+    // now update deltaT
+    _deltaT = _newDeltaT;
+  }
+
+  _runTime += MPI_Wtime() - startTime;
+#if VERBOSE > 1
+  PetscPrintf(PETSC_COMM_WORLD,"Ending ETD2_WBE::integrate in odeSolverImex.cpp.\n");
+#endif
   return ierr;
 }
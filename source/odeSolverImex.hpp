@@ -11,6 +11,8 @@
 #include <boost/circular_buffer.hpp>
 #include "integratorContextImex.hpp"
 #include "genFuncs.hpp"
+#include "checkpoint.hpp"
+#include "packedVec.hpp"
 
 using namespace std;
 
@@ -24,9 +26,13 @@ using namespace std;
  *   var          map<string,Vec> of explicitly integrated variables
  *   varIm    map<string,Vec> of implicitly integrated variables
  *
+ * Internally, var and the intermediate Runge-Kutta stages are stored packed
+ * into one contiguous Vec each (see PackedVec).
+ *
  * SOLVER TYPE        ALGORITHM
  *  RK32_WBE        explicit part Runge-Kutta (2,3), implicit controlled by user
  *  RK43_WBE        explicit part Runge-Kutta (3,4), implicit controlled by user
+ *  ETD2_WBE        explicit part exponential time differencing (2,1), implicit controlled by user
  *
  *
  * At minimum, the user must specify:
@@ -47,6 +53,7 @@ using namespace std;
  *  maximum step size        setStepSize
  *  minimum step size        setTimeStepBounds
  *  initial step size        setTimeStepBounds
+ *  step sizes _bucketRatio^k setStepSizeBuckets
  *
  * Once the odeSolver context is set, call integrate() to perform
  * the integration.
@@ -64,15 +71,18 @@ public:
   PetscReal               _initT,_finalT,_currT,_deltaT;
   PetscReal          _newDeltaT; // stores future deltaT for access by outside classes, primarily for checkpointing
   PetscInt                _maxNumSteps,_stepCount;
-  map<string,Vec>         _varEx,_dvar; // explicit integration variable and rate
+  map<string,Vec>         _varEx; // explicit integration variable
+  PackedVec               _y,_dy; // packed copy of _varEx, and its rate
   map<string,Vec>         _varIm; // implicit integration variable, once per time step
   vector<string>          _errInds; // which inds of _var to use for error control
+  vector<PetscInt>        _errFields; // index of each entry of _errInds in _y
   vector<double>          _scale; // scale factor for entries in _errInds
   double                  _runTime;
   string                  _controlType;
   string                  _normType;
 
   PetscReal   _minDeltaT,_maxDeltaT;
+  PetscReal   _bucketRatio; // if > 1, step sizes are rounded down to a power of this
   PetscReal   _totTol; // total tolerance, might be atol, or rtol, or a combination of both
   PetscInt    _numRejectedSteps,_numMinSteps,_numMaxSteps;
 
@@ -86,6 +96,20 @@ public:
   // member functions
   PetscErrorCode setInitialStepCount(const PetscReal stepCount);
   PetscErrorCode setToleranceType(const string normType); // type of norm used for error control
+  PetscErrorCode setUpErrFields(const string& name); // check _errInds and _scale, and fill _errFields
+
+  // only take step sizes ratio^k, so that the implicit solve can reuse
+  // operators set up for earlier steps (see HeatEquation::getCachedKSP)
+  PetscErrorCode setStepSizeBuckets(const PetscReal ratio);
+  PetscReal snapStepSize(const PetscReal deltaT) const;
+
+  // checkpointing: step count, next step size and error history, i.e. everything
+  // needed to continue the time step sequence exactly after a restart
+  PetscErrorCode writeCheckpoint(Checkpoint& ckpt);
+  PetscErrorCode loadCheckpoint(const Checkpoint& ckpt); // call after setTimeRange
+
+  // single time step of size deltaT (see odeSolverImex.cpp)
+  PetscErrorCode step(IntegratorContextImex *obj, const PetscReal time, const PetscInt stepCount, const PetscReal deltaT);
 
   // virtual member functions are declared in base class and redefined in derived class
   virtual PetscErrorCode setTimeRange(const PetscReal initT,const PetscReal finalT) = 0;
@@ -114,7 +138,7 @@ public:
   PetscReal   _totErr; // error between 3rd order solution and embedded 2nd order solution
 
   // intermediate values for time stepping for the explicit variable
-  map<string,Vec> _k1,_f1,_k2,_f2,_y2,_y3;
+  PackedVec       _k1,_f1,_k2,_f2,_y2,_y3;
   map<string,Vec> _vardTIm;
 
   // constructor and destructor
@@ -153,8 +177,8 @@ public:
   PetscReal   _totErr;
 
   // intermediate values for time stepping for the explicit variable
-  map<string,Vec> _k1,_k2,_k3,_k4,_k5,_k6,_y4,_y3;
-  map<string,Vec> _f1,_f2,_f3,_f4,_f5,_f6;
+  PackedVec       _k2,_k3,_k4,_k5,_k6,_y4,_y3;
+  PackedVec       _f2,_f3,_f4,_f5,_f6; // f1 is _dy
 
   // intermediate value for implict variable
   map<string,Vec> _vardTIm;
@@ -177,5 +201,51 @@ public:
   PetscReal computeError();
 };
 
+
+
+// 2nd order exponential time differencing scheme (ETD2RK) from Cox and Matthews (2002):
+// "Exponential time differencing for stiff systems", for explicit variables with
+// a stiff linear relaxation term, dy/dt = -lambda*y + N(t,y), where lambda is
+// supplied pointwise by IntegratorContextImex::getLinearRelaxationRates.
+// The relaxation is integrated exactly, so the step size is not limited by 1/lambda.
+// The embedded 1st order solution is exponential Euler. Reduces to Heun's method
+// where lambda = 0. Backward Euler implicit scheme once per time step.
+// derived class from OdeSolverImex
+class ETD2_WBE : public OdeSolverImex
+{
+public:
+
+  // for P or PID error control
+  PetscReal   _kappa,_ord; // safety factor in step size determinance, order of accuracy of method
+  PetscReal   _totErr; // error between 2nd order solution and embedded 1st order solution
+
+  // intermediate values for time stepping for the explicit variable
+  PackedVec       _lambda; // relaxation rates at the last accepted solution
+  PackedVec       _y1,_f1,_y2; // exponential Euler stage, its rate, and 2nd order update
+  map<string,Vec> _vardTIm;
+
+  // constructor and destructor
+  ETD2_WBE(PetscInt maxNumSteps,PetscReal finalT,PetscReal deltaT,string controlType);
+  ~ETD2_WBE();
+
+  // member functions
+  PetscErrorCode setTimeRange(const PetscReal initT,const PetscReal finalT);
+  PetscErrorCode setStepSize(const PetscReal deltaT);
+  PetscErrorCode setTolerance(const PetscReal tol);
+  PetscErrorCode setTimeStepBounds(const PetscReal minDeltaT, const PetscReal maxDeltaT);
+  PetscErrorCode setInitialConds(map<string,Vec>& varEx, map<string,Vec>& varIm);
+  PetscErrorCode setErrInds(vector<string>& errInds);
+  PetscErrorCode setErrInds(vector<string>& errInds, vector<double> scale);
+  PetscErrorCode view();
+  PetscErrorCode integrate(IntegratorContextImex *obj);
+  PetscReal computeStepSize(const PetscReal totErr);
+  PetscReal computeError();
+
+private:
+  PetscErrorCode updateRelaxationRates(IntegratorContextImex *obj);
+  PetscErrorCode takeStage();
+  PetscErrorCode takeUpdate();
+};
+
 #endif
 
@@ -24,10 +24,8 @@ OdeSolver_WaveEq::~OdeSolver_WaveEq()
   PetscPrintf(PETSC_COMM_WORLD,"Starting RK43::destructor in odeSolver.cpp.\n");
 #endif
 
-  // destruct temporary containers
-  destroyVector(_varNext);
-  destroyVector(_var);
-  destroyVector(_varPrev);
+  // _varNext, _var, and _varPrev are views into the packed containers,
+  // which are freed by their own destructors
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending RK43::destructor in odeSolver.cpp.\n");
@@ -96,17 +94,19 @@ PetscErrorCode OdeSolver_WaveEq::setInitialConds(std::map<string,Vec>& var)
   double startTime = MPI_Wtime();
   PetscErrorCode ierr = 0;
 
-  for (map<string,Vec>::iterator it = var.begin(); it != var.end(); it++ ) {
+  // allocate n: var
+  ierr = _y.create(var);CHKERRQ(ierr);
+  ierr = _y.copyFrom(var);CHKERRQ(ierr);
+  _var = _y._views;
 
-    // allocate n: var
-    VecDuplicate(var[it->first],&_var[it->first]); VecCopy(var[it->first],_var[it->first]);
+  // allocate n-1: varPrev
+  ierr = _yPrev.duplicate(_y);CHKERRQ(ierr);
+  ierr = _yPrev.copyFrom(var);CHKERRQ(ierr);
+  _varPrev = _yPrev._views;
 
-    // allocate n-1: varPrev
-    VecDuplicate(var[it->first],&_varPrev[it->first]); VecCopy(var[it->first],_varPrev[it->first]);
-
-    // allocate n+1: varNext
-    VecDuplicate(var[it->first],&_varNext[it->first]); VecSet(_varNext[it->first],0.);
-  }
+  // allocate n+1: varNext
+  ierr = _yNext.duplicate(_y);CHKERRQ(ierr);
+  _varNext = _yNext._views;
 
   _runTime += MPI_Wtime() - startTime;
 #if VERBOSE > 1
@@ -123,17 +123,19 @@ PetscErrorCode OdeSolver_WaveEq::setInitialConds(std::map<string,Vec>& var,std::
   double startTime = MPI_Wtime();
   PetscErrorCode ierr = 0;
 
-  for (map<string,Vec>::iterator it = var.begin(); it != var.end(); it++ ) {
+  // allocate n: var
+  ierr = _y.create(var);CHKERRQ(ierr);
+  ierr = _y.copyFrom(var);CHKERRQ(ierr);
+  _var = _y._views;
 
-    // allocate n: var
-    VecDuplicate(var[it->first],&_var[it->first]); VecCopy(var[it->first],_var[it->first]);
+  // allocate n-1: varPrev
+  ierr = _yPrev.duplicate(_y);CHKERRQ(ierr);
+  ierr = _yPrev.copyFrom(varPrev);CHKERRQ(ierr);
+  _varPrev = _yPrev._views;
 
-    // allocate n-1: varPrev
-    VecDuplicate(varPrev[it->first],&_varPrev[it->first]); VecCopy(varPrev[it->first],_varPrev[it->first]);
-
-    // allocate n+1: varNext
-    VecDuplicate(var[it->first],&_varNext[it->first]); VecSet(_varNext[it->first],0.);
-  }
+  // allocate n+1: varNext
+  ierr = _yNext.duplicate(_y);CHKERRQ(ierr);
+  _varNext = _yNext._views;
 
   _runTime += MPI_Wtime() - startTime;
 #if VERBOSE > 1
@@ -164,13 +166,16 @@ PetscErrorCode OdeSolver_WaveEq::integrate(IntegratorContext_WaveEq *obj)
     if (_currT>_finalT) { _currT = _finalT; }
     _stepCount++;
     ierr = obj->d_dt(_currT,_deltaT,_varNext,_var,_varPrev);CHKERRQ(ierr);
-
-    // accept time step and update
-    for (map<string,Vec>::iterator it = _var.begin(); it != _var.end(); it++ ) {
-      VecCopy(_var[it->first],_varPrev[it->first]);
-      VecCopy(_varNext[it->first],_var[it->first]);
-      VecSet(_varNext[it->first],0.0);
-    }
+    ierr = _yNext.fieldsChanged();CHKERRQ(ierr);
+
+    // accept time step and update: rotate the buffers instead of copying,
+    // n-1 <- n, n <- n+1, and n+1 reuses the storage of n-1
+    ierr = _yPrev.swap(_y);CHKERRQ(ierr);
+    ierr = _y.swap(_yNext);CHKERRQ(ierr);
+    _varPrev.swap(_var);
+    _var.swap(_varNext);
+    ierr = VecSet(_yNext._vec,0.0);CHKERRQ(ierr);
+    ierr = _yNext.packedChanged();CHKERRQ(ierr);
 
     ierr = obj->timeMonitor(_currT,_deltaT,_stepCount,stopIntegration);CHKERRQ(ierr);
     if (stopIntegration > 0) { PetscPrintf(PETSC_COMM_WORLD,"OdeSolver WaveEq: Detected stop time integration request.\n"); break; }
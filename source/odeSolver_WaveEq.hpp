@@ -9,6 +9,7 @@
 #include <assert.h>
 #include "integratorContext_WaveEq.hpp"
 #include "genFuncs.hpp"
+#include "packedVec.hpp"
 
 
 class OdeSolver_WaveEq
@@ -17,7 +18,8 @@ class OdeSolver_WaveEq
 
     PetscScalar             _initT,_finalT,_currT,_deltaT;
     PetscInt                _maxNumSteps,_stepCount;
-    std::map<string,Vec>    _varNext,_var,_varPrev; // variable at time step: n+1, n, n-1
+    PackedVec               _yNext,_y,_yPrev; // all fields at time step: n+1, n, n-1, packed into one Vec each
+    std::map<string,Vec>    _varNext,_var,_varPrev; // views of the fields in _yNext, _y, _yPrev
     int                     _lenVar;
     double                  _runTime;
 
@@ -35,6 +37,8 @@ class OdeSolver_WaveEq
     PetscErrorCode view();
     PetscErrorCode integrate(IntegratorContext_WaveEq *obj);
 
+    // the buffers are rotated every time step, so the Vecs for time step n
+    // must be looked up through this after integrating, not cached
     std::map<string,Vec>& getVar(){return _var;};
 };
 
@@ -171,11 +171,12 @@ PetscErrorCode OdeSolver_WaveEq_Imex::integrate(IntegratorContext_WaveEq_Imex *o
     _stepCount++;
     ierr = obj->d_dt(_currT,_deltaT,_varNext,_var,_varPrev,_varIm, _varImPrev); CHKERRQ(ierr);
 
-    // accept time step and update explicitly integrated variables
-    for (map<string,Vec>::iterator it = _var.begin(); it != _var.end(); it++ ) {
-      VecCopy(_var[it->first],_varPrev[it->first]);
-      VecCopy(_varNext[it->first],_var[it->first]);
-      VecSet(_varNext[it->first],0.0);
+    // accept time step and update explicitly integrated variables: rotate
+    // the buffers instead of copying, n-1 <- n, n <- n+1, and n+1 reuses the storage of n-1
+    _varPrev.swap(_var);
+    _var.swap(_varNext);
+    for (map<string,Vec>::iterator it = _varNext.begin(); it != _varNext.end(); it++ ) {
+      VecSet(it->second,0.0);
     }
 
     // accept updated state for implicit variables
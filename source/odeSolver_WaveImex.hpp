@@ -36,6 +36,8 @@ class OdeSolver_WaveEq_Imex
     PetscErrorCode view();
     PetscErrorCode integrate(IntegratorContext_WaveEq_Imex *obj);
 
+    // the buffers are rotated every time step, so the Vecs for time step n
+    // must be looked up through this after integrating, not cached
     std::map<string,Vec>& getVar(){return _var;};
 };
 
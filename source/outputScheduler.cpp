@@ -0,0 +1,186 @@
+#include "outputScheduler.hpp"
+
+#define FILENAME "outputScheduler.cpp"
+
+using namespace std;
+
+
+OutputScheduler::OutputScheduler(const char *file, const string delim, const string dim)
+: _file(file),_delim(delim),_dim(dim),_cadence("stride"),
+  _timeInterval(-1),_velThreshold(-1),_fastStride(1),_fieldTol(-1),_numWrites(0),
+  _lastStep(0),_lastTime(0),_wasFast(false)
+{
+  #if VERBOSE > 1
+    string funcName = "OutputScheduler::OutputScheduler";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  loadSettings(_file);
+  checkInput();
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+}
+
+
+OutputScheduler::~OutputScheduler()
+{
+  for (map<string,Vec>::iterator it = _lastFields.begin(); it != _lastFields.end(); it++) {
+    VecDestroy(&it->second);
+  }
+}
+
+
+PetscErrorCode OutputScheduler::loadSettings(const char *file)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "OutputScheduler::loadSettings";
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);CHKERRQ(ierr);
+  #endif
+
+  ifstream infile( file );
+  string line, var, rhs;
+  size_t pos = 0;
+  while (getline(infile, line)) {
+    istringstream iss(line);
+    pos = line.find(_delim); // find position of the delimiter
+    var = line.substr(0,pos);
+    rhs = "";
+    if (line.length() > (pos + _delim.length())) {
+      rhs = line.substr(pos+_delim.length(),line.npos);
+    }
+
+    // interpret everything after the appearance of a space on the line as a comment
+    pos = rhs.find(" ");
+    rhs = rhs.substr(0,pos);
+
+    if (var.compare("outputCadence" + _dim) == 0) { _cadence = rhs; }
+    else if (var.compare("outputTimeInterval" + _dim) == 0) { _timeInterval = atof(rhs.c_str()); }
+    else if (var.compare("outputVelThreshold" + _dim) == 0) { _velThreshold = atof(rhs.c_str()); }
+    else if (var.compare("outputFastStride" + _dim) == 0) { _fastStride = (int)atof(rhs.c_str()); }
+    else if (var.compare("outputFieldTol" + _dim) == 0) { _fieldTol = atof(rhs.c_str()); }
+  }
+
+  #if VERBOSE > 1
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);CHKERRQ(ierr);
+  #endif
+  return ierr;
+}
+
+
+PetscErrorCode OutputScheduler::checkInput()
+{
+  PetscErrorCode ierr = 0;
+
+  assert(_dim.compare("1D") == 0 || _dim.compare("2D") == 0);
+  assert(_cadence.compare("stride") == 0 || _cadence.compare("event") == 0);
+  assert(_fastStride >= 1);
+
+  return ierr;
+}
+
+
+PetscErrorCode OutputScheduler::checkWrite(const PetscInt stepCount, const PetscInt stride, const PetscScalar time,
+  const PetscScalar maxTime, const Vec& slipVel, const map<string,Vec>& fields, bool& write)
+{
+  PetscErrorCode ierr = 0;
+  write = false;
+  if (stride <= 0) { return ierr; } // output is turned off
+
+  if (_cadence.compare("stride") == 0) {
+    write = (time == maxTime) || (stepCount % stride == 0);
+    if (write) { _numWrites++; }
+    return ierr;
+  }
+
+  // event-driven output
+  write = (_numWrites == 0) || (time == maxTime);
+  if (_timeInterval > 0 && time - _lastTime >= _timeInterval) { write = true; }
+  if (_velThreshold > 0) {
+    PetscScalar maxVel = 0;
+    ierr = VecNorm(slipVel,NORM_INFINITY,&maxVel);CHKERRQ(ierr);
+    const bool isFast = maxVel >= _velThreshold;
+    if (isFast != _wasFast) { write = true; } // start or end of an event
+    else if (isFast && stepCount - _lastStep >= _fastStride) { write = true; }
+    _wasFast = isFast;
+  }
+  if (!write && _fieldTol > 0) {
+    ierr = fieldsChanged(fields,write);CHKERRQ(ierr);
+  }
+
+  if (write) { ierr = recordWrite(stepCount,time,fields);CHKERRQ(ierr); }
+  return ierr;
+}
+
+
+// whether any field changed by more than _fieldTol since the last write,
+// with one reduction for all the fields
+PetscErrorCode OutputScheduler::fieldsChanged(const map<string,Vec>& fields, bool& changed)
+{
+  PetscErrorCode ierr = 0;
+  changed = false;
+  if (_lastFields.empty()) { changed = true; return ierr; }
+
+  // local max norms: [0,n) for the change, [n,2n) for the field at the last write
+  const size_t n = fields.size();
+  vector<PetscReal> part(2*n,0.0);
+  size_t j = 0;
+  for (map<string,Vec>::const_iterator it = fields.begin(); it != fields.end(); it++, j++) {
+    map<string,Vec>::iterator last = _lastFields.find(it->first);
+    assert(last != _lastFields.end());
+
+    PetscInt nLocal = 0;
+    const PetscScalar *x,*xLast;
+    ierr = VecGetLocalSize(it->second,&nLocal);CHKERRQ(ierr);
+    ierr = VecGetArrayRead(it->second,&x);CHKERRQ(ierr);
+    ierr = VecGetArrayRead(last->second,&xLast);CHKERRQ(ierr);
+    for (PetscInt Ii = 0; Ii < nLocal; Ii++) {
+      part[j] = max(part[j],(PetscReal) PetscAbsScalar(x[Ii] - xLast[Ii]));
+      part[n + j] = max(part[n + j],(PetscReal) PetscAbsScalar(xLast[Ii]));
+    }
+    ierr = VecRestoreArrayRead(it->second,&x);CHKERRQ(ierr);
+    ierr = VecRestoreArrayRead(last->second,&xLast);CHKERRQ(ierr);
+  }
+  ierr = MPI_Allreduce(MPI_IN_PLACE,&part[0],(int) part.size(),MPIU_REAL,MPI_MAX,PETSC_COMM_WORLD);CHKERRQ(ierr);
+
+  for (j = 0; j < n; j++) {
+    if (part[j] > _fieldTol * max(part[n + j],(PetscReal) PETSC_MACHINE_EPSILON)) { changed = true; }
+  }
+  return ierr;
+}
+
+
+PetscErrorCode OutputScheduler::recordWrite(const PetscInt stepCount, const PetscScalar time, const map<string,Vec>& fields)
+{
+  PetscErrorCode ierr = 0;
+  _numWrites++;
+  _lastStep = stepCount;
+  _lastTime = time;
+
+  if (_fieldTol <= 0) { return ierr; }
+  for (map<string,Vec>::const_iterator it = fields.begin(); it != fields.end(); it++) {
+    if (_lastFields.find(it->first) == _lastFields.end()) {
+      ierr = VecDuplicate(it->second,&_lastFields[it->first]);CHKERRQ(ierr);
+    }
+    ierr = VecCopy(it->second,_lastFields[it->first]);CHKERRQ(ierr);
+  }
+  return ierr;
+}
+
+
+PetscErrorCode OutputScheduler::writeContext(PetscViewer& viewer)
+{
+  PetscErrorCode ierr = 0;
+
+  ierr = PetscViewerASCIIPrintf(viewer,"outputCadence%s = %s\n",_dim.c_str(),_cadence.c_str());CHKERRQ(ierr);
+  if (_cadence.compare("event") == 0) {
+    ierr = PetscViewerASCIIPrintf(viewer,"outputTimeInterval%s = %.15e # (s)\n",_dim.c_str(),_timeInterval);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"outputVelThreshold%s = %.15e # (m/s)\n",_dim.c_str(),_velThreshold);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"outputFastStride%s = %i\n",_dim.c_str(),_fastStride);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"outputFieldTol%s = %.15e\n",_dim.c_str(),_fieldTol);CHKERRQ(ierr);
+  }
+
+  return ierr;
+}
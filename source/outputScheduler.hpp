@@ -0,0 +1,80 @@
+#ifndef OUTPUTSCHEDULER_HPP_INCLUDED
+#define OUTPUTSCHEDULER_HPP_INCLUDED
+
+#include <petscksp.h>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <algorithm>
+#include <assert.h>
+
+using namespace std;
+
+/*
+ * Decides at which time steps a mediator writes its 1D or 2D output.
+ * Each mediator has one scheduler for 1D output and one for 2D output, and
+ * they are configured separately in the input file, with options ending in
+ * 1D or 2D respectively.
+ *
+ * outputCadence1D = stride (default): write every stride1D time steps, as
+ *   before.
+ * outputCadence1D = event: write when any of the following is true
+ *   - outputTimeInterval1D (s) of simulated time have passed since the last
+ *     write,
+ *   - the max slip velocity is above outputVelThreshold1D (m/s): every
+ *     outputFastStride1D time steps, and when it crosses the threshold in
+ *     either direction,
+ *   - slip or shear stress on the fault changed by more than
+ *     outputFieldTol1D, relative to its max norm, since the last write.
+ *   Each trigger is turned off by a value <= 0, which is the default.
+ *
+ * In either case the first step and the final time are always written, and
+ * a stride <= 0 turns the output off altogether.
+ *
+ */
+
+class OutputScheduler
+{
+public:
+
+  const char   *_file;
+  string        _delim;
+  string        _dim; // "1D" or "2D", suffix of the input file options
+  string        _cadence; // "stride" or "event"
+  PetscScalar   _timeInterval; // (s)
+  PetscScalar   _velThreshold; // (m/s)
+  PetscInt      _fastStride; // # of time steps between writes above _velThreshold
+  PetscScalar   _fieldTol; // relative change in a field
+  PetscInt      _numWrites;
+
+  OutputScheduler(const char *file, const string delim, const string dim);
+  ~OutputScheduler();
+
+  // set write = true if output should be written at this step, and if so
+  // remember the state of fields for the next call (collective)
+  // slipVel and fields are only used for outputCadence = event
+  PetscErrorCode checkWrite(const PetscInt stepCount, const PetscInt stride, const PetscScalar time,
+    const PetscScalar maxTime, const Vec& slipVel, const map<string,Vec>& fields, bool& write);
+
+  PetscErrorCode writeContext(PetscViewer& viewer);
+
+private:
+  // disable default copy constructor and assignment operator
+  OutputScheduler(const OutputScheduler& that);
+  OutputScheduler& operator=(const OutputScheduler& rhs);
+
+  PetscInt        _lastStep; // time step of the last write
+  PetscScalar     _lastTime; // time of the last write
+  bool            _wasFast; // whether the slip velocity was above _velThreshold at the last call
+  map<string,Vec> _lastFields; // fields at the last write
+
+  PetscErrorCode loadSettings(const char *file);
+  PetscErrorCode checkInput();
+  PetscErrorCode fieldsChanged(const map<string,Vec>& fields, bool& changed);
+  PetscErrorCode recordWrite(const PetscInt stepCount, const PetscScalar time, const map<string,Vec>& fields);
+};
+
+#endif
@@ -0,0 +1,239 @@
+#include "packedVec.hpp"
+
+using namespace std;
+
+PackedVec::PackedVec()
+: _vec(NULL),_localSize(0),_comm(PETSC_COMM_WORLD),_array(NULL)
+{ }
+
+PackedVec::~PackedVec()
+{
+  destroy();
+}
+
+
+// allocate one contiguous array for all the fields in layout, and create
+// _vec and _views on it
+PetscErrorCode PackedVec::create(const map<string,Vec>& layout)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Starting PackedVec::create in packedVec.cpp.\n");CHKERRQ(ierr);
+  #endif
+
+  ierr = destroy();CHKERRQ(ierr);
+  assert(layout.size() > 0);
+
+  ierr = PetscObjectGetComm((PetscObject) layout.begin()->second,&_comm);CHKERRQ(ierr);
+
+  PetscInt globalSize = 0;
+  _localSize = 0;
+  for (map<string,Vec>::const_iterator it = layout.begin(); it != layout.end(); it++) {
+    PetscInt nLocal = 0, nGlobal = 0;
+    ierr = VecGetLocalSize(it->second,&nLocal);CHKERRQ(ierr);
+    ierr = VecGetSize(it->second,&nGlobal);CHKERRQ(ierr);
+    _keys.push_back(it->first);
+    _offsets.push_back(_localSize);
+    _localSizes.push_back(nLocal);
+    _globalSizes.push_back(nGlobal);
+    _localSize += nLocal;
+    globalSize += nGlobal;
+  }
+
+  ierr = PetscMalloc1(_localSize,&_array);CHKERRQ(ierr);
+  ierr = VecCreateMPIWithArray(_comm,1,_localSize,globalSize,_array,&_vec);CHKERRQ(ierr);
+  for (size_t i = 0; i < _keys.size(); i++) {
+    Vec view;
+    ierr = VecCreateMPIWithArray(_comm,1,_localSizes[i],_globalSizes[i],_array + _offsets[i],&view);CHKERRQ(ierr);
+    _views[_keys[i]] = view;
+  }
+  ierr = VecSet(_vec,0.0);CHKERRQ(ierr);
+  ierr = packedChanged();CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending PackedVec::create in packedVec.cpp.\n");CHKERRQ(ierr);
+  #endif
+  return ierr;
+}
+
+
+// allocate storage with the same fields as that
+PetscErrorCode PackedVec::duplicate(const PackedVec& that)
+{
+  PetscErrorCode ierr = 0;
+  ierr = create(that._views);CHKERRQ(ierr);
+  return ierr;
+}
+
+
+PetscErrorCode PackedVec::destroy()
+{
+  PetscErrorCode ierr = 0;
+
+  // views must be destroyed before the storage they point to
+  for (map<string,Vec>::iterator it = _views.begin(); it != _views.end(); it++) {
+    ierr = VecDestroy(&it->second);CHKERRQ(ierr);
+  }
+  _views.clear();
+  if (_vec != NULL) { ierr = VecDestroy(&_vec);CHKERRQ(ierr); }
+  if (_array != NULL) { ierr = PetscFree(_array);CHKERRQ(ierr); }
+  _vec = NULL;
+  _array = NULL;
+
+  _keys.clear();
+  _offsets.clear();
+  _localSizes.clear();
+  _globalSizes.clear();
+  _localSize = 0;
+
+  return ierr;
+}
+
+
+// copy values from var into the packed fields
+PetscErrorCode PackedVec::copyFrom(const map<string,Vec>& var)
+{
+  PetscErrorCode ierr = 0;
+  for (map<string,Vec>::iterator it = _views.begin(); it != _views.end(); it++) {
+    map<string,Vec>::const_iterator src = var.find(it->first);
+    assert(src != var.end());
+    ierr = VecCopy(src->second,it->second);CHKERRQ(ierr);
+  }
+  ierr = fieldsChanged();CHKERRQ(ierr);
+  return ierr;
+}
+
+
+// copy values of the packed fields into var
+PetscErrorCode PackedVec::copyTo(map<string,Vec>& var) const
+{
+  PetscErrorCode ierr = 0;
+  for (map<string,Vec>::const_iterator it = _views.begin(); it != _views.end(); it++) {
+    map<string,Vec>::iterator dest = var.find(it->first);
+    assert(dest != var.end());
+    ierr = VecCopy(it->second,dest->second);CHKERRQ(ierr);
+  }
+  return ierr;
+}
+
+
+// call after writing to the fields through _views
+PetscErrorCode PackedVec::fieldsChanged()
+{
+  PetscErrorCode ierr = 0;
+  ierr = PetscObjectStateIncrease((PetscObject) _vec);CHKERRQ(ierr);
+  return ierr;
+}
+
+
+// exchange storage with that, which must have the same fields
+PetscErrorCode PackedVec::swap(PackedVec& that)
+{
+  PetscErrorCode ierr = 0;
+  assert(_keys == that._keys && _localSize == that._localSize);
+  std::swap(_vec,that._vec);
+  std::swap(_array,that._array);
+  _views.swap(that._views);
+  return ierr;
+}
+
+
+// call after writing to _vec
+PetscErrorCode PackedVec::packedChanged()
+{
+  PetscErrorCode ierr = 0;
+  for (map<string,Vec>::iterator it = _views.begin(); it != _views.end(); it++) {
+    ierr = PetscObjectStateIncrease((PetscObject) it->second);CHKERRQ(ierr);
+  }
+  return ierr;
+}
+
+
+PetscInt PackedVec::fieldIndex(const string& key) const
+{
+  for (size_t i = 0; i < _keys.size(); i++) {
+    if (_keys[i].compare(key) == 0) { return (PetscInt) i; }
+  }
+  return -1;
+}
+
+
+bool PackedVec::hasLayout(const map<string,Vec>& layout) const
+{
+  if (_vec == NULL || layout.size() != _keys.size()) { return false; }
+
+  size_t i = 0;
+  for (map<string,Vec>::const_iterator it = layout.begin(); it != layout.end(); it++, i++) {
+    PetscInt nLocal = 0;
+    VecGetLocalSize(it->second,&nLocal);
+    if (it->first.compare(_keys[i]) != 0 || nLocal != _localSizes[i]) { return false; }
+  }
+  return true;
+}
+
+
+// embedded error estimate, see header
+// All local partial results (sums of squares, or maxima) are reduced
+// together, so this costs one MPI_Allreduce regardless of the number of
+// fields, and the difference a - b is never stored.
+PetscErrorCode PackedVec::errorNorm(const PackedVec& a, const PackedVec& b, const vector<PetscInt>& inds,
+  const vector<double>& scale, const string& normType, PetscReal& totErr)
+{
+  PetscErrorCode ierr = 0;
+  totErr = 0;
+  const size_t nInds = inds.size();
+  if (nInds == 0) { return ierr; }
+  assert(scale.size() == nInds);
+  assert(a._localSize == b._localSize);
+
+  const bool isMax = normType.compare("max_relative") == 0;
+  const bool isRelative = normType.compare("L2_relative") == 0;
+  assert(isMax || isRelative || normType.compare("L2_absolute") == 0);
+
+  // local partial results: [0,nInds) for e, [nInds,2*nInds) for b if needed
+  vector<PetscReal> part(isRelative ? 2*nInds : nInds, isMax ? PETSC_MIN_REAL : 0.0);
+
+  const PetscScalar *aa,*bb;
+  ierr = VecGetArrayRead(a._vec,&aa);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(b._vec,&bb);CHKERRQ(ierr);
+  for (size_t j = 0; j < nInds; j++) {
+    const PetscInt start = a._offsets[inds[j]];
+    const PetscInt end = start + a._localSizes[inds[j]];
+    if (isMax) {
+      PetscReal m = part[j];
+      for (PetscInt k = start; k < end; k++) {
+        m = max(m,(PetscReal) (PetscAbsScalar(aa[k] - bb[k]) / bb[k]));
+      }
+      part[j] = m;
+    }
+    else {
+      PetscReal e2 = 0, b2 = 0;
+      for (PetscInt k = start; k < end; k++) {
+        const PetscScalar d = aa[k] - bb[k];
+        e2 += d*d;
+        b2 += bb[k]*bb[k];
+      }
+      part[j] = e2;
+      if (isRelative) { part[nInds + j] = b2; }
+    }
+  }
+  ierr = VecRestoreArrayRead(a._vec,&aa);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(b._vec,&bb);CHKERRQ(ierr);
+
+  ierr = MPI_Allreduce(MPI_IN_PLACE,&part[0],(int) part.size(),MPIU_REAL,isMax ? MPI_MAX : MPI_SUM,a._comm);CHKERRQ(ierr);
+
+  for (size_t j = 0; j < nInds; j++) {
+    if (isMax) {
+      assert(!isinf(part[j]));
+      totErr += part[j] / scale[j];
+    }
+    else if (isRelative) {
+      totErr += sqrt(part[j]) / (sqrt(part[nInds + j]) * scale[j]);
+    }
+    else {
+      totErr += sqrt(part[j]) / (sqrt((PetscReal) a._globalSizes[inds[j]]) * scale[j]);
+    }
+  }
+
+  return ierr;
+}
@@ -0,0 +1,90 @@
+#ifndef PACKEDVEC_HPP_INCLUDED
+#define PACKEDVEC_HPP_INCLUDED
+
+#include <petscvec.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <algorithm>
+#include <assert.h>
+
+using namespace std;
+
+/*
+ * Stores a set of named fields (for example "slip", "psi", "gammaVxy")
+ * in one contiguous Vec, so that linear combinations of the whole state
+ * (such as Runge-Kutta stage updates) take one VecWAXPY/VecMAXPY instead
+ * of one call per field, and the error norms of several fields take one
+ * reduction.
+ *
+ * Each field is also available as a Vec (_views) that shares storage with
+ * _vec, with the same size and parallel layout as the Vec the field was
+ * created from, so the fields can still be passed to functions that take
+ * a map<string,Vec>, such as IntegratorContextEx::d_dt.
+ *
+ * PETSc caches norms in each Vec, so after writing to the fields through
+ * _views call fieldsChanged(), and after writing to _vec call
+ * packedChanged(), so that no stale cached values are used.
+ *
+ */
+
+class PackedVec
+{
+public:
+
+  Vec                  _vec; // all fields, contiguous on each processor
+  map<string,Vec>      _views; // each field, sharing storage with _vec
+  vector<string>       _keys; // field names, in storage order
+  vector<PetscInt>     _offsets; // offset of each field in the local part of _vec
+  vector<PetscInt>     _localSizes,_globalSizes; // size of each field
+  PetscInt             _localSize;
+  MPI_Comm             _comm;
+
+  PackedVec();
+  ~PackedVec();
+
+  // allocate storage for the fields in layout (values are not copied)
+  PetscErrorCode create(const map<string,Vec>& layout);
+  PetscErrorCode duplicate(const PackedVec& that);
+  PetscErrorCode destroy();
+
+  // copy values between the packed fields and a map with the same fields
+  PetscErrorCode copyFrom(const map<string,Vec>& var);
+  PetscErrorCode copyTo(map<string,Vec>& var) const;
+
+  // exchange storage with that, which must have the same fields
+  // (O(1): no values are copied, and views are swapped along with _vec)
+  PetscErrorCode swap(PackedVec& that);
+
+  // mark cached values as out of date
+  PetscErrorCode fieldsChanged();
+  PetscErrorCode packedChanged();
+
+  // position of field key in _keys, or -1 if it is not a field
+  PetscInt fieldIndex(const string& key) const;
+
+  // whether storage has been allocated for exactly the fields in layout,
+  // with the same local sizes, so that it can be reused for them
+  bool hasLayout(const map<string,Vec>& layout) const;
+
+  // embedded error estimate for adaptive time stepping, from the
+  // difference e = a - b of two solutions with the same fields
+  // Computes e, the weights, and the norm of every field in inds in one pass
+  // over the local arrays and one MPI_Allreduce, and returns the sum over
+  // the fields j of
+  //   normType "L2_absolute":  ||e_j|| / (sqrt(N_j) * scale_j)
+  //   normType "L2_relative":  ||e_j|| / (||b_j|| * scale_j)
+  //   normType "max_relative": max_k(|e_jk| / b_jk) / scale_j
+  static PetscErrorCode errorNorm(const PackedVec& a, const PackedVec& b, const vector<PetscInt>& inds,
+    const vector<double>& scale, const string& normType, PetscReal& totErr);
+
+private:
+  PetscScalar         *_array; // storage shared by _vec and _views
+
+  // disable default copy constructor and assignment operator
+  PackedVec(const PackedVec& that);
+  PackedVec& operator=(const PackedVec& rhs);
+};
+
+#endif
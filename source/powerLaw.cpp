@@ -4,6 +4,33 @@
 
 using namespace std;
 
+// whether v has the same value everywhere, and if so which (collective)
+static PetscErrorCode isUniform(const Vec& v, bool& uniform, PetscScalar& val)
+{
+  PetscErrorCode ierr = 0;
+  PetscScalar minVal = 0, maxVal = 0;
+  ierr = VecMin(v,NULL,&minVal);CHKERRQ(ierr);
+  ierr = VecMax(v,NULL,&maxVal);CHKERRQ(ierr);
+  uniform = (minVal == maxVal);
+  val = minVal;
+  return ierr;
+}
+
+// exponent p as a small nonnegative integer, or -1 if it is not one
+static int smallIntExponent(const bool uniform, const PetscScalar p)
+{
+  if (uniform && p >= 0 && p <= 4 && p == floor(p)) { return (int) p; }
+  return -1;
+}
+
+// s^p by repeated multiplication
+static inline PetscScalar intPow(const PetscScalar s, const int p)
+{
+  PetscScalar val = 1.0;
+  for (int i = 0; i < p; i++) { val *= s; }
+  return val;
+}
+
 //======================================================================
 // pseudoplasticity class
 
@@ -186,43 +213,12 @@ PetscErrorCode Pseudoplasticity::guessInvEffVisc(const double dg)
 }
 
 
-// compute 1 / (effective viscosity)
-PetscErrorCode Pseudoplasticity::computeInvEffVisc(const Vec& dgdev)
-{
-  PetscErrorCode ierr = 0;
-  #if VERBOSE > 1
-    string funcName = "Pseudoplasticity::computeInvEffVisc()";
-    ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
-    CHKERRQ(ierr);
-  #endif
-
-  PetscScalar const *dg=0,*sy=0;
-  PetscScalar *invEffVisc=0;
-  PetscInt Ii,Istart,Iend;
-  VecGetOwnershipRange(_invEffVisc,&Istart,&Iend);
-  VecGetArrayRead(_yieldStress,&sy);
-  VecGetArrayRead(dgdev,&dg);
-  VecGetArray(_invEffVisc,&invEffVisc);
-  PetscInt Jj = 0;
-  for (Ii=Istart;Ii<Iend;Ii++) {
-    invEffVisc[Jj] = dg[Jj] / sy[Jj];
-    Jj++;
-  }
-  VecRestoreArrayRead(dgdev,&dg);
-  VecRestoreArray(_invEffVisc,&invEffVisc);
-
-  #if VERBOSE > 1
-    ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
-    CHKERRQ(ierr);
-  #endif
-  return ierr;
-}
-
 //======================================================================
 // dislocation creep class
 
 DislocationCreep::DislocationCreep(const Vec& y, const Vec& z, const char *file, const string delim)
-  : _file(file),_delim(delim),_inputDir("unspecified"),_y(&y),_z(&z)
+  : _file(file),_delim(delim),_inputDir("unspecified"),_y(&y),_z(&z),
+    _nIsUniform(false),_nUniform(0)
 {
   #if VERBOSE > 1
     string funcName = "DislocationCreep::DislocationCreep";
@@ -233,6 +229,7 @@ DislocationCreep::DislocationCreep(const Vec& y, const Vec& z, const char *file,
   checkInput();
   setMaterialParameters();
   loadFieldsFromFiles();
+  isUniform(_n,_nIsUniform,_nUniform);
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -434,51 +431,13 @@ PetscErrorCode DislocationCreep::guessInvEffVisc(const Vec& Temp,const double dg
   return ierr;
 }
 
-// compute 1 / (effective viscosity)
-PetscErrorCode DislocationCreep::computeInvEffVisc(const Vec& Temp,const Vec& sdev)
-{
-  PetscErrorCode ierr = 0;
-  #if VERBOSE > 1
-    string funcName = "DislocationCreep::computeInvEffVisc";
-    ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
-    CHKERRQ(ierr);
-  #endif
-
-  PetscScalar const *s,*A,*B,*n,*T=0;
-  PetscScalar *invEffVisc=0;
-  PetscInt Ii,Istart,Iend;
-  VecGetOwnershipRange(_invEffVisc,&Istart,&Iend);
-  VecGetArrayRead(sdev,&s);
-  VecGetArrayRead(_A,&A);
-  VecGetArrayRead(_QR,&B);
-  VecGetArrayRead(_n,&n);
-  VecGetArrayRead(Temp,&T);
-  VecGetArray(_invEffVisc,&invEffVisc);
-  PetscInt Jj = 0;
-  for (Ii=Istart;Ii<Iend;Ii++) {
-    invEffVisc[Jj] = 1e3 * A[Jj] * pow(s[Jj],n[Jj]-1.0) * exp(-B[Jj]/T[Jj]);
-    Jj++;
-  }
-  VecRestoreArrayRead(sdev,&s);
-  VecRestoreArrayRead(_A,&A);
-  VecRestoreArrayRead(_QR,&B);
-  VecRestoreArrayRead(_n,&n);
-  VecRestoreArrayRead(Temp,&T);
-  VecRestoreArray(_invEffVisc,&invEffVisc);
-
-  #if VERBOSE > 1
-    ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
-    CHKERRQ(ierr);
-  #endif
-  return ierr;
-}
-
 //======================================================================
 // diffusion creep class
 
 
 DiffusionCreep::DiffusionCreep(const Vec& y, const Vec& z, const char *file, const string delim)
-  : _file(file),_delim(delim),_inputDir("unspecified"),_y(&y),_z(&z)
+  : _file(file),_delim(delim),_inputDir("unspecified"),_y(&y),_z(&z),
+    _nIsUniform(false),_mIsUniform(false),_nUniform(0),_mUniform(0)
 {
   #if VERBOSE > 1
     string funcName = "DiffusionCreep::DiffusionCreep";
@@ -489,6 +448,8 @@ DiffusionCreep::DiffusionCreep(const Vec& y, const Vec& z, const char *file, con
   checkInput();
   setMaterialParameters();
   loadFieldsFromFiles();
+  isUniform(_n,_nIsUniform,_nUniform);
+  isUniform(_m,_mIsUniform,_mUniform);
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -702,49 +663,6 @@ PetscErrorCode DiffusionCreep::guessInvEffVisc(const Vec& Temp,const double dg,c
   return ierr;
 }
 
-// compute 1 / (effective viscosity)
-PetscErrorCode DiffusionCreep::computeInvEffVisc(const Vec& Temp,const Vec& sdev,const Vec& grainSize)
-{
-  PetscErrorCode ierr = 0;
-  #if VERBOSE > 1
-    string funcName = "DiffusionCreep::computeInvEffVisc";
-    ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
-    CHKERRQ(ierr);
-  #endif
-
-  PetscScalar const *s,*A,*B,*n,*T,*d,*m;
-  PetscScalar *invEffVisc;
-  PetscInt Ii,Istart,Iend;
-  VecGetOwnershipRange(_invEffVisc,&Istart,&Iend);
-  VecGetArrayRead(sdev,&s);
-  VecGetArrayRead(grainSize,&d);
-  VecGetArrayRead(_A,&A);
-  VecGetArrayRead(_QR,&B);
-  VecGetArrayRead(_n,&n);
-  VecGetArrayRead(_m,&m);
-  VecGetArrayRead(Temp,&T);
-  VecGetArray(_invEffVisc,&invEffVisc);
-  PetscInt Jj = 0;
-  for (Ii=Istart;Ii<Iend;Ii++) {
-    invEffVisc[Jj] = 1e3 * A[Jj] * pow(s[Jj],n[Jj]-1.0) * exp(-B[Jj]/T[Jj]) * pow(d[Jj],-m[Jj]);
-    Jj++;
-  }
-  VecRestoreArrayRead(sdev,&s);
-  VecRestoreArrayRead(grainSize,&d);
-  VecRestoreArrayRead(_A,&A);
-  VecRestoreArrayRead(_QR,&B);
-  VecRestoreArrayRead(_n,&n);
-  VecRestoreArrayRead(_m,&m);
-  VecRestoreArrayRead(Temp,&T);
-  VecRestoreArray(_invEffVisc,&invEffVisc);
-
-  #if VERBOSE > 1
-    ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
-    CHKERRQ(ierr);
-  #endif
-  return ierr;
-}
-
 
 //======================================================================
 // power-law rheology class
@@ -760,6 +678,7 @@ PowerLaw::PowerLaw(Domain& D,std::string bcRType,std::string bcTType,std::string
   _linSolver("unspecified"),_bcRType(bcRType),_bcTType(bcTType),_bcLType(bcLType),_bcBType(bcBType),
   _rhs(NULL),_bcT(NULL),_bcR(NULL),_bcB(NULL),_bcL(NULL),_bcRShift(NULL),
   _ksp(NULL),_pc(NULL),_kspTol(1e-10),_sbp(NULL),_B(NULL),_C(NULL),
+  _bcKey(bcRType + "_" + bcTType + "_" + bcLType + "_" + bcBType),
   _sbp_eta(NULL),_ksp_eta(NULL),_pc_eta(NULL),
   _integrateTime(0),_writeTime(0),_linSolveTime(0),_factorTime(0),_startTime(MPI_Wtime()),_miscTime(0),_linSolveCount(0),
   _timeV1D(NULL),_timeV2D(NULL)
@@ -774,6 +693,7 @@ PowerLaw::PowerLaw(Domain& D,std::string bcRType,std::string bcTType,std::string
   allocateFields(); // initialize fields
   setMaterialParameters();
   loadFieldsFromFiles(); // load from previous simulation
+  if (_D->_ckpt > 0 && _D->_ckptNumber > 0) { loadCheckpoint(); }
 
   // set up deformation mechanisms
   if (_wPlasticity == "yes") {
@@ -827,6 +747,12 @@ PowerLaw::~PowerLaw()
   VecDestroy(&_dgVdev); VecDestroy(&_dgVdev_disl);
 
   // linear system
+  // once the boundary conditions have been changed, _sbp and _ksp are in _bcContexts
+  if (!_bcContexts.empty()) { _sbp = NULL; _ksp = NULL; }
+  for (map<string,pair<SbpOps*,KSP> >::iterator it = _bcContexts.begin(); it != _bcContexts.end(); it++) {
+    delete it->second.first;
+    KSPDestroy(&it->second.second);
+  }
   KSPDestroy(&_ksp);
   KSPDestroy(&_ksp_eta);
   MatDestroy(&_B);
@@ -1094,6 +1020,65 @@ PetscErrorCode PowerLaw::loadFieldsFromFiles()
   return ierr;
 }
 
+// load viscous strains, stresses and boundary conditions from a checkpoint
+PetscErrorCode PowerLaw::loadCheckpoint()
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "PowerLaw::loadCheckpoint";
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);CHKERRQ(ierr);
+  #endif
+
+  const Checkpoint& ckpt = _D->_checkpoint;
+  ierr = ckpt.getVec("momBal_bcR",_bcR); CHKERRQ(ierr);
+  ierr = ckpt.getVec("momBal_bcRShift",_bcRShift); CHKERRQ(ierr);
+  ierr = ckpt.getVec("momBal_bcT",_bcT); CHKERRQ(ierr);
+  ierr = ckpt.getVec("momBal_bcL",_bcL); CHKERRQ(ierr);
+  ierr = ckpt.getVec("momBal_bcB",_bcB); CHKERRQ(ierr);
+
+  ierr = ckpt.getVec("momBal_u",_u); CHKERRQ(ierr);
+  ierr = ckpt.getVec("momBal_effVisc",_effVisc); CHKERRQ(ierr);
+  ierr = ckpt.getVec("momBal_gVxy",_gVxy); CHKERRQ(ierr);
+  ierr = ckpt.getVec("momBal_gVxz",_gVxz); CHKERRQ(ierr);
+  ierr = ckpt.getVec("momBal_sxy",_sxy); CHKERRQ(ierr);
+  ierr = ckpt.getVec("momBal_sxz",_sxz); CHKERRQ(ierr);
+  ierr = computeSDev(); CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);CHKERRQ(ierr);
+  #endif
+  return ierr;
+}
+
+// add viscous strains, stresses and boundary conditions to the next checkpoint
+PetscErrorCode PowerLaw::writeCheckpoint()
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "PowerLaw::writeCheckpoint";
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);CHKERRQ(ierr);
+  #endif
+
+  Checkpoint& ckpt = _D->_checkpoint;
+  ierr = ckpt.setVec("momBal_bcR",_bcR); CHKERRQ(ierr);
+  ierr = ckpt.setVec("momBal_bcRShift",_bcRShift); CHKERRQ(ierr);
+  ierr = ckpt.setVec("momBal_bcT",_bcT); CHKERRQ(ierr);
+  ierr = ckpt.setVec("momBal_bcL",_bcL); CHKERRQ(ierr);
+  ierr = ckpt.setVec("momBal_bcB",_bcB); CHKERRQ(ierr);
+
+  ierr = ckpt.setVec("momBal_u",_u); CHKERRQ(ierr);
+  ierr = ckpt.setVec("momBal_effVisc",_effVisc); CHKERRQ(ierr);
+  ierr = ckpt.setVec("momBal_gVxy",_gVxy); CHKERRQ(ierr);
+  ierr = ckpt.setVec("momBal_gVxz",_gVxz); CHKERRQ(ierr);
+  ierr = ckpt.setVec("momBal_sxy",_sxy); CHKERRQ(ierr);
+  ierr = ckpt.setVec("momBal_sxz",_sxz); CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);CHKERRQ(ierr);
+  #endif
+  return ierr;
+}
+
 // set up SBP operators
 PetscErrorCode PowerLaw::setUpSBPContext(Domain& D)
 {
@@ -1106,29 +1091,46 @@ PetscErrorCode PowerLaw::setUpSBPContext(Domain& D)
   delete _sbp;
   KSPDestroy(&_ksp);
 
+  ierr = createSbpOps(_sbp,_bcRType,_bcTType,_bcLType,_bcBType); CHKERRQ(ierr);
+
+  KSPCreate(PETSC_COMM_WORLD,&_ksp);
+  Mat A; _sbp->getA(A);
+  setupKSP(_ksp,_pc,A);
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+// create SBP operators for the given boundary condition types
+PetscErrorCode PowerLaw::createSbpOps(SbpOps*& sbp,const string& bcR,const string& bcT,const string& bcL,const string& bcB)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "PowerLaw::createSbpOps";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
   if (_D->_gridSpacingType.compare("constantGridSpacing")==0) {
-    _sbp = new SbpOps_m_constGrid(_order,_Ny,_Nz,_Ly,_Lz,_mu);
+    sbp = new SbpOps_m_constGrid(_order,_Ny,_Nz,_Ly,_Lz,_mu);
   }
   else if (_D->_gridSpacingType.compare("variableGridSpacing")==0) {
-    _sbp = new SbpOps_m_varGrid(_order,_Ny,_Nz,_Ly,_Lz,_mu);
-    if (_Ny > 1 && _Nz > 1) { _sbp->setGrid(_y,_z); }
-    else if (_Ny == 1 && _Nz > 1) { _sbp->setGrid(NULL,_z); }
-    else if (_Ny > 1 && _Nz == 1) { _sbp->setGrid(_y,NULL); }
+    sbp = new SbpOps_m_varGrid(_order,_Ny,_Nz,_Ly,_Lz,_mu);
+    if (_Ny > 1 && _Nz > 1) { sbp->setGrid(_y,_z); }
+    else if (_Ny == 1 && _Nz > 1) { sbp->setGrid(NULL,_z); }
+    else if (_Ny > 1 && _Nz == 1) { sbp->setGrid(_y,NULL); }
   }
   else {
     PetscPrintf(PETSC_COMM_WORLD,"ERROR: SBP type type not understood\n");
     assert(0); // automatically fail
   }
-  _sbp->setCompatibilityType(_D->_sbpCompatibilityType);
-  _sbp->setBCTypes(_bcRType,_bcTType,_bcLType,_bcBType);
-  _sbp->setMultiplyByH(1);
-  _sbp->setLaplaceType("yz");
-  _sbp->setDeleteIntermediateFields(0);
-  _sbp->computeMatrices(); // actually create the matrices
-
-  KSPCreate(PETSC_COMM_WORLD,&_ksp);
-  Mat A; _sbp->getA(A);
-  setupKSP(_ksp,_pc,A);
+  sbp->setCompatibilityType(_D->_sbpCompatibilityType);
+  sbp->setBCTypes(bcR,bcT,bcL,bcB);
+  sbp->setMultiplyByH(1);
+  sbp->setLaplaceType("yz");
+  sbp->setDeleteIntermediateFields(0);
+  sbp->computeMatrices(); // actually create the matrices
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -1634,12 +1636,30 @@ PetscErrorCode PowerLaw::changeBCTypes(string bcRTtype,string bcTTtype,string bc
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
 
-  _sbp->changeBCTypes(bcRTtype,bcTTtype,bcLTtype,bcBTtype);
-  KSPDestroy(&_ksp);
-  Mat A;
-  _sbp->getA(A);
-  KSPCreate(PETSC_COMM_WORLD,&_ksp);
-  setupKSP(_ksp,_pc,A);
+  const string key = bcRTtype + "_" + bcTTtype + "_" + bcLTtype + "_" + bcBTtype;
+  if (key.compare(_bcKey)==0) { return ierr; }
+
+  // keep the current SBP operators and KSP context
+  _bcContexts[_bcKey] = make_pair(_sbp,_ksp);
+
+  // switch to those for the new boundary condition types, setting them up
+  // (and factoring A) only the first time these types are used
+  map<string,pair<SbpOps*,KSP> >::iterator it = _bcContexts.find(key);
+  if (it != _bcContexts.end()) {
+    _sbp = it->second.first;
+    _ksp = it->second.second;
+  }
+  else {
+    _sbp = NULL;
+    ierr = createSbpOps(_sbp,bcRTtype,bcTTtype,bcLTtype,bcBTtype); CHKERRQ(ierr);
+
+    Mat A;
+    ierr = _sbp->getA(A); CHKERRQ(ierr);
+    ierr = KSPCreate(PETSC_COMM_WORLD,&_ksp); CHKERRQ(ierr);
+    ierr = setupKSP(_ksp,_pc,A); CHKERRQ(ierr);
+    _bcContexts[key] = make_pair(_sbp,_ksp);
+  }
+  _bcKey = key;
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -1684,17 +1704,110 @@ PetscErrorCode PowerLaw::computeViscosity(const PetscScalar viscCap)
     return ierr;
   }
 
-  // estimate 1 / (effective viscosity) based on strain rate
-  if (_wPlasticity.compare("yes")==0) { _plastic->computeInvEffVisc(_dgVdev); }
-  if (_wDislCreep.compare("yes")==0) { _disl->computeInvEffVisc(_T,_sdev); }
-  if (_wDiffCreep.compare("yes")==0) { _diff->computeInvEffVisc(_T,_sdev,_grainSize); }
-
   // 1 / effVisc = 1/(plastic eff visc) + 1/(disl eff visc) + 1/(diff eff visc) + 1/(max eff visc)
-  VecSet(_effVisc,1.0/_effViscCap);
-  if (_wPlasticity.compare("yes")==0) { VecAXPY(_effVisc,1.0,_plastic->_invEffVisc); }
-  if (_wDislCreep.compare("yes")==0) { VecAXPY(_effVisc,1.0,_disl->_invEffVisc); }
-  if (_wDiffCreep.compare("yes")==0) { VecAXPY(_effVisc,1.0,_diff->_invEffVisc); }
-  VecReciprocal(_effVisc);
+  // computed in one pass for all active mechanisms, with each creep law
+  // A s^(n-1) exp(-B/T) d^-m evaluated as A exp((n-1) log(s) - B/T - m log(d)),
+  // where log(s) is shared between the creep laws and skipped if n-1 is a small
+  // integer that is the same everywhere. At s = 0 log(s) = -inf, which gives
+  // NaN for n = 1, so those nodes use pow instead.
+  const bool wPlastic = _wPlasticity.compare("yes")==0;
+  const bool wDisl = _wDislCreep.compare("yes")==0;
+  const bool wDiff = _wDiffCreep.compare("yes")==0;
+  const int dislIntExp = wDisl ? smallIntExponent(_disl->_nIsUniform,_disl->_nUniform - 1.0) : 0;
+  const int diffIntExp = wDiff ? smallIntExponent(_diff->_nIsUniform,_diff->_nUniform - 1.0) : 0;
+  const bool needLogS = (wDisl && dislIntExp < 0) || (wDiff && diffIntExp < 0);
+  const bool needLogD = wDiff && !(_diff->_mIsUniform && _diff->_mUniform == 0);
+
+  PetscScalar const *s=0,*T=0,*dg=0,*sy=0,*d=0;
+  PetscScalar const *dislA=0,*dislB=0,*dislN=0,*diffA=0,*diffB=0,*diffN=0,*diffM=0;
+  PetscScalar *effVisc=0,*invPlastic=0,*invDisl=0,*invDiff=0;
+  PetscInt nLocal = 0;
+  VecGetLocalSize(_effVisc,&nLocal);
+  VecGetArrayRead(_sdev,&s);
+  VecGetArrayRead(_T,&T);
+  VecGetArray(_effVisc,&effVisc);
+  if (wPlastic) {
+    VecGetArrayRead(_dgVdev,&dg);
+    VecGetArrayRead(_plastic->_yieldStress,&sy);
+    VecGetArray(_plastic->_invEffVisc,&invPlastic);
+  }
+  if (wDisl) {
+    VecGetArrayRead(_disl->_A,&dislA);
+    VecGetArrayRead(_disl->_QR,&dislB);
+    VecGetArrayRead(_disl->_n,&dislN);
+    VecGetArray(_disl->_invEffVisc,&invDisl);
+  }
+  if (wDiff) {
+    VecGetArrayRead(_grainSize,&d);
+    VecGetArrayRead(_diff->_A,&diffA);
+    VecGetArrayRead(_diff->_QR,&diffB);
+    VecGetArrayRead(_diff->_n,&diffN);
+    VecGetArrayRead(_diff->_m,&diffM);
+    VecGetArray(_diff->_invEffVisc,&invDiff);
+  }
+
+  for (PetscInt Jj = 0; Jj < nLocal; Jj++) {
+    const PetscScalar invT = 1.0 / T[Jj];
+    const bool useLogS = needLogS && s[Jj] > 0;
+    const PetscScalar logs = useLogS ? log(s[Jj]) : 0.0;
+    PetscScalar invEffVisc = 1.0/_effViscCap;
+
+    if (wPlastic) {
+      invPlastic[Jj] = dg[Jj] / sy[Jj];
+      invEffVisc += invPlastic[Jj];
+    }
+    if (wDisl) {
+      if (dislIntExp >= 0) {
+        invDisl[Jj] = 1e3 * dislA[Jj] * intPow(s[Jj],dislIntExp) * exp(-dislB[Jj]*invT);
+      }
+      else if (useLogS) {
+        invDisl[Jj] = 1e3 * dislA[Jj] * exp((dislN[Jj]-1.0)*logs - dislB[Jj]*invT);
+      }
+      else {
+        invDisl[Jj] = 1e3 * dislA[Jj] * pow(s[Jj],dislN[Jj]-1.0) * exp(-dislB[Jj]*invT);
+      }
+      invEffVisc += invDisl[Jj];
+    }
+    if (wDiff) {
+      PetscScalar expo = -diffB[Jj]*invT;
+      if (needLogD) { expo -= diffM[Jj] * log(d[Jj]); }
+      if (diffIntExp >= 0) {
+        invDiff[Jj] = 1e3 * diffA[Jj] * intPow(s[Jj],diffIntExp) * exp(expo);
+      }
+      else if (useLogS) {
+        invDiff[Jj] = 1e3 * diffA[Jj] * exp((diffN[Jj]-1.0)*logs + expo);
+      }
+      else {
+        invDiff[Jj] = 1e3 * diffA[Jj] * pow(s[Jj],diffN[Jj]-1.0) * exp(expo);
+      }
+      invEffVisc += invDiff[Jj];
+    }
+
+    effVisc[Jj] = 1.0 / invEffVisc;
+  }
+
+  VecRestoreArrayRead(_sdev,&s);
+  VecRestoreArrayRead(_T,&T);
+  VecRestoreArray(_effVisc,&effVisc);
+  if (wPlastic) {
+    VecRestoreArrayRead(_dgVdev,&dg);
+    VecRestoreArrayRead(_plastic->_yieldStress,&sy);
+    VecRestoreArray(_plastic->_invEffVisc,&invPlastic);
+  }
+  if (wDisl) {
+    VecRestoreArrayRead(_disl->_A,&dislA);
+    VecRestoreArrayRead(_disl->_QR,&dislB);
+    VecRestoreArrayRead(_disl->_n,&dislN);
+    VecRestoreArray(_disl->_invEffVisc,&invDisl);
+  }
+  if (wDiff) {
+    VecRestoreArrayRead(_grainSize,&d);
+    VecRestoreArrayRead(_diff->_A,&diffA);
+    VecRestoreArrayRead(_diff->_QR,&diffB);
+    VecRestoreArrayRead(_diff->_n,&diffN);
+    VecRestoreArrayRead(_diff->_m,&diffM);
+    VecRestoreArray(_diff->_invEffVisc,&invDiff);
+  }
 
   #if VERBOSE > 1
     ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -2285,20 +2398,20 @@ PetscErrorCode PowerLaw::writeStep1D(const std::string outputDir)
   double startTime = MPI_Wtime();
 
   if (_viewers1D.empty()) {
-    initiate_appendVecToOutput(_viewers1D, "surfDisp", _surfDisp, outputDir + "surfDisp", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers1D, "bcR", _bcR, outputDir + "momBal_bcR", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers1D, "bcT", _bcT, outputDir + "momBal_bcT", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers1D, "bcL", _bcL, outputDir + "momBal_bcL", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers1D, "bcB", _bcB, outputDir + "momBal_bcB", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers1D, "bcRShift", _bcRShift, outputDir + "momBal_bcRShift", _D->_outFileMode);
+    _D->initiateTimeSeries(_viewers1D, "surfDisp", _surfDisp, outputDir + "surfDisp");
+    _D->initiateTimeSeries(_viewers1D, "bcR", _bcR, outputDir + "momBal_bcR");
+    _D->initiateTimeSeries(_viewers1D, "bcT", _bcT, outputDir + "momBal_bcT");
+    _D->initiateTimeSeries(_viewers1D, "bcL", _bcL, outputDir + "momBal_bcL");
+    _D->initiateTimeSeries(_viewers1D, "bcB", _bcB, outputDir + "momBal_bcB");
+    _D->initiateTimeSeries(_viewers1D, "bcRShift", _bcRShift, outputDir + "momBal_bcRShift");
   }
   else {
-    ierr = VecView(_surfDisp,_viewers1D["surfDisp"].first); CHKERRQ(ierr);
-    ierr = VecView(_bcL,_viewers1D["bcL"].first); CHKERRQ(ierr);
-    ierr = VecView(_bcR,_viewers1D["bcR"].first); CHKERRQ(ierr);
-    ierr = VecView(_bcB,_viewers1D["bcB"].first); CHKERRQ(ierr);
-    ierr = VecView(_bcT,_viewers1D["bcT"].first); CHKERRQ(ierr);
-    ierr = VecView(_bcR,_viewers1D["bcRShift"].first); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_surfDisp,_viewers1D["surfDisp"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_bcL,_viewers1D["bcL"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_bcR,_viewers1D["bcR"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_bcB,_viewers1D["bcB"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_bcT,_viewers1D["bcT"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_bcRShift,_viewers1D["bcRShift"]); CHKERRQ(ierr);
   }
 
   _writeTime += MPI_Wtime() - startTime;
@@ -2320,48 +2433,48 @@ PetscErrorCode PowerLaw::writeStep2D(const std::string outputDir)
 double startTime = MPI_Wtime();
 
   if (_viewers2D.empty()) {
-    initiate_appendVecToOutput(_viewers2D, "u", _u, outputDir + "momBal_u", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers2D, "sxy", _sxy, outputDir + "momBal_sxy", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers2D, "sxz", _sxz, outputDir + "momBal_sxz", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers2D, "sdev", _sdev, outputDir + "momBal_sdev", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers2D, "gTxy", _gTxy, outputDir + "momBal_gTxy", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers2D, "gTxz", _gTxz, outputDir + "momBal_gTxz", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers2D, "gxy", _gVxy, outputDir + "momBal_gxy", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers2D, "gxz", _gVxz, outputDir + "momBal_gxz", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers2D, "dgVxy", _dgVxy, outputDir + "momBal_dgVxy", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers2D, "dgVxz", _dgVxz, outputDir + "momBal_dgVxz", _D->_outFileMode);
-    initiate_appendVecToOutput(_viewers2D, "effVisc", _effVisc, outputDir + "momBal_effVisc", _D->_outFileMode);
+    _D->initiateTimeSeries(_viewers2D, "u", _u, outputDir + "momBal_u");
+    _D->initiateTimeSeries(_viewers2D, "sxy", _sxy, outputDir + "momBal_sxy");
+    _D->initiateTimeSeries(_viewers2D, "sxz", _sxz, outputDir + "momBal_sxz");
+    _D->initiateTimeSeries(_viewers2D, "sdev", _sdev, outputDir + "momBal_sdev");
+    _D->initiateTimeSeries(_viewers2D, "gTxy", _gTxy, outputDir + "momBal_gTxy");
+    _D->initiateTimeSeries(_viewers2D, "gTxz", _gTxz, outputDir + "momBal_gTxz");
+    _D->initiateTimeSeries(_viewers2D, "gxy", _gVxy, outputDir + "momBal_gxy");
+    _D->initiateTimeSeries(_viewers2D, "gxz", _gVxz, outputDir + "momBal_gxz");
+    _D->initiateTimeSeries(_viewers2D, "dgVxy", _dgVxy, outputDir + "momBal_dgVxy");
+    _D->initiateTimeSeries(_viewers2D, "dgVxz", _dgVxz, outputDir + "momBal_dgVxz");
+    _D->initiateTimeSeries(_viewers2D, "effVisc", _effVisc, outputDir + "momBal_effVisc");
 
     if (_wDiffCreep.compare("yes")==0) {
-      ierr = io_initiateWriteAppend(_viewers2D, "momBal_grainSize", _grainSize, outputDir + "momBal_grainSize"); CHKERRQ(ierr);
-      ierr = io_initiateWriteAppend(_viewers2D, "diff_invEffVisc", _diff->_invEffVisc, outputDir + "diff_invEffVisc"); CHKERRQ(ierr);
+      ierr = _D->initiateTimeSeries(_viewers2D, "momBal_grainSize", _grainSize, outputDir + "momBal_grainSize"); CHKERRQ(ierr);
+      ierr = _D->initiateTimeSeries(_viewers2D, "diff_invEffVisc", _diff->_invEffVisc, outputDir + "diff_invEffVisc"); CHKERRQ(ierr);
     }
     if (_wDislCreep.compare("yes")==0) {
-      ierr = io_initiateWriteAppend(_viewers2D, "momBal_T", _T, outputDir + "momBal_T"); CHKERRQ(ierr);
-      ierr = io_initiateWriteAppend(_viewers2D, "disl_invEffVisc", _disl->_invEffVisc, outputDir + "disl_invEffVisc"); CHKERRQ(ierr);
-      ierr = io_initiateWriteAppend(_viewers2D, "disl_dgVdev", _dgVdev_disl, outputDir + "disl_dgVdev"); CHKERRQ(ierr);
+      ierr = _D->initiateTimeSeries(_viewers2D, "momBal_T", _T, outputDir + "momBal_T"); CHKERRQ(ierr);
+      ierr = _D->initiateTimeSeries(_viewers2D, "disl_invEffVisc", _disl->_invEffVisc, outputDir + "disl_invEffVisc"); CHKERRQ(ierr);
+      ierr = _D->initiateTimeSeries(_viewers2D, "disl_dgVdev", _dgVdev_disl, outputDir + "disl_dgVdev"); CHKERRQ(ierr);
     }
   }
   else {
-    ierr = VecView(_u,_viewers2D["u"].first); CHKERRQ(ierr);
-    ierr = VecView(_sxy,_viewers2D["sxy"].first); CHKERRQ(ierr);
-    ierr = VecView(_sxz,_viewers2D["sxz"].first); CHKERRQ(ierr);
-    ierr = VecView(_sdev,_viewers2D["sdev"].first); CHKERRQ(ierr);
-    ierr = VecView(_gTxy,_viewers2D["gTxy"].first); CHKERRQ(ierr);
-    ierr = VecView(_gTxz,_viewers2D["gTxz"].first); CHKERRQ(ierr);
-    ierr = VecView(_gVxy,_viewers2D["gxy"].first); CHKERRQ(ierr);
-    ierr = VecView(_gVxz,_viewers2D["gxz"].first); CHKERRQ(ierr);
-    ierr = VecView(_dgVxy,_viewers2D["dgVxy"].first); CHKERRQ(ierr);
-    ierr = VecView(_dgVxz,_viewers2D["dgVxz"].first); CHKERRQ(ierr);
-    ierr = VecView(_effVisc,_viewers2D["effVisc"].first); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_u,_viewers2D["u"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_sxy,_viewers2D["sxy"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_sxz,_viewers2D["sxz"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_sdev,_viewers2D["sdev"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_gTxy,_viewers2D["gTxy"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_gTxz,_viewers2D["gTxz"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_gVxy,_viewers2D["gxy"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_gVxz,_viewers2D["gxz"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_dgVxy,_viewers2D["dgVxy"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_dgVxz,_viewers2D["dgVxz"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_effVisc,_viewers2D["effVisc"]); CHKERRQ(ierr);
 
 
     if (_wDiffCreep.compare("yes")==0) {
-      ierr = VecView(_diff->_invEffVisc,_viewers2D["diff_invEffVisc"].first); CHKERRQ(ierr);
+      ierr = _D->appendTimeSeries(_diff->_invEffVisc,_viewers2D["diff_invEffVisc"]); CHKERRQ(ierr);
     }
     if (_wDislCreep.compare("yes")==0) {
-      ierr = VecView(_disl->_invEffVisc,_viewers2D["disl_invEffVisc"].first); CHKERRQ(ierr);
-      ierr = VecView(_dgVdev_disl,_viewers2D["disl_dgVdev"].first); CHKERRQ(ierr);
+      ierr = _D->appendTimeSeries(_disl->_invEffVisc,_viewers2D["disl_invEffVisc"]); CHKERRQ(ierr);
+      ierr = _D->appendTimeSeries(_dgVdev_disl,_viewers2D["disl_dgVdev"]); CHKERRQ(ierr);
     }
   }
 
@@ -2385,6 +2498,7 @@ PetscErrorCode PowerLaw::view(const double totRunTime)
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   number of times linear system was solved: %i\n",_linSolveCount);CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent solving linear system (s): %g\n",_linSolveTime);CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   %% integration time spent solving linear system: %g\n",_linSolveTime/totRunTime*100.);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   # of boundary condition sets with resident SBP operators and KSP: %i\n",_bcContexts.empty() ? 1 : (int) _bcContexts.size());CHKERRQ(ierr);
 
   //~ ierr = PetscPrintf(PETSC_COMM_WORLD,"   misc time (s): %g\n",_miscTime);CHKERRQ(ierr);
   //~ ierr = PetscPrintf(PETSC_COMM_WORLD,"   %% misc time: %g\n",_miscTime/_integrateTime*100.);CHKERRQ(ierr);
@@ -41,7 +41,6 @@ public:
   Pseudoplasticity(const Vec& y, const Vec& z, const char *file, const string delim);
   ~Pseudoplasticity();
   PetscErrorCode guessInvEffVisc(const double dg);
-  PetscErrorCode computeInvEffVisc(const Vec& dgdev);
   PetscErrorCode writeContext(const string outputDir);
 };
 
@@ -68,11 +67,12 @@ public:
   const Vec      *_y,*_z;
   Vec             _A,_n,_QR;
   Vec             _invEffVisc; // 1 / (effective viscosity)
+  bool            _nIsUniform; // whether n is the same everywhere
+  PetscScalar     _nUniform; // value of n if _nIsUniform
 
   DislocationCreep(const Vec& y, const Vec& z, const char *file, const string delim);
   ~DislocationCreep();
   PetscErrorCode guessInvEffVisc(const Vec& Temp, const double dg);
-  PetscErrorCode computeInvEffVisc(const Vec& Temp,const Vec& sdev);
   PetscErrorCode writeContext(const string outputDir);
 };
 
@@ -99,11 +99,12 @@ public:
   const Vec      *_y,*_z;
   Vec             _A,_n,_QR,_m;
   Vec             _invEffVisc; // 1 / (effective viscosity)
+  bool            _nIsUniform,_mIsUniform; // whether n and m are the same everywhere
+  PetscScalar     _nUniform,_mUniform; // values of n and m if uniform
 
   DiffusionCreep(const Vec& y, const Vec& z, const char *file, const string delim);
   ~DiffusionCreep();
   PetscErrorCode guessInvEffVisc(const Vec& Temp,const double dg,const Vec& grainSize);
-  PetscErrorCode computeInvEffVisc(const Vec& Temp,const Vec& sdev,const Vec& grainSize);
   PetscErrorCode writeContext(const string outputDir);
 };
 
@@ -158,6 +159,11 @@ class PowerLaw
     PetscScalar           _kspTol;
     SbpOps               *_sbp;
     Mat                   _B,_C; // composite matrices to make momentum balance simpler
+    // SBP operators and KSP context set up for each set of boundary condition
+    // types used so far, so that changeBCTypes only switches the _sbp and _ksp
+    // handles, without rebuilding A or re-factoring it (key: bcR_bcT_bcL_bcB types)
+    std::map<std::string,std::pair<SbpOps*,KSP> >  _bcContexts;
+    std::string           _bcKey; // key of the boundary condition types _sbp and _ksp are set up for
     PetscErrorCode        initializeMomBalMats(); // computes B and C
 
     // for steady-state computations
@@ -197,7 +203,10 @@ class PowerLaw
     PetscErrorCode allocateFields(); // allocate space for member fields
     PetscErrorCode setMaterialParameters();
     PetscErrorCode loadFieldsFromFiles(); // load non-effective-viscosity parameters
+    PetscErrorCode loadCheckpoint();
+    PetscErrorCode writeCheckpoint();
     PetscErrorCode setUpSBPContext(Domain& D);
+    PetscErrorCode createSbpOps(SbpOps*& sbp,const std::string& bcR,const std::string& bcT,const std::string& bcL,const std::string& bcB);
     PetscErrorCode setupKSP(KSP& ksp,PC& pc,Mat& A);
     PetscErrorCode setupKSP_SSIts(KSP& ksp,PC& pc,Mat& A);
 
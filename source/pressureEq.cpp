@@ -19,7 +19,8 @@ PressureEq::PressureEq(Domain &D)
   _bcB_ratio(1.0), _bcB_type("Q"),
   _maxBeIteration(1), _minBeDifference(0.01),
   _linSolver("AMG"), _ksp(NULL), _kspTol(1e-10), _sbp(NULL), _linSolveCount(0),
-  _writeTime(0), _linSolveTime(0), _ptTime(0), _startTime(0), _miscTime(0), _invTime(0)
+  _writeTime(0), _linSolveTime(0), _ptTime(0), _startTime(0), _miscTime(0), _invTime(0),
+  _work("PressureEq")
 {
   #if VERBOSE > 1
     string funcName = "PressureEq::PressureEq";
@@ -59,7 +60,6 @@ PressureEq::PressureEq(Domain &D)
           computeVariableCoefficient(coeff);
           _sbp->updateVarCoeff(coeff);
           updateBoundaryCoefficient(coeff);
-          VecDestroy(&coeff);
         }
       }
       if (_permPressureDependent == "yes" && _permSlipDependent == "yes") {
@@ -489,14 +489,15 @@ PetscErrorCode PressureEq::loadFieldsFromFiles()
 #endif
 
   if (_D->_ckptNumber > 0) {
-    ierr = loadVecFromInputFile(_p, _outputDir, "p_ckpt");
-    ierr = loadVecFromInputFile(_p_t, _outputDir, "p_t_ckpt");
-    ierr = loadVecFromInputFile(_k_p, _outputDir, "k_ckpt");
-    ierr = loadVecFromInputFile(_k_slip, _outputDir, "k_slip_ckpt");
-    ierr = loadVecFromInputFile(_k_press, _outputDir, "k_press_ckpt");
+    const Checkpoint& ckpt = _D->_checkpoint;
+    ierr = ckpt.getVec("p", _p); CHKERRQ(ierr);
+    ierr = ckpt.getVec("p_t", _p_t); CHKERRQ(ierr);
+    ierr = ckpt.getVec("p_k", _k_p); CHKERRQ(ierr);
+    ierr = ckpt.getVec("p_k_slip", _k_slip); CHKERRQ(ierr);
+    ierr = ckpt.getVec("p_k_press", _k_press); CHKERRQ(ierr);
 
     // other material properties files to load (not checkpoint files)
-    ierr = loadVecFromInputFile(_beta_p, _outputDir, "p_n"); CHKERRQ(ierr);
+    ierr = loadVecFromInputFile(_n_p, _outputDir, "p_n"); CHKERRQ(ierr);
     ierr = loadVecFromInputFile(_beta_p, _outputDir, "p_beta"); CHKERRQ(ierr);
     ierr = loadVecFromInputFile(_eta_p, _outputDir, "p_eta"); CHKERRQ(ierr);
     ierr = loadVecFromInputFile(_rho_f, _outputDir, "p_rho_f"); CHKERRQ(ierr);
@@ -573,7 +574,7 @@ PetscErrorCode PressureEq::computeVariableCoefficient(Vec &coeff)
     CHKERRQ(ierr);
   #endif
 
-  VecDuplicate(_p, &coeff);
+  ierr = _work.get("coeff",_p,coeff); CHKERRQ(ierr);
 
   // coeff = rho_f * k_p / eta_p
   VecSet(coeff, 1.0); //g
@@ -602,14 +603,12 @@ PetscErrorCode PressureEq::updateBoundaryCoefficient(const Vec &coeff)
 
   double startTime = MPI_Wtime(); // time this section
 
-  Vec coeff_rho_g;
-  VecDuplicate(coeff, &coeff_rho_g);
+  Vec coeff_rho_g, tmp;
+  ierr = _work.get("updateBoundaryCoefficient_coeff_rho_g",coeff,coeff_rho_g); CHKERRQ(ierr);
+  ierr = _work.get("updateBoundaryCoefficient_tmp",coeff,tmp); CHKERRQ(ierr);
   VecCopy(coeff, coeff_rho_g);
   VecPointwiseMult(coeff_rho_g, coeff_rho_g, _rho_f);
 
-  Vec tmp;
-  VecDuplicate(coeff, &tmp);
-
   // add gradient instead of flux
   if ( _bcB_type.compare("Dp") == 0 ) {
     VecSet(tmp, _g * (1.0 + _bcB_ratio)); //g
@@ -626,10 +625,6 @@ PetscErrorCode PressureEq::updateBoundaryCoefficient(const Vec &coeff)
     VecAXPY(_bcB, 1.0, _bcB_impose);
   }
 
-  // free memory
-  VecDestroy(&coeff_rho_g);
-  VecDestroy(&tmp);
-
   _ptTime += MPI_Wtime() - startTime;
 
   #if VERBOSE > 1
@@ -690,7 +685,6 @@ PetscErrorCode PressureEq::setUpSBP()
   _sbp->setLaplaceType("z");
   _sbp->computeMatrices(); // actually create the matrices
 
-  VecDestroy(&coeff);
 
   #if VERBOSE > 1
     ierr = PetscPrintf(PETSC_COMM_WORLD, "Ending %s in %s\n", funcName.c_str(), FILENAME);
@@ -1010,9 +1004,9 @@ PetscErrorCode PressureEq::updatePermPressureDependent()
 
   // k = (k0 - kmin2) / exp( (sN-p)/sigma_p ) + kmin2
   Vec tmp1, tmp2;
-  VecDuplicate(_k_p, &tmp1);
+  ierr = _work.get("updatePermPressureDependent_tmp1",_k_p,tmp1); CHKERRQ(ierr);
+  ierr = _work.get("updatePermPressureDependent_tmp2",_sN,tmp2); CHKERRQ(ierr);
   VecCopy(_k_slip, tmp1);
-  VecDuplicate(_sN, &tmp2);
   VecCopy(_sN, tmp2);
 
   ierr = VecAXPY(tmp2, -1.0, _p); // sN - p
@@ -1025,10 +1019,6 @@ PetscErrorCode PressureEq::updatePermPressureDependent()
 
   VecCopy(_k_p, _k_press);
 
-  // free memory
-  VecDestroy(&tmp1);
-  VecDestroy(&tmp2);
-
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD, "Ending %s in %s\n", funcName.c_str(), FILENAME);
   #endif
@@ -1048,15 +1038,14 @@ PetscErrorCode PressureEq::dk_dt(const PetscScalar time, const map<string, Vec>
 
   double startTime = MPI_Wtime(); // time this section
 
-  Vec vel_abs;
-  VecDuplicate(dvarEx.find("slip")->second, &vel_abs);
+  Vec vel_abs, tmp;
+  ierr = _work.get("dk_dt_vel_abs",dvarEx.find("slip")->second,vel_abs); CHKERRQ(ierr);
+  ierr = _work.get("dk_dt_tmp",_p,tmp); CHKERRQ(ierr);
   VecCopy(dvarEx.find("slip")->second, vel_abs);
   ierr = VecAbs(vel_abs);
   Vec dk = dvarEx["permeability"];
 
   // dk_dt = - |V|/L * (k - kmax) - 1/T * (k - kmin)
-  Vec tmp;
-  VecDuplicate(_p, &tmp);
   // - |V|/L * (k - kmax)
   VecWAXPY(tmp, -1.0, _kmax_p, _k_p);
   VecPointwiseMult(tmp, tmp, vel_abs);
@@ -1067,9 +1056,6 @@ PetscErrorCode PressureEq::dk_dt(const PetscScalar time, const map<string, Vec>
   VecPointwiseDivide(tmp, tmp, _kT_p);
   VecAXPY(dk, -1.0, tmp);
 
-  VecDestroy(&tmp);
-  VecDestroy(&vel_abs);
-
   _ptTime += MPI_Wtime() - startTime;
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD, "Ending %s in %s\n", funcName.c_str(), FILENAME);
@@ -1089,14 +1075,13 @@ PetscErrorCode PressureEq::dk_dt(const PetscScalar time, const Vec slipVel, cons
 
   double startTime = MPI_Wtime(); // time this section
 
-  Vec vel_abs;
-  VecDuplicate(slipVel, &vel_abs);
+  Vec vel_abs, tmp;
+  ierr = _work.get("dk_dt_vel_abs",slipVel,vel_abs); CHKERRQ(ierr);
+  ierr = _work.get("dk_dt_tmp",_p,tmp); CHKERRQ(ierr);
   VecCopy(slipVel, vel_abs);
   ierr = VecAbs(vel_abs);
 
   // dk_dt = - |V|/L * (k - kmax) - 1/T * (k - kmin)
-  Vec tmp;
-  VecDuplicate(_p, &tmp);
 
   // - |V|/L * (k - kmax)
   VecWAXPY(tmp, -1.0, _kmax_p, _k_p);
@@ -1108,9 +1093,6 @@ PetscErrorCode PressureEq::dk_dt(const PetscScalar time, const Vec slipVel, cons
   VecPointwiseDivide(tmp, tmp, _kT_p);
   VecAXPY(dKdt, -1.0, tmp);
 
-  VecDestroy(&tmp);
-  VecDestroy(&vel_abs);
-
   _ptTime += MPI_Wtime() - startTime;
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD, "Ending %s in %s\n", funcName.c_str(), FILENAME);
@@ -1203,20 +1185,20 @@ PetscErrorCode PressureEq::dp_dt(const PetscScalar time, const map<string, Vec>
     computeVariableCoefficient(coeff);
     _sbp->updateVarCoeff(coeff);
     updateBoundaryCoefficient(coeff);
-    VecDestroy(&coeff);
   }
 
   Vec p_t = dvarEx["pressure"]; // to make this code slightly easier to read
 
   // source term from gravity: d/dz ( rho*k/eta * g )
-  Vec rhog, rhog_y;
-  VecDuplicate(_p, &rhog);
+  Vec rhog, rhog_y, rhs;
+  ierr = _work.get("dp_dt_rhog",_p,rhog); CHKERRQ(ierr);
+  ierr = _work.get("dp_dt_rhog_y",_p,rhog_y); CHKERRQ(ierr);
+  ierr = _work.get("dp_dt_rhs",_p,rhs); CHKERRQ(ierr);
   VecSet(rhog, _g);                       //g
   VecPointwiseMult(rhog, rhog, _rho_f);   // rho*g
   VecPointwiseMult(rhog, rhog, _rho_f);   // rho^2*g
   VecPointwiseMult(rhog, rhog, _k_p);     // rho^2*g*k
   VecPointwiseDivide(rhog, rhog, _eta_p); // rho^2*g *k/eta
-  VecDuplicate(_p, &rhog_y);
   _sbp->Dz(rhog, rhog_y); //Dz(rho^2*g*k/eta)
 
   Mat D2;
@@ -1225,8 +1207,6 @@ PetscErrorCode PressureEq::dp_dt(const PetscScalar time, const map<string, Vec>
   CHKERRQ(ierr);
 
   // set up boundary terms
-  Vec rhs;
-  VecDuplicate(_k_p, &rhs);
   _sbp->setRhs(rhs, _bcL, _bcL, _bcT, _bcB);
 
   // d/dt p = (D2*p - Dz(rho^2*g*k/eta) - rhs) / (rho * n * beta)
@@ -1238,10 +1218,9 @@ PetscErrorCode PressureEq::dp_dt(const PetscScalar time, const map<string, Vec>
     ierr = _sbp->getCoordTrans(J, Jinv, qy, rz, yq, zr);
     CHKERRQ(ierr);
     Vec temp;
-    VecDuplicate(p_t, &temp);
+    ierr = _work.get("dp_dt_temp",p_t,temp); CHKERRQ(ierr);
     ierr = MatMult(Jinv, p_t, temp);
     VecCopy(temp, p_t);
-    VecDestroy(&temp);
   }
 
   VecAXPY(p_t, -1.0, rhog_y);
@@ -1250,9 +1229,6 @@ PetscErrorCode PressureEq::dp_dt(const PetscScalar time, const map<string, Vec>
   VecPointwiseDivide(p_t, p_t, _n_p);
   VecPointwiseDivide(p_t, p_t, _beta_p);
 
-  VecDestroy(&rhog);
-  VecDestroy(&rhog_y);
-  VecDestroy(&rhs);
 
   _ptTime += MPI_Wtime() - startTime;
   #if VERBOSE > 1
@@ -1284,18 +1260,18 @@ PetscErrorCode PressureEq::dp_dt(const PetscScalar time, const Vec &P, Vec &dPdt
     computeVariableCoefficient(coeff);
     _sbp->updateVarCoeff(coeff);
     updateBoundaryCoefficient(coeff);
-    VecDestroy(&coeff);
   }
 
   // source term from gravity: d/dz ( rho*k/eta * g )
-  Vec rhog, rhog_y;
-  VecDuplicate(_p, &rhog);
+  Vec rhog, rhog_y, rhs;
+  ierr = _work.get("dp_dt_rhog",_p,rhog); CHKERRQ(ierr);
+  ierr = _work.get("dp_dt_rhog_y",_p,rhog_y); CHKERRQ(ierr);
+  ierr = _work.get("dp_dt_rhs",_p,rhs); CHKERRQ(ierr);
   VecSet(rhog, _g);                       //g
   VecPointwiseMult(rhog, rhog, _rho_f);   // rho*g
   VecPointwiseMult(rhog, rhog, _rho_f);   // rho^2*g
   VecPointwiseMult(rhog, rhog, _k_p);     // rho^2*g*k
   VecPointwiseDivide(rhog, rhog, _eta_p); // rho^2*g *k/eta
-  VecDuplicate(_p, &rhog_y);
   _sbp->Dz(rhog, rhog_y); //Dz(rho^2*g*k/eta)
 
   Mat D2;
@@ -1304,8 +1280,6 @@ PetscErrorCode PressureEq::dp_dt(const PetscScalar time, const Vec &P, Vec &dPdt
   CHKERRQ(ierr);
 
   // set up boundary terms
-  Vec rhs;
-  VecDuplicate(_k_p, &rhs);
   _sbp->setRhs(rhs, _bcL, _bcL, _bcT, _bcB);
   // VecView(_bcB, PETSC_VIEWER_STDOUT_WORLD);
 
@@ -1320,10 +1294,9 @@ PetscErrorCode PressureEq::dp_dt(const PetscScalar time, const Vec &P, Vec &dPdt
     ierr = _sbp->getCoordTrans(J, Jinv, qy, rz, yq, zr);
     CHKERRQ(ierr);
     Vec temp;
-    VecDuplicate(dPdt, &temp);
+    ierr = _work.get("dp_dt_temp",dPdt,temp); CHKERRQ(ierr);
     ierr = MatMult(Jinv, dPdt, temp);
     VecCopy(temp, dPdt);
-    VecDestroy(&temp);
   }
 
   VecAXPY(dPdt, -1.0, rhog_y);
@@ -1332,9 +1305,6 @@ PetscErrorCode PressureEq::dp_dt(const PetscScalar time, const Vec &P, Vec &dPdt
   VecPointwiseDivide(dPdt, dPdt, _n_p);
   VecPointwiseDivide(dPdt, dPdt, _beta_p);
 
-  VecDestroy(&rhog);
-  VecDestroy(&rhog_y);
-  VecDestroy(&rhs);
 
   _ptTime += MPI_Wtime() - startTime;
   #if VERBOSE > 1
@@ -1358,14 +1328,15 @@ PetscErrorCode PressureEq::d_dt_mms(const PetscScalar time, const map<string, Ve
   Vec p_t = dvarEx["pressure"]; // to make this code slightly easier to read
 
   // source term from gravity: d/dz ( rho*k/eta * g )
-  Vec rhog, rhog_y;
-  VecDuplicate(_p, &rhog);
+  Vec rhog, rhog_y, rhs;
+  ierr = _work.get("dp_dt_rhog",_p,rhog); CHKERRQ(ierr);
+  ierr = _work.get("dp_dt_rhog_y",_p,rhog_y); CHKERRQ(ierr);
+  ierr = _work.get("dp_dt_rhs",_p,rhs); CHKERRQ(ierr);
   VecSet(rhog, _g);                       //g
   VecPointwiseMult(rhog, rhog, _rho_f);   // rho*g
   VecPointwiseMult(rhog, rhog, _rho_f);   // rho^2*g
   VecPointwiseMult(rhog, rhog, _k_p);     // rho^2*g*k
   VecPointwiseDivide(rhog, rhog, _eta_p); // rho^2*g *k/eta
-  VecDuplicate(_p, &rhog_y);
   _sbp->Dz(rhog, rhog_y); //Dz(rho^2*g*k/eta)
 
   Mat D2;
@@ -1374,8 +1345,6 @@ PetscErrorCode PressureEq::d_dt_mms(const PetscScalar time, const map<string, Ve
   CHKERRQ(ierr);
 
   // set up boundary terms
-  Vec rhs;
-  VecDuplicate(_k_p, &rhs);
   _sbp->setRhs(rhs, _bcL, _bcL, _bcT, _bcB);
 
   // d/dt p = (D2*p - Dz(rho^2*g*k/eta) - rhs) / (rho * n * beta)
@@ -1389,10 +1358,9 @@ PetscErrorCode PressureEq::d_dt_mms(const PetscScalar time, const map<string, Ve
     ierr = _sbp->getCoordTrans(J, Jinv, qy, rz, yq, zr);
     CHKERRQ(ierr);
     Vec temp;
-    VecDuplicate(p_t, &temp);
+    ierr = _work.get("dp_dt_temp",p_t,temp); CHKERRQ(ierr);
     ierr = MatMult(Jinv, p_t, temp);
     VecCopy(temp, p_t);
-    VecDestroy(&temp);
   }
 
   VecAXPY(p_t, -1.0, rhog_y);
@@ -1402,15 +1370,11 @@ PetscErrorCode PressureEq::d_dt_mms(const PetscScalar time, const map<string, Ve
   VecPointwiseDivide(p_t, p_t, _beta_p);
 
   Vec source;
-  VecDuplicate(_p, &source);
+  ierr = _work.get("d_dt_mms_source",_p,source); CHKERRQ(ierr);
   mapToVec(source, zzmms_pSource1D, _z, time);
 
   VecAXPY(p_t, 1.0, source);
 
-  VecDestroy(&rhog);
-  VecDestroy(&rhog_y);
-  VecDestroy(&rhs);
-  VecDestroy(&source);
 
   _ptTime += MPI_Wtime() - startTime;
   #if VERBOSE > 1
@@ -1439,7 +1403,6 @@ PetscErrorCode PressureEq::be(const PetscScalar time, const map<string, Vec> &va
     computeVariableCoefficient(coeff);
     _sbp->updateVarCoeff(coeff);
     updateBoundaryCoefficient(coeff);
-    VecDestroy(&coeff);
     if (_permPressureDependent.compare("yes") == 0) {
       VecCopy(_k_p, _k_slip); // used in permPressureDependent
     }
@@ -1447,23 +1410,18 @@ PetscErrorCode PressureEq::be(const PetscScalar time, const map<string, Vec> &va
 
   VecCopy(varImo.find("pressure")->second, _p);
 
-  Vec rhog, rhog_y;
-  VecDuplicate(_p, &rhog);
-  VecDuplicate(_p, &rhog_y);
-
-  Vec rhs;
-  VecDuplicate(_p, &rhs);
-
-  Vec temp;
-  VecDuplicate(_p, &temp);
-
-  Vec p_prev;
-  VecDuplicate(_p, &p_prev);
+  Vec rhog, rhog_y, rhs, temp, p_prev, rho_n_beta, Hxp, tmp1, errVec; // rho_n_beta = 1/(rho * n * beta)
+  ierr = _work.get("be_rhog",_p,rhog); CHKERRQ(ierr);
+  ierr = _work.get("be_rhog_y",_p,rhog_y); CHKERRQ(ierr);
+  ierr = _work.get("be_rhs",_p,rhs); CHKERRQ(ierr);
+  ierr = _work.get("be_temp",_p,temp); CHKERRQ(ierr);
+  ierr = _work.get("be_p_prev",_p,p_prev); CHKERRQ(ierr);
+  ierr = _work.get("be_rho_n_beta",_p,rho_n_beta); CHKERRQ(ierr);
+  ierr = _work.get("be_Hxp",_p,Hxp); CHKERRQ(ierr);
+  ierr = _work.get("be_tmp1",_p,tmp1); CHKERRQ(ierr);
+  ierr = _work.get("be_errVec",_p,errVec); CHKERRQ(ierr);
   VecCopy(_p, p_prev);
 
-  Vec rho_n_beta; // rho_n_beta = 1/(rho * n * beta)
-  VecDuplicate(_p, &rho_n_beta);
-
   Mat Diag_rho_n_beta = NULL;
   Mat D2_rho_n_beta = NULL;
 
@@ -1474,11 +1432,6 @@ PetscErrorCode PressureEq::be(const PetscScalar time, const map<string, Vec> &va
   _sbp->getA(D2);
   MatMatMult(Diag_rho_n_beta, D2, MAT_INITIAL_MATRIX, PETSC_DEFAULT, &D2_rho_n_beta);
 
-  Vec Hxp;
-  VecDuplicate(_p, &Hxp);
-
-  Vec tmp1;
-  VecDuplicate(_p, &tmp1);
   Mat tmp2;
   Mat J, Jinv, qy, rz, yq, zr;
   ierr = _sbp->getCoordTrans(J, Jinv, qy, rz, yq, zr); CHKERRQ(ierr);
@@ -1497,7 +1450,6 @@ PetscErrorCode PressureEq::be(const PetscScalar time, const map<string, Vec> &va
       computeVariableCoefficient(coeff);
       _sbp->updateVarCoeff(coeff);
       updateBoundaryCoefficient(coeff);
-      VecDestroy(&coeff);
     }
     _miscTime += MPI_Wtime() - tmpTime;
 
@@ -1560,12 +1512,8 @@ PetscErrorCode PressureEq::be(const PetscScalar time, const map<string, Vec> &va
 
     // calculate relative error
     PetscReal err=0.0, s=0.0;
-    Vec errVec;
-    VecDuplicate(_p, &errVec);
-    VecSet(errVec,0.0);
     ierr = VecWAXPY(errVec, -1.0, p_prev, _p); CHKERRQ(ierr);
     VecNorm(errVec, NORM_2, &err);
-    VecDestroy(&errVec);
     VecNorm(_p, NORM_2, &s);
     err = err / s;
 
@@ -1583,16 +1531,8 @@ PetscErrorCode PressureEq::be(const PetscScalar time, const map<string, Vec> &va
   _linSolveCount++;
 
   // free memory
-  VecDestroy(&rhog);
-  VecDestroy(&rhog_y);
-  VecDestroy(&temp);
-  VecDestroy(&rhs);
-  VecDestroy(&rho_n_beta);
-  VecDestroy(&Hxp);
-  VecDestroy(&p_prev);
   MatDestroy(&Diag_rho_n_beta);
   MatDestroy(&D2_rho_n_beta);
-  VecDestroy(&tmp1);
   MatDestroy(&tmp2);
 
   _ptTime += MPI_Wtime() - startTime;
@@ -1856,11 +1796,18 @@ PetscErrorCode PressureEq::view(const double totRunTime)
   ierr = PetscPrintf(PETSC_COMM_WORLD, "   %% integration time spent computing pressure rate: %g\n", _ptTime / totRunTime * 100.); CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD, "   delete and create SBP (s): %g\n", _miscTime); CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD, "   inversion (s): %g\n", _invTime); CHKERRQ(ierr);
+  ierr = _work.view(); CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD, "\n"); CHKERRQ(ierr);
   return ierr;
 }
 
 
+PetscErrorCode PressureEq::endStep(const PetscInt stepCount)
+{
+  return _work.endStep(stepCount);
+}
+
+
 // extends SymmFault's writeContext
 PetscErrorCode PressureEq::writeContext(const string outputDir)
 {
@@ -1935,40 +1882,30 @@ PetscErrorCode PressureEq::writeStep(const PetscInt stepCount, const PetscScalar
     VecDuplicate(_p, &pA);
     mapToVec(pA, zzmms_pA1D, _z, time);
     if (stepCount == 0) {
-      ierr = io_initiateWriteAppend(_viewers, "pA", pA, outputDir + "p_pA"); CHKERRQ(ierr);
+      ierr = _D->initiateTimeSeries(_viewers, "pA", pA, outputDir + "p_pA"); CHKERRQ(ierr);
     }
     else {
-      ierr = VecView(pA, _viewers["pA"].first); CHKERRQ(ierr);
+      ierr = _D->appendTimeSeries(pA, _viewers["pA"]); CHKERRQ(ierr);
     }
     VecDestroy(&pA);
   }
 
 
   if (_viewers.empty()) {
-    ierr = initiate_appendVecToOutput(_viewers, "p", _p, outputDir + "p",_D->_outFileMode); CHKERRQ(ierr);
-    ierr = initiate_appendVecToOutput(_viewers, "p_t", _p_t, outputDir + "p_t",_D->_outFileMode); CHKERRQ(ierr);
-    ierr = initiate_appendVecToOutput(_viewers, "k", _k_p, outputDir + "k",_D->_outFileMode); CHKERRQ(ierr);
-    ierr = initiate_appendVecToOutput(_viewers, "k_slip", _k_slip, outputDir + "k_slip",_D->_outFileMode); CHKERRQ(ierr);
-    ierr = initiate_appendVecToOutput(_viewers, "k_press", _k_press, outputDir + "k_press",_D->_outFileMode); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "p", _p, outputDir + "p"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "p_t", _p_t, outputDir + "p_t"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "k", _k_p, outputDir + "k"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "k_slip", _k_slip, outputDir + "k_slip"); CHKERRQ(ierr);
+    ierr = _D->initiateTimeSeries(_viewers, "k_press", _k_press, outputDir + "k_press"); CHKERRQ(ierr);
   }
   else {
-    ierr = VecView(_p, _viewers["p"].first); CHKERRQ(ierr);
-    ierr = VecView(_p_t, _viewers["p_t"].first); CHKERRQ(ierr);
-    ierr = VecView(_k_p, _viewers["k"].first); CHKERRQ(ierr);
-    ierr = VecView(_k_slip, _viewers["k_slip"].first); CHKERRQ(ierr);
-    ierr = VecView(_k_press, _viewers["k_press"].first); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_p, _viewers["p"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_p_t, _viewers["p_t"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_k_p, _viewers["k"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_k_slip, _viewers["k_slip"]); CHKERRQ(ierr);
+    ierr = _D->appendTimeSeries(_k_press, _viewers["k_press"]); CHKERRQ(ierr);
   }
 
-
-    // write checkpoint files
-    //~ if (stepCount == _maxStepCount && _D->_ckpt > 0) {
-      //~ ierr = writeVec(_p, outputDir + "p_ckpt"); CHKERRQ(ierr);
-      //~ ierr = writeVec(_p_t, outputDir + "p_t_ckpt"); CHKERRQ(ierr);
-      //~ ierr = writeVec(_k_p, outputDir + "k_ckpt"); CHKERRQ(ierr);
-      //~ ierr = writeVec(_k_slip, outputDir + "k_slip_ckpt"); CHKERRQ(ierr);
-      //~ ierr = writeVec(_k_press, outputDir + "k_press_ckpt"); CHKERRQ(ierr);
-    //~ }
-
   #if VERBOSE > 1
     ierr = PetscPrintf(PETSC_COMM_WORLD, "Ending %s in %s\n", funcName.c_str(), FILENAME);
     CHKERRQ(ierr);
@@ -1977,6 +1914,29 @@ PetscErrorCode PressureEq::writeStep(const PetscInt stepCount, const PetscScalar
 }
 
 
+// add pressure and permeability to the next checkpoint
+PetscErrorCode PressureEq::writeCheckpoint()
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "PressureEq::writeCheckpoint";
+    ierr = PetscPrintf(PETSC_COMM_WORLD, "Starting %s in %s\n", funcName.c_str(), FILENAME); CHKERRQ(ierr);
+  #endif
+
+  Checkpoint& ckpt = _D->_checkpoint;
+  ierr = ckpt.setVec("p", _p); CHKERRQ(ierr);
+  ierr = ckpt.setVec("p_t", _p_t); CHKERRQ(ierr);
+  ierr = ckpt.setVec("p_k", _k_p); CHKERRQ(ierr);
+  ierr = ckpt.setVec("p_k_slip", _k_slip); CHKERRQ(ierr);
+  ierr = ckpt.setVec("p_k_press", _k_press); CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    ierr = PetscPrintf(PETSC_COMM_WORLD, "Ending %s in %s\n", funcName.c_str(), FILENAME); CHKERRQ(ierr);
+  #endif
+  return ierr;
+}
+
+
 // MMS functions
 // test convergence to analytical solution
 PetscErrorCode PressureEq::measureMMSError(const double totRunTime)
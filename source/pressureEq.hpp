@@ -14,6 +14,7 @@
 #include "sbpOps_m_varGrid.hpp"
 #include "integratorContextEx.hpp"
 #include "integratorContextImex.hpp"
+#include "workspace.hpp"
 
 /* This class solves for the uncoupled fluid pressure during earthquake cycle
  * simulations, and solves for the permeability changes due to fault slip and
@@ -89,6 +90,9 @@ private:
   double _writeTime, _linSolveTime, _ptTime, _startTime, _miscTime;
   double _invTime;
 
+  // scratch Vecs for the functions called every time step
+  Workspace _work;
+
 
   // viewers:
   // 1st string = key naming relevant field, e.g. "slip"
@@ -101,7 +105,7 @@ private:
   PressureEq &operator=(const PressureEq &rhs);
 
   // private member functions
-  PetscErrorCode computeVariableCoefficient(Vec &coeff);
+  PetscErrorCode computeVariableCoefficient(Vec &coeff); // coeff is a scratch Vec from _work, do not destroy it
   PetscErrorCode updateBoundaryCoefficient(const Vec &coeff);
   PetscErrorCode setUpSBP();
   PetscErrorCode computeInitialSteadyStatePressure(Domain &D);
@@ -151,9 +155,11 @@ public:
 
   // IO
   PetscErrorCode view(const double totRunTime);
+  PetscErrorCode endStep(const PetscInt stepCount); // report scratch Vecs allocated during this step
   PetscErrorCode writeContext(const string outputDir);
   PetscErrorCode writeStep(const PetscInt stepCount, const PetscScalar time);
   PetscErrorCode writeStep(const PetscInt stepCount, const PetscScalar time, const string outputDir);
+  PetscErrorCode writeCheckpoint();
 
   // MMS error
   PetscErrorCode measureMMSError(const double totRunTime);
@@ -0,0 +1,221 @@
+#include "regimeSwitch.hpp"
+
+#define FILENAME "regimeSwitch.cpp"
+
+using namespace std;
+
+
+RegimeSwitch::RegimeSwitch(const char *file, const string delim, const string outputDir,
+  const PetscFileMode mode)
+: _file(file),_delim(delim),_outputDir(outputDir),_type("threshold"),
+  _trendWeight(0.5),_predictSteps(5),_costRatio(0.1),_delayLimit(1e-1),
+  _numSwitches(0),_numDelayed(0),
+  _mode(mode),_viewer(NULL),
+  _started(false),_inDynamic(false),_phaseStartWall(0),_phaseStartStep(0),_phaseDelayed(0),
+  _lastR(0),_lastTime(0),_growthRate(0),_numSamples(0),
+  _wallPerStep_qd(-1),_wallPerStep_fd(-1),_deltaT_qd(-1)
+{
+  #if VERBOSE > 1
+    string funcName = "RegimeSwitch::RegimeSwitch";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  loadSettings(_file);
+  checkInput();
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+}
+
+
+RegimeSwitch::~RegimeSwitch()
+{
+  PetscViewerDestroy(&_viewer);
+}
+
+
+PetscErrorCode RegimeSwitch::loadSettings(const char *file)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "RegimeSwitch::loadSettings";
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);CHKERRQ(ierr);
+  #endif
+
+  ifstream infile( file );
+  string line, var, rhs;
+  size_t pos = 0;
+  while (getline(infile, line)) {
+    istringstream iss(line);
+    pos = line.find(_delim); // find position of the delimiter
+    var = line.substr(0,pos);
+    rhs = "";
+    if (line.length() > (pos + _delim.length())) {
+      rhs = line.substr(pos+_delim.length(),line.npos);
+    }
+
+    // interpret everything after the appearance of a space on the line as a comment
+    pos = rhs.find(" ");
+    rhs = rhs.substr(0,pos);
+
+    if (var.compare("regimeSwitchType") == 0) { _type = rhs; }
+    else if (var.compare("regimeSwitchTrendWeight") == 0) { _trendWeight = atof(rhs.c_str()); }
+    else if (var.compare("regimeSwitchPredictSteps") == 0) { _predictSteps = atof(rhs.c_str()); }
+    else if (var.compare("regimeSwitchCostRatio") == 0) { _costRatio = atof(rhs.c_str()); }
+    else if (var.compare("regimeSwitchDelayLimit") == 0) { _delayLimit = atof(rhs.c_str()); }
+  }
+
+  #if VERBOSE > 1
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);CHKERRQ(ierr);
+  #endif
+  return ierr;
+}
+
+
+PetscErrorCode RegimeSwitch::checkInput()
+{
+  PetscErrorCode ierr = 0;
+
+  assert(_type.compare("threshold") == 0 || _type.compare("predictive") == 0);
+  assert(_trendWeight > 0 && _trendWeight <= 1);
+  assert(_predictSteps >= 0);
+  assert(_costRatio > 0);
+  assert(_delayLimit > 0);
+
+  return ierr;
+}
+
+
+PetscErrorCode RegimeSwitch::startPhase(const bool inDynamic, const PetscInt stepCount, const PetscScalar R,
+  const PetscScalar time, const double wallTime)
+{
+  PetscErrorCode ierr = 0;
+
+  _started = true;
+  _inDynamic = inDynamic;
+  _phaseStartWall = wallTime;
+  _phaseStartStep = stepCount;
+  _phaseDelayed = 0;
+
+  // the trend does not carry over from the other regime
+  _lastR = R;
+  _lastTime = time;
+  _growthRate = 0;
+  _numSamples = 0;
+
+  return ierr;
+}
+
+
+PetscErrorCode RegimeSwitch::checkSwitch(const bool inDynamic, const PetscInt cycleCount, const PetscScalar time,
+  const PetscInt stepCount, const PetscScalar deltaT, const PetscScalar deltaT_fd, const PetscScalar R,
+  bool& mustSwitch)
+{
+  PetscErrorCode ierr = 0;
+  double wallTime = MPI_Wtime();
+
+  if (!_started || inDynamic != _inDynamic) {
+    ierr = startPhase(inDynamic,stepCount,R,time,wallTime); CHKERRQ(ierr);
+  }
+  else if (time > _lastTime && R > 0 && _lastR > 0) {
+    PetscScalar g = (log(R) - log(_lastR)) / (time - _lastTime);
+    if (_numSamples == 0) { _growthRate = g; }
+    else { _growthRate = _trendWeight * g + (1.0 - _trendWeight) * _growthRate; }
+    _numSamples++;
+    _lastR = R;
+    _lastTime = time;
+  }
+
+  // wall time per step in the current regime
+  PetscInt phaseSteps = stepCount - _phaseStartStep;
+  if (phaseSteps > 0) {
+    if (inDynamic) { _wallPerStep_fd = (wallTime - _phaseStartWall) / phaseSteps; }
+    else { _wallPerStep_qd = (wallTime - _phaseStartWall) / phaseSteps; }
+  }
+  if (!inDynamic) { _deltaT_qd = deltaT; }
+
+  // predicted time for R to reach regimeSwitchDelayLimit, < 0 if R is not growing
+  PetscScalar predTime = -1;
+  if (R >= _delayLimit) { predTime = 0; }
+  else if (_numSamples > 0 && _growthRate > 0 && R > 0) { predTime = log(_delayLimit / R) / _growthRate; }
+
+  // wall time per simulated second in each regime, < 0 if unknown
+  PetscScalar cost_qd = -1, cost_fd = -1;
+  if (_wallPerStep_qd > 0 && _deltaT_qd > 0) { cost_qd = _wallPerStep_qd / _deltaT_qd; }
+  double wallPerStep_fd = _wallPerStep_fd;
+  if (wallPerStep_fd <= 0 && _wallPerStep_qd > 0) { wallPerStep_fd = _costRatio * _wallPerStep_qd; }
+  if (wallPerStep_fd > 0 && deltaT_fd > 0) { cost_fd = wallPerStep_fd / deltaT_fd; }
+
+  if (mustSwitch && _type.compare("predictive") == 0) {
+    if (!inDynamic && cost_qd > 0 && cost_fd > 0) {
+      bool fdIsCheaper = cost_fd <= cost_qd;
+      bool isImminent = predTime >= 0 && predTime <= _predictSteps * deltaT;
+      mustSwitch = fdIsCheaper || isImminent;
+    }
+    else if (inDynamic && _numSamples > 0 && _growthRate > 0) {
+      mustSwitch = false;
+    }
+    if (!mustSwitch) { _numDelayed++; _phaseDelayed++; }
+  }
+
+  if (mustSwitch) {
+    ierr = writeSwitch(cycleCount,time,stepCount,R,predTime,cost_qd,cost_fd,wallTime); CHKERRQ(ierr);
+    _numSwitches++;
+  }
+
+  return ierr;
+}
+
+
+// append one line per switch to regimeSwitch.txt
+PetscErrorCode RegimeSwitch::writeSwitch(const PetscInt cycleCount, const PetscScalar time, const PetscInt stepCount,
+  const PetscScalar R, const PetscScalar predTime, const PetscScalar cost_qd, const PetscScalar cost_fd,
+  const double wallTime)
+{
+  PetscErrorCode ierr = 0;
+
+  if (_viewer == NULL) {
+    ierr = PetscViewerCreate(PETSC_COMM_WORLD,&_viewer); CHKERRQ(ierr);
+    ierr = PetscViewerSetType(_viewer,PETSCVIEWERASCII); CHKERRQ(ierr);
+    ierr = PetscViewerFileSetMode(_viewer,_mode); CHKERRQ(ierr);
+    ierr = PetscViewerFileSetName(_viewer,(_outputDir + "regimeSwitch.txt").c_str()); CHKERRQ(ierr);
+    if (_mode == FILE_MODE_WRITE) {
+      ierr = PetscViewerASCIIPrintf(_viewer,"# cycle time step switch R growthRate predTime"
+        " wallPerStep_qd wallPerStep_fd cost_qd cost_fd phaseSteps phaseWallTime phaseDelayedSteps\n"); CHKERRQ(ierr);
+    }
+  }
+
+  string direction = "qd2fd";
+  if (_inDynamic) { direction = "fd2qd"; }
+  ierr = PetscViewerASCIIPrintf(_viewer,"%i %.15e %i %s %.6e %.6e %.6e %.6e %.6e %.6e %.6e %i %.6e %i\n",
+    cycleCount,time,stepCount,direction.c_str(),R,_growthRate,predTime,_wallPerStep_qd,_wallPerStep_fd,
+    cost_qd,cost_fd,stepCount - _phaseStartStep,wallTime - _phaseStartWall,_phaseDelayed); CHKERRQ(ierr);
+
+  return ierr;
+}
+
+
+PetscErrorCode RegimeSwitch::writeContext(PetscViewer& viewer)
+{
+  PetscErrorCode ierr = 0;
+
+  ierr = PetscViewerASCIIPrintf(viewer,"regimeSwitchType = %s\n",_type.c_str());CHKERRQ(ierr);
+  if (_type.compare("predictive") == 0) {
+    ierr = PetscViewerASCIIPrintf(viewer,"regimeSwitchTrendWeight = %g\n",_trendWeight);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"regimeSwitchPredictSteps = %g\n",_predictSteps);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"regimeSwitchCostRatio = %g\n",_costRatio);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"regimeSwitchDelayLimit = %g\n",_delayLimit);CHKERRQ(ierr);
+  }
+
+  return ierr;
+}
+
+
+PetscErrorCode RegimeSwitch::view()
+{
+  PetscErrorCode ierr = 0;
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   # of regime switches: %i\n",_numSwitches);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   # of time steps a regime switch was delayed for: %i\n",_numDelayed);CHKERRQ(ierr);
+  return ierr;
+}
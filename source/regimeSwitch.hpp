@@ -0,0 +1,105 @@
+#ifndef REGIMESWITCH_HPP_INCLUDED
+#define REGIMESWITCH_HPP_INCLUDED
+
+#include <petscksp.h>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <cmath>
+#include <assert.h>
+
+using namespace std;
+
+/*
+ * Decides when a qd_fd mediator switches between the quasidynamic (qd) and
+ * fully dynamic (fd) regimes, given R = max(eta*V/tauQS) at each time step.
+ * The mediator first applies its own threshold rule (trigger_qd2fd,
+ * trigger_fd2qd, limit_qd, limit_fd), and passes the result to checkSwitch.
+ *
+ * At every call the controller also tracks
+ *   - the growth rate g of ln(R), a moving average weighted by
+ *     regimeSwitchTrendWeight, and from it the predicted time for R to
+ *     reach regimeSwitchDelayLimit (default 0.1), ln(regimeSwitchDelayLimit/R)/g,
+ *   - the wall time per time step in each regime, and from it the cost of
+ *     one simulated second in each regime: wall time per qd step divided by
+ *     the current adaptive time step, and wall time per fd step divided by
+ *     the CFL limited time step.
+ *
+ * regimeSwitchType = threshold (default): the threshold rule decides, as
+ *   before.
+ * regimeSwitchType = predictive: once the threshold rule asks for a switch
+ *   from qd to fd, the switch is delayed until any of the following is true
+ *   - fd is at least as cheap as qd per simulated second,
+ *   - R is predicted to reach regimeSwitchDelayLimit within
+ *     regimeSwitchPredictSteps qd time steps,
+ *   - R has already reached regimeSwitchDelayLimit.
+ *   This keeps slow slip transients, which cross trigger_qd2fd without
+ *   becoming dynamic, in qd. Until an fd phase has been timed, an fd step is
+ *   assumed to cost regimeSwitchCostRatio qd steps. The switch back from fd
+ *   to qd is delayed while R is still growing.
+ *
+ * In either case each switch appends a line to regimeSwitch.txt in the
+ * output directory, with the state of the controller and the time spent in
+ * the phase that just ended.
+ *
+ */
+
+class RegimeSwitch
+{
+public:
+
+  const char   *_file;
+  string        _delim;
+  string        _outputDir;
+  string        _type; // "threshold" or "predictive"
+  PetscScalar   _trendWeight; // weight of the newest sample in the growth rate
+  PetscScalar   _predictSteps; // # of qd time steps to look ahead
+  PetscScalar   _costRatio; // assumed cost of an fd step relative to a qd step
+  PetscScalar   _delayLimit; // R at which qd to fd can no longer be delayed
+  PetscInt      _numSwitches;
+  PetscInt      _numDelayed; // # of time steps a switch was delayed for
+
+  RegimeSwitch(const char *file, const string delim, const string outputDir,
+    const PetscFileMode mode);
+  ~RegimeSwitch();
+
+  // update the trend and cost estimates, and decide whether to switch at
+  // this step: mustSwitch holds the threshold rule's decision on input,
+  // and the controller's on output (collective)
+  PetscErrorCode checkSwitch(const bool inDynamic, const PetscInt cycleCount, const PetscScalar time,
+    const PetscInt stepCount, const PetscScalar deltaT, const PetscScalar deltaT_fd, const PetscScalar R,
+    bool& mustSwitch);
+
+  PetscErrorCode writeContext(PetscViewer& viewer);
+  PetscErrorCode view();
+
+private:
+  // disable default copy constructor and assignment operator
+  RegimeSwitch(const RegimeSwitch& that);
+  RegimeSwitch& operator=(const RegimeSwitch& rhs);
+
+  PetscFileMode   _mode;
+  PetscViewer     _viewer; // regimeSwitch.txt
+
+  // current phase
+  bool            _started,_inDynamic;
+  double          _phaseStartWall;
+  PetscInt        _phaseStartStep,_phaseDelayed;
+
+  // trend of R
+  PetscScalar     _lastR,_lastTime,_growthRate;
+  PetscInt        _numSamples;
+
+  // cost model
+  double          _wallPerStep_qd,_wallPerStep_fd; // < 0 if not timed yet
+  PetscScalar     _deltaT_qd; // last qd time step
+
+  PetscErrorCode loadSettings(const char *file);
+  PetscErrorCode checkInput();
+  PetscErrorCode startPhase(const bool inDynamic, const PetscInt stepCount, const PetscScalar R, const PetscScalar time, const double wallTime);
+  PetscErrorCode writeSwitch(const PetscInt cycleCount, const PetscScalar time, const PetscInt stepCount,
+    const PetscScalar R, const PetscScalar predTime, const PetscScalar cost_qd, const PetscScalar cost_fd,
+    const double wallTime);
+};
+
+#endif
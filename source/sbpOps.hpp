@@ -14,6 +14,10 @@
  *         m                   4                 c
  *         m                   2                 fc
  *         m                   4                 fc
+ *         s                   2                 c     (constant grid spacing only)
+ *         s                   4                 c     (constant grid spacing only)
+ *         s                   2                 fc    (constant grid spacing only)
+ *         s                   4                 fc    (constant grid spacing only)
  *
  *
  * To create a member of this class, several functions need to be called called to set up
@@ -0,0 +1,1089 @@
+#include "sbpOps_mf_constGrid.hpp"
+
+#define FILENAME "sbpOps_mf_constGrid.cpp"
+
+
+//======================================================================
+// callbacks for MATSHELL objects
+//======================================================================
+
+static PetscErrorCode MfShellMult(Mat mat,Vec in,Vec out)
+{
+  PetscErrorCode ierr = 0;
+  MfShellCtx *ctx;
+  ierr = MatShellGetContext(mat,&ctx); CHKERRQ(ierr);
+  ierr = ctx->_sbp->shellMult(ctx->_type,in,out); CHKERRQ(ierr);
+  return ierr;
+}
+
+static PetscErrorCode MfShellGetDiagonal(Mat mat,Vec diag)
+{
+  PetscErrorCode ierr = 0;
+  MfShellCtx *ctx;
+  ierr = MatShellGetContext(mat,&ctx); CHKERRQ(ierr);
+  ierr = ctx->_sbp->shellGetDiagonal(ctx->_type,diag); CHKERRQ(ierr);
+  return ierr;
+}
+
+
+//======================================================================
+// 1D stencils
+//======================================================================
+
+Stencil1D::Stencil1D()
+: _N(0),_reach(0),_intStart(0),_intEnd(0)
+{}
+
+void Stencil1D::set(const Spmat& mat)
+{
+  _N = mat.size(1);
+  mat.convertToCSR(_rowStart,_cols,_vals);
+
+  _reach = 0;
+  for (PetscInt row = 0; row < _N; row++) {
+    for (PetscInt k = _rowStart[row]; k < _rowStart[row+1]; k++) {
+      _reach = max(_reach, (PetscInt) abs(_cols[k] - row));
+    }
+  }
+
+  // interior stencil: the largest block of rows around the middle row
+  // that have the same offsets and weights as the middle row
+  _intStart = 0; _intEnd = 0;
+  _intOffsets.clear(); _intWeights.clear();
+  if (_N < 1) { return; }
+  const PetscInt mid = _N/2;
+  for (PetscInt k = _rowStart[mid]; k < _rowStart[mid+1]; k++) {
+    _intOffsets.push_back(_cols[k] - mid);
+    _intWeights.push_back(_vals[k]);
+  }
+  if (_intOffsets.empty()) { return; }
+  _intStart = mid;
+  while (_intStart > 0 && matchesInterior(_intStart-1)) { _intStart--; }
+  _intEnd = mid + 1;
+  while (_intEnd < _N && matchesInterior(_intEnd)) { _intEnd++; }
+}
+
+bool Stencil1D::matchesInterior(const PetscInt row) const
+{
+  if (_rowStart[row+1] - _rowStart[row] != (PetscInt) _intOffsets.size()) { return 0; }
+  for (size_t k = 0; k < _intOffsets.size(); k++) {
+    const PetscInt Jj = _rowStart[row] + k;
+    if (_cols[Jj] - row != _intOffsets[k] || _vals[Jj] != _intWeights[k]) { return 0; }
+  }
+  return 1;
+}
+
+PetscScalar Stencil1D::operator()(const PetscInt row, const PetscInt col) const
+{
+  if (row < 0 || row >= _N) { return 0.0; }
+  for (PetscInt k = _rowStart[row]; k < _rowStart[row+1]; k++) {
+    if (_cols[k] == col) { return _vals[k]; }
+  }
+  return 0.0;
+}
+
+
+//======================================================================
+// constructor and destructor
+//======================================================================
+
+SbpOps_mf_constGrid::SbpOps_mf_constGrid(const int order,const PetscInt Ny,const PetscInt Nz,const PetscScalar Ly,const PetscScalar Lz,Vec& muVec)
+: _order(order),_Ny(Ny),_Nz(Nz),_dy(Ly/(Ny-1.)),_dz(Lz/(Nz-1.)),
+  _bcRType("unspecified"),_bcTType("unspecified"),
+  _bcLType("unspecified"),_bcBType("unspecified"),
+  _runTime(0),_compatibilityType("fullyCompatible"),_D2type("yz"),
+  _multByH(0),_deleteMats(0),
+  _Istart(0),_Iend(0),_gStart(0),_gEnd(0),
+  _scatterGhost(NULL),_inLoc(NULL),_scatterY0(NULL),_scatterZ0(NULL),_bcY0(NULL),_bcZ0(NULL)
+{
+#if VERBOSE > 1
+  PetscPrintf(PETSC_COMM_WORLD,"Starting constructor in %s.\n",FILENAME);
+#endif
+
+  // ensure this is in an acceptable state
+  assert(order == 2 || order == 4);
+  assert(Ny > 0); assert(Nz > 0);
+  assert(Ly > 0); assert(Lz > 0);
+  if (Ny == 1) { _dy = Ly; }
+  if (Nz == 1) { _dz = Lz; }
+  assert(muVec != NULL);
+  VecDuplicate(muVec, &_muVec);
+  VecCopy(muVec, _muVec);
+
+  for (int dir = 0; dir < 2; dir++) {
+    _bc0[dir] = MF_DIRICHLET;
+    _bcN[dir] = MF_DIRICHLET;
+  }
+
+  for (int Ii = 0; Ii < MF_NUMSHELLS; Ii++) {
+    _shells[Ii] = NULL;
+    _shellCtx[Ii]._sbp = this;
+    _shellCtx[Ii]._type = Ii;
+  }
+
+  // penalty weights
+  _alphaT = -1.0; // von Neumann
+  _beta= 1.0; // 1 part of Dirichlet
+  if (_order == 2) {
+    _alphaDy = -4.0/_dy;
+    _alphaDz = -4.0/_dz;
+    _h11y = 0.5 * _dy;
+    _h11z = 0.5 * _dz;
+  }
+  else if (_order == 4) {
+    _alphaDy = 2.0*-48.0/17.0 /_dy;
+    _alphaDz = 2.0*-48.0/17.0 /_dz;
+    _h11y = 17.0/48.0 * _dy;
+    _h11z = 17.0/48.0 * _dz;
+  }
+
+#if VERBOSE > 1
+  PetscPrintf(PETSC_COMM_WORLD,"Ending constructor in %s.\n",FILENAME);
+#endif
+}
+
+
+SbpOps_mf_constGrid::~SbpOps_mf_constGrid()
+{
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Starting destructor in %s.\n",FILENAME);
+  #endif
+
+  VecDestroy(&_muVec);
+  VecDestroy(&_inLoc);
+  VecDestroy(&_bcY0);
+  VecDestroy(&_bcZ0);
+  VecScatterDestroy(&_scatterGhost);
+  VecScatterDestroy(&_scatterY0);
+  VecScatterDestroy(&_scatterZ0);
+
+  for (int Ii = 0; Ii < MF_NUMSHELLS; Ii++) { MatDestroy(&_shells[Ii]); }
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending destructor in %s.\n",FILENAME);
+  #endif
+}
+
+
+//======================================================================
+// functions for setting options for class
+//======================================================================
+
+PetscErrorCode SbpOps_mf_constGrid::setBCTypes(std::string bcR, std::string bcT, std::string bcL, std::string bcB)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "SbpOps_mf_constGrid::setBCTypes";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  // check that each string is a valid option
+  assert(bcR.compare("Dirichlet") == 0 || bcR.compare("Neumann") == 0 );
+  assert(bcT.compare("Dirichlet") == 0 || bcT.compare("Neumann") == 0 );
+  assert(bcL.compare("Dirichlet") == 0 || bcL.compare("Neumann") == 0 );
+  assert(bcB.compare("Dirichlet") == 0 || bcB.compare("Neumann") == 0 );
+
+  _bcRType = bcR;
+  _bcTType = bcT;
+  _bcLType = bcL;
+  _bcBType = bcB;
+
+  // so the kernels do not compare strings
+  _bc0[0] = (bcL.compare("Neumann") == 0) ? MF_NEUMANN : MF_DIRICHLET;
+  _bcN[0] = (bcR.compare("Neumann") == 0) ? MF_NEUMANN : MF_DIRICHLET;
+  _bc0[1] = (bcT.compare("Neumann") == 0) ? MF_NEUMANN : MF_DIRICHLET;
+  _bcN[1] = (bcB.compare("Neumann") == 0) ? MF_NEUMANN : MF_DIRICHLET;
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+
+// not used for this type of SBP operator
+PetscErrorCode SbpOps_mf_constGrid::setGrid(Vec* y, Vec* z) { return 0; }
+
+PetscErrorCode SbpOps_mf_constGrid::setMultiplyByH(const int multByH)
+{
+  assert( multByH == 1 || multByH == 0 );
+  _multByH = multByH;
+  return 0;
+}
+
+PetscErrorCode SbpOps_mf_constGrid::setLaplaceType(const std::string type)
+{
+  _D2type = type;
+  assert(_D2type.compare("yz") == 0 || _D2type.compare("y") == 0 || _D2type.compare("z") == 0 );
+  return 0;
+}
+
+PetscErrorCode SbpOps_mf_constGrid::setCompatibilityType(const string type)
+{
+  _compatibilityType = type;
+  assert(_compatibilityType.compare("fullyCompatible") == 0 || _compatibilityType.compare("compatible") == 0 );
+  return 0;
+}
+
+// nothing is stored that could be deleted
+PetscErrorCode SbpOps_mf_constGrid::setDeleteIntermediateFields(const int deleteMats)
+{
+  assert(deleteMats == 0 || deleteMats == 1);
+  _deleteMats = deleteMats;
+  return 0;
+}
+
+// the boundary conditions are applied on the fly, so no operators need to be rebuilt
+PetscErrorCode SbpOps_mf_constGrid::changeBCTypes(std::string bcR, std::string bcT, std::string bcL, std::string bcB)
+{
+  return setBCTypes(bcR,bcT,bcL,bcB);
+}
+
+
+//======================================================================
+// functions for constructing the 1D operators and shells
+//======================================================================
+
+PetscErrorCode SbpOps_mf_constGrid::computeMatrices()
+{
+  PetscErrorCode ierr = 0;
+  double startTime = MPI_Wtime();
+  #if VERBOSE > 1
+    string funcName = "SbpOps_mf_constGrid::computeMatrices";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  ierr = construct1DOps(_opsY,_Ny,_dy); CHKERRQ(ierr);
+  ierr = construct1DOps(_opsZ,_Nz,_dz); CHKERRQ(ierr);
+  ierr = setUpScatters(); CHKERRQ(ierr);
+  ierr = updateMuLoc(); CHKERRQ(ierr);
+  ierr = setUpShells(); CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  _runTime += MPI_Wtime() - startTime;
+  return ierr;
+}
+
+
+// store 1D operators in 1 direction, using the same functions as the matrix-based operators
+PetscErrorCode SbpOps_mf_constGrid::construct1DOps(Ops1D_mf& ops,const PetscInt N,const PetscScalar d)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "SbpOps_mf_constGrid::construct1DOps";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  ops._N = N;
+
+  Spmat H(N,N),Hinv(N,N),D1(N,N),D1int(N,N),BS(N,N);
+  ierr = sbp_Spmat(_order,N,1./d,H,Hinv,D1,D1int,BS,_compatibilityType); CHKERRQ(ierr);
+
+  ops._H.resize(N);
+  ops._Hinv.resize(N);
+  for (PetscInt Ii = 0; Ii < N; Ii++) {
+    ops._H[Ii] = H(Ii,Ii);
+    ops._Hinv[Ii] = Hinv(Ii,Ii);
+  }
+
+  ops._D1.set(D1);
+  Spmat D1T(D1); D1T.transpose();
+  ops._D1T.set(D1T);
+  Spmat BST(BS); BST.transpose();
+  ops._BST.set(BST);
+  ops._D1_00 = D1(0,0); ops._D1_NN = D1(N-1,N-1);
+  ops._BS_00 = BS(0,0); ops._BS_NN = BS(N-1,N-1);
+
+  // remainder terms, see SbpOps_m_constGrid::constructRymu
+  ops._Ca.assign(N,0.0);
+  ops._Cb.assign(N,0.0);
+  if (_order == 2) {
+    Spmat D2(N,N),C2(N,N);
+    ierr = sbp_Spmat2(N,1.0/d,D2,C2); CHKERRQ(ierr);
+    ops._Da.set(D2);
+    Spmat D2T(D2); D2T.transpose();
+    ops._DaT.set(D2T);
+    for (PetscInt Ii = 0; Ii < N; Ii++) { ops._Ca[Ii] = C2(Ii,Ii); }
+    ops._scaleA = 0.25*pow(d,3);
+    ops._useMu3 = 0;
+    ops._scaleB = 0.0;
+  }
+  else if (_order == 4) {
+    Spmat D3(N,N),D4(N,N),C3(N,N),C4(N,N);
+    ierr = sbp_Spmat4(N,1/d,D3,D4,C3,C4); CHKERRQ(ierr);
+    ops._Da.set(D3);
+    Spmat D3T(D3); D3T.transpose();
+    ops._DaT.set(D3T);
+    ops._Db.set(D4);
+    Spmat D4T(D4); D4T.transpose();
+    ops._DbT.set(D4T);
+    for (PetscInt Ii = 0; Ii < N; Ii++) {
+      ops._Ca[Ii] = C3(Ii,Ii);
+      ops._Cb[Ii] = C4(Ii,Ii);
+    }
+    ops._scaleA = 1.0/d/18.0;
+    ops._useMu3 = 1;
+    ops._scaleB = 1.0/d/144.0;
+  }
+
+  ops._reach = max(max(ops._D1._reach,ops._BST._reach),max(ops._Da._reach,ops._Db._reach));
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+
+// set up scatter from a body Vec to this processor's rows plus ghost rows
+// wide enough for 2 consecutive stencil applications
+PetscErrorCode SbpOps_mf_constGrid::setUpScatters()
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "SbpOps_mf_constGrid::setUpScatters";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  ierr = VecGetOwnershipRange(_muVec,&_Istart,&_Iend); CHKERRQ(ierr);
+  const PetscInt halo = 2 * max(_opsY._reach*_Nz, _opsZ._reach);
+  expand(_Istart,_Iend,halo,_gStart,_gEnd);
+  const PetscInt nLoc = _gEnd - _gStart;
+
+  VecDestroy(&_inLoc);
+  VecScatterDestroy(&_scatterGhost);
+  ierr = VecCreateSeq(PETSC_COMM_SELF,nLoc,&_inLoc); CHKERRQ(ierr);
+  IS isf; ierr = ISCreateStride(PETSC_COMM_SELF,nLoc,_gStart,1,&isf); CHKERRQ(ierr);
+  IS ist; ierr = ISCreateStride(PETSC_COMM_SELF,nLoc,0,1,&ist); CHKERRQ(ierr);
+  ierr = VecScatterCreate(_muVec,isf,_inLoc,ist,&_scatterGhost); CHKERRQ(ierr);
+  ISDestroy(&isf);
+  ISDestroy(&ist);
+
+  _muLoc.assign(nLoc,0.0);
+  _mu3yLoc.assign(nLoc,0.0);
+  _mu3zLoc.assign(nLoc,0.0);
+  _t1.assign(nLoc,0.0);
+  _t2.assign(nLoc,0.0);
+  _acc.assign(nLoc,0.0);
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+
+PetscErrorCode SbpOps_mf_constGrid::setUpShells()
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    string funcName = "SbpOps_mf_constGrid::setUpShells";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  const PetscInt N = _Ny*_Nz;
+  for (int Ii = 0; Ii < MF_NUMSHELLS; Ii++) {
+    MatDestroy(&_shells[Ii]);
+
+    PetscInt cols = N;
+    if (Ii == MF_e0Y || Ii == MF_eNY) { cols = _Nz; }
+    else if (Ii == MF_e0Z || Ii == MF_eNZ) { cols = _Ny; }
+
+    ierr = MatCreateShell(PETSC_COMM_WORLD,PETSC_DECIDE,PETSC_DECIDE,N,cols,&_shellCtx[Ii],&_shells[Ii]); CHKERRQ(ierr);
+    ierr = MatShellSetOperation(_shells[Ii],MATOP_MULT,(void(*)(void))MfShellMult); CHKERRQ(ierr);
+    if (Ii != MF_DY && Ii != MF_DZ && cols == N) {
+      ierr = MatShellSetOperation(_shells[Ii],MATOP_GET_DIAGONAL,(void(*)(void))MfShellGetDiagonal); CHKERRQ(ierr);
+    }
+  }
+  if (_multByH) { ierr = MatSetOption(_shells[MF_A],MAT_SYMMETRIC,PETSC_TRUE); CHKERRQ(ierr); }
+  ierr = PetscObjectSetName((PetscObject) _shells[MF_A], "_A"); CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+
+// copy coefficient onto local + ghost rows, and form mu3 for the 4th order
+// remainder terms as in SbpOps_m_constGrid::constructRymu (y) and
+// constructRzmu (z), where mu3 is a diagonal matrix in the global ordering:
+//   y: mu3(i) = 0.5*(mu(i) + mu(i+1)),  mu3(N-1) = 0.5*(mu(N-1) + mu(N-2))
+//   z: as y, except mu3(0) = 0.5*(mu(0) + 2*mu(1)) and mu3(N-2) = 0.5*mu(N-2)
+// with N = Ny*Nz. The matrix-based operators build mu3 from the values
+// owned by each processor, so with more than one processor they also leave
+// out mu(i+1) in the last row of each processor. That depends on the
+// partitioning, so it is not reproduced here: the two agree on one
+// processor.
+PetscErrorCode SbpOps_mf_constGrid::updateMuLoc()
+{
+  PetscErrorCode ierr = 0;
+
+  ierr = scatterToLocal(_muVec); CHKERRQ(ierr);
+  const PetscScalar *mu;
+  ierr = VecGetArrayRead(_inLoc,&mu); CHKERRQ(ierr);
+  const PetscInt nLoc = _gEnd - _gStart;
+  const PetscInt N = _Ny*_Nz;
+  for (PetscInt Jj = 0; Jj < nLoc; Jj++) {
+    _muLoc[Jj] = mu[Jj];
+    const PetscInt Ii = _gStart + Jj;
+    if (Ii == N - 1 && Jj > 0) { _mu3yLoc[Jj] = 0.5*(mu[Jj] + mu[Jj-1]); }
+    else if (Jj + 1 < nLoc) { _mu3yLoc[Jj] = 0.5*(mu[Jj] + mu[Jj+1]); }
+    else { _mu3yLoc[Jj] = 0.5*mu[Jj]; } // outside the range any stencil reaches
+
+    _mu3zLoc[Jj] = _mu3yLoc[Jj];
+    if (Ii == 0 && N > 1 && Jj + 1 < nLoc) { _mu3zLoc[Jj] = 0.5*(mu[Jj] + 2.0*mu[Jj+1]); }
+    else if (Ii == N - 2) { _mu3zLoc[Jj] = 0.5*mu[Jj]; }
+  }
+  ierr = VecRestoreArrayRead(_inLoc,&mu); CHKERRQ(ierr);
+
+  return ierr;
+}
+
+
+PetscErrorCode SbpOps_mf_constGrid::scatterToLocal(const Vec& in)
+{
+  PetscErrorCode ierr = 0;
+  ierr = VecScatterBegin(_scatterGhost, in, _inLoc, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+  ierr = VecScatterEnd(_scatterGhost, in, _inLoc, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+  return ierr;
+}
+
+
+// gather 1D Vec onto every processor
+// dir = 0: Vec of length Nz (on y=0 or y=Ly), dir = 1: Vec of length Ny (on z=0 or z=Lz)
+PetscErrorCode SbpOps_mf_constGrid::scatter1D(const int dir, const Vec& in, vector<PetscScalar>& arr)
+{
+  PetscErrorCode ierr = 0;
+
+  VecScatter& scatter = (dir == 0) ? _scatterY0 : _scatterZ0;
+  Vec& all = (dir == 0) ? _bcY0 : _bcZ0;
+  if (scatter == NULL) { ierr = VecScatterCreateToAll(in,&scatter,&all); CHKERRQ(ierr); }
+
+  ierr = VecScatterBegin(scatter, in, all, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+  ierr = VecScatterEnd(scatter, in, all, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+
+  PetscInt len;
+  const PetscScalar *a;
+  ierr = VecGetSize(all,&len); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(all,&a); CHKERRQ(ierr);
+  arr.assign(a,a+len);
+  ierr = VecRestoreArrayRead(all,&a); CHKERRQ(ierr);
+
+  return ierr;
+}
+
+
+//======================================================================
+// stencil kernels
+//======================================================================
+
+// range of global rows [lo,hi) extended by width on each side
+void SbpOps_mf_constGrid::expand(const PetscInt lo, const PetscInt hi, const PetscInt width, PetscInt& elo, PetscInt& ehi) const
+{
+  elo = max((PetscInt) 0, lo - width);
+  ehi = min(_Ny*_Nz, hi + width);
+}
+
+bool SbpOps_mf_constGrid::isActive(const int dir) const
+{
+  if (_D2type.compare("yz") == 0) { return 1; }
+  if (dir == 0) { return _D2type.compare("y") == 0; }
+  return _D2type.compare("z") == 0;
+}
+
+
+// out = S * in along y for global rows [lo,hi)
+// Rows with the same y index are contiguous, so each stencil entry is
+// applied to a contiguous piece of a z-line.
+void SbpOps_mf_constGrid::applyY(const Stencil1D& S, const PetscScalar *in, PetscScalar *out, const PetscInt lo, const PetscInt hi) const
+{
+  if (lo >= hi) { return; }
+  const PetscInt IyStart = lo/_Nz, IyEnd = (hi-1)/_Nz + 1;
+  for (PetscInt Iy = IyStart; Iy < IyEnd; Iy++) {
+    const PetscInt a = max(lo, Iy*_Nz), b = min(hi, (Iy+1)*_Nz), len = b - a;
+    PetscScalar *o = out + a - _gStart;
+    for (PetscInt Jj = 0; Jj < len; Jj++) { o[Jj] = 0.0; }
+    if (S._N < 1) { continue; }
+    for (PetscInt k = S._rowStart[Iy]; k < S._rowStart[Iy+1]; k++) {
+      const PetscScalar v = S._vals[k];
+      const PetscScalar *src = in + S._cols[k]*_Nz + (a - Iy*_Nz) - _gStart;
+      for (PetscInt Jj = 0; Jj < len; Jj++) { o[Jj] += v * src[Jj]; }
+    }
+  }
+}
+
+// out = S * in along z for global rows [lo,hi)
+void SbpOps_mf_constGrid::applyZ(const Stencil1D& S, const PetscScalar *in, PetscScalar *out, const PetscInt lo, const PetscInt hi) const
+{
+  if (lo >= hi) { return; }
+  const PetscInt nInt = S._intOffsets.size();
+  const PetscInt IyStart = lo/_Nz, IyEnd = (hi-1)/_Nz + 1;
+  for (PetscInt Iy = IyStart; Iy < IyEnd; Iy++) {
+    const PetscInt a = max(lo, Iy*_Nz), b = min(hi, (Iy+1)*_Nz);
+    const PetscScalar *line = in + Iy*_Nz - _gStart;
+    PetscScalar *o = out + Iy*_Nz - _gStart;
+    for (PetscInt Iz = a - Iy*_Nz; Iz < b - Iy*_Nz; Iz++) {
+      PetscScalar sum = 0.0;
+      if (S._N < 1) { o[Iz] = 0.0; continue; }
+      if (Iz >= S._intStart && Iz < S._intEnd) { // interior stencil
+        for (PetscInt k = 0; k < nInt; k++) { sum += S._intWeights[k] * line[Iz + S._intOffsets[k]]; }
+      }
+      else { // boundary closure
+        for (PetscInt k = S._rowStart[Iz]; k < S._rowStart[Iz+1]; k++) { sum += S._vals[k] * line[S._cols[k]]; }
+      }
+      o[Iz] = sum;
+    }
+  }
+}
+
+void SbpOps_mf_constGrid::apply1D(const int dir, const Stencil1D& S, const PetscScalar *in, PetscScalar *out, const PetscInt lo, const PetscInt hi) const
+{
+  if (dir == 0) { applyY(S,in,out,lo,hi); }
+  else { applyZ(S,in,out,lo,hi); }
+}
+
+// out = w1D[I1] * in for global rows [lo,hi), where I1 is the index of the
+// row in direction dir (Iy for dir = 0, Iz for dir = 1)
+// Rows are visited one z-line at a time, so I1 is never computed from Ii.
+void SbpOps_mf_constGrid::scaleLines(const int dir, const PetscScalar *w1D, const PetscScalar *in, PetscScalar *out, const PetscInt lo, const PetscInt hi) const
+{
+  if (lo >= hi) { return; }
+  const PetscInt IyStart = lo/_Nz, IyEnd = (hi-1)/_Nz + 1;
+  for (PetscInt Iy = IyStart; Iy < IyEnd; Iy++) {
+    const PetscInt a = max(lo, Iy*_Nz) - Iy*_Nz, b = min(hi, (Iy+1)*_Nz) - Iy*_Nz;
+    const PetscScalar *src = in + Iy*_Nz - _gStart;
+    PetscScalar *dst = out + Iy*_Nz - _gStart;
+    if (dir == 0) {
+      const PetscScalar w = w1D[Iy];
+      for (PetscInt Iz = a; Iz < b; Iz++) { dst[Iz] = w * src[Iz]; }
+    }
+    else {
+      for (PetscInt Iz = a; Iz < b; Iz++) { dst[Iz] = w1D[Iz] * src[Iz]; }
+    }
+  }
+}
+
+// the rows with index 0 (side = 0) or N-1 (side = 1) in direction dir are
+// first + k*step for k = 0,...,count-1: one z-line for dir = 0, and one row
+// per z-line for dir = 1
+void SbpOps_mf_constGrid::faceRows(const int dir, const int side, PetscInt& first, PetscInt& step, PetscInt& count) const
+{
+  if (dir == 0) {
+    first = side * (_Ny-1)*_Nz;
+    step = 1;
+    count = _Nz;
+  }
+  else {
+    first = side * (_Nz-1);
+    step = _Nz;
+    count = _Ny;
+  }
+}
+
+
+// acc += Dyymu * u + SAT terms for y = 0 and y = Ly (dir = 0), or the
+// equivalent in z (dir = 1), for the local rows. See
+// SbpOps_m_constGrid::constructDyymu, constructBC_Neumann, and constructBC_Dirichlet.
+void SbpOps_mf_constGrid::addSecondDeriv(const int dir, const PetscScalar *u, PetscScalar *acc)
+{
+  const Ops1D_mf& ops = (dir == 0) ? _opsY : _opsZ;
+  const PetscInt N = ops._N;
+  const PetscInt stride = (dir == 0) ? _Nz : 1;
+  const BCType bc[2] = { _bc0[dir], _bcN[dir] };
+  const PetscScalar alphaD = (dir == 0) ? _alphaDy : _alphaDz;
+  const PetscScalar satN[2] = { -1.0 * _alphaT * ops._Hinv[0], 1.0 * _alphaT * ops._Hinv[N-1] }; // Bfact * alphaT * Hinv
+  PetscScalar *t1 = &_t1[0], *t2 = &_t2[0];
+  const PetscScalar *mu = &_muLoc[0], *mu3 = (dir == 0) ? &_mu3yLoc[0] : &_mu3zLoc[0];
+  PetscInt first,step,count;
+
+  PetscInt elo,ehi;
+  expand(_Istart,_Iend,ops._reach*stride,elo,ehi);
+
+  // D1 * mu * D1 * u
+  apply1D(dir,ops._D1,u,t1,elo,ehi);
+  for (PetscInt Ii = elo; Ii < ehi; Ii++) { t1[Ii-_gStart] *= mu[Ii-_gStart]; }
+  apply1D(dir,ops._D1,t1,t2,_Istart,_Iend);
+  for (PetscInt Ii = _Istart; Ii < _Iend; Ii++) { acc[Ii-_gStart] += t2[Ii-_gStart]; }
+
+  // Neumann SAT: alphaT * Bfact * Hinv * E * mu * D1 * u
+  for (int side = 0; side < 2 && N > 1; side++) {
+    if (bc[side] != MF_NEUMANN) { continue; }
+    faceRows(dir,side,first,step,count);
+    for (PetscInt k = 0; k < count; k++) {
+      const PetscInt Ii = first + k*step;
+      if (Ii >= _Istart && Ii < _Iend) { acc[Ii-_gStart] += satN[side] * t1[Ii-_gStart]; }
+    }
+  }
+
+  // remainder: - Hinv * (scaleA * DaT * Ca * mu3 * Da + scaleB * DbT * Cb * mu * Db) * u
+  for (int term = 0; term < 2; term++) {
+    const Stencil1D& D = (term == 0) ? ops._Da : ops._Db;
+    const Stencil1D& DT = (term == 0) ? ops._DaT : ops._DbT;
+    const vector<PetscScalar>& C = (term == 0) ? ops._Ca : ops._Cb;
+    const PetscScalar scale = (term == 0) ? ops._scaleA : ops._scaleB;
+    const PetscScalar *coeff = (term == 0 && ops._useMu3) ? mu3 : mu;
+    if (D._N < 1) { continue; }
+
+    apply1D(dir,D,u,t1,elo,ehi);
+    for (PetscInt Ii = elo; Ii < ehi; Ii++) { t1[Ii-_gStart] *= coeff[Ii-_gStart]; }
+    scaleLines(dir,&C[0],t1,t1,elo,ehi);
+    apply1D(dir,DT,t1,t2,_Istart,_Iend);
+    scaleLines(dir,&ops._Hinv[0],t2,t2,_Istart,_Iend);
+    for (PetscInt Ii = _Istart; Ii < _Iend; Ii++) { acc[Ii-_gStart] -= scale * t2[Ii-_gStart]; }
+  }
+
+  // Dirichlet SAT: Hinv * (BS^T * mu * E + alphaD * mu * E) * u
+  if (N > 1 && (bc[0] == MF_DIRICHLET || bc[1] == MF_DIRICHLET)) {
+    for (PetscInt Ii = elo; Ii < ehi; Ii++) { t1[Ii-_gStart] = 0.0; }
+    for (int side = 0; side < 2; side++) {
+      if (bc[side] != MF_DIRICHLET) { continue; }
+      faceRows(dir,side,first,step,count);
+      for (PetscInt k = 0; k < count; k++) {
+        const PetscInt Ii = first + k*step;
+        if (Ii >= elo && Ii < ehi) { t1[Ii-_gStart] = mu[Ii-_gStart] * u[Ii-_gStart]; }
+      }
+    }
+    apply1D(dir,ops._BST,t1,t2,_Istart,_Iend);
+    for (PetscInt Ii = _Istart; Ii < _Iend; Ii++) { t2[Ii-_gStart] += alphaD * t1[Ii-_gStart]; }
+    scaleLines(dir,&ops._Hinv[0],t2,t2,_Istart,_Iend);
+    for (PetscInt Ii = _Istart; Ii < _Iend; Ii++) { acc[Ii-_gStart] += t2[Ii-_gStart]; }
+  }
+}
+
+
+// diagonal entry of the operator added by addSecondDeriv
+PetscScalar SbpOps_mf_constGrid::diagSecondDeriv(const int dir, const PetscInt Ii) const
+{
+  const Ops1D_mf& ops = (dir == 0) ? _opsY : _opsZ;
+  const PetscInt N = ops._N;
+  const PetscInt stride = (dir == 0) ? _Nz : 1;
+  const PetscInt I1 = (Ii/stride) % N;
+  const PetscInt base = Ii - I1*stride - _gStart; // location of entry 0 of this line in local arrays
+  const PetscScalar alphaD = (dir == 0) ? _alphaDy : _alphaDz;
+  const PetscScalar mu = _muLoc[Ii-_gStart];
+  const vector<PetscScalar>& mu3 = (dir == 0) ? _mu3yLoc : _mu3zLoc;
+
+  // D1 * mu * D1: sum_j D1(I1,j) * mu(j) * D1(j,I1)
+  PetscScalar diag = 0.0;
+  for (PetscInt k = ops._D1T._rowStart[I1]; k < ops._D1T._rowStart[I1+1]; k++) {
+    const PetscInt Jj = ops._D1T._cols[k];
+    diag += ops._D1(I1,Jj) * _muLoc[base + Jj*stride] * ops._D1T._vals[k];
+  }
+
+  // remainder: sum_j D(j,I1)^2 * C(j) * mu(j)
+  if (ops._DaT._N > 0) {
+    for (PetscInt k = ops._DaT._rowStart[I1]; k < ops._DaT._rowStart[I1+1]; k++) {
+      const PetscInt Jj = ops._DaT._cols[k];
+      const PetscScalar coeff = ops._useMu3 ? mu3[base + Jj*stride] : _muLoc[base + Jj*stride];
+      diag -= ops._Hinv[I1] * ops._scaleA * ops._DaT._vals[k] * ops._DaT._vals[k] * ops._Ca[Jj] * coeff;
+    }
+  }
+  if (ops._DbT._N > 0) {
+    for (PetscInt k = ops._DbT._rowStart[I1]; k < ops._DbT._rowStart[I1+1]; k++) {
+      const PetscInt Jj = ops._DbT._cols[k];
+      diag -= ops._Hinv[I1] * ops._scaleB * ops._DbT._vals[k] * ops._DbT._vals[k] * ops._Cb[Jj] * _muLoc[base + Jj*stride];
+    }
+  }
+
+  // SAT terms
+  if (N > 1 && I1 == 0) {
+    if (_bc0[dir] == MF_NEUMANN) { diag += -1.0 * _alphaT * ops._Hinv[0] * mu * ops._D1_00; }
+    else { diag += ops._Hinv[0] * (ops._BS_00 + alphaD) * mu; }
+  }
+  if (N > 1 && I1 == N-1) {
+    if (_bcN[dir] == MF_NEUMANN) { diag += _alphaT * ops._Hinv[N-1] * mu * ops._D1_NN; }
+    else { diag += ops._Hinv[N-1] * (ops._BS_NN + alphaD) * mu; }
+  }
+
+  return diag;
+}
+
+
+//======================================================================
+// functions to apply the operators
+//======================================================================
+
+// out = A * in
+PetscErrorCode SbpOps_mf_constGrid::applyA(const Vec &in, Vec &out)
+{
+  PetscErrorCode ierr = 0;
+  double startTime = MPI_Wtime();
+
+  ierr = scatterToLocal(in); CHKERRQ(ierr);
+  const PetscScalar *u;
+  ierr = VecGetArrayRead(_inLoc,&u); CHKERRQ(ierr);
+
+  PetscScalar *acc = &_acc[0];
+  for (PetscInt Ii = _Istart; Ii < _Iend; Ii++) { acc[Ii-_gStart] = 0.0; }
+  if (isActive(0)) { addSecondDeriv(0,u,acc); }
+  if (isActive(1)) { addSecondDeriv(1,u,acc); }
+
+  ierr = VecRestoreArrayRead(_inLoc,&u); CHKERRQ(ierr);
+
+  PetscScalar *o;
+  ierr = VecGetArray(out,&o); CHKERRQ(ierr);
+  for (PetscInt Ii = _Istart; Ii < _Iend; Ii++) {
+    o[Ii-_Istart] = acc[Ii-_gStart];
+    if (_multByH) { o[Ii-_Istart] *= diagCoeff(MF_H,Ii); }
+  }
+  ierr = VecRestoreArray(out,&o); CHKERRQ(ierr);
+
+  _runTime += MPI_Wtime() - startTime;
+  return ierr;
+}
+
+PetscErrorCode SbpOps_mf_constGrid::getDiagonalA(Vec &diag)
+{
+  PetscErrorCode ierr = 0;
+
+  PetscScalar *d;
+  ierr = VecGetArray(diag,&d); CHKERRQ(ierr);
+  for (PetscInt Ii = _Istart; Ii < _Iend; Ii++) {
+    d[Ii-_Istart] = 0.0;
+    if (isActive(0)) { d[Ii-_Istart] += diagSecondDeriv(0,Ii); }
+    if (isActive(1)) { d[Ii-_Istart] += diagSecondDeriv(1,Ii); }
+    if (_multByH) { d[Ii-_Istart] *= diagCoeff(MF_H,Ii); }
+  }
+  ierr = VecRestoreArray(diag,&d); CHKERRQ(ierr);
+
+  return ierr;
+}
+
+
+// entry Ii of diagonal operators
+PetscScalar SbpOps_mf_constGrid::diagCoeff(const int type, const PetscInt Ii) const
+{
+  const PetscInt Iy = Ii/_Nz;
+  const PetscInt Iz = Ii - Iy*_Nz;
+  switch (type) {
+    case MF_H: return _opsY._H[Iy] * _opsZ._H[Iz];
+    case MF_HINV: return _opsY._Hinv[Iy] * _opsZ._Hinv[Iz];
+    case MF_MU: return _muLoc[Ii-_gStart];
+    case MF_HY: return _opsY._H[Iy];
+    case MF_HZ: return _opsZ._H[Iz];
+    case MF_HYINV: return _opsY._Hinv[Iy];
+    case MF_HZINV: return _opsZ._Hinv[Iz];
+    case MF_E0Y: return (_Ny > 1 && Iy == 0) ? 1.0 : 0.0;
+    case MF_ENY: return (_Ny > 1 && Iy == _Ny-1) ? 1.0 : 0.0;
+    case MF_E0Z: return (_Nz > 1 && Iz == 0) ? 1.0 : 0.0;
+    case MF_ENZ: return (_Nz > 1 && Iz == _Nz-1) ? 1.0 : 0.0;
+    default: return 1.0;
+  }
+}
+
+// out = diag(type) * diag(type2) * in, type2 < 0 to ignore
+PetscErrorCode SbpOps_mf_constGrid::applyDiag(const int type, const int type2, const Vec& in, Vec& out)
+{
+  PetscErrorCode ierr = 0;
+
+  const PetscScalar *i;
+  PetscScalar *o;
+  ierr = VecGetArrayRead(in,&i); CHKERRQ(ierr);
+  ierr = VecGetArray(out,&o); CHKERRQ(ierr);
+  for (PetscInt Ii = _Istart; Ii < _Iend; Ii++) {
+    PetscScalar coeff = diagCoeff(type,Ii);
+    if (type2 >= 0) { coeff *= diagCoeff(type2,Ii); }
+    o[Ii-_Istart] = coeff * i[Ii-_Istart];
+  }
+  ierr = VecRestoreArrayRead(in,&i); CHKERRQ(ierr);
+  ierr = VecRestoreArray(out,&o); CHKERRQ(ierr);
+
+  return ierr;
+}
+
+// out = scale * e * in, where e is one of e0y, eNy, e0z, eNz
+PetscErrorCode SbpOps_mf_constGrid::apply1DToBody(const int type, const PetscScalar scale, const Vec& in, Vec& out)
+{
+  PetscErrorCode ierr = 0;
+
+  const int dir = (type == MF_e0Y || type == MF_eNY) ? 0 : 1;
+  vector<PetscScalar> bc;
+  ierr = scatter1D(dir,in,bc); CHKERRQ(ierr);
+
+  PetscScalar *o;
+  ierr = VecGetArray(out,&o); CHKERRQ(ierr);
+  for (PetscInt Ii = _Istart; Ii < _Iend; Ii++) {
+    const PetscInt Iy = Ii/_Nz;
+    const PetscInt Iz = Ii - Iy*_Nz;
+    o[Ii-_Istart] = 0.0;
+    if (type == MF_e0Y && _Ny > 1 && Iy == 0) { o[Ii-_Istart] = scale * bc[Iz]; }
+    else if (type == MF_eNY && _Ny > 1 && Iy == _Ny-1) { o[Ii-_Istart] = scale * bc[Iz]; }
+    else if (type == MF_e0Z && _Nz > 1 && Iz == 0) { o[Ii-_Istart] = scale * bc[Iy]; }
+    else if (type == MF_eNZ && _Nz > 1 && Iz == _Nz-1) { o[Ii-_Istart] = scale * bc[Iy]; }
+  }
+  ierr = VecRestoreArray(out,&o); CHKERRQ(ierr);
+
+  return ierr;
+}
+
+// out = [mu] * D1 * [mu] * in along y (dir = 0) or z (dir = 1)
+PetscErrorCode SbpOps_mf_constGrid::applyDerivative(const int dir, const int muBefore, const int muAfter, const Vec &in, Vec &out)
+{
+  PetscErrorCode ierr = 0;
+  double startTime = MPI_Wtime();
+
+  const Ops1D_mf& ops = (dir == 0) ? _opsY : _opsZ;
+  const PetscInt stride = (dir == 0) ? _Nz : 1;
+
+  ierr = scatterToLocal(in); CHKERRQ(ierr);
+  const PetscScalar *u;
+  ierr = VecGetArrayRead(_inLoc,&u); CHKERRQ(ierr);
+
+  const PetscScalar *src = u;
+  if (muBefore) {
+    PetscInt elo,ehi;
+    expand(_Istart,_Iend,ops._reach*stride,elo,ehi);
+    for (PetscInt Ii = elo; Ii < ehi; Ii++) { _t1[Ii-_gStart] = _muLoc[Ii-_gStart] * u[Ii-_gStart]; }
+    src = &_t1[0];
+  }
+  apply1D(dir,ops._D1,src,&_t2[0],_Istart,_Iend);
+  ierr = VecRestoreArrayRead(_inLoc,&u); CHKERRQ(ierr);
+
+  PetscScalar *o;
+  ierr = VecGetArray(out,&o); CHKERRQ(ierr);
+  for (PetscInt Ii = _Istart; Ii < _Iend; Ii++) {
+    o[Ii-_Istart] = _t2[Ii-_gStart];
+    if (muAfter) { o[Ii-_Istart] *= _muLoc[Ii-_gStart]; }
+  }
+  ierr = VecRestoreArray(out,&o); CHKERRQ(ierr);
+
+  _runTime += MPI_Wtime() - startTime;
+  return ierr;
+}
+
+
+// called by the MATSHELL objects
+PetscErrorCode SbpOps_mf_constGrid::shellMult(const int type, const Vec &in, Vec &out)
+{
+  PetscErrorCode ierr = 0;
+  switch (type) {
+    case MF_A: ierr = applyA(in,out); CHKERRQ(ierr); break;
+    case MF_DY: ierr = applyDerivative(0,0,0,in,out); CHKERRQ(ierr); break;
+    case MF_DZ: ierr = applyDerivative(1,0,0,in,out); CHKERRQ(ierr); break;
+    case MF_e0Y: case MF_eNY: case MF_e0Z: case MF_eNZ:
+      ierr = apply1DToBody(type,1.0,in,out); CHKERRQ(ierr); break;
+    default: ierr = applyDiag(type,-1,in,out); CHKERRQ(ierr); break;
+  }
+  return ierr;
+}
+
+PetscErrorCode SbpOps_mf_constGrid::shellGetDiagonal(const int type, Vec &diag)
+{
+  PetscErrorCode ierr = 0;
+  if (type == MF_A) {
+    ierr = getDiagonalA(diag); CHKERRQ(ierr);
+  }
+  else {
+    PetscScalar *d;
+    ierr = VecGetArray(diag,&d); CHKERRQ(ierr);
+    for (PetscInt Ii = _Istart; Ii < _Iend; Ii++) { d[Ii-_Istart] = diagCoeff(type,Ii); }
+    ierr = VecRestoreArray(diag,&d); CHKERRQ(ierr);
+  }
+  return ierr;
+}
+
+
+// map the boundary condition vectors to rhs
+PetscErrorCode SbpOps_mf_constGrid::setRhs(Vec&rhs,Vec &bcL,Vec &bcR,Vec &bcT,Vec &bcB)
+{
+  PetscErrorCode ierr = 0;
+  double startTime = MPI_Wtime();
+  #if VERBOSE > 1
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Starting function setRhs in %s.\n", FILENAME);CHKERRQ(ierr);
+  #endif
+
+  PetscScalar *acc = &_acc[0];
+  for (PetscInt Ii = _Istart; Ii < _Iend; Ii++) { acc[Ii-_gStart] = 0.0; }
+  if (isActive(0)) { ierr = addBoundaryRhs(0,bcL,bcR,acc); CHKERRQ(ierr); }
+  if (isActive(1)) { ierr = addBoundaryRhs(1,bcT,bcB,acc); CHKERRQ(ierr); }
+
+  PetscScalar *o;
+  ierr = VecGetArray(rhs,&o); CHKERRQ(ierr);
+  for (PetscInt Ii = _Istart; Ii < _Iend; Ii++) {
+    o[Ii-_Istart] = acc[Ii-_gStart];
+    if (_multByH) { o[Ii-_Istart] *= diagCoeff(MF_H,Ii); }
+  }
+  ierr = VecRestoreArray(rhs,&o); CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending function setRhs in %s.\n", FILENAME);CHKERRQ(ierr);
+  #endif
+  _runTime += MPI_Wtime() - startTime;
+  return ierr;
+}
+
+// acc += rhs0 * bc0 + rhsN * bcN, where rhs0 and rhsN are the SAT terms for
+// y = 0 and y = Ly (dir = 0) or z = 0 and z = Lz (dir = 1)
+PetscErrorCode SbpOps_mf_constGrid::addBoundaryRhs(const int dir, const Vec& bc0, const Vec& bcN, PetscScalar *acc)
+{
+  PetscErrorCode ierr = 0;
+
+  const Ops1D_mf& ops = (dir == 0) ? _opsY : _opsZ;
+  const PetscInt N = ops._N;
+  if (N < 2) { return ierr; }
+  const PetscInt stride = (dir == 0) ? _Nz : 1;
+  const BCType bc[2] = { _bc0[dir], _bcN[dir] };
+  const PetscScalar alphaD = (dir == 0) ? _alphaDy : _alphaDz;
+  const PetscScalar satN[2] = { -1.0 * _alphaT * ops._Hinv[0], 1.0 * _alphaT * ops._Hinv[N-1] }; // Bfact * alphaT * Hinv
+
+  vector<PetscScalar> b[2];
+  ierr = scatter1D(dir,bc0,b[0]); CHKERRQ(ierr);
+  ierr = scatter1D(dir,bcN,b[1]); CHKERRQ(ierr);
+
+  PetscInt elo,ehi;
+  expand(_Istart,_Iend,ops._reach*stride,elo,ehi);
+  PetscScalar *t1 = &_t1[0], *t2 = &_t2[0];
+  for (PetscInt Ii = elo; Ii < ehi; Ii++) { t1[Ii-_gStart] = 0.0; }
+
+  // entry k of a face is entry k of its boundary Vec
+  PetscInt first,step,count;
+  for (int side = 0; side < 2; side++) {
+    faceRows(dir,side,first,step,count);
+    for (PetscInt k = 0; k < count; k++) {
+      const PetscInt Ii = first + k*step;
+
+      // Neumann: alphaT * Bfact * Hinv * e * bc
+      if (bc[side] == MF_NEUMANN && Ii >= _Istart && Ii < _Iend) { acc[Ii-_gStart] += satN[side] * b[side][k]; }
+
+      // Dirichlet: mu * e * bc, to be multiplied by Hinv * (BS^T + alphaD)
+      if (bc[side] == MF_DIRICHLET && Ii >= elo && Ii < ehi) { t1[Ii-_gStart] = _muLoc[Ii-_gStart] * b[side][k]; }
+    }
+  }
+
+  if (bc[0] == MF_DIRICHLET || bc[1] == MF_DIRICHLET) {
+    apply1D(dir,ops._BST,t1,t2,_Istart,_Iend);
+    for (PetscInt Ii = _Istart; Ii < _Iend; Ii++) { t2[Ii-_gStart] += alphaD * t1[Ii-_gStart]; }
+    scaleLines(dir,&ops._Hinv[0],t2,t2,_Istart,_Iend);
+    for (PetscInt Ii = _Istart; Ii < _Iend; Ii++) { acc[Ii-_gStart] += t2[Ii-_gStart]; }
+  }
+
+  return ierr;
+}
+
+
+PetscErrorCode SbpOps_mf_constGrid::updateVarCoeff(const Vec& coeff)
+{
+  PetscErrorCode  ierr = 0;
+  double startTime = MPI_Wtime();
+  #if VERBOSE > 1
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Starting function updateVarCoeff in %s.\n", FILENAME); CHKERRQ(ierr);
+  #endif
+
+  ierr = VecCopy(coeff,_muVec); CHKERRQ(ierr);
+  ierr = updateMuLoc(); CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending function updateVarCoeff in %s.\n", FILENAME); CHKERRQ(ierr);
+  #endif
+  _runTime += MPI_Wtime() - startTime;
+  return ierr;
+}
+
+
+// there are no assembled matrices to write
+PetscErrorCode SbpOps_mf_constGrid::writeOps(const std::string outputDir) { return 0; }
+
+PetscErrorCode SbpOps_mf_constGrid::geth11(PetscScalar &h11y, PetscScalar &h11z) { h11y = _h11y; h11z = _h11z; return 0; }
+
+
+//======================================================================
+// functions to allow user access to various matrices
+//======================================================================
+
+PetscErrorCode SbpOps_mf_constGrid::getA(Mat &mat) { mat = _shells[MF_A]; return 0; }
+
+PetscErrorCode SbpOps_mf_constGrid::getH(Mat &mat) { mat = _shells[MF_H]; return 0; }
+
+PetscErrorCode SbpOps_mf_constGrid::getDs(Mat &Dy,Mat &Dz) { Dy = _shells[MF_DY]; Dz = _shells[MF_DZ]; return 0; }
+
+PetscErrorCode SbpOps_mf_constGrid::getMus(Mat &mu,Mat &muqy,Mat &murz)
+{
+  mu = _shells[MF_MU];
+  muqy = _shells[MF_MU];
+  murz = _shells[MF_MU];
+  return 0;
+}
+
+PetscErrorCode SbpOps_mf_constGrid::getEs(Mat& E0y_Iz,Mat& ENy_Iz,Mat& Iy_E0z,Mat& Iy_ENz)
+{
+  E0y_Iz = _shells[MF_E0Y];
+  ENy_Iz = _shells[MF_ENY];
+  Iy_E0z = _shells[MF_E0Z];
+  Iy_ENz = _shells[MF_ENZ];
+  return 0;
+}
+
+PetscErrorCode SbpOps_mf_constGrid::getes(Mat& e0y_Iz,Mat& eNy_Iz,Mat& Iy_e0z,Mat& Iy_eNz)
+{
+  e0y_Iz = _shells[MF_e0Y];
+  eNy_Iz = _shells[MF_eNY];
+  Iy_e0z = _shells[MF_e0Z];
+  Iy_eNz = _shells[MF_eNZ];
+  return 0;
+}
+
+PetscErrorCode SbpOps_mf_constGrid::getHs(Mat& Hy_Iz,Mat& Iy_Hz)
+{
+  Hy_Iz = _shells[MF_HY];
+  Iy_Hz = _shells[MF_HZ];
+  return 0;
+}
+
+PetscErrorCode SbpOps_mf_constGrid::getHinvs(Mat& Hyinv_Iz,Mat& Iy_Hzinv)
+{
+  Hyinv_Iz = _shells[MF_HYINV];
+  Iy_Hzinv = _shells[MF_HZINV];
+  return 0;
+}
+
+PetscErrorCode SbpOps_mf_constGrid::getCoordTrans(Mat&J, Mat& Jinv,Mat& qy,Mat& rz, Mat& yq, Mat& zr) { assert(0); return 0; }
+
+
+//======================================================================
+// functions to compute various derivatives of input vectors
+//======================================================================
+
+// out = Dy * in
+PetscErrorCode SbpOps_mf_constGrid::Dy(const Vec &in, Vec &out) { return applyDerivative(0,0,0,in,out); }
+
+// out = mu * Dy * in
+PetscErrorCode SbpOps_mf_constGrid::muxDy(const Vec &in, Vec &out) { return applyDerivative(0,0,1,in,out); }
+
+// out = Dy * mu * in
+PetscErrorCode SbpOps_mf_constGrid::Dyxmu(const Vec &in, Vec &out) { return applyDerivative(0,1,0,in,out); }
+
+// out = Dz * in
+PetscErrorCode SbpOps_mf_constGrid::Dz(const Vec &in, Vec &out) { return applyDerivative(1,0,0,in,out); }
+
+// out = mu * Dz * in
+PetscErrorCode SbpOps_mf_constGrid::muxDz(const Vec &in, Vec &out) { return applyDerivative(1,0,1,in,out); }
+
+// out = Dz * mu * in
+PetscErrorCode SbpOps_mf_constGrid::Dzxmu(const Vec &in, Vec &out) { return applyDerivative(1,1,0,in,out); }
+
+// out = H * in
+PetscErrorCode SbpOps_mf_constGrid::H(const Vec &in, Vec &out) { return applyDiag(MF_H,-1,in,out); }
+
+// out = Hinv * in
+PetscErrorCode SbpOps_mf_constGrid::Hinv(const Vec &in, Vec &out) { return applyDiag(MF_HINV,-1,in,out); }
+
+// out = Hy^-1 * e0y * in
+PetscErrorCode SbpOps_mf_constGrid::Hyinvxe0y(const Vec &in, Vec &out) { return apply1DToBody(MF_e0Y,_opsY._Hinv[0],in,out); }
+
+// out = Hy^-1 * eNy * in
+PetscErrorCode SbpOps_mf_constGrid::HyinvxeNy(const Vec &in, Vec &out) { return apply1DToBody(MF_eNY,_opsY._Hinv[_Ny-1],in,out); }
+
+// out = Hy^-1 * E0y * in
+PetscErrorCode SbpOps_mf_constGrid::HyinvxE0y(const Vec &in, Vec &out) { return applyDiag(MF_HYINV,MF_E0Y,in,out); }
+
+// out = Hy^-1 * ENy * in
+PetscErrorCode SbpOps_mf_constGrid::HyinvxENy(const Vec &in, Vec &out) { return applyDiag(MF_HYINV,MF_ENY,in,out); }
+
+// out = Hz^-1 * E0z * in
+PetscErrorCode SbpOps_mf_constGrid::HzinvxE0z(const Vec &in, Vec &out) { return applyDiag(MF_HZINV,MF_E0Z,in,out); }
+
+// out = Hz^-1 * ENz * in
+PetscErrorCode SbpOps_mf_constGrid::HzinvxENz(const Vec &in, Vec &out) { return applyDiag(MF_HZINV,MF_ENZ,in,out); }
@@ -0,0 +1,224 @@
+#ifndef SBPOPS_MF_CONSTGRIDSPACING_H_INCLUDED
+#define SBPOPS_MF_CONSTGRIDSPACING_H_INCLUDED
+
+#include <petscksp.h>
+#include <string>
+#include <vector>
+#include <assert.h>
+#include "spmat.hpp"
+#include "sbpOps.hpp"
+
+using namespace std;
+
+
+/*
+ * Matrix-free (stencil) version of SbpOps_m_constGrid, for constant grid
+ * spacing only.
+ *
+ * Instead of assembling the 2D operators as Kronecker products, only the
+ * 1D operators (from sbp_Spmat, sbp_Spmat2, sbp_Spmat4) are stored, in
+ * compressed row form, and are applied along y-lines or z-lines of the
+ * local part of the input Vec plus a ghost region of a few lines. The
+ * result is the operator that SbpOps_m_constGrid assembles on one
+ * processor (for the 4th order A with more than one processor, see
+ * updateMuLoc), so the two are interchangeable for all functions that
+ * compute derivatives (Dy, muxDy, H, Hinv, Hyinvxe0y, setRhs, ...).
+ * tests/testSbpOps compares the two.
+ *
+ * The get* functions return MATSHELL matrices which support MatMult (and
+ * MatGetDiagonal where the diagonal is known), so A can be used with
+ * Krylov solvers and Jacobi preconditioning but not with direct solvers,
+ * and none of these matrices can be used in MatMatMult.
+ *
+ */
+
+// 1D operator in compressed row storage, with the interior stencil
+// stored separately so that it can be applied without indirection
+struct Stencil1D
+{
+  PetscInt              _N; // # of rows
+  PetscInt              _reach; // max |col - row|
+  vector<PetscInt>      _rowStart,_cols;
+  vector<PetscScalar>   _vals;
+
+  // rows [_intStart,_intEnd) all use the same stencil
+  PetscInt              _intStart,_intEnd;
+  vector<PetscInt>      _intOffsets;
+  vector<PetscScalar>   _intWeights;
+
+  Stencil1D();
+  void set(const Spmat& mat);
+  PetscScalar operator()(const PetscInt row, const PetscInt col) const; // value of entry (row,col)
+
+private:
+  bool matchesInterior(const PetscInt row) const;
+};
+
+// 1D operators for one direction (y or z)
+struct Ops1D_mf
+{
+  PetscInt             _N;
+  vector<PetscScalar>  _H,_Hinv; // diagonal norm matrix and its inverse
+  Stencil1D            _D1,_D1T,_BST; // 1st derivative, its transpose, and BS^T
+  PetscScalar          _D1_00,_D1_NN,_BS_00,_BS_NN; // corner entries, for SAT terms
+
+  // remainder term R = scaleA * DaT * Ca * mu * Da + scaleB * DbT * Cb * mu * Db
+  // (order 2: Da = D2, order 4: Da = D3, Db = D4, with mu replaced by mu3 for Da)
+  Stencil1D            _Da,_DaT,_Db,_DbT;
+  vector<PetscScalar>  _Ca,_Cb;
+  PetscScalar          _scaleA,_scaleB;
+  int                  _useMu3; // 1 if term A uses mu3
+
+  PetscInt             _reach; // max reach of all stencils in this direction
+};
+
+class SbpOps_mf_constGrid;
+
+// context for the MATSHELL objects returned by get*
+struct MfShellCtx
+{
+  SbpOps_mf_constGrid *_sbp;
+  int                  _type;
+};
+
+
+class SbpOps_mf_constGrid : public SbpOps
+{
+  public:
+
+    // operators that are provided as MATSHELL objects
+    enum ShellType { MF_A, MF_H, MF_HINV, MF_MU, MF_DY, MF_DZ,
+      MF_HY, MF_HZ, MF_HYINV, MF_HZINV,
+      MF_E0Y, MF_ENY, MF_E0Z, MF_ENZ,
+      MF_e0Y, MF_eNY, MF_e0Z, MF_eNZ, MF_NUMSHELLS };
+
+    // boundary condition types, decoded from the strings once in setBCTypes
+    enum BCType { MF_DIRICHLET, MF_NEUMANN };
+
+    const PetscInt      _order,_Ny,_Nz;
+    PetscScalar         _dy,_dz;
+    Vec                 _muVec; // variable coefficient
+    std::string         _bcRType,_bcTType,_bcLType,_bcBType; // options: "Dirichlet", "Traction"
+    BCType              _bc0[2],_bcN[2]; // types at index 0 (L, T) and N-1 (R, B) in each direction (0 = y, 1 = z)
+    double              _runTime;
+    string              _compatibilityType; // "fullyCompatible" (S = D),  or "compatible" (S =/= D)
+    string              _D2type; // "yz", "y", or "z"
+    int                 _multByH; // (default: 0) 1 if yes, 0 if no
+    int                 _deleteMats; // (default: 0) 1 if yes, 0 if no (nothing to delete for this class)
+
+    // boundary condition penalty weights
+    PetscScalar _alphaT,_alphaDy,_alphaDz,_beta;
+    PetscScalar _h11y,_h11z;
+
+    // 1D operators
+    Ops1D_mf    _opsY,_opsZ;
+
+    // parallel layout: local rows [_Istart,_Iend), local + ghost rows [_gStart,_gEnd)
+    PetscInt            _Istart,_Iend,_gStart,_gEnd;
+    VecScatter          _scatterGhost; // body Vec -> _inLoc
+    Vec                 _inLoc; // local + ghost values of input Vec
+    VecScatter          _scatterY0,_scatterZ0; // 1D Vecs of length Nz (Ny) -> _bcY0 (_bcZ0) on every processor
+    Vec                 _bcY0,_bcZ0;
+    vector<PetscScalar> _muLoc,_mu3yLoc,_mu3zLoc; // coefficient on local + ghost rows
+    vector<PetscScalar> _t1,_t2,_acc; // work arrays on local + ghost rows
+
+    // shell matrices
+    Mat                 _shells[MF_NUMSHELLS];
+    MfShellCtx          _shellCtx[MF_NUMSHELLS];
+
+
+    SbpOps_mf_constGrid(const int order,const PetscInt Ny,const PetscInt Nz,const PetscScalar Ly, const PetscScalar Lz,Vec& muVec);
+    ~SbpOps_mf_constGrid();
+
+    PetscErrorCode setBCTypes(std::string bcR, std::string bcT, std::string bcL, std::string bcB);
+    PetscErrorCode setGrid(Vec* y, Vec* z);
+    PetscErrorCode setMultiplyByH(const int multByH);
+    PetscErrorCode setLaplaceType(const string type); // "y", "z", or "yz"
+    PetscErrorCode setCompatibilityType(const string type); // "fullyCompatible" or "compatible"
+    PetscErrorCode setDeleteIntermediateFields(const int deleteMats);
+    PetscErrorCode changeBCTypes(string bcR, string bcT, string bcL, string bcB);
+    PetscErrorCode computeMatrices(); // 1D operators and shells not constructed until now
+
+
+    // create the vector rhs out of the boundary conditions (_bc*)
+    PetscErrorCode setRhs(Vec&rhs,Vec &bcL,Vec &bcR,Vec &bcT,Vec &bcB);
+
+    // read/write commands
+    PetscErrorCode writeOps(const std::string outputDir);
+
+    // allow variable coefficient to change
+    PetscErrorCode updateVarCoeff(const Vec& coeff);
+
+    // functions to compute various derivatives of input vectors
+    PetscErrorCode Dy(const Vec &in, Vec &out); // out = Dy * in
+    PetscErrorCode muxDy(const Vec &in, Vec &out); // out = mu * Dy * in
+    PetscErrorCode Dyxmu(const Vec &in, Vec &out); // out = Dy * mu * in
+    PetscErrorCode Dz(const Vec &in, Vec &out); // out = Dz * in
+    PetscErrorCode muxDz(const Vec &in, Vec &out); // out = mu * Dz * in
+    PetscErrorCode Dzxmu(const Vec &in, Vec &out); // out = Dz * mu * in
+
+    PetscErrorCode H(const Vec &in, Vec &out); // out = H * in
+    PetscErrorCode Hinv(const Vec &in, Vec &out); // out = H^-1 * in
+    PetscErrorCode Hyinvxe0y(const Vec &in, Vec &out); // out = Hy^-1 * e0y * in
+    PetscErrorCode HyinvxeNy(const Vec &in, Vec &out); // out = Hy^-1 * eNy * in
+    PetscErrorCode HyinvxE0y(const Vec &in, Vec &out); // out = Hy^-1 * E0y * in
+    PetscErrorCode HyinvxENy(const Vec &in, Vec &out); // out = Hy^-1 * ENy * in
+    PetscErrorCode HzinvxE0z(const Vec &in, Vec &out); // out = Hz^-1 * E0z * in
+    PetscErrorCode HzinvxENz(const Vec &in, Vec &out); // out = Hz^-1 * ENz * in
+
+    // out = A * in, where A = [H] * (D2 + SAT terms)
+    PetscErrorCode applyA(const Vec &in, Vec &out);
+    PetscErrorCode getDiagonalA(Vec &diag);
+
+    // called by the MATSHELL objects
+    PetscErrorCode shellMult(const int type, const Vec &in, Vec &out);
+    PetscErrorCode shellGetDiagonal(const int type, Vec &diag);
+
+    // return penalty weight h11 (the first element of the H matrix)
+    PetscErrorCode geth11(PetscScalar &h11y, PetscScalar &h11z);
+
+    // allow access to matrices (as MATSHELL objects)
+    PetscErrorCode getCoordTrans(Mat&J, Mat& Jinv,Mat& qy,Mat& rz, Mat& yq, Mat& zr);
+    PetscErrorCode getA(Mat &mat);
+    PetscErrorCode getH(Mat &mat);
+    PetscErrorCode getDs(Mat &Dy,Mat &Dz);
+    PetscErrorCode getMus(Mat &mu,Mat &muqy,Mat &murz);
+    PetscErrorCode getEs(Mat& E0y_Iz,Mat& ENy_Iz,Mat& Iy_E0z,Mat& Iy_ENz);
+    PetscErrorCode getes(Mat& e0y_Iz,Mat& eNy_Iz,Mat& Iy_e0z,Mat& Iy_eNz);
+    PetscErrorCode getHs(Mat& Hy_Iz,Mat& Iy_Hz);
+    PetscErrorCode getHinvs(Mat& Hyinv_Iz,Mat& Iy_Hzinv);
+
+  private:
+    // disable default copy constructor and assignment operator
+    SbpOps_mf_constGrid(const SbpOps_mf_constGrid & that);
+    SbpOps_mf_constGrid& operator=( const SbpOps_mf_constGrid& rhs );
+
+    PetscErrorCode construct1DOps(Ops1D_mf& ops,const PetscInt N,const PetscScalar d);
+    PetscErrorCode setUpScatters();
+    PetscErrorCode setUpShells();
+    PetscErrorCode updateMuLoc();
+    PetscErrorCode scatterToLocal(const Vec& in);
+    PetscErrorCode scatter1D(const int dir, const Vec& in, vector<PetscScalar>& arr); // gather 1D Vec onto every processor
+
+    // kernels on local + ghost arrays, computed for global rows [lo,hi)
+    // (dir = 0 for y, 1 for z)
+    void applyY(const Stencil1D& S, const PetscScalar *in, PetscScalar *out, const PetscInt lo, const PetscInt hi) const;
+    void applyZ(const Stencil1D& S, const PetscScalar *in, PetscScalar *out, const PetscInt lo, const PetscInt hi) const;
+    void apply1D(const int dir, const Stencil1D& S, const PetscScalar *in, PetscScalar *out, const PetscInt lo, const PetscInt hi) const;
+    void addSecondDeriv(const int dir, const PetscScalar *u, PetscScalar *acc); // D2 and SAT terms in 1 direction
+    PetscErrorCode addBoundaryRhs(const int dir, const Vec& bc0, const Vec& bcN, PetscScalar *acc);
+    PetscScalar diagSecondDeriv(const int dir, const PetscInt Ii) const;
+    void scaleLines(const int dir, const PetscScalar *w1D, const PetscScalar *in, PetscScalar *out, const PetscInt lo, const PetscInt hi) const; // out = w1D(index in dir) * in
+    void faceRows(const int dir, const int side, PetscInt& first, PetscInt& step, PetscInt& count) const; // rows with index 0 (side = 0) or N-1 (side = 1) in dir
+
+    PetscScalar diagCoeff(const int type, const PetscInt Ii) const; // entry Ii of diagonal operators
+    PetscErrorCode applyDiag(const int type, const int type2, const Vec& in, Vec& out); // out = diag(type) * diag(type2) * in
+    PetscErrorCode apply1DToBody(const int type, const PetscScalar scale, const Vec& in, Vec& out); // out = scale * e * in
+    PetscErrorCode applyDerivative(const int dir, const int muBefore, const int muAfter, const Vec &in, Vec &out);
+
+    // helpers for global row indices
+    void expand(const PetscInt lo, const PetscInt hi, const PetscInt width, PetscInt& elo, PetscInt& ehi) const;
+    bool isActive(const int dir) const; // true if D2type includes direction dir
+};
+
+#endif
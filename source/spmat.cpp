@@ -95,6 +95,32 @@ void Spmat::convert(Mat& petscMat, PetscInt N) const
   MatAssemblyEnd(petscMat,MAT_FINAL_ASSEMBLY);
 }
 
+// convert to compressed row storage: the entries of row Ii are
+// cols[rowStart[Ii]] ... cols[rowStart[Ii+1]-1], in increasing column order
+void Spmat::convertToCSR(std::vector<PetscInt>& rowStart,std::vector<PetscInt>& cols,std::vector<PetscScalar>& vals) const
+{
+  rowStart.assign(_rowSize+1,0);
+  cols.clear();
+  vals.clear();
+
+  const_row_iter Ii;
+  const_col_iter Jj;
+  for (Ii=_mat.begin(); Ii!=_mat.end(); Ii++) // count nnz per row
+  {
+    rowStart[Ii->first+1] = Ii->second.size();
+  }
+  for (size_t row=0; row<_rowSize; row++) { rowStart[row+1] += rowStart[row]; }
+
+  for (Ii=_mat.begin(); Ii!=_mat.end(); Ii++) // rows are stored in increasing order
+  {
+    for (Jj=(Ii->second).begin(); Jj!=(Ii->second).end(); Jj++)
+    {
+      cols.push_back(Jj->first);
+      vals.push_back(Jj->second);
+    }
+  }
+}
+
 void Spmat::transpose()
 {
   Spmat temp(size(1),size(2)); // copy input
@@ -39,6 +39,9 @@ public:
   // convert to PETSc style matrix
   void convert(Mat& petscMat, PetscInt N) const;
 
+  // convert to compressed row storage (used by matrix-free operators)
+  void convertToCSR(std::vector<PetscInt>& rowStart,std::vector<PetscInt>& cols,std::vector<PetscScalar>& vals) const;
+
   friend Spmat kron(const Spmat& left,const Spmat& right);
   friend void kronConvert(const Spmat& left,const Spmat& right,Mat& mat,PetscInt diag,PetscInt offDiag);
   friend void kronConvert_symbolic(const Spmat& left,const Spmat& right,Mat& mat,PetscInt* d_nnz,PetscInt* o_nnz);
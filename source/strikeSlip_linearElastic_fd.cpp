@@ -8,7 +8,7 @@ using namespace std;
 strikeSlip_linearElastic_fd::strikeSlip_linearElastic_fd(Domain&D)
 : _D(&D),_delim(D._delim),_isMMS(D._isMMS),
   _order(D._order),_Ny(D._Ny),_Nz(D._Nz), _Ly(D._Ly),_Lz(D._Lz),
-  _deltaT(-1), _CFL(-1),_y(&D._y),_z(&D._z),_alphay(NULL),
+  _deltaT(-1), _CFL(-1),_ltsRatio(1),_y(&D._y),_z(&D._z),_alphay(NULL),
   _inputDir(D._inputDir),_outputDir(D._outputDir),_vL(1e-9),
   _initialConditions("u"),_guessSteadyStateICs(0),_faultTypeScale(2.0),
   _maxStepCount(1e8), _stride1D(1),_stride2D(1),
@@ -17,7 +17,7 @@ strikeSlip_linearElastic_fd::strikeSlip_linearElastic_fd(Domain&D)
   _yCenterU(0.3), _zCenterU(0.8), _yStdU(5.0), _zStdU(5.0), _ampU(10.0),
   _timeV1D(NULL),_dtimeV1D(NULL),_timeV2D(NULL),_dtimeV2D(NULL),
   _integrateTime(0),_writeTime(0),_linSolveTime(0),_factorTime(0),
-  _startTime(MPI_Wtime()),_miscTime(0), _propagateTime(0),
+  _startTime(MPI_Wtime()),_miscTime(0), _propagateTime(0),_work("strikeSlip_linearElastic_fd"),
   _bcRType("outGoingCharacteristics"),_bcTType("freeSurface"),_bcLType("symmFault"),_bcBType("outGoingCharacteristics"),
   _mat_bcRType("Neumann"),_mat_bcTType("Neumann"),_mat_bcLType("Neumann"),_mat_bcBType("Neumann"),
   _quadWaveEx(NULL),_fault(NULL),_material(NULL)
@@ -29,6 +29,8 @@ strikeSlip_linearElastic_fd::strikeSlip_linearElastic_fd(Domain&D)
 
   loadSettings(D._file);
   checkInput();
+  _outSched1D = new OutputScheduler(D._file,_delim,"1D");
+  _outSched2D = new OutputScheduler(D._file,_delim,"2D");
 
   // determine if material is symmetric about the fault, or if one side is rigid
   _faultTypeScale = 2.0;
@@ -75,6 +77,8 @@ strikeSlip_linearElastic_fd::~strikeSlip_linearElastic_fd()
   VecDestroy(&_ay);
 
   delete _quadWaveEx;      _quadWaveEx = NULL;
+  delete _outSched1D;      _outSched1D = NULL;
+  delete _outSched2D;      _outSched2D = NULL;
   delete _material;        _material = NULL;
   delete _fault;           _fault = NULL;
 
@@ -121,6 +125,7 @@ PetscErrorCode strikeSlip_linearElastic_fd::loadSettings(const char *file)
     else if (var.compare("maxTime")==0) { _maxTime = atof( rhs.c_str() ); }
     else if (var.compare("deltaT")==0) { _deltaT = atof( rhs.c_str() ); }
     else if (var.compare("CFL")==0) { _CFL = atof( rhs.c_str() ); }
+    else if (var.compare("localTimeStepRatio")==0) { _ltsRatio = atoi( rhs.c_str() ); }
 
     else if (var.compare("center_y")==0) { _yCenterU = atof( rhs.c_str() ); }
     else if (var.compare("center_z")==0) { _zCenterU = atof( rhs.c_str() ); }
@@ -170,6 +175,8 @@ PetscErrorCode strikeSlip_linearElastic_fd::checkInput()
   assert(_bcLType.compare("symmFault")==0 || _bcRType.compare("rigidFault")==0);
   assert(_bcTType.compare("freeSurface")==0 || _bcTType.compare("outGoingCharacteristics")==0);
   assert(_bcBType.compare("freeSurface")==0 || _bcBType.compare("outGoingCharacteristics")==0);
+  assert(_ltsRatio >= 1);
+  assert(_ltsRatio == 1 || _D->_gridSpacingType.compare("variableGridSpacing")==0); // on a constant grid every node would be fine (this also rules out matrix-free operators, which have no rows of D2)
 
   #if VERBOSE > 1
     ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -228,19 +235,30 @@ double startTime = MPI_Wtime();
   _stepCount = stepCount;
   _currTime = time;
 
-  if ( (_stride1D > 0 && _currTime == _maxTime) || (_stride1D > 0 && stepCount % _stride1D == 0) ) {
+  // decide whether to write output at this step
+  bool write1D = false, write2D = false;
+  map<string,Vec> outputFields;
+  outputFields["slip"] = _fault->_slip;
+  outputFields["tauP"] = _fault->_tauP;
+  ierr = _outSched1D->checkWrite(stepCount,_stride1D,_currTime,_maxTime,_fault->_slipVel,outputFields,write1D); CHKERRQ(ierr);
+  ierr = _outSched2D->checkWrite(stepCount,_stride2D,_currTime,_maxTime,_fault->_slipVel,outputFields,write2D); CHKERRQ(ierr);
+
+  if (write1D) {
     ierr = writeStep1D(_stepCount,time,_outputDir); CHKERRQ(ierr);
     ierr = _material->writeStep1D(_stepCount,_outputDir); CHKERRQ(ierr);
     ierr = _fault->writeStep(_stepCount,_outputDir); CHKERRQ(ierr);
   }
 
-  if ( (_stride2D>0 &&_currTime == _maxTime) || (_stride2D>0 && stepCount % _stride2D == 0)) {
+  if (write2D) {
     ierr = writeStep2D(_stepCount,time,_outputDir); CHKERRQ(ierr);
     ierr = _material->writeStep2D(_stepCount,_outputDir);CHKERRQ(ierr);
   }
 
   _writeTime += MPI_Wtime() - startTime;
 
+  // report any scratch Vecs allocated during this step
+  ierr = _work.endStep(stepCount); CHKERRQ(ierr);
+
   #if VERBOSE > 0
     ierr = PetscPrintf(PETSC_COMM_WORLD,"%i %.15e\n",stepCount,_currTime);CHKERRQ(ierr);
   #endif
@@ -259,18 +277,24 @@ PetscErrorCode strikeSlip_linearElastic_fd::writeStep1D(PetscInt stepCount, Pets
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
 
-  if (_timeV1D == NULL ) {
-    ierr = initiateWriteASCII(outputDir, "med_time1D.txt", _D->_outFileMode, _timeV1D, "%.15e\n", time);
-    CHKERRQ(ierr);
-  }
-  else {
-    ierr = PetscViewerASCIIPrintf(_timeV1D, "%.15e\n", time); CHKERRQ(ierr);
-  }
-  if (_dtimeV1D == NULL ) {
-    initiateWriteASCII(outputDir, "med_dt1D.txt", _D->_outFileMode, _dtimeV1D, "%.15e\n", _deltaT);
+  if (_D->_outputFormat.compare("hdf5") == 0) {
+    ierr = _D->_hdf5Writer.appendScalar(time,"med_time1D"); CHKERRQ(ierr);
+    ierr = _D->_hdf5Writer.appendScalar(_deltaT,"med_dt1D"); CHKERRQ(ierr);
   }
   else {
-    ierr = PetscViewerASCIIPrintf(_dtimeV1D, "%.15e\n", _deltaT); CHKERRQ(ierr);
+    if (_timeV1D == NULL ) {
+      ierr = initiateWriteASCII(outputDir, "med_time1D.txt", _D->_outFileMode, _timeV1D, "%.15e\n", time);
+      CHKERRQ(ierr);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_timeV1D, "%.15e\n", time); CHKERRQ(ierr);
+    }
+    if (_dtimeV1D == NULL ) {
+      initiateWriteASCII(outputDir, "med_dt1D.txt", _D->_outFileMode, _dtimeV1D, "%.15e\n", _deltaT);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_dtimeV1D, "%.15e\n", _deltaT); CHKERRQ(ierr);
+    }
   }
 
   #if VERBOSE > 1
@@ -287,18 +311,24 @@ PetscErrorCode strikeSlip_linearElastic_fd::writeStep2D(PetscInt stepCount, Pets
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
 
-  if (_timeV2D == NULL ) {
-    ierr = initiateWriteASCII(outputDir, "med_time2D.txt", _D->_outFileMode, _timeV2D, "%.15e\n", time);
-    CHKERRQ(ierr);
-  }
-  else {
-    ierr = PetscViewerASCIIPrintf(_timeV2D, "%.15e\n", time); CHKERRQ(ierr);
-  }
-  if (_dtimeV2D == NULL ) {
-    ierr = initiateWriteASCII(outputDir, "med_dt2D.txt", _D->_outFileMode, _dtimeV2D, "%.15e\n", _deltaT); CHKERRQ(ierr);
+  if (_D->_outputFormat.compare("hdf5") == 0) {
+    ierr = _D->_hdf5Writer.appendScalar(time,"med_time2D"); CHKERRQ(ierr);
+    ierr = _D->_hdf5Writer.appendScalar(_deltaT,"med_dt2D"); CHKERRQ(ierr);
   }
   else {
-    ierr = PetscViewerASCIIPrintf(_dtimeV2D, "%.15e\n", _deltaT); CHKERRQ(ierr);
+    if (_timeV2D == NULL ) {
+      ierr = initiateWriteASCII(outputDir, "med_time2D.txt", _D->_outFileMode, _timeV2D, "%.15e\n", time);
+      CHKERRQ(ierr);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_timeV2D, "%.15e\n", time); CHKERRQ(ierr);
+    }
+    if (_dtimeV2D == NULL ) {
+      ierr = initiateWriteASCII(outputDir, "med_dt2D.txt", _D->_outFileMode, _dtimeV2D, "%.15e\n", _deltaT); CHKERRQ(ierr);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_dtimeV2D, "%.15e\n", _deltaT); CHKERRQ(ierr);
+    }
   }
 
   #if VERBOSE > 1
@@ -329,7 +359,16 @@ PetscErrorCode strikeSlip_linearElastic_fd::view()
   ierr = PetscPrintf(PETSC_COMM_WORLD,"strikeSlip_linearElastic_fd Runtime Summary:\n");CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent in integration (s): %g\n",_integrateTime);CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent writing output (s): %g\n",_writeTime);CHKERRQ(ierr);
+  if (_D->_asyncOutput == 1) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent staging output for writing (s): %g\n",_D->_asyncWriter._stageTime);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent waiting for output writer (s): %g\n",_D->_asyncWriter._waitTime);CHKERRQ(ierr);
+  }
+  if (_D->_outputFormat.compare("hdf5") == 0) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent writing HDF5 output (s): %g\n",_D->_hdf5Writer._writeTime);CHKERRQ(ierr);
+  }
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent propagating the wave (s): %g\n",_propagateTime);CHKERRQ(ierr);
+  ierr = _work.view();CHKERRQ(ierr);
+  ierr = _waveOp.view();CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   %% integration time spent writing output: %g\n",_writeTime/totRunTime*100.);CHKERRQ(ierr);
   return ierr;
 }
@@ -356,11 +395,14 @@ PetscErrorCode strikeSlip_linearElastic_fd::writeContext()
   ierr = PetscViewerASCIIPrintf(viewer,"timeIntegrator = %s\n",_timeIntegrator.c_str());CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"timeControlType = %s\n",_timeControlType.c_str());CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"stride1D = %i\n",_stride1D);CHKERRQ(ierr);
-  ierr = PetscViewerASCIIPrintf(viewer,"stride2D = %i\n",_stride1D);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"stride2D = %i\n",_stride2D);CHKERRQ(ierr);
+  ierr = _outSched1D->writeContext(viewer);CHKERRQ(ierr);
+  ierr = _outSched2D->writeContext(viewer);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"maxStepCount = %i\n",_maxStepCount);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"initTime = %.15e # (s)\n",_initTime);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"maxTime = %.15e # (s)\n",_maxTime);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"deltaT = %.15e # (s)\n",_deltaT);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"localTimeStepRatio = %i\n",_ltsRatio);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"atol = %.15e\n",_atol);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"timeIntInds = %s\n",vector2str(_timeIntInds).c_str());CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"\n");CHKERRQ(ierr);
@@ -452,60 +494,15 @@ PetscErrorCode strikeSlip_linearElastic_fd::propagateWaves(const PetscScalar tim
 
 double startPropagation = MPI_Wtime();
 
-  // compute D2u = (Dyy+Dzz)*u
-  Vec D2u, temp;
-  VecDuplicate(*_y, &D2u);
-  VecDuplicate(*_y, &temp);
-  Mat A; _material->_sbp->getA(A);
-  ierr = MatMult(A, var.find("u")->second, temp);
-  ierr = _material->_sbp->Hinv(temp, D2u);
-  VecDestroy(&temp);
-  if (_D->_gridSpacingType.compare("variableGridSpacing")==0) {
-      Mat J,Jinv,qy,rz,yq,zr;
-      ierr = _material->_sbp->getCoordTrans(J,Jinv,qy,rz,yq,zr); CHKERRQ(ierr);
-      Vec temp;
-      VecDuplicate(D2u, &temp);
-      MatMult(Jinv, D2u, temp);
-      VecCopy(temp, D2u);
-      VecDestroy(&temp);
+  // K depends on deltaT and on the material's boundary conditions
+  if (!_waveOp.isSetUp(deltaT)) {
+    bool isVariableGridSpacing = _D->_gridSpacingType.compare("variableGridSpacing")==0;
+    ierr = _waveOp.setUp(_material->_sbp,_rho,_ay,_fault->_d2u,isVariableGridSpacing,deltaT); CHKERRQ(ierr);
   }
-  ierr = VecScatterBegin(*_body2fault, D2u, _fault->_d2u, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
-  ierr = VecScatterEnd(*_body2fault, D2u, _fault->_d2u, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
-
-
 
   // Propagate waves and compute displacement at the next time step
-  // includes boundary conditions except for fault
-
-  PetscInt       Ii,Istart,Iend;
-  PetscScalar   *uNextA; // changed in this loop
-  const PetscScalar   *u, *uPrev, *d2u, *ay, *rho; // unchchanged in this loop
-  ierr = VecGetArray(varNext["u"], &uNextA);
-  ierr = VecGetArrayRead(var.find("u")->second, &u);
-  ierr = VecGetArrayRead(varPrev.find("u")->second, &uPrev);
-  ierr = VecGetArrayRead(_ay, &ay);
-  ierr = VecGetArrayRead(D2u, &d2u);
-  ierr = VecGetArrayRead(_rho, &rho);
-
-  ierr = VecGetOwnershipRange(varNext["u"],&Istart,&Iend);CHKERRQ(ierr);
-  PetscInt       Jj = 0;
-  for (Ii = Istart; Ii < Iend; Ii++){
-    PetscScalar c1 = deltaT*deltaT / rho[Jj];
-    PetscScalar c2 = deltaT*ay[Jj] - 1.0;
-    PetscScalar c3 = deltaT*ay[Jj] + 1.0;
-
-    uNextA[Jj] = (c1*d2u[Jj] + 2.*u[Jj] + c2*uPrev[Jj]) / c3;
-    Jj++;
-  }
-  ierr = VecRestoreArray(varNext["u"], &uNextA);
-  ierr = VecRestoreArrayRead(var.find("u")->second, &u);
-  ierr = VecRestoreArrayRead(varPrev.find("u")->second, &uPrev);
-  ierr = VecRestoreArrayRead(_ay, &ay);
-  ierr = VecRestoreArrayRead(D2u, &d2u);
-  ierr = VecRestoreArrayRead(_rho, &rho);
-
-  VecDestroy(&D2u);
-
+  // includes boundary conditions except for fault, and D2u on the fault
+  ierr = _waveOp.apply(var.find("u")->second,varPrev.find("u")->second,varNext["u"],_fault->_d2u); CHKERRQ(ierr);
 
 _propagateTime += MPI_Wtime() - startPropagation;
 
@@ -557,6 +554,12 @@ PetscErrorCode strikeSlip_linearElastic_fd::computeTimeStep()
   VecMin(ts_dy,NULL,&min_ts_dy);
   VecMin(ts_dz,NULL,&min_ts_dz);
 
+  // local time stepping: the nodes that cannot take a step of localTimeStepRatio
+  // times the global CFL limit form the fine region, which takes substeps
+  if (_ltsRatio > 1) {
+    ierr = _waveOp.setLocalTimeStepping(_ltsRatio,ts_dy,ts_dz); CHKERRQ(ierr);
+  }
+
   // clean up memory usage
   VecDestroy(&dy);
   VecDestroy(&dz);
@@ -597,6 +600,11 @@ PetscErrorCode strikeSlip_linearElastic_fd::computeTimeStep()
     }
   }
 
+  // with local time stepping, deltaT above is the step in the fine region
+  if (_ltsRatio > 1) {
+    _deltaT = _ltsRatio * _deltaT;
+  }
+
   #if VERBOSE > 1
      PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
   #endif
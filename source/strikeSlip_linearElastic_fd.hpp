@@ -12,7 +12,10 @@
 #include "integratorContext_WaveEq.hpp"
 #include "odeSolver_WaveEq.hpp"
 #include "genFuncs.hpp"
+#include "workspace.hpp"
+#include "waveOperator.hpp"
 #include "domain.hpp"
+#include "outputScheduler.hpp"
 #include "sbpOps.hpp"
 #include "sbpOps_m_constGrid.hpp"
 #include "sbpOps_m_varGrid.hpp"
@@ -47,6 +50,7 @@ private:
   const PetscInt  _order,_Ny,_Nz;
   PetscScalar     _Ly,_Lz;
   PetscScalar     _deltaT, _CFL;
+  PetscInt        _ltsRatio; // # of local time steps near the fault per time step
   Vec            *_y,*_z; // to handle variable grid spacing
 
   Vec             _mu, _rho, _cs, _ay;
@@ -65,6 +69,7 @@ private:
   string            _timeIntegrator,_timeControlType;
   PetscInt          _maxStepCount; // largest number of time steps
   PetscInt          _stride1D,_stride2D; // stride
+  OutputScheduler  *_outSched1D,*_outSched2D; // decide which steps to write 1D and 2D output
   PetscScalar       _initTime,_currTime,_maxTime;
   int               _stepCount;
   PetscScalar       _atol;
@@ -76,6 +81,8 @@ private:
 
   // runtime data
   double       _integrateTime,_writeTime,_linSolveTime,_factorTime,_startTime,_miscTime, _propagateTime;
+  Workspace    _work; // scratch Vecs for the functions called every time step
+  WaveOperator _waveOp; // precomputed off-fault update operator
 
   // boundary conditions
   // Options: freeSurface, tau, outgoingCharacteristics, remoteLoading, symmFault, rigidFault
@@ -20,6 +20,7 @@ StrikeSlip_LinearElastic_qd::StrikeSlip_LinearElastic_qd(Domain &D)
   _miscTime(0),_timeV1D(NULL),_dtimeV1D(NULL),_timeV2D(NULL),_dtimeV2D(NULL),
   _forcingVal(0),
   _bcRType("remoteLoading"),_bcTType("freeSurface"),_bcLType("symmFault"),_bcBType("freeSurface"),
+  _hmatTol(1e-6),_hmatEta(1.0),_hmatLeafSize(32),_G(NULL),_hmat(NULL),_tauQS_bcR(NULL),_tauQS_0(NULL),_greensFunctionSetUpTime(0),
   _quadEx(NULL),_quadImex(NULL),_fault(NULL),_material(NULL),_he(NULL),_p(NULL)
 {
   #if VERBOSE > 1
@@ -29,16 +30,15 @@ StrikeSlip_LinearElastic_qd::StrikeSlip_LinearElastic_qd(Domain &D)
 
   loadSettings(D._file);
 
-  // if checkpoint number > 0 (i.e. there has been a checkpoint already), load _initTime from checkpoint file
+  // if checkpoint number > 0 (i.e. there has been a checkpoint already), continue from it
   if (_D->_ckptNumber > 0) {
-    loadValueFromCheckpoint(_outputDir, "chkpt_currT", _initTime);
-    _currTime = _initTime;
+    loadCheckpoint();
     _guessSteadyStateICs = 0;
-    loadValueFromCheckpoint(_outputDir, "chkpt_deltaT", _initDeltaT);
-    loadValueFromCheckpoint(_outputDir, "chkpt_stepCount", _stepCount);
   }
 
   checkInput();
+  _outSched1D = new OutputScheduler(D._file,_delim,"1D");
+  _outSched2D = new OutputScheduler(D._file,_delim,"2D");
   parseBCs();
 
   // heat equation
@@ -72,6 +72,9 @@ StrikeSlip_LinearElastic_qd::StrikeSlip_LinearElastic_qd(Domain &D)
   // compute min allowed time step for adaptive time stepping method
   computeMinTimeStep();
 
+  // every class has copied its fields out of the checkpoint
+  _D->_checkpoint.releaseLoaded();
+
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
@@ -109,13 +112,19 @@ StrikeSlip_LinearElastic_qd::~StrikeSlip_LinearElastic_qd()
 
   delete _quadImex;    _quadImex = NULL;
   delete _quadEx;      _quadEx = NULL;
+  delete _outSched1D;  _outSched1D = NULL;
+  delete _outSched2D;  _outSched2D = NULL;
   delete _material;    _material = NULL;
   delete _fault;       _fault = NULL;
   delete _he;          _he = NULL;
   delete _p;           _p = NULL;
+  delete _hmat;        _hmat = NULL;
 
   VecDestroy(&_forcingTerm);
   VecDestroy(&_forcingTermPlain);
+  VecDestroy(&_tauQS_bcR);
+  VecDestroy(&_tauQS_0);
+  MatDestroy(&_G);
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -184,6 +193,11 @@ PetscErrorCode StrikeSlip_LinearElastic_qd::loadSettings(const char *file)
     else if (var.compare("momBal_bcT_qd")==0) { _bcTType = rhs.c_str(); }
     else if (var.compare("momBal_bcL_qd")==0) { _bcLType = rhs.c_str(); }
     else if (var.compare("momBal_bcB_qd")==0) { _bcBType = rhs.c_str(); }
+
+    // H-matrix approximation of the Green's function
+    else if (var.compare("hmatTol")==0) { _hmatTol = atof( rhs.c_str() ); }
+    else if (var.compare("hmatEta")==0) { _hmatEta = atof( rhs.c_str() ); }
+    else if (var.compare("hmatLeafSize")==0) { _hmatLeafSize = (int)atof( rhs.c_str() ); }
   }
 
   #if VERBOSE > 1
@@ -247,6 +261,17 @@ PetscErrorCode StrikeSlip_LinearElastic_qd::checkInput()
     assert(_thermalCoupling.compare("no")!=0);
   }
 
+  // the Green's function only accounts for slip and remote loading
+  if (_D->_momentumBalanceType.compare("quasidynamic_greensFunction")==0) {
+    assert(!_isMMS);
+  }
+  if (_D->_momentumBalanceType.compare("quasidynamic_hmatrix")==0) {
+    assert(!_isMMS);
+    assert(_hmatTol > 0);
+    assert(_hmatEta > 0);
+    assert(_hmatLeafSize >= 1);
+  }
+
   #if VERBOSE > 1
     ierr = PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
     CHKERRQ(ierr);
@@ -405,6 +430,11 @@ PetscErrorCode StrikeSlip_LinearElastic_qd::initiateIntegrand()
 
   if (_hydraulicCoupling != "no") { _p->initiateIntegrand(_initTime,_varEx,_varIm); }
 
+  if (_D->_momentumBalanceType.compare("quasidynamic_greensFunction")==0 ||
+    _D->_momentumBalanceType.compare("quasidynamic_hmatrix")==0) {
+    setUpGreensFunction();
+  }
+
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
   #endif
@@ -431,7 +461,18 @@ double startTime = MPI_Wtime();
   _deltaT = deltaT;
   _currTime = time;
 
-  if ( (_stride1D > 0 && _currTime == _maxTime) || (_stride1D > 0 && stepCount % _stride1D == 0)) {
+  // decide whether to write output at this step
+  bool write1D = false, write2D = false;
+  map<string,Vec> outputFields;
+  outputFields["slip"] = _fault->_slip;
+  outputFields["tauP"] = _fault->_tauP;
+  ierr = _outSched1D->checkWrite(stepCount,_stride1D,_currTime,_maxTime,_fault->_slipVel,outputFields,write1D); CHKERRQ(ierr);
+  ierr = _outSched2D->checkWrite(stepCount,_stride2D,_currTime,_maxTime,_fault->_slipVel,outputFields,write2D); CHKERRQ(ierr);
+
+  // d_dt only computes the shear stress on the fault
+  if (write1D || write2D) { ierr = updateBodyFields(time); CHKERRQ(ierr); }
+
+  if (write1D) {
     ierr = writeStep1D(_stepCount, _currTime, _deltaT, _outputDir); CHKERRQ(ierr);
     ierr = _material->writeStep1D(_stepCount, _outputDir); CHKERRQ(ierr);
     ierr = _fault->writeStep(_stepCount, _outputDir); CHKERRQ(ierr);
@@ -439,19 +480,22 @@ double startTime = MPI_Wtime();
     if (_thermalCoupling.compare("no")!=0) { _he->writeStep1D(_stepCount,_currTime,_outputDir); }
   }
 
-  if ( (_stride2D > 0 && _currTime == _maxTime) || (_stride2D > 0 && stepCount % _stride2D == 0)) {
+  if (write2D) {
     ierr = writeStep2D(_stepCount, _currTime, _deltaT, _outputDir); CHKERRQ(ierr);
     ierr = _material->writeStep2D(_stepCount, _outputDir); CHKERRQ(ierr);
     if (_thermalCoupling.compare("no")!=0) { _he->writeStep2D(_stepCount, _currTime,_outputDir); }
   }
 
-  if (_D->_ckpt > 0 && (stepCount % _D->_interval == 0 || stepCount >= _maxStepCount || time >= _maxTime)) {
-    ierr = writeCheckpoint(); CHKERRQ(ierr);
-    ierr = _material->writeCheckpoint(); CHKERRQ(ierr);
-    ierr = _fault->writeCheckpoint(); CHKERRQ(ierr);
-    //~ if (_hydraulicCoupling.compare("no")!=0) { _p->writeCheckpoint(); }
-    //~ if (_thermalCoupling.compare("no")!=0) { _he->writeCheckpoint(); }
-    stopIntegration = 1;
+  if (_D->_ckpt > 0) {
+    bool writeCkpt = false, stopAfterCkpt = false;
+    ierr = _D->_checkpoint.checkWrite(stepCount,_D->_interval,writeCkpt,stopAfterCkpt); CHKERRQ(ierr);
+    if (stepCount >= _maxStepCount || time >= _maxTime) { writeCkpt = true; stopAfterCkpt = true; }
+    if (writeCkpt) {
+      if (!write1D && !write2D) { ierr = updateBodyFields(time); CHKERRQ(ierr); }
+      ierr = _D->flushTimeSeries(); CHKERRQ(ierr); // output files must be complete when the checkpoint is
+      ierr = writeCheckpoint(); CHKERRQ(ierr);
+    }
+    if (stopAfterCkpt) { stopIntegration = 1; }
   }
 
 _writeTime += MPI_Wtime() - startTime;
@@ -472,18 +516,24 @@ PetscErrorCode StrikeSlip_LinearElastic_qd::writeStep1D(PetscInt stepCount, Pets
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
 
-  if (_timeV1D == NULL ) {
-    ierr = initiateWriteASCII(outputDir, "med_time1D.txt", _D->_outFileMode, _timeV1D, "%.15e\n", time);
-    CHKERRQ(ierr);
+  if (_D->_outputFormat.compare("hdf5") == 0) {
+    ierr = _D->_hdf5Writer.appendScalar(time,"med_time1D"); CHKERRQ(ierr);
+    ierr = _D->_hdf5Writer.appendScalar(deltaT,"med_dt1D"); CHKERRQ(ierr);
   }
   else {
-    ierr = PetscViewerASCIIPrintf(_timeV1D, "%.15e\n", time); CHKERRQ(ierr);
-  }
-  if (_dtimeV1D == NULL ) {
-    initiateWriteASCII(outputDir, "med_dt1D.txt", _D->_outFileMode, _dtimeV1D, "%.15e\n", deltaT);
-  }
-  else {
-    ierr = PetscViewerASCIIPrintf(_dtimeV1D, "%.15e\n", deltaT); CHKERRQ(ierr);
+    if (_timeV1D == NULL ) {
+      ierr = initiateWriteASCII(outputDir, "med_time1D.txt", _D->_outFileMode, _timeV1D, "%.15e\n", time);
+      CHKERRQ(ierr);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_timeV1D, "%.15e\n", time); CHKERRQ(ierr);
+    }
+    if (_dtimeV1D == NULL ) {
+      initiateWriteASCII(outputDir, "med_dt1D.txt", _D->_outFileMode, _dtimeV1D, "%.15e\n", deltaT);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_dtimeV1D, "%.15e\n", deltaT); CHKERRQ(ierr);
+    }
   }
 
   #if VERBOSE > 1
@@ -503,18 +553,24 @@ PetscErrorCode StrikeSlip_LinearElastic_qd::writeStep2D(PetscInt stepCount, Pets
   #endif
 
 
-  if (_timeV2D == NULL ) {
-    ierr = initiateWriteASCII(outputDir, "med_time2D.txt", _D->_outFileMode, _timeV2D, "%.15e\n", time);
-    CHKERRQ(ierr);
-  }
-  else {
-    ierr = PetscViewerASCIIPrintf(_timeV2D, "%.15e\n", time); CHKERRQ(ierr);
-  }
-  if (_dtimeV2D == NULL ) {
-    initiateWriteASCII(outputDir, "med_dt2D.txt", _D->_outFileMode, _dtimeV2D, "%.15e\n", deltaT);
+  if (_D->_outputFormat.compare("hdf5") == 0) {
+    ierr = _D->_hdf5Writer.appendScalar(time,"med_time2D"); CHKERRQ(ierr);
+    ierr = _D->_hdf5Writer.appendScalar(deltaT,"med_dt2D"); CHKERRQ(ierr);
   }
   else {
-    ierr = PetscViewerASCIIPrintf(_dtimeV2D, "%.15e\n", deltaT); CHKERRQ(ierr);
+    if (_timeV2D == NULL ) {
+      ierr = initiateWriteASCII(outputDir, "med_time2D.txt", _D->_outFileMode, _timeV2D, "%.15e\n", time);
+      CHKERRQ(ierr);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_timeV2D, "%.15e\n", time); CHKERRQ(ierr);
+    }
+    if (_dtimeV2D == NULL ) {
+      initiateWriteASCII(outputDir, "med_dt2D.txt", _D->_outFileMode, _dtimeV2D, "%.15e\n", deltaT);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_dtimeV2D, "%.15e\n", deltaT); CHKERRQ(ierr);
+    }
   }
 
   #if VERBOSE > 1
@@ -523,7 +579,29 @@ PetscErrorCode StrikeSlip_LinearElastic_qd::writeStep2D(PetscInt stepCount, Pets
   return ierr;
 }
 
-// write out time and _deltaT at each time step
+// load the mediator's state from the checkpoint Domain loaded
+PetscErrorCode StrikeSlip_LinearElastic_qd::loadCheckpoint()
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    std::string funcName = "StrikeSlip_LinearElastic_qd::loadCheckpoint";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  const Checkpoint& ckpt = _D->_checkpoint;
+  ierr = ckpt.getScalar("med_currT",_initTime); CHKERRQ(ierr);
+  ierr = ckpt.getScalar("med_stepCount",_stepCount); CHKERRQ(ierr);
+  ierr = ckpt.getScalar("ode_deltaT",_initDeltaT); CHKERRQ(ierr);
+  _currTime = _initTime;
+
+  #if VERBOSE > 1
+     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+// write checkpoint _ckptNumber + 1, with the state of the mediator, the
+// time integrator and every physics module
 PetscErrorCode StrikeSlip_LinearElastic_qd::writeCheckpoint()
 {
   PetscErrorCode ierr = 0;
@@ -532,23 +610,19 @@ PetscErrorCode StrikeSlip_LinearElastic_qd::writeCheckpoint()
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
 
-  _D->_ckptNumber++;
-  writeASCII(_outputDir, "ckptNumber", _D->_ckptNumber,"%i\n");
-  writeASCII(_outputDir, "chkpt_currT", _currTime,"%.15e\n");
-  writeASCII(_outputDir, "chkpt_stepCount", _stepCount,"%i\n");
+  Checkpoint& ckpt = _D->_checkpoint;
+  ierr = ckpt.setScalar("med_currT",_currTime); CHKERRQ(ierr);
+  ierr = ckpt.setScalar("med_stepCount",_stepCount); CHKERRQ(ierr);
+  if (_quadImex != NULL) { ierr = _quadImex->writeCheckpoint(ckpt); CHKERRQ(ierr); }
+  if (_quadEx != NULL) { ierr = _quadEx->writeCheckpoint(ckpt); CHKERRQ(ierr); }
 
-  if (_timeIntegrator == "RK32_WBE" || _timeIntegrator == "RK43_WBE") {
-    assert(0);
-    writeASCII(_outputDir, "chkpt_prevErr", _quadImex->_errA[1],"%.15e\n");
-    writeASCII(_outputDir, "chkpt_currErr", _quadImex->_errA[0],"%.15e\n");
-    writeASCII(_outputDir, "chkpt_deltaT", _quadImex->_newDeltaT,"%.15e\n");
-  }
-  else {
-    writeASCII(_outputDir, "chkpt_prevErr", _quadEx->_errA[1],"%.15e\n");
-    writeASCII(_outputDir, "chkpt_currErr", _quadEx->_errA[0],"%.15e\n");
-    writeASCII(_outputDir, "chkpt_deltaT", _quadEx->_newDeltaT,"%.15e\n");
-  }
+  ierr = _material->writeCheckpoint(); CHKERRQ(ierr);
+  ierr = _fault->writeCheckpoint(); CHKERRQ(ierr);
+  if (_hydraulicCoupling.compare("no")!=0) { ierr = _p->writeCheckpoint(); CHKERRQ(ierr); }
+  if (_thermalCoupling.compare("no")!=0) { ierr = _he->writeCheckpoint(); CHKERRQ(ierr); }
 
+  _D->_ckptNumber++;
+  ierr = ckpt.write(_outputDir,_D->_ckptNumber); CHKERRQ(ierr);
 
   #if VERBOSE > 1
      PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -574,11 +648,26 @@ PetscErrorCode StrikeSlip_LinearElastic_qd::view()
   }
   if (_hydraulicCoupling.compare("no")!=0) { _p->view(_integrateTime); }
   if (_thermalCoupling.compare("no")!=0) { _he->view(); }
+  if (_hmat != NULL) { ierr = _hmat->view();CHKERRQ(ierr); }
 
   ierr = PetscPrintf(PETSC_COMM_WORLD,"-------------------------------\n\n");CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"StrikeSlip_LinearElastic_qd Runtime Summary:\n");CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent in integration (s): %g\n",_integrateTime);CHKERRQ(ierr);
+  if (_G != NULL || _hmat != NULL) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent setting up Green's function (s): %g\n",_greensFunctionSetUpTime);CHKERRQ(ierr);
+  }
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent writing output (s): %g\n",_writeTime);CHKERRQ(ierr);
+  if (_D->_asyncOutput == 1) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent staging output for writing (s): %g\n",_D->_asyncWriter._stageTime);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent waiting for output writer (s): %g\n",_D->_asyncWriter._waitTime);CHKERRQ(ierr);
+  }
+  if (_D->_outputFormat.compare("hdf5") == 0) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent writing HDF5 output (s): %g\n",_D->_hdf5Writer._writeTime);CHKERRQ(ierr);
+  }
+  if (_D->_ckpt > 0) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent writing checkpoints (s): %g\n",_D->_checkpoint._writeTime);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   checkpoints written: %i\n",_D->_checkpoint._numWrites);CHKERRQ(ierr);
+  }
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   total run time (s): %g\n",totRunTime);CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   %% integration time spent writing output: %g\n",(_writeTime/_integrateTime)*100.);CHKERRQ(ierr);
 
@@ -612,7 +701,9 @@ PetscErrorCode StrikeSlip_LinearElastic_qd::writeContext()
   ierr = PetscViewerASCIIPrintf(viewer,"timeIntegrator = %s\n",_timeIntegrator.c_str());CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"timeControlType = %s\n",_timeControlType.c_str());CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"stride1D = %i\n",_stride1D);CHKERRQ(ierr);
-  ierr = PetscViewerASCIIPrintf(viewer,"stride2D = %i\n",_stride1D);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"stride2D = %i\n",_stride2D);CHKERRQ(ierr);
+  ierr = _outSched1D->writeContext(viewer);CHKERRQ(ierr);
+  ierr = _outSched2D->writeContext(viewer);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"maxStepCount = %i\n",_maxStepCount);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"initTime = %.15e # (s)\n",_initTime);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"maxTime = %.15e # (s)\n",_maxTime);CHKERRQ(ierr);
@@ -635,6 +726,12 @@ PetscErrorCode StrikeSlip_LinearElastic_qd::writeContext()
   ierr = PetscViewerASCIIPrintf(viewer,"momBal_bcB = %s\n",_bcBType.c_str());CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"faultTypeScale = %g\n",_faultTypeScale);CHKERRQ(ierr);
 
+  if (_D->_momentumBalanceType.compare("quasidynamic_hmatrix")==0) {
+    ierr = PetscViewerASCIIPrintf(viewer,"hmatTol = %g\n",_hmatTol);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"hmatEta = %g\n",_hmatEta);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"hmatLeafSize = %i\n",_hmatLeafSize);CHKERRQ(ierr);
+  }
+
   // free memory
   PetscViewerDestroy(&viewer);
 
@@ -700,19 +797,22 @@ PetscErrorCode StrikeSlip_LinearElastic_qd::integrate()
   if (_timeIntegrator == "RK32_WBE" || _timeIntegrator == "RK43_WBE") {
     ierr = _quadImex->setTolerance(_timeStepTol);CHKERRQ(ierr);
     ierr = _quadImex->setTimeStepBounds(_minDeltaT,_maxDeltaT);CHKERRQ(ierr);
+    if (_he != NULL && _he->_dtCacheSize > 0 && _he->_dtCacheSnap == 1) {
+      ierr = _quadImex->setStepSizeBuckets(_he->_dtCacheRatio);CHKERRQ(ierr);
+    }
     ierr = _quadImex->setTimeRange(_initTime,_maxTime);
     ierr = _quadImex->setToleranceType(_normType); CHKERRQ(ierr);
     ierr = _quadImex->setInitialConds(_varEx,_varIm);CHKERRQ(ierr);
     ierr = _quadImex->setErrInds(_timeIntInds,_scale);
 
-    // save initial conditions before beginning integration
-    PetscInt stopIntegration = 0;
-    timeMonitor(_initTime,_initDeltaT,0,stopIntegration);
-
+    // save initial conditions before beginning integration, unless they
+    // were already written before the checkpoint being restarted from
     if (_D->_ckpt > 0 && _D->_ckptNumber > 0) {
-      loadValueFromCheckpoint(_outputDir, "chkpt_prevErr", _quadImex->_errA[1]);
-      loadValueFromCheckpoint(_outputDir, "chkpt_currErr", _quadImex->_errA[0]);
-      _quadImex->_stepCount = _stepCount;
+      ierr = _quadImex->loadCheckpoint(_D->_checkpoint);CHKERRQ(ierr);
+    }
+    else {
+      PetscInt stopIntegration = 0;
+      timeMonitor(_initTime,_initDeltaT,0,stopIntegration);
     }
 
     ierr = _quadImex->integrate(this);CHKERRQ(ierr);
@@ -727,14 +827,14 @@ PetscErrorCode StrikeSlip_LinearElastic_qd::integrate()
     ierr = _quadEx->setInitialConds(_varEx);CHKERRQ(ierr);
     ierr = _quadEx->setErrInds(_timeIntInds,_scale);
 
-    // save initial conditions before beginning integration
-    PetscInt stopIntegration = 0;
-    timeMonitor(_initTime,_initDeltaT,0,stopIntegration);
-
+    // save initial conditions before beginning integration, unless they
+    // were already written before the checkpoint being restarted from
     if (_D->_ckpt > 0 && _D->_ckptNumber > 0) {
-      loadValueFromCheckpoint(_outputDir, "chkpt_prevErr", _quadEx->_errA[1]);
-      loadValueFromCheckpoint(_outputDir, "chkpt_currErr", _quadEx->_errA[0]);
-      _quadEx->_stepCount = _stepCount;
+      ierr = _quadEx->loadCheckpoint(_D->_checkpoint);CHKERRQ(ierr);
+    }
+    else {
+      PetscInt stopIntegration = 0;
+      timeMonitor(_initTime,_initDeltaT,0,stopIntegration);
     }
 
     ierr = _quadEx->integrate(this);CHKERRQ(ierr);
@@ -751,6 +851,16 @@ PetscErrorCode StrikeSlip_LinearElastic_qd::integrate()
 }
 
 
+// called by the integrator before each evaluation of d_dt
+// the fault uses the stage to warm start the slip velocity solve
+PetscErrorCode StrikeSlip_LinearElastic_qd::setStage(const PetscInt stage)
+{
+  PetscErrorCode ierr = 0;
+  ierr = _fault->setStage(stage);CHKERRQ(ierr);
+  return ierr;
+}
+
+
 // purely explicit time stepping
 // note that the heat equation never appears here because it is only ever solved implicitly
 PetscErrorCode StrikeSlip_LinearElastic_qd::d_dt(const PetscScalar time,const map<string,Vec>& varEx,map<string,Vec>& dvarEx)
@@ -779,13 +889,8 @@ PetscErrorCode StrikeSlip_LinearElastic_qd::d_dt(const PetscScalar time,const ma
   }
 
   // 2. compute rates
-  ierr = solveMomentumBalance(time,varEx,dvarEx); CHKERRQ(ierr);
-
-  // update fields on fault from other classes
-  Vec sxy,sxz,sdev;
-  ierr = _material->getStresses(sxy,sxz,sdev);
-  ierr = VecScatterBegin(*_body2fault, sxy, _fault->_tauQSP, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
-  ierr = VecScatterEnd(*_body2fault, sxy, _fault->_tauQSP, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+  if (_G != NULL || _hmat != NULL) { ierr = computeTauQS_greensFunction(time,varEx); CHKERRQ(ierr); }
+  else { ierr = computeTauQS(time,varEx,dvarEx); CHKERRQ(ierr); }
 
   // rates for fault
   ierr = _fault->d_dt(time,varEx,dvarEx); // sets rates for slip and state
@@ -834,13 +939,8 @@ PetscErrorCode StrikeSlip_LinearElastic_qd::d_dt(const PetscScalar time,const ma
   }
 
   // 2. compute explicit rates
-  ierr = solveMomentumBalance(time,varEx,dvarEx); CHKERRQ(ierr);
-
-  // update shear stress on fault from momentum balance computation
-  Vec sxy,sxz,sdev;
-  ierr = _material->getStresses(sxy,sxz,sdev);
-  ierr = VecScatterBegin(*_body2fault, sxy, _fault->_tauQSP, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
-  ierr = VecScatterEnd(*_body2fault, sxy, _fault->_tauQSP, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+  if (_G != NULL || _hmat != NULL) { ierr = computeTauQS_greensFunction(time,varEx); CHKERRQ(ierr); }
+  else { ierr = computeTauQS(time,varEx,dvarEx); CHKERRQ(ierr); }
 
   // rates for fault
   ierr = _fault->d_dt(time,varEx,dvarEx); // sets rates for slip and state
@@ -875,6 +975,18 @@ PetscErrorCode StrikeSlip_LinearElastic_qd::solveMomentumBalance(const PetscScal
 {
   PetscErrorCode ierr = 0;
 
+  // compute displacement and stresses
+  ierr = solveForU(time); CHKERRQ(ierr);
+  _material->computeStresses();
+
+  return ierr;
+}
+
+
+PetscErrorCode StrikeSlip_LinearElastic_qd::solveForU(const PetscScalar time)
+{
+  PetscErrorCode ierr = 0;
+
   // update rhs
   if (_isMMS) { _material->setMMSBoundaryConditions(time); }
   _material->setRHS();
@@ -883,10 +995,197 @@ PetscErrorCode StrikeSlip_LinearElastic_qd::solveMomentumBalance(const PetscScal
   // add source term for driving the ice stream to rhs Vec
   if (_forcingType.compare("iceStream")==0) { VecAXPY(_material->_rhs,1.0,_forcingTerm); }
 
-  // compute displacement and stresses
-  _material->computeU();
-  _material->computeStresses();
+  ierr = _material->computeU(); CHKERRQ(ierr);
+
+  return ierr;
+}
+
+
+// shear stress on the fault from the momentum balance equation
+// Only the fault rows of mu*Dy*u are computed after the solve. The stresses in
+// the rest of the body are only needed for output, so timeMonitor computes them
+// from the displacement of the latest call, which is at the accepted solution.
+PetscErrorCode StrikeSlip_LinearElastic_qd::computeTauQS(const PetscScalar time,const map<string,Vec>& varEx,map<string,Vec>& dvarEx)
+{
+  PetscErrorCode ierr = 0;
+
+  if (!_isMMS) {
+    ierr = solveForU(time); CHKERRQ(ierr);
+    ierr = _material->computeFaultShearStress(_fault->_tauQSP,*_body2fault); CHKERRQ(ierr);
+    return ierr;
+  }
+
+  ierr = solveMomentumBalance(time,varEx,dvarEx); CHKERRQ(ierr);
+
+  // update shear stress on fault from momentum balance computation
+  Vec sxy,sxz,sdev;
+  ierr = _material->getStresses(sxy,sxz,sdev);
+  ierr = VecScatterBegin(*_body2fault, sxy, _fault->_tauQSP, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+  ierr = VecScatterEnd(*_body2fault, sxy, _fault->_tauQSP, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+
+  return ierr;
+}
 
+
+// bring the body fields up to date with the boundary conditions set in the
+// latest d_dt: with a Green's function d_dt does not solve for them at all,
+// otherwise only the stresses are missing
+PetscErrorCode StrikeSlip_LinearElastic_qd::updateBodyFields(const PetscScalar time)
+{
+  PetscErrorCode ierr = 0;
+
+  if (_G != NULL || _hmat != NULL) { ierr = solveMomentumBalance(time,_varEx,_varEx); CHKERRQ(ierr); }
+  else if (!_isMMS) { ierr = _material->computeStresses(); CHKERRQ(ierr); }
+
+  return ierr;
+}
+
+
+// shear stress on the fault from the Green's function, in place of solveMomentumBalance
+// This is one mat-vec with the fault-sized G (compressed or not), so its
+// cost does not depend on the size of the body grid.
+PetscErrorCode StrikeSlip_LinearElastic_qd::computeTauQS_greensFunction(const PetscScalar time,const map<string,Vec>& varEx)
+{
+  PetscErrorCode ierr = 0;
+
+  if (_hmat != NULL) { ierr = _hmat->mult(varEx.find("slip")->second,_fault->_tauQSP); CHKERRQ(ierr); }
+  else { ierr = MatMult(_G,varEx.find("slip")->second,_fault->_tauQSP); CHKERRQ(ierr); }
+  if (_bcRType.compare("remoteLoading")==0) {
+    ierr = VecAXPY(_fault->_tauQSP,_vL*time/_faultTypeScale,_tauQS_bcR); CHKERRQ(ierr);
+  }
+  ierr = VecAXPY(_fault->_tauQSP,1.0,_tauQS_0); CHKERRQ(ierr);
+
+  return ierr;
+}
+
+
+// solve the momentum balance equation with the current boundary conditions,
+// without body forcing, and put the shear stress on the fault into tau
+PetscErrorCode StrikeSlip_LinearElastic_qd::solveForTauQS(Vec& tau)
+{
+  PetscErrorCode ierr = 0;
+
+  ierr = _material->setRHS(); CHKERRQ(ierr);
+  ierr = _material->computeU(); CHKERRQ(ierr);
+  ierr = _material->computeStresses(); CHKERRQ(ierr);
+
+  Vec sxy,sxz,sdev;
+  ierr = _material->getStresses(sxy,sxz,sdev); CHKERRQ(ierr);
+  ierr = VecScatterBegin(*_body2fault, sxy, tau, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+  ierr = VecScatterEnd(*_body2fault, sxy, tau, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+
+  return ierr;
+}
+
+
+// Compute the Green's function mapping slip to shear stress on the fault,
+// with blocks of right-hand sides solved together (see
+// LinearElastic::computeFaultGreensFunction). It is kept as a dense matrix
+// (quasidynamic_greensFunction) or compressed (quasidynamic_hmatrix). The
+// momentum balance equation is linear in the boundary conditions, so
+//   tauQS = G*slip + (vL*time/faultTypeScale)*_tauQS_bcR + _tauQS_0,
+// where _tauQS_bcR is the stress due to a unit displacement on the right
+// boundary, and _tauQS_0 the stress due to everything that does not change
+// in time (bcRShift, the top and bottom boundary conditions, and body forcing).
+PetscErrorCode StrikeSlip_LinearElastic_qd::setUpGreensFunction()
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    std::string funcName = "StrikeSlip_LinearElastic_qd::setUpGreensFunction";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  double startTime = MPI_Wtime();
+
+  // save boundary conditions, which are overwritten below
+  Vec bcL0,bcR0,bcT0,bcB0;
+  ierr = VecDuplicate(_material->_bcL,&bcL0); CHKERRQ(ierr);
+  ierr = VecCopy(_material->_bcL,bcL0); CHKERRQ(ierr);
+  ierr = VecDuplicate(_material->_bcR,&bcR0); CHKERRQ(ierr);
+  ierr = VecCopy(_material->_bcR,bcR0); CHKERRQ(ierr);
+  ierr = VecDuplicate(_material->_bcT,&bcT0); CHKERRQ(ierr);
+  ierr = VecCopy(_material->_bcT,bcT0); CHKERRQ(ierr);
+  ierr = VecDuplicate(_material->_bcB,&bcB0); CHKERRQ(ierr);
+  ierr = VecCopy(_material->_bcB,bcB0); CHKERRQ(ierr);
+
+  // z-coordinates of every fault node, on every processor
+  VecScatter scatter;
+  Vec zAll;
+  PetscInt N;
+  const PetscScalar *za;
+  ierr = VecScatterCreateToAll(_fault->_z,&scatter,&zAll); CHKERRQ(ierr);
+  ierr = VecScatterBegin(scatter,_fault->_z,zAll,INSERT_VALUES,SCATTER_FORWARD); CHKERRQ(ierr);
+  ierr = VecScatterEnd(scatter,_fault->_z,zAll,INSERT_VALUES,SCATTER_FORWARD); CHKERRQ(ierr);
+  ierr = VecGetSize(zAll,&N); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(zAll,&za); CHKERRQ(ierr);
+  vector<PetscScalar> z(za,za + N);
+  ierr = VecRestoreArrayRead(zAll,&za); CHKERRQ(ierr);
+  VecScatterDestroy(&scatter);
+  VecDestroy(&zAll);
+
+  // column j of G: shear stress due to unit slip at fault node j, computed
+  // _D->_greensFunctionBlockSize columns at a time (the boundary conditions
+  // are restored afterwards)
+  Vec tau;
+  PetscInt rowStart,rowEnd;
+  ierr = VecDuplicate(_fault->_tauQSP,&tau); CHKERRQ(ierr);
+  ierr = VecGetOwnershipRange(tau,&rowStart,&rowEnd); CHKERRQ(ierr);
+  ierr = _material->computeFaultGreensFunction(_G,_D->_greensFunctionBlockSize,tau,*_body2fault); CHKERRQ(ierr);
+  ierr = MatScale(_G,1.0/_faultTypeScale); CHKERRQ(ierr);
+
+  if (_D->_momentumBalanceType.compare("quasidynamic_hmatrix")==0) {
+    // HMatrix takes this processor's rows of G, stored row by row
+    PetscScalar *g;
+    vector<PetscScalar> G((rowEnd - rowStart) * N,0.0);
+    ierr = MatDenseGetArray(_G,&g); CHKERRQ(ierr);
+    for (PetscInt i = 0; i < rowEnd - rowStart; i++) {
+      for (PetscInt j = 0; j < N; j++) { G[i*N + j] = g[j*(rowEnd - rowStart) + i]; }
+    }
+    ierr = MatDenseRestoreArray(_G,&g); CHKERRQ(ierr);
+    MatDestroy(&_G);
+
+    _hmat = new HMatrix(_hmatTol,_hmatLeafSize,_hmatEta);
+    ierr = _hmat->compress(z,rowStart,rowEnd,G); CHKERRQ(ierr);
+  }
+  ierr = VecSet(_material->_bcL,0.0); CHKERRQ(ierr);
+  ierr = VecSet(_material->_bcT,0.0); CHKERRQ(ierr);
+  ierr = VecSet(_material->_bcB,0.0); CHKERRQ(ierr);
+
+  // stress due to a unit displacement on the right boundary
+  ierr = VecDuplicate(tau,&_tauQS_bcR); CHKERRQ(ierr);
+  ierr = VecSet(_tauQS_bcR,0.0); CHKERRQ(ierr);
+  if (_bcRType.compare("remoteLoading")==0) {
+    ierr = VecSet(_material->_bcR,1.0); CHKERRQ(ierr);
+    ierr = solveForTauQS(_tauQS_bcR); CHKERRQ(ierr);
+  }
+
+  // stress due to the boundary conditions and forcing that are fixed in time
+  ierr = VecDuplicate(tau,&_tauQS_0); CHKERRQ(ierr);
+  if (_bcRType.compare("remoteLoading")==0) { ierr = VecCopy(_material->_bcRShift,_material->_bcR); CHKERRQ(ierr); }
+  else { ierr = VecCopy(bcR0,_material->_bcR); CHKERRQ(ierr); }
+  ierr = VecCopy(bcT0,_material->_bcT); CHKERRQ(ierr);
+  ierr = VecCopy(bcB0,_material->_bcB); CHKERRQ(ierr);
+  ierr = solveMomentumBalance(_initTime,_varEx,_varEx); CHKERRQ(ierr);
+  Vec sxy,sxz,sdev;
+  ierr = _material->getStresses(sxy,sxz,sdev); CHKERRQ(ierr);
+  ierr = VecScatterBegin(*_body2fault, sxy, _tauQS_0, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+  ierr = VecScatterEnd(*_body2fault, sxy, _tauQS_0, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+
+  // restore boundary conditions
+  ierr = VecCopy(bcL0,_material->_bcL); CHKERRQ(ierr);
+  ierr = VecCopy(bcR0,_material->_bcR); CHKERRQ(ierr);
+  VecDestroy(&bcL0);
+  VecDestroy(&bcR0);
+  VecDestroy(&bcT0);
+  VecDestroy(&bcB0);
+  VecDestroy(&tau);
+
+  _greensFunctionSetUpTime = MPI_Wtime() - startTime;
+  #if VERBOSE > 0
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Computed Green's function for %i fault nodes in %g s\n",N,_greensFunctionSetUpTime);CHKERRQ(ierr);
+  #endif
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
   return ierr;
 }
 
@@ -16,6 +16,7 @@
 #include "odeSolverImex.hpp"
 #include "genFuncs.hpp"
 #include "domain.hpp"
+#include "outputScheduler.hpp"
 #include "sbpOps.hpp"
 #include "sbpOps_m_constGrid.hpp"
 #include "sbpOps_m_varGrid.hpp"
@@ -23,6 +24,7 @@
 #include "pressureEq.hpp"
 #include "heatEquation.hpp"
 #include "linearElastic.hpp"
+#include "hMatrix.hpp"
 
 using namespace std;
 
@@ -30,6 +32,22 @@ using namespace std;
  * Mediator-level class for the simulation of earthquake cycles on a vertical strike-slip fault
  *  with linear elastic material properties.
  * Uses the quasi-dynamic approximation.
+ *
+ * With momentumBalanceType = quasidynamic_greensFunction or
+ * quasidynamic_hmatrix, the shear stress on the fault is computed from a
+ * Green's function instead of solving the momentum balance equation at every
+ * evaluation of d_dt, so the Runge-Kutta stages do not depend on the size of
+ * the body grid. The Green's function is computed once at start-up,
+ * greensFunctionBlockSize right-hand sides solved together (see
+ * LinearElastic::computeFaultGreensFunction), and stored as a dense matrix
+ * (quasidynamic_greensFunction) or as an H-matrix (quasidynamic_hmatrix, see
+ * HMatrix). The body fields are then only solved for when they are written
+ * out or checkpointed.
+ *
+ * With momentumBalanceType = quasidynamic, every evaluation of d_dt still
+ * solves for u, but only computes the shear stress on the fault from it (the
+ * fault rows of mu*Dy). The stresses in the rest of the body are computed only
+ * when they are written out or checkpointed.
  */
 
 
@@ -63,6 +81,7 @@ private:
   map <string,Vec>  _varIm; // holds variables for implicit integration in time
   string            _timeIntegrator,_timeControlType;
   PetscInt          _stride1D,_stride2D; // stride
+  OutputScheduler  *_outSched1D,*_outSched2D; // decide which steps to write 1D and 2D output
   PetscInt          _maxStepCount; // largest number of time steps
   PetscScalar       _initTime,_currTime,_maxTime,_minDeltaT,_maxDeltaT,_deltaT;
   int               _stepCount; // number of time steps at which results are written out
@@ -94,12 +113,27 @@ private:
   // for mapping from body fields to the fault
   VecScatter* _body2fault;
 
+  // for momentumBalanceType = quasidynamic_greensFunction and quasidynamic_hmatrix
+  // shear stress on fault = G*slip + (vL*time/faultTypeScale)*_tauQS_bcR + _tauQS_0
+  PetscScalar  _hmatTol,_hmatEta; // ACA tolerance, admissibility parameter
+  PetscInt     _hmatLeafSize; // max size of dense blocks
+  Mat          _G; // dense G (quasidynamic_greensFunction)
+  HMatrix     *_hmat; // compressed G (quasidynamic_hmatrix)
+  Vec          _tauQS_bcR,_tauQS_0; // due to unit remote displacement, and due to forcing and fixed boundary conditions
+  double       _greensFunctionSetUpTime;
+
   // private member functions
   PetscErrorCode loadSettings(const char *file);
   PetscErrorCode checkInput();
   PetscErrorCode parseBCs(); // parse boundary conditions
   PetscErrorCode computeMinTimeStep(); // compute min allowed time step as dx / cs
   PetscErrorCode constructIceStreamForcingTerm(); // ice stream forcing term
+  PetscErrorCode setUpGreensFunction(); // compute (and compress) the Green's function
+  PetscErrorCode solveForTauQS(Vec& tau); // solve momentum balance with current bcs, and put shear stress on fault into tau
+  PetscErrorCode computeTauQS_greensFunction(const PetscScalar time,const map<string,Vec>& varEx);
+  PetscErrorCode solveForU(const PetscScalar time); // set rhs from current bcs and solve momentum balance for u
+  PetscErrorCode computeTauQS(const PetscScalar time,const map<string,Vec>& varEx,map<string,Vec>& dvarEx);
+  PetscErrorCode updateBodyFields(const PetscScalar time); // u and stresses for output, from the latest d_dt
 
 public:
 
@@ -131,6 +165,9 @@ public:
   // methods for implicit/explicit time stepping
   PetscErrorCode d_dt(const PetscScalar time,const map<string,Vec>& varEx,map<string,Vec>& dvarEx, map<string,Vec>& varIm,const map<string,Vec>& varImo,const PetscScalar dt);
 
+  // lets the fault reuse slip velocity from earlier stages
+  PetscErrorCode setStage(const PetscInt stage);
+
   // IO functions
   PetscErrorCode view();
   PetscErrorCode writeContext();
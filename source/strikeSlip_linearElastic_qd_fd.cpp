@@ -12,10 +12,11 @@ strikeSlip_linearElastic_qd_fd::strikeSlip_linearElastic_qd_fd(Domain&D)
     _hydraulicCoupling("no"),_hydraulicTimeIntType("explicit"),
     _guessSteadyStateICs(0),_forcingType("no"),_faultTypeScale(2.0),
     _cycleCount(0),_maxNumCycles(1e3),
-    _deltaT(-1), _CFL(-1),_y(&D._y),_z(&D._z),
+    _deltaT(-1), _CFL(-1),_ltsRatio(1),
+    _fdWindowMargin(-1),_fdWindowTol(1e-3),_y(&D._y),_z(&D._z),
     _inDynamic(false),_allowed(false),
     _trigger_qd2fd(1e-3), _trigger_fd2qd(1e-3),
-    _limit_qd(10*_vL), _limit_fd(1e-1),_limit_stride_fd(-1),_u0(NULL),
+    _limit_qd(10*_vL), _limit_fd(1e-1),_limit_stride_fd(-1),_regimeSwitch(NULL),_u0(NULL),
     _timeIntegrator("RK43"),_timeControlType("PID"),
     _stride1D(10),_stride2D(10),
     _stride1D_qd(10),_stride2D_qd(10),_stride1D_fd(10),
@@ -26,11 +27,13 @@ strikeSlip_linearElastic_qd_fd::strikeSlip_linearElastic_qd_fd(Domain&D)
     _timeV1D(NULL),_dtimeV1D(NULL),_timeV2D(NULL),_dtimeV2D(NULL),_regime1DV(NULL), _regime2DV(NULL),
     _integrateTime(0),_writeTime(0),_linSolveTime(0),_factorTime(0),
     _startTime(MPI_Wtime()),_miscTime(0),_dynTime(0), _qdTime(0),
+    _work("strikeSlip_linearElastic_qd_fd"),
     _forcingVal(0),
     _qd_bcRType("remoteLoading"),_qd_bcTType("freeSurface"),_qd_bcLType("symmFault"),_qd_bcBType("freeSurface"),
     _fd_bcRType("outGoingCharacteristics"),_fd_bcTType("freeSurface"),_fd_bcLType("symmFault"),_fd_bcBType("outGoingCharacteristics"),
     _mat_fd_bcRType("Neumann"),_mat_fd_bcTType("Neumann"),_mat_fd_bcLType("Neumann"),_mat_fd_bcBType("Neumann"),
     _quadEx_qd(NULL),_quadImex_qd(NULL), _quadWaveEx(NULL),
+    _quadEx_step(NULL),_quadImex_step(NULL),
     _fault_qd(NULL),_fault_fd(NULL), _material(NULL),_he(NULL),_p(NULL)
 {
 #if VERBOSE > 1
@@ -43,6 +46,9 @@ strikeSlip_linearElastic_qd_fd::strikeSlip_linearElastic_qd_fd(Domain&D)
     _guessSteadyStateICs = 0;
   }
   checkInput();
+  _outSched1D = new OutputScheduler(D._file,_delim,"1D");
+  _outSched2D = new OutputScheduler(D._file,_delim,"2D");
+  _regimeSwitch = new RegimeSwitch(D._file,_delim,_outputDir,D._outFileMode);
   parseBCs();
 
   _body2fault = &(D._scatters["body2L"]);
@@ -120,6 +126,11 @@ strikeSlip_linearElastic_qd_fd::~strikeSlip_linearElastic_qd_fd()
 
   delete _quadImex_qd;    _quadImex_qd = NULL;
   delete _quadEx_qd;      _quadEx_qd = NULL;
+  delete _quadImex_step;  _quadImex_step = NULL;
+  delete _quadEx_step;    _quadEx_step = NULL;
+  delete _outSched1D;     _outSched1D = NULL;
+  delete _outSched2D;     _outSched2D = NULL;
+  delete _regimeSwitch;   _regimeSwitch = NULL;
   delete _material;       _material = NULL;
   delete _fault_qd;       _fault_qd = NULL;
   delete _fault_fd;       _fault_fd = NULL;
@@ -219,6 +230,9 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::loadSettings(const char *file)
     else if (var.compare("limit_stride_fd")==0) { _limit_stride_fd = atof(rhs.c_str() ); }
     else if (var.compare("deltaT_fd")==0) { _deltaT = atof(rhs.c_str() ); }
     else if (var.compare("CFL")==0) { _CFL = atof(rhs.c_str() ); }
+    else if (var.compare("localTimeStepRatio")==0) { _ltsRatio = atoi(rhs.c_str() ); }
+    else if (var.compare("fdWindowMargin")==0) { _fdWindowMargin = atof(rhs.c_str() ); }
+    else if (var.compare("fdWindowTol")==0) { _fdWindowTol = atof(rhs.c_str() ); }
     else if (var.compare("maxNumCycles")==0) { _maxNumCycles = atoi(rhs.c_str() ); }
 
   }
@@ -279,6 +293,10 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::checkInput()
   assert(_fd_bcTType.compare("freeSurface")==0 || _fd_bcTType.compare("outGoingCharacteristics")==0 );
   assert(_fd_bcLType.compare("symmFault")==0 || _fd_bcLType.compare("rigidFault")==0 );
   assert(_fd_bcBType.compare("freeSurface")==0 || _fd_bcBType.compare("outGoingCharacteristics")==0 );
+  assert(_ltsRatio >= 1);
+  assert(_ltsRatio == 1 || _fdWindowMargin <= 0); // the window is not used with local time stepping
+  assert(_fdWindowTol > 0);
+  assert(_ltsRatio == 1 || _D->_gridSpacingType.compare("variableGridSpacing")==0); // on a constant grid every node would be fine (this also rules out matrix-free operators, which have no rows of D2)
 
   if (_stateLaw.compare("flashHeating")==0) {
     assert(_thermalCoupling.compare("no")!=0);
@@ -393,6 +411,12 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::computeTimeStep()
   VecMin(ts_dy,NULL,&min_ts_dy);
   VecMin(ts_dz,NULL,&min_ts_dz);
 
+  // local time stepping: the nodes that cannot take a step of localTimeStepRatio
+  // times the global CFL limit form the fine region, which takes substeps
+  if (_ltsRatio > 1) {
+    ierr = _waveOp.setLocalTimeStepping(_ltsRatio,ts_dy,ts_dz); CHKERRQ(ierr);
+  }
+
   // clean up memory usage
   VecDestroy(&dy);
   VecDestroy(&dz);
@@ -433,6 +457,11 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::computeTimeStep()
     }
   }
 
+  // with local time stepping, deltaT above is the step in the fine region
+  if (_ltsRatio > 1) {
+    _deltaT = _ltsRatio * _deltaT;
+  }
+
   _deltaT_fd = _deltaT;
 
   #if VERBOSE > 1
@@ -581,11 +610,12 @@ _dynTime += MPI_Wtime() - startTime_fd;
 
 
 
-// returns true if it's time to switch from qd to fd, or fd to qd, or if
-// the maximum time or step count has been reached
-bool strikeSlip_linearElastic_qd_fd::checkSwitchRegime(const Fault* _fault)
+// sets mustSwitch to true if it's time to switch from qd to fd, or fd to qd,
+// or if the maximum time or step count has been reached
+PetscErrorCode strikeSlip_linearElastic_qd_fd::checkSwitchRegime(const Fault* _fault, bool& mustSwitch)
 {
-  bool mustSwitch = false;
+  PetscErrorCode ierr = 0;
+  mustSwitch = false;
 
   // if using max slip velocity as switching criteria
   //~ Vec absSlipVel;
@@ -597,12 +627,11 @@ bool strikeSlip_linearElastic_qd_fd::checkSwitchRegime(const Fault* _fault)
   //~ VecDestroy(&absSlipVel);
 
   // if using R = eta*V / tauQS
-  Vec R; VecDuplicate(_fault->_slipVel,&R);
+  Vec R; _work.get("checkSwitchRegime_R",_fault->_slipVel,R);
   VecPointwiseMult(R,_fault_qd->_eta_rad,_fault->_slipVel);
   VecPointwiseDivide(R,R,_fault->_tauQSP);
   PetscScalar maxV;
   VecMax(R,NULL,&maxV);
-  VecDestroy(&R);
 
 
   //~ // if integrating past allowed time or step count, force switching now
@@ -626,6 +655,9 @@ bool strikeSlip_linearElastic_qd_fd::checkSwitchRegime(const Fault* _fault)
   // switching from qd to fd happens if maxV > _trigger_qd2fd
   if (!_inDynamic && _allowed && maxV > _trigger_qd2fd) { mustSwitch = true; }
 
+  // the regime switch controller may delay the switch (regimeSwitchType = predictive)
+  ierr = _regimeSwitch->checkSwitch(_inDynamic,_cycleCount,_currTime,_stepCount,_deltaT,_deltaT_fd,maxV,mustSwitch); CHKERRQ(ierr);
+
 
   // also change stride for IO to avoid writing out too many time steps
   // at the end of an earthquake
@@ -658,7 +690,7 @@ bool strikeSlip_linearElastic_qd_fd::checkSwitchRegime(const Fault* _fault)
       //~ mustSwitch = true;
     //~ }
   //~ }
-  return mustSwitch;
+  return ierr;
 }
 
 
@@ -793,6 +825,7 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::prepare_fd2qd()
 
   // update momentum balance equation boundary conditions
   _material->changeBCTypes(_mat_qd_bcRType,_mat_qd_bcTType,_mat_qd_bcLType,_mat_qd_bcBType);
+  _waveOp.invalidate();
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -878,6 +911,12 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::prepare_qd2fd()
 
   // update momentum balance equation boundary conditions
   _material->changeBCTypes(_mat_fd_bcRType,_mat_fd_bcTType,_mat_fd_bcLType,_mat_fd_bcBType);
+  _waveOp.invalidate();
+
+  // the fd window starts at the fault and grows with the shear wave front
+  if (_fdWindowMargin > 0) {
+    ierr = _waveOp.startWindow(*_y,_material->_cs,_fdWindowMargin,_fdWindowTol,_currTime); CHKERRQ(ierr);
+  }
 
 
   #if VERBOSE > 1
@@ -896,57 +935,51 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::integrate_singleQDTimeStep()
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
 
-  OdeSolver      *quadEx = NULL; // explicit time stepping
-  OdeSolverImex  *quadImex = NULL; // implicit time stepping
+  // the time integrator is set up on the first call and kept for later
+  // calls, so that its stage Vecs are only allocated once
+  if (_quadEx_step == NULL && _quadImex_step == NULL) {
+    if (_timeIntegrator.compare("FEuler")==0) {
+      _quadEx_step = new FEuler(1,_maxTime,_deltaT_fd,_timeControlType);
+    }
+    else if (_timeIntegrator.compare("RK32")==0) {
+      _quadEx_step = new RK32(1,_maxTime,_deltaT_fd,_timeControlType);
+    }
+    else if (_timeIntegrator.compare("RK43")==0) {
+      _quadEx_step = new RK43(1,_maxTime,_deltaT_fd,_timeControlType);
+    }
+    else if (_timeIntegrator.compare("RK32_WBE")==0) {
+      _quadImex_step = new RK32_WBE(1,_maxTime,_deltaT_fd,_timeControlType);
+    }
+    else if (_timeIntegrator.compare("RK43_WBE")==0) {
+      _quadImex_step = new RK43_WBE(1,_maxTime,_deltaT_fd,_timeControlType);
+    }
+    else {
+      PetscPrintf(PETSC_COMM_WORLD,"ERROR: timeIntegrator type not understood\n");
+      assert(0); // automatically fail
+    }
 
-  // initialize time integrator
-  if (_timeIntegrator.compare("FEuler")==0) {
-    quadEx = new FEuler(1,_maxTime,_deltaT_fd,_timeControlType);
-  }
-  else if (_timeIntegrator.compare("RK32")==0) {
-    quadEx = new RK32(1,_maxTime,_deltaT_fd,_timeControlType);
-  }
-  else if (_timeIntegrator.compare("RK43")==0) {
-    quadEx = new RK43(1,_maxTime,_deltaT_fd,_timeControlType);
-  }
-  else if (_timeIntegrator.compare("RK32_WBE")==0) {
-    quadImex = new RK32_WBE(1,_maxTime,_deltaT_fd,_timeControlType);
-  }
-  else if (_timeIntegrator.compare("RK43_WBE")==0) {
-    quadImex = new RK43_WBE(1,_maxTime,_deltaT_fd,_timeControlType);
-  }
-  else {
-    PetscPrintf(PETSC_COMM_WORLD,"ERROR: timeIntegrator type not understood\n");
-    assert(0); // automatically fail
+    if (_quadImex_step != NULL) {
+      ierr = _quadImex_step->setTolerance(_timeStepTol);CHKERRQ(ierr);
+      ierr = _quadImex_step->setToleranceType(_normType);CHKERRQ(ierr);
+      ierr = _quadImex_step->setErrInds(_timeIntInds,_scale);CHKERRQ(ierr);
+    }
+    else {
+      ierr = _quadEx_step->setTolerance(_timeStepTol);CHKERRQ(ierr);
+      ierr = _quadEx_step->setToleranceType(_normType);CHKERRQ(ierr);
+      ierr = _quadEx_step->setErrInds(_timeIntInds,_scale);CHKERRQ(ierr);
+    }
   }
 
   // integrate
-  if (_timeIntegrator.compare("RK32_WBE")==0 || _timeIntegrator.compare("RK43_WBE")==0) {
-    quadImex->setTolerance(_timeStepTol);CHKERRQ(ierr);
-    quadImex->setTimeStepBounds(_deltaT_fd,_deltaT_fd);
-    quadImex->setTimeRange(_currTime,_currTime+_deltaT_fd);
-    quadImex->setInitialStepCount(_stepCount);
-    quadImex->setInitialConds(_varQSEx,_varIm);
-    quadImex->setToleranceType(_normType);
-    quadImex->setErrInds(_timeIntInds,_scale);
-
-    ierr = quadImex->integrate(this); CHKERRQ(ierr);
+  if (_quadImex_step != NULL) {
+    ierr = _quadImex_step->setInitialConds(_varQSEx,_varIm);CHKERRQ(ierr);
+    ierr = _quadImex_step->step(this,_currTime,_stepCount,_deltaT_fd); CHKERRQ(ierr);
   }
   else {
-    quadEx->setTolerance(_timeStepTol);CHKERRQ(ierr);
-    quadEx->setTimeStepBounds(_deltaT_fd,_deltaT_fd);
-    quadEx->setTimeRange(_currTime,_currTime+_deltaT_fd);
-    quadEx->setInitialStepCount(_stepCount);
-    quadEx->setToleranceType(_normType);
-    quadEx->setInitialConds(_varQSEx);
-    quadEx->setErrInds(_timeIntInds,_scale);
-
-    ierr = quadEx->integrate(this); CHKERRQ(ierr);
+    ierr = _quadEx_step->setInitialConds(_varQSEx);CHKERRQ(ierr);
+    ierr = _quadEx_step->step(this,_currTime,_stepCount,_deltaT_fd); CHKERRQ(ierr);
   }
 
-  delete quadEx;
-  delete quadImex;
-
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -964,26 +997,33 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::writeStep1D(PetscInt stepCount, P
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
 
-  if (_timeV1D == NULL ) {
-    ierr = initiateWriteASCII(outputDir, "med_time1D.txt", _D->_outFileMode, _timeV1D, "%.15e\n", time);
-    CHKERRQ(ierr);
+  if (_D->_outputFormat.compare("hdf5") == 0) {
+    ierr = _D->_hdf5Writer.appendScalar(time,"med_time1D"); CHKERRQ(ierr);
+    ierr = _D->_hdf5Writer.appendScalar(_deltaT,"med_dt1D"); CHKERRQ(ierr);
+    ierr = _D->_hdf5Writer.appendScalar(_inDynamic,"regime1D"); CHKERRQ(ierr);
   }
   else {
-    ierr = PetscViewerASCIIPrintf(_timeV1D, "%.15e\n", time); CHKERRQ(ierr);
-  }
+    if (_timeV1D == NULL ) {
+      ierr = initiateWriteASCII(outputDir, "med_time1D.txt", _D->_outFileMode, _timeV1D, "%.15e\n", time);
+      CHKERRQ(ierr);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_timeV1D, "%.15e\n", time); CHKERRQ(ierr);
+    }
 
-  if (_dtimeV1D == NULL ) {
-    initiateWriteASCII(outputDir, "med_dt1D.txt", _D->_outFileMode, _dtimeV1D, "%.15e\n", _deltaT);
-  }
-  else {
-    ierr = PetscViewerASCIIPrintf(_dtimeV1D, "%.15e\n", _deltaT); CHKERRQ(ierr);
-  }
+    if (_dtimeV1D == NULL ) {
+      initiateWriteASCII(outputDir, "med_dt1D.txt", _D->_outFileMode, _dtimeV1D, "%.15e\n", _deltaT);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_dtimeV1D, "%.15e\n", _deltaT); CHKERRQ(ierr);
+    }
 
-  if (_regime1DV == NULL ) {
-    initiateWriteASCII(outputDir, "regime1D.txt", _D->_outFileMode, _regime1DV, "%i\n", (int)_inDynamic);
-  }
-  else {
-    ierr = PetscViewerASCIIPrintf(_regime1DV, "%i\n",_inDynamic);CHKERRQ(ierr);
+    if (_regime1DV == NULL ) {
+      initiateWriteASCII(outputDir, "regime1D.txt", _D->_outFileMode, _regime1DV, "%i\n", (int)_inDynamic);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_regime1DV, "%i\n",_inDynamic);CHKERRQ(ierr);
+    }
   }
 
   #if VERBOSE > 1
@@ -1000,25 +1040,32 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::writeStep2D(const PetscInt stepCo
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
 
-  if (_timeV2D == NULL ) {
-    ierr = initiateWriteASCII(outputDir, "med_time2D.txt", _D->_outFileMode, _timeV2D, "%.15e\n", time);
-    CHKERRQ(ierr);
+  if (_D->_outputFormat.compare("hdf5") == 0) {
+    ierr = _D->_hdf5Writer.appendScalar(time,"med_time2D"); CHKERRQ(ierr);
+    ierr = _D->_hdf5Writer.appendScalar(_deltaT,"med_dt2D"); CHKERRQ(ierr);
+    ierr = _D->_hdf5Writer.appendScalar(_inDynamic,"regime2D"); CHKERRQ(ierr);
   }
   else {
-    ierr = PetscViewerASCIIPrintf(_timeV2D, "%.15e\n", time); CHKERRQ(ierr);
-  }
-  if (_dtimeV2D == NULL ) {
-    initiateWriteASCII(outputDir, "med_dt2D.txt", _D->_outFileMode, _dtimeV2D, "%.15e\n", _deltaT);
-  }
-  else {
-    ierr = PetscViewerASCIIPrintf(_dtimeV2D, "%.15e\n", _deltaT); CHKERRQ(ierr);
-  }
+    if (_timeV2D == NULL ) {
+      ierr = initiateWriteASCII(outputDir, "med_time2D.txt", _D->_outFileMode, _timeV2D, "%.15e\n", time);
+      CHKERRQ(ierr);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_timeV2D, "%.15e\n", time); CHKERRQ(ierr);
+    }
+    if (_dtimeV2D == NULL ) {
+      initiateWriteASCII(outputDir, "med_dt2D.txt", _D->_outFileMode, _dtimeV2D, "%.15e\n", _deltaT);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_dtimeV2D, "%.15e\n", _deltaT); CHKERRQ(ierr);
+    }
 
-  if (_regime2DV == NULL ) {
-    initiateWriteASCII(outputDir, "regime2D.txt", _D->_outFileMode, _regime2DV, "%i\n", (int)_inDynamic);
-  }
-  else {
-    ierr = PetscViewerASCIIPrintf(_regime2DV, "%i\n",_inDynamic);CHKERRQ(ierr);
+    if (_regime2DV == NULL ) {
+      initiateWriteASCII(outputDir, "regime2D.txt", _D->_outFileMode, _regime2DV, "%i\n", (int)_inDynamic);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_regime2DV, "%i\n",_inDynamic);CHKERRQ(ierr);
+    }
   }
 
 
@@ -1047,7 +1094,17 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::view()
   ierr = PetscPrintf(PETSC_COMM_WORLD,"strikeSlip_linearElastic_qd_fd Runtime Summary:\n");CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent in integration (s): %g\n",_integrateTime);CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent writing output (s): %g\n",_writeTime);CHKERRQ(ierr);
+  if (_D->_asyncOutput == 1) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent staging output for writing (s): %g\n",_D->_asyncWriter._stageTime);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent waiting for output writer (s): %g\n",_D->_asyncWriter._waitTime);CHKERRQ(ierr);
+  }
+  if (_D->_outputFormat.compare("hdf5") == 0) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent writing HDF5 output (s): %g\n",_D->_hdf5Writer._writeTime);CHKERRQ(ierr);
+  }
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent propagating the wave (s): %g\n",_propagateTime);CHKERRQ(ierr);
+  ierr = _work.view();CHKERRQ(ierr);
+  ierr = _regimeSwitch->view();CHKERRQ(ierr);
+  ierr = _waveOp.view();CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent in quasidynamic (s): %g\n",_qdTime);CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent in dynamic (s): %g\n",_dynTime);CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   total run time (s): %g\n",totRunTime);CHKERRQ(ierr);
@@ -1086,6 +1143,8 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::writeContext()
   ierr = PetscViewerASCIIPrintf(viewer,"stride2D_fd = %i\n",_stride2D_fd);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"stride1D_fd_end = %i\n",_stride1D_fd_end);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"stride2D_fd_end = %i\n",_stride2D_fd_end);CHKERRQ(ierr);
+  ierr = _outSched1D->writeContext(viewer);CHKERRQ(ierr);
+  ierr = _outSched2D->writeContext(viewer);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"\n");CHKERRQ(ierr);
 
   ierr = PetscViewerASCIIPrintf(viewer,"maxStepCount = %i\n",_maxStepCount);CHKERRQ(ierr);
@@ -1108,7 +1167,11 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::writeContext()
   ierr = PetscViewerASCIIPrintf(viewer,"limit_qd = %.15e\n",_limit_qd);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"limit_fd = %.15e\n",_limit_fd);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"limit_stride_fd = %.15e\n",_limit_stride_fd);CHKERRQ(ierr);
+  ierr = _regimeSwitch->writeContext(viewer);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"CFL = %.15e\n",_CFL);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"localTimeStepRatio = %i\n",_ltsRatio);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"fdWindowMargin = %.15e # (m)\n",_fdWindowMargin);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"fdWindowTol = %.15e\n",_fdWindowTol);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"deltaT_fd = %.15e\n",_deltaT_fd);CHKERRQ(ierr);
 
 
@@ -1154,13 +1217,49 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::solveMomentumBalance(const PetscS
 {
   PetscErrorCode ierr = 0;
 
+  ierr = solveForU(); CHKERRQ(ierr);
+  _material->computeStresses();
+
+  return ierr;
+}
+
+
+PetscErrorCode strikeSlip_linearElastic_qd_fd::solveForU()
+{
+  PetscErrorCode ierr = 0;
+
   _material->setRHS();
 
   // add source term for driving the ice stream to rhs Vec
   if (_forcingType.compare("iceStream")==0) { VecAXPY(_material->_rhs,1.0,_forcingTerm); }
 
-  _material->computeU();
-  _material->computeStresses();
+  ierr = _material->computeU(); CHKERRQ(ierr);
+
+  return ierr;
+}
+
+
+// quasidynamic: shear stress on the fault from the momentum balance equation
+// The stresses in the body are only used at the accepted solution (stage 0),
+// so unless the caller needs them, the intermediate Runge-Kutta stages only
+// compute the fault rows of mu*Dy*u after the solve.
+PetscErrorCode strikeSlip_linearElastic_qd_fd::computeTauQS(const PetscScalar time,const map<string,Vec>& varEx,map<string,Vec>& dvarEx,const bool needsStresses)
+{
+  PetscErrorCode ierr = 0;
+
+  if (_fault_qd->_stage > 0 && !needsStresses) {
+    ierr = solveForU(); CHKERRQ(ierr);
+    ierr = _material->computeFaultShearStress(_fault_qd->_tauQSP,*_body2fault); CHKERRQ(ierr);
+    return ierr;
+  }
+
+  ierr = solveMomentumBalance(time,varEx,dvarEx); CHKERRQ(ierr);
+
+  // update shear stress on fault from momentum balance computation
+  Vec sxy,sxz,sdev;
+  ierr = _material->getStresses(sxy,sxz,sdev);
+  ierr = VecScatterBegin(*_body2fault, sxy, _fault_qd->_tauQSP, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+  ierr = VecScatterEnd(*_body2fault, sxy, _fault_qd->_tauQSP, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
 
   return ierr;
 }
@@ -1177,58 +1276,18 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::propagateWaves(const PetscScalar
 
 double startPropagation = MPI_Wtime();
 
-  // compute D2u = (Dyy+Dzz)*u
-  Vec D2u, temp;
-  VecDuplicate(*_y, &D2u);
-  VecDuplicate(*_y, &temp);
-  Mat A; _material->_sbp->getA(A);
-  ierr = MatMult(A, var.find("u")->second, temp);
-  ierr = _material->_sbp->Hinv(temp, D2u);
-  VecDestroy(&temp);
-  if (_D->_gridSpacingType.compare("variableGridSpacing")==0) {
-      Mat J,Jinv,qy,rz,yq,zr;
-      ierr = _material->_sbp->getCoordTrans(J,Jinv,qy,rz,yq,zr); CHKERRQ(ierr);
-      Vec temp;
-      VecDuplicate(D2u, &temp);
-      MatMult(Jinv, D2u, temp);
-      VecCopy(temp, D2u);
-      VecDestroy(&temp);
+  // K depends on deltaT and on the material's boundary conditions
+  if (!_waveOp.isSetUp(deltaT)) {
+    bool isVariableGridSpacing = _D->_gridSpacingType.compare("variableGridSpacing")==0;
+    ierr = _waveOp.setUp(_material->_sbp,_material->_rho,_ay,_fault_fd->_d2u,isVariableGridSpacing,deltaT); CHKERRQ(ierr);
   }
-  ierr = VecScatterBegin(*_body2fault, D2u, _fault_fd->_d2u, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
-  ierr = VecScatterEnd(*_body2fault, D2u, _fault_fd->_d2u, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
 
+  // keep the window (if any) ahead of the waves
+  ierr = _waveOp.updateWindow(time); CHKERRQ(ierr);
 
   // Propagate waves and compute displacement at the next time step
-  // includes boundary conditions except for fault
-
-  PetscInt       Ii,Istart,Iend;
-  PetscScalar   *uNextA; // changed in this loop
-  const PetscScalar   *u, *uPrev, *d2u, *ay, *rho; // unchchanged in this loop
-  ierr = VecGetArray(varNext["u"], &uNextA);
-  ierr = VecGetArrayRead(var.find("u")->second, &u);
-  ierr = VecGetArrayRead(varPrev.find("u")->second, &uPrev);
-  ierr = VecGetArrayRead(_ay, &ay);
-  ierr = VecGetArrayRead(D2u, &d2u);
-  ierr = VecGetArrayRead(_material->_rho, &rho);
-
-  ierr = VecGetOwnershipRange(varNext["u"],&Istart,&Iend);CHKERRQ(ierr);
-  PetscInt       Jj = 0;
-  for (Ii = Istart; Ii < Iend; Ii++){
-    PetscScalar c1 = deltaT*deltaT / rho[Jj];
-    PetscScalar c2 = deltaT*ay[Jj] - 1.0;
-    PetscScalar c3 = deltaT*ay[Jj] + 1.0;
-
-    uNextA[Jj] = (c1*d2u[Jj] + 2.*u[Jj] + c2*uPrev[Jj]) / c3;
-    Jj++;
-  }
-  ierr = VecRestoreArray(varNext["u"], &uNextA);
-  ierr = VecRestoreArrayRead(var.find("u")->second, &u);
-  ierr = VecRestoreArrayRead(varPrev.find("u")->second, &uPrev);
-  ierr = VecRestoreArrayRead(_ay, &ay);
-  ierr = VecRestoreArrayRead(D2u, &d2u);
-  ierr = VecRestoreArrayRead(_material->_rho, &rho);
-
-  VecDestroy(&D2u);
+  // includes boundary conditions except for fault, and D2u on the fault
+  ierr = _waveOp.apply(var.find("u")->second,varPrev.find("u")->second,varNext["u"],_fault_fd->_d2u); CHKERRQ(ierr);
 
 _propagateTime += MPI_Wtime() - startPropagation;
 
@@ -1270,6 +1329,7 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::solveSS()
   // update boundary conditions, stresses
   solveSSb();
   _material->changeBCTypes(_mat_qd_bcRType,_mat_qd_bcTType,_mat_qd_bcLType,_mat_qd_bcBType);
+  _waveOp.invalidate();
 
   // steady state temperature
   if (_thermalCoupling.compare("no")!=0) {
@@ -1526,7 +1586,7 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::integrate_fd()
 
   ierr = quadWaveEx->integrate(this);CHKERRQ(ierr);
 
-  std::map<string,Vec> varOut = quadWaveEx->_var;
+  std::map<string,Vec>& varOut = quadWaveEx->getVar();
   for (map<string,Vec>::iterator it = varOut.begin(); it != varOut.end(); it++ ) {
     VecCopy(varOut[it->first],_varFD[it->first]);
   }
@@ -1543,6 +1603,16 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::integrate_fd()
 
 
 
+// called by the integrator before each evaluation of d_dt
+// the fault uses the stage to warm start the slip velocity solve
+PetscErrorCode strikeSlip_linearElastic_qd_fd::setStage(const PetscInt stage)
+{
+  PetscErrorCode ierr = 0;
+  ierr = _fault_qd->setStage(stage);CHKERRQ(ierr);
+  return ierr;
+}
+
+
 // quasidynamic: purely explicit time stepping
 // note that the heat equation never appears here because it is only ever solved implicitly
 PetscErrorCode strikeSlip_linearElastic_qd_fd::d_dt(const PetscScalar time,const map<string,Vec>& varEx,map<string,Vec>& dvarEx)
@@ -1574,13 +1644,7 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::d_dt(const PetscScalar time,const
   }
 
   // compute rates
-  ierr = solveMomentumBalance(time,varEx,dvarEx); CHKERRQ(ierr);
-
-  // update fields on fault from other classes
-  Vec sxy,sxz,sdev;
-  ierr = _material->getStresses(sxy,sxz,sdev);
-  ierr = VecScatterBegin(*_body2fault, sxy, _fault_qd->_tauQSP, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
-  ierr = VecScatterEnd(*_body2fault, sxy, _fault_qd->_tauQSP, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+  ierr = computeTauQS(time,varEx,dvarEx,false); CHKERRQ(ierr);
 
   // rates for fault
   ierr = _fault_qd->d_dt(time,varEx,dvarEx); // sets rates for slip and state
@@ -1635,13 +1699,8 @@ PetscErrorCode strikeSlip_linearElastic_qd_fd::d_dt(const PetscScalar time,const
 
 
   // 2. compute rates, and update implicitly integrated variables
-  ierr = solveMomentumBalance(time,varEx,dvarEx); CHKERRQ(ierr);
-
-  // update shear stress on fault from momentum balance computation
-  Vec sxy,sxz,sdev;
-  ierr = _material->getStresses(sxy,sxz,sdev);
-  ierr = VecScatterBegin(*_body2fault, sxy, _fault_qd->_tauQSP, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
-  ierr = VecScatterEnd(*_body2fault, sxy, _fault_qd->_tauQSP, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
+  // (the heat equation below needs sdev at every stage)
+  ierr = computeTauQS(time,varEx,dvarEx,varIm.find("Temp") != varIm.end()); CHKERRQ(ierr);
 
   // rates for fault
   ierr = _fault_qd->d_dt(time,varEx,dvarEx); // sets rates for slip and state
@@ -1825,7 +1884,17 @@ double startTime = MPI_Wtime();
   if (_stepCount == stepCount && _stepCount != 0) { return ierr; } // don't write out the same step twice
   _stepCount = stepCount;
 
-  if ( (_stride1D>0 &&_currTime == _maxTime) || (_stride1D>0 && stepCount % _stride1D == 0) ) {
+  // decide whether to write output at this step
+  Fault *fault = _fault_qd;
+  if (_inDynamic) { fault = _fault_fd; }
+  bool write1D = false, write2D = false;
+  map<string,Vec> outputFields;
+  outputFields["slip"] = fault->_slip;
+  outputFields["tauP"] = fault->_tauP;
+  ierr = _outSched1D->checkWrite(stepCount,_stride1D,_currTime,_maxTime,fault->_slipVel,outputFields,write1D); CHKERRQ(ierr);
+  ierr = _outSched2D->checkWrite(stepCount,_stride2D,_currTime,_maxTime,fault->_slipVel,outputFields,write2D); CHKERRQ(ierr);
+
+  if (write1D) {
     ierr = writeStep1D(_stepCount,time,_outputDir); CHKERRQ(ierr);
     ierr = _material->writeStep1D(_stepCount,_outputDir); CHKERRQ(ierr);
     if(_inDynamic){ ierr = _fault_fd->writeStep(_stepCount,_outputDir); CHKERRQ(ierr); }
@@ -1834,14 +1903,21 @@ double startTime = MPI_Wtime();
     if (_thermalCoupling.compare("no")!=0) { ierr =  _he->writeStep1D(_stepCount,time,_outputDir); CHKERRQ(ierr); }
   }
 
-  if ( (_stride2D>0 &&_currTime == _maxTime) || (_stride2D>0 && stepCount % _stride2D == 0) ) {
+  if (write2D) {
     ierr = writeStep2D(_stepCount,time,_outputDir); CHKERRQ(ierr);
     ierr = _material->writeStep2D(_stepCount,_outputDir);CHKERRQ(ierr);
     if (_thermalCoupling.compare("no")!=0) { ierr =  _he->writeStep2D(_stepCount,time,_outputDir);CHKERRQ(ierr); }
   }
 
-  if(_inDynamic){ if(checkSwitchRegime(_fault_fd)){ stopIntegration = 1; } }
-  else { if(checkSwitchRegime(_fault_qd)){ stopIntegration = 1; } }
+  bool mustSwitch = false;
+  if(_inDynamic){ ierr = checkSwitchRegime(_fault_fd,mustSwitch); CHKERRQ(ierr); }
+  else { ierr = checkSwitchRegime(_fault_qd,mustSwitch); CHKERRQ(ierr); }
+  if (mustSwitch) { stopIntegration = 1; }
+
+  // report any scratch Vecs allocated during this step
+  ierr = _work.endStep(stepCount); CHKERRQ(ierr);
+  if (_thermalCoupling.compare("no")!=0) { ierr = _he->_work.endStep(stepCount); CHKERRQ(ierr); }
+  if (_hydraulicCoupling.compare("no")!=0) { ierr = _p->endStep(stepCount); CHKERRQ(ierr); }
 
   #if VERBOSE > 0
     std::string regime = "quasidynamic";
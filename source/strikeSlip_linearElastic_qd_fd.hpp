@@ -19,7 +19,11 @@
 #include "odeSolver_WaveEq.hpp"
 #include "odeSolver_WaveImex.hpp"
 #include "genFuncs.hpp"
+#include "workspace.hpp"
+#include "waveOperator.hpp"
 #include "domain.hpp"
+#include "outputScheduler.hpp"
+#include "regimeSwitch.hpp"
 #include "sbpOps.hpp"
 #include "sbpOps_m_constGrid.hpp"
 #include "sbpOps_m_varGrid.hpp"
@@ -62,11 +66,15 @@ private:
 
   PetscInt     _cycleCount,_maxNumCycles;
   PetscScalar  _deltaT, _deltaT_fd, _CFL; // current time step size, time step for fully dynamic, CFL factor
+  PetscInt     _ltsRatio; // # of local time steps near the fault per fully dynamic time step
+  PetscScalar  _fdWindowMargin; // (m) fd only advances the nodes in a window kept this far ahead of the shear wave front, <= 0 = off
+  PetscScalar  _fdWindowTol; // grow the window when the change in u at its edge exceeds this fraction of the largest change in it
   Vec         *_y,*_z;
   Vec          _ay;
   Vec          _alphay;
   bool         _inDynamic,_allowed;
   PetscScalar  _trigger_qd2fd, _trigger_fd2qd, _limit_qd, _limit_fd, _limit_stride_fd;
+  RegimeSwitch *_regimeSwitch; // decides when to switch between qd and fd
 
   // time stepping data
   map <string,Vec>  _varFD,_varFDPrev; // holds variables for time step: n+1, n (current), n-1
@@ -75,6 +83,7 @@ private:
   Vec               _u0; // total displacement at start of fd
   string            _timeIntegrator,_timeControlType;
   PetscInt          _stride1D,_stride2D; // stride
+  OutputScheduler  *_outSched1D,*_outSched2D; // decide which steps to write 1D and 2D output
   PetscInt          _stride1D_qd, _stride2D_qd, _stride1D_fd, _stride2D_fd, _stride1D_fd_end, _stride2D_fd_end;
   PetscInt          _maxStepCount; // largest number of time steps
   PetscScalar       _initTime,_currTime,_minDeltaT,_maxDeltaT, _maxTime;
@@ -92,6 +101,8 @@ private:
 
   // runtime data
   double _integrateTime,_writeTime,_linSolveTime,_factorTime,_startTime,_miscTime, _propagateTime, _dynTime, _qdTime;
+  Workspace _work; // scratch Vecs for the functions called every time step
+  WaveOperator _waveOp; // precomputed off-fault update operator, rebuilt after each switch to fd
 
   // forcing term for ice stream problem
   Vec _forcingTerm, _forcingTermPlain; // body forcing term, copy of body forcing term for output
@@ -121,6 +132,8 @@ public:
   OdeSolverImex             *_quadImex_qd; // implicit time stepping
   OdeSolver_WaveEq          *_quadWaveEx;
   OdeSolver_WaveEq_Imex     *_quadWaveImex;
+  OdeSolver                 *_quadEx_step; // kept for integrate_singleQDTimeStep
+  OdeSolverImex             *_quadImex_step;
 
   Fault_qd                   *_fault_qd;
   Fault_fd                   *_fault_fd;
@@ -144,11 +157,13 @@ public:
   PetscErrorCode integrate_singleQDTimeStep(); // take 1 quasidynamic time step with deltaT = deltaT_fd
   PetscErrorCode initiateIntegrands(); // allocate space for vars, guess steady-state initial conditions
   PetscErrorCode solveMomentumBalance(const PetscScalar time,const map<string,Vec>& varEx,map<string,Vec>& dvarEx);
+  PetscErrorCode solveForU(); // set rhs from current bcs and solve momentum balance for u
+  PetscErrorCode computeTauQS(const PetscScalar time,const map<string,Vec>& varEx,map<string,Vec>& dvarEx,const bool needsStresses);
   PetscErrorCode propagateWaves(const PetscScalar time, const PetscScalar deltaT,
         map<string,Vec>& varNext, const map<string,Vec>& var, const map<string,Vec>& varPrev);
 
   // help with switching between fully dynamic and quasidynamic
-  bool checkSwitchRegime(const Fault* _fault);
+  PetscErrorCode checkSwitchRegime(const Fault* _fault, bool& mustSwitch);
   PetscErrorCode prepare_qd2fd(); // switch from quasidynamic to fully dynamic
   PetscErrorCode prepare_fd2qd(); // switch from fully dynamic to quasidynamic
 
@@ -160,6 +175,9 @@ public:
   // methods for implicit/explicit time stepping
   PetscErrorCode d_dt(const PetscScalar time,const map<string,Vec>& varEx,map<string,Vec>& dvarEx, map<string,Vec>& varIm,const map<string,Vec>& varImo,const PetscScalar dt); // quasidynamic
 
+  // lets the fault reuse slip velocity from earlier stages
+  PetscErrorCode setStage(const PetscInt stage);
+
   PetscErrorCode d_dt(const PetscScalar time, const PetscScalar deltaT, map<string,Vec>& varNext, const map<string,Vec>& var, const map<string,Vec>& varPrev, map<string,Vec>& varIm, const map<string,Vec>& varImPrev); // fully dynamic
 
 
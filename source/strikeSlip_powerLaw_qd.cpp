@@ -34,7 +34,16 @@ StrikeSlip_PowerLaw_qd::StrikeSlip_PowerLaw_qd(Domain&D)
   #endif
 
   loadSettings(D._file);
+
+  // if checkpoint number > 0 (i.e. there has been a checkpoint already), continue from it
+  if (_D->_ckptNumber > 0) {
+    loadCheckpoint();
+    _guessSteadyStateICs = 0;
+  }
+
   checkInput();
+  _outSched1D = new OutputScheduler(D._file,_delim,"1D");
+  _outSched2D = new OutputScheduler(D._file,_delim,"2D");
   parseBCs();
 
   // initiate momentum balance equation
@@ -63,6 +72,9 @@ StrikeSlip_PowerLaw_qd::StrikeSlip_PowerLaw_qd(Domain&D)
   _forcingTerm = NULL; _forcingTermPlain = NULL;
   if (_forcingType.compare("iceStream")==0) { constructIceStreamForcingTerm(); }
 
+  // every class has copied its fields out of the checkpoint
+  _D->_checkpoint.releaseLoaded();
+
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
@@ -98,6 +110,8 @@ StrikeSlip_PowerLaw_qd::~StrikeSlip_PowerLaw_qd()
 
   delete _quadImex;    _quadImex = NULL;
   delete _quadEx;      _quadEx = NULL;
+  delete _outSched1D;  _outSched1D = NULL;
+  delete _outSched2D;  _outSched2D = NULL;
   delete _material;    _material = NULL;
   delete _fault;       _fault = NULL;
   delete _he;          _he = NULL;
@@ -222,7 +236,8 @@ PetscErrorCode StrikeSlip_PowerLaw_qd::checkInput()
       _timeIntegrator.compare("RK32")==0 ||
       _timeIntegrator.compare("RK43")==0 ||
       _timeIntegrator.compare("RK32_WBE")==0 ||
-      _timeIntegrator.compare("RK43_WBE")==0 );
+      _timeIntegrator.compare("RK43_WBE")==0 ||
+      _timeIntegrator.compare("ETD2_WBE")==0 );
 
   assert(_timeControlType.compare("P")==0 ||
          _timeControlType.compare("PI")==0 ||
@@ -314,7 +329,8 @@ PetscErrorCode StrikeSlip_PowerLaw_qd::initiateIntegrand()
   VecDuplicate(_material->_bcL,&slip);
   VecCopy(_material->_bcL,slip);
   VecScale(slip,2.0);
-  ierr = loadVecFromInputFile(slip,_D->_inputDir,"slip"); CHKERRQ(ierr);
+  if (_D->_ckptNumber > 0) { VecCopy(_fault->_slip,slip); } // continue from the checkpoint
+  else { ierr = loadVecFromInputFile(slip,_D->_inputDir,"slip"); CHKERRQ(ierr); }
   _varEx["slip"] = slip;
 
   if (_guessSteadyStateICs) {
@@ -364,10 +380,15 @@ double startTime = MPI_Wtime();
   _deltaT = deltaT;
   _currTime = time;
 
-  if (_stepCount < 50 ) { _stride1D = 1; _stride2D = 1; }
-  else { _stride1D = 100; _stride2D = 100; }
+  // decide whether to write output at this step
+  bool write1D = false, write2D = false;
+  map<string,Vec> outputFields;
+  outputFields["slip"] = _fault->_slip;
+  outputFields["tauP"] = _fault->_tauP;
+  ierr = _outSched1D->checkWrite(stepCount,_stride1D,_currTime,_maxTime,_fault->_slipVel,outputFields,write1D); CHKERRQ(ierr);
+  ierr = _outSched2D->checkWrite(stepCount,_stride2D,_currTime,_maxTime,_fault->_slipVel,outputFields,write2D); CHKERRQ(ierr);
 
-  if ( (_stride1D>0 &&_currTime == _maxTime) || (_stride1D>0 && stepCount % _stride1D == 0)) {
+  if (write1D) {
     ierr = writeStep1D(stepCount,time,_outputDir); CHKERRQ(ierr);
     ierr = _material->writeStep1D(_outputDir); CHKERRQ(ierr);
     ierr = _fault->writeStep(_stepCount, _outputDir); CHKERRQ(ierr);
@@ -375,17 +396,20 @@ double startTime = MPI_Wtime();
     if (_thermalCoupling.compare("no")!=0) { ierr =  _he->writeStep1D(_stepCount,time,_outputDir); CHKERRQ(ierr); }
   }
 
-  if ( (_stride2D>0 &&_currTime == _maxTime) || (_stride2D>0 && stepCount % _stride2D == 0)) {
+  if (write2D) {
     ierr = writeStep2D(stepCount,time,_outputDir); CHKERRQ(ierr);
     ierr = _material->writeStep2D(_outputDir);CHKERRQ(ierr);
     if (_thermalCoupling.compare("no")!=0) { ierr =  _he->writeStep2D(_stepCount,time,_outputDir);CHKERRQ(ierr); }
     if (_grainSizeEvCoupling.compare("no")!=0) { ierr =  _grainDist->writeStep(_stepCount,time,_outputDir);CHKERRQ(ierr); }
   }
 
+  // the Maxwell time limits the step size, except for ETD2_WBE, which
+  // integrates the viscous relaxation exactly
   PetscScalar maxTimeStep_tot, maxDeltaT_momBal = 0.0;
   _material->computeMaxTimeStep(maxDeltaT_momBal);
   maxTimeStep_tot = min(_maxDeltaT,0.9*maxDeltaT_momBal);
-  if (_timeIntegrator.compare("RK32_WBE")==0 || _timeIntegrator.compare("RK43_WBE")==0) {
+  if (_timeIntegrator.compare("ETD2_WBE")==0) { maxTimeStep_tot = _maxDeltaT; }
+  if (_quadImex != NULL) {
       _quadImex->setTimeStepBounds(_minDeltaT,maxTimeStep_tot);CHKERRQ(ierr);
   }
   else {_quadEx->setTimeStepBounds(_minDeltaT,maxTimeStep_tot);CHKERRQ(ierr); }
@@ -397,6 +421,17 @@ double startTime = MPI_Wtime();
     if (time >= 5e10) { stopIntegration = 1; }
   }
 
+  if (_D->_ckpt > 0) {
+    bool writeCkpt = false, stopAfterCkpt = false;
+    ierr = _D->_checkpoint.checkWrite(stepCount,_D->_interval,writeCkpt,stopAfterCkpt); CHKERRQ(ierr);
+    if (stepCount >= _maxStepCount || time >= _maxTime) { writeCkpt = true; stopAfterCkpt = true; }
+    if (writeCkpt) {
+      ierr = _D->flushTimeSeries(); CHKERRQ(ierr); // output files must be complete when the checkpoint is
+      ierr = writeCheckpoint(); CHKERRQ(ierr);
+    }
+    if (stopAfterCkpt) { stopIntegration = 1; }
+  }
+
   #if VERBOSE > 0
     ierr = PetscPrintf(PETSC_COMM_WORLD,"%i: t = %.15e s, dt = %.5e, min Tmax = %.5e\n",stepCount,_currTime,_deltaT,maxDeltaT_momBal);CHKERRQ(ierr);
   #endif
@@ -407,6 +442,58 @@ _writeTime += MPI_Wtime() - startTime;
   return ierr;
 }
 
+// load the mediator's state from the checkpoint Domain loaded
+PetscErrorCode StrikeSlip_PowerLaw_qd::loadCheckpoint()
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    std::string funcName = "StrikeSlip_PowerLaw_qd::loadCheckpoint";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  const Checkpoint& ckpt = _D->_checkpoint;
+  ierr = ckpt.getScalar("med_currT",_initTime); CHKERRQ(ierr);
+  ierr = ckpt.getScalar("med_stepCount",_stepCount); CHKERRQ(ierr);
+  ierr = ckpt.getScalar("ode_deltaT",_initDeltaT); CHKERRQ(ierr);
+  _currTime = _initTime;
+
+  #if VERBOSE > 1
+     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+// write checkpoint _ckptNumber + 1, with the state of the mediator, the
+// time integrator and every physics module
+PetscErrorCode StrikeSlip_PowerLaw_qd::writeCheckpoint()
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    std::string funcName = "StrikeSlip_PowerLaw_qd::writeCheckpoint";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  Checkpoint& ckpt = _D->_checkpoint;
+  ierr = ckpt.setScalar("med_currT",_currTime); CHKERRQ(ierr);
+  ierr = ckpt.setScalar("med_stepCount",_stepCount); CHKERRQ(ierr);
+  if (_quadImex != NULL) { ierr = _quadImex->writeCheckpoint(ckpt); CHKERRQ(ierr); }
+  if (_quadEx != NULL) { ierr = _quadEx->writeCheckpoint(ckpt); CHKERRQ(ierr); }
+
+  ierr = _material->writeCheckpoint(); CHKERRQ(ierr);
+  ierr = _fault->writeCheckpoint(); CHKERRQ(ierr);
+  ierr = _he->writeCheckpoint(); CHKERRQ(ierr); // the heat equation always exists in this class
+  if (_hydraulicCoupling.compare("no")!=0) { ierr = _p->writeCheckpoint(); CHKERRQ(ierr); }
+  if (_grainSizeEvCoupling.compare("no")!=0) { ierr = _grainDist->writeCheckpoint(); CHKERRQ(ierr); }
+
+  _D->_ckptNumber++;
+  ierr = ckpt.write(_outputDir,_D->_ckptNumber); CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
 PetscErrorCode StrikeSlip_PowerLaw_qd::writeStep1D(PetscInt stepCount, PetscScalar time, const std::string outputDir)
 {
   PetscErrorCode ierr = 0;
@@ -415,18 +502,24 @@ PetscErrorCode StrikeSlip_PowerLaw_qd::writeStep1D(PetscInt stepCount, PetscScal
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
 
-  if (_timeV1D == NULL ) {
-    ierr = initiateWriteASCII(outputDir, "med_time1D.txt", _D->_outFileMode, _timeV1D, "%.15e\n", time);
-    CHKERRQ(ierr);
+  if (_D->_outputFormat.compare("hdf5") == 0) {
+    ierr = _D->_hdf5Writer.appendScalar(time,"med_time1D"); CHKERRQ(ierr);
+    ierr = _D->_hdf5Writer.appendScalar(_deltaT,"med_dt1D"); CHKERRQ(ierr);
   }
   else {
-    ierr = PetscViewerASCIIPrintf(_timeV1D, "%.15e\n", time); CHKERRQ(ierr);
-  }
-  if (_dtimeV1D == NULL ) {
-    initiateWriteASCII(outputDir, "med_dt1D.txt", _D->_outFileMode, _dtimeV1D, "%.15e\n", _deltaT);
-  }
-  else {
-    ierr = PetscViewerASCIIPrintf(_dtimeV1D, "%.15e\n", _deltaT); CHKERRQ(ierr);
+    if (_timeV1D == NULL ) {
+      ierr = initiateWriteASCII(outputDir, "med_time1D.txt", _D->_outFileMode, _timeV1D, "%.15e\n", time);
+      CHKERRQ(ierr);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_timeV1D, "%.15e\n", time); CHKERRQ(ierr);
+    }
+    if (_dtimeV1D == NULL ) {
+      initiateWriteASCII(outputDir, "med_dt1D.txt", _D->_outFileMode, _dtimeV1D, "%.15e\n", _deltaT);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_dtimeV1D, "%.15e\n", _deltaT); CHKERRQ(ierr);
+    }
   }
 
   #if VERBOSE > 1
@@ -444,18 +537,24 @@ PetscErrorCode StrikeSlip_PowerLaw_qd::writeStep2D(PetscInt stepCount, PetscScal
   #endif
 
 
-  if (_timeV2D == NULL ) {
-    ierr = initiateWriteASCII(outputDir, "med_time2D.txt", _D->_outFileMode, _timeV2D, "%.15e\n", time);
-    CHKERRQ(ierr);
-  }
-  else {
-    ierr = PetscViewerASCIIPrintf(_timeV2D, "%.15e\n", time); CHKERRQ(ierr);
-  }
-  if (_dtimeV2D == NULL ) {
-    initiateWriteASCII(outputDir, "med_dt2D.txt", _D->_outFileMode, _dtimeV2D, "%.15e\n", _deltaT);
+  if (_D->_outputFormat.compare("hdf5") == 0) {
+    ierr = _D->_hdf5Writer.appendScalar(time,"med_time2D"); CHKERRQ(ierr);
+    ierr = _D->_hdf5Writer.appendScalar(_deltaT,"med_dt2D"); CHKERRQ(ierr);
   }
   else {
-    ierr = PetscViewerASCIIPrintf(_dtimeV2D, "%.15e\n", _deltaT); CHKERRQ(ierr);
+    if (_timeV2D == NULL ) {
+      ierr = initiateWriteASCII(outputDir, "med_time2D.txt", _D->_outFileMode, _timeV2D, "%.15e\n", time);
+      CHKERRQ(ierr);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_timeV2D, "%.15e\n", time); CHKERRQ(ierr);
+    }
+    if (_dtimeV2D == NULL ) {
+      initiateWriteASCII(outputDir, "med_dt2D.txt", _D->_outFileMode, _dtimeV2D, "%.15e\n", _deltaT);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_dtimeV2D, "%.15e\n", _deltaT); CHKERRQ(ierr);
+    }
   }
 
   #if VERBOSE > 1
@@ -471,7 +570,7 @@ PetscErrorCode StrikeSlip_PowerLaw_qd::view()
 
   double totRunTime = MPI_Wtime() - _startTime;
 
-  if (_timeIntegrator.compare("IMEX")==0&& _quadImex!=NULL) { ierr = _quadImex->view(); }
+  if (_quadImex!=NULL) { ierr = _quadImex->view(); }
   if (_timeIntegrator.compare("RK32")==0 && _quadEx!=NULL) { ierr = _quadEx->view(); }
 
   _material->view(_integrateTime);
@@ -483,6 +582,17 @@ PetscErrorCode StrikeSlip_PowerLaw_qd::view()
   ierr = PetscPrintf(PETSC_COMM_WORLD,"StrikeSlip_PowerLaw_qd Runtime Summary:\n");CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent in integration (s): %g\n",_integrateTime);CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent writing output (s): %g\n",_writeTime);CHKERRQ(ierr);
+  if (_D->_asyncOutput == 1) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent staging output for writing (s): %g\n",_D->_asyncWriter._stageTime);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent waiting for output writer (s): %g\n",_D->_asyncWriter._waitTime);CHKERRQ(ierr);
+  }
+  if (_D->_outputFormat.compare("hdf5") == 0) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent writing HDF5 output (s): %g\n",_D->_hdf5Writer._writeTime);CHKERRQ(ierr);
+  }
+  if (_D->_ckpt > 0) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent writing checkpoints (s): %g\n",_D->_checkpoint._writeTime);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   checkpoints written: %i\n",_D->_checkpoint._numWrites);CHKERRQ(ierr);
+  }
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   %% integration time spent writing output: %g\n",_writeTime/totRunTime*100.);CHKERRQ(ierr);
   return ierr;
 }
@@ -513,7 +623,9 @@ PetscErrorCode StrikeSlip_PowerLaw_qd::writeContext()
   ierr = PetscViewerASCIIPrintf(viewer,"timeIntegrator = %s\n",_timeIntegrator.c_str());CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"timeControlType = %s\n",_timeControlType.c_str());CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"stride1D = %i\n",_stride1D);CHKERRQ(ierr);
-  ierr = PetscViewerASCIIPrintf(viewer,"stride2D = %i\n",_stride1D);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"stride2D = %i\n",_stride2D);CHKERRQ(ierr);
+  ierr = _outSched1D->writeContext(viewer);CHKERRQ(ierr);
+  ierr = _outSched2D->writeContext(viewer);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"maxStepCount = %i\n",_maxStepCount);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"initTime = %.15e # (s)\n",_initTime);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"maxTime = %.15e # (s)\n",_maxTime);CHKERRQ(ierr);
@@ -587,22 +699,34 @@ PetscErrorCode StrikeSlip_PowerLaw_qd::integrate()
   else if (_timeIntegrator.compare("RK43_WBE")==0) {
     _quadImex = new RK43_WBE(_maxStepCount,_maxTime,_initDeltaT,_timeControlType);
   }
+  else if (_timeIntegrator.compare("ETD2_WBE")==0) {
+    _quadImex = new ETD2_WBE(_maxStepCount,_maxTime,_initDeltaT,_timeControlType);
+  }
   else {
     PetscPrintf(PETSC_COMM_WORLD,"ERROR: timeIntegrator type not understood\n");
     assert(0); // automatically fail
   }
 
-  if (_timeIntegrator.compare("RK32_WBE")==0 || _timeIntegrator.compare("RK43_WBE")==0) {
+  if (_quadImex != NULL) {
     _quadImex->setTolerance(_timeStepTol);CHKERRQ(ierr);
     _quadImex->setTimeStepBounds(_minDeltaT,_maxDeltaT);CHKERRQ(ierr);
+    if (_he != NULL && _he->_dtCacheSize > 0 && _he->_dtCacheSnap == 1) {
+      ierr = _quadImex->setStepSizeBuckets(_he->_dtCacheRatio);CHKERRQ(ierr);
+    }
     ierr = _quadImex->setTimeRange(_initTime,_maxTime);
     ierr = _quadImex->setInitialConds(_varEx,_varIm);CHKERRQ(ierr);
     ierr = _quadImex->setToleranceType(_normType); CHKERRQ(ierr);
     ierr = _quadImex->setErrInds(_timeIntInds,_scale); // control which fields are used to select step size
 
-    // save initial conditions before beginning integration
-    PetscInt stopIntegration = 0;
-    timeMonitor(_initTime,_initDeltaT,0,stopIntegration);
+    // save initial conditions before beginning integration, unless they
+    // were already written before the checkpoint being restarted from
+    if (_D->_ckpt > 0 && _D->_ckptNumber > 0) {
+      ierr = _quadImex->loadCheckpoint(_D->_checkpoint);CHKERRQ(ierr);
+    }
+    else {
+      PetscInt stopIntegration = 0;
+      timeMonitor(_initTime,_initDeltaT,0,stopIntegration);
+    }
 
     ierr = _quadImex->integrate(this);CHKERRQ(ierr);
   }
@@ -614,9 +738,15 @@ PetscErrorCode StrikeSlip_PowerLaw_qd::integrate()
     ierr = _quadEx->setInitialConds(_varEx);CHKERRQ(ierr);
     ierr = _quadEx->setErrInds(_timeIntInds,_scale); // control which fields are used to select step size
 
-    // save initial conditions before beginning integration
-    PetscInt stopIntegration = 0;
-    timeMonitor(_initTime,_initDeltaT,0,stopIntegration);
+    // save initial conditions before beginning integration, unless they
+    // were already written before the checkpoint being restarted from
+    if (_D->_ckpt > 0 && _D->_ckptNumber > 0) {
+      ierr = _quadEx->loadCheckpoint(_D->_checkpoint);CHKERRQ(ierr);
+    }
+    else {
+      PetscInt stopIntegration = 0;
+      timeMonitor(_initTime,_initDeltaT,0,stopIntegration);
+    }
 
     ierr = _quadEx->integrate(this);CHKERRQ(ierr);
   }
@@ -628,6 +758,31 @@ PetscErrorCode StrikeSlip_PowerLaw_qd::integrate()
   return ierr;
 }
 
+// called by the integrator before each evaluation of d_dt
+// the fault uses the stage to warm start the slip velocity solve
+PetscErrorCode StrikeSlip_PowerLaw_qd::setStage(const PetscInt stage)
+{
+  PetscErrorCode ierr = 0;
+  ierr = _fault->setStage(stage);CHKERRQ(ierr);
+  return ierr;
+}
+
+
+// for ETD2_WBE: the viscous strains relax at the rate mu/effVisc, since
+// d/dt gV = (mu*(gT - gV) + ...)/effVisc, with effVisc from the latest d_dt
+PetscErrorCode StrikeSlip_PowerLaw_qd::getLinearRelaxationRates(map<string,Vec>& lambda)
+{
+  PetscErrorCode ierr = 0;
+  if (lambda.find("gVxy") != lambda.end()) {
+    ierr = VecPointwiseDivide(lambda["gVxy"],_material->_mu,_material->_effVisc);CHKERRQ(ierr);
+  }
+  if (_material->_Nz > 1 && lambda.find("gVxz") != lambda.end()) {
+    ierr = VecPointwiseDivide(lambda["gVxz"],_material->_mu,_material->_effVisc);CHKERRQ(ierr);
+  }
+  return ierr;
+}
+
+
 // purely explicit time stepping
 // note that the heat equation never appears here because it is only ever solved implicitly
 PetscErrorCode StrikeSlip_PowerLaw_qd::d_dt(const PetscScalar time,const map<string,Vec>& varEx,map<string,Vec>& dvarEx)
@@ -16,6 +16,7 @@
 #include "odeSolverImex.hpp"
 #include "genFuncs.hpp"
 #include "domain.hpp"
+#include "outputScheduler.hpp"
 #include "sbpOps.hpp"
 #include "sbpOps_m_constGrid.hpp"
 #include "sbpOps_m_varGrid.hpp"
@@ -68,6 +69,7 @@ public:
   map <string,Vec>  _varIm; // holds variables for implicit integration in time
   string            _timeIntegrator,_timeControlType;
   PetscInt          _stride1D,_stride2D; // stride
+  OutputScheduler  *_outSched1D,*_outSched2D; // decide which steps to write 1D and 2D output
   PetscInt          _maxStepCount; // largest number of time steps
   PetscScalar       _initTime,_currTime,_maxTime,_minDeltaT,_maxDeltaT,_deltaT;
   int               _stepCount;
@@ -152,6 +154,12 @@ public:
   // methods for implicit/explicit time stepping
   PetscErrorCode d_dt(const PetscScalar time,const map<string,Vec>& varEx,map<string,Vec>& dvarEx, map<string,Vec>& varIm,const map<string,Vec>& varImo,const PetscScalar dt);
 
+  // lets the fault reuse slip velocity from earlier stages
+  PetscErrorCode setStage(const PetscInt stage);
+
+  // rates of viscous relaxation, for exponential integrators
+  PetscErrorCode getLinearRelaxationRates(map<string,Vec>& lambda);
+
 
   // IO functions
   PetscErrorCode view();
@@ -160,6 +168,10 @@ public:
   PetscErrorCode writeStep1D(PetscInt stepCount, PetscScalar time, const string outputDir);
   PetscErrorCode writeStep2D(PetscInt stepCount, PetscScalar time, const string outputDir);
 
+  // checkpointing functions
+  PetscErrorCode loadCheckpoint();
+  PetscErrorCode writeCheckpoint();
+
   // debugging and MMS tests
   PetscErrorCode measureMMSError();
 
@@ -11,22 +11,24 @@ StrikeSlip_PowerLaw_qd_fd::StrikeSlip_PowerLaw_qd_fd(Domain&D)
   _thermalCoupling("no"),_heatEquationType("transient"),
   _hydraulicCoupling("no"),_hydraulicTimeIntType("explicit"),
   _guessSteadyStateICs(0),_forcingType("no"),_faultTypeScale(2.0),
-  _cycleCount(0),_maxNumCycles(1e3),_deltaT(1e-3),_deltaT_fd(-1),_CFL(0.5),
+  _cycleCount(0),_maxNumCycles(1e3),_deltaT(1e-3),_deltaT_fd(-1),_CFL(0.5),_ltsRatio(1),
+  _fdWindowMargin(-1),_fdWindowTol(1e-3),
   _ay(NULL),_Fhat(NULL),_alphay(NULL),
   _inDynamic(false),_allowed(false), _trigger_qd2fd(1e-3), _trigger_fd2qd(1e-3),
-  _limit_qd(10*_vL), _limit_fd(1e-1),_limit_stride_fd(1e-2),_u0(NULL),
+  _limit_qd(10*_vL), _limit_fd(1e-1),_limit_stride_fd(1e-2),_regimeSwitch(NULL),_u0(NULL),
   _timeIntegrator("RK32"),_timeControlType("PID"),
   _stride1D(1),_stride2D(1),_maxStepCount(1e8),
   _initTime(0),_currTime(0),_maxTime(1e15),
   _minDeltaT(1e-3),_maxDeltaT(1e10),
   _stepCount(0),_timeStepTol(1e-8),_initDeltaT(1e-3),_normType("L2_absolute"),
   _integrateTime(0),_writeTime(0),_linSolveTime(0),_factorTime(0),
-  _startTime(MPI_Wtime()),_miscTime(0),
+  _startTime(MPI_Wtime()),_miscTime(0),_work("StrikeSlip_PowerLaw_qd_fd"),
   _timeV1D(NULL),_dtimeV1D(NULL),_timeV2D(NULL),_dtimeV2D(NULL),_regime1DV(NULL),_regime2DV(NULL),_forcingVal(0),
   _qd_bcRType("remoteLoading"),_qd_bcTType("freeSurface"),_qd_bcLType("symmFault"),_qd_bcBType("freeSurface"),
   _fd_bcRType("outGoingCharacteristics"),_fd_bcTType("freeSurface"),_fd_bcLType("symmFault"),_fd_bcBType("outGoingCharacteristics"),
   _mat_fd_bcRType("Neumann"),_mat_fd_bcTType("Neumann"),_mat_fd_bcLType("Neumann"),_mat_fd_bcBType("Neumann"),
   _quadEx(NULL),_quadImex(NULL),
+  _quadEx_step(NULL),_quadImex_step(NULL),
   _fault_qd(NULL),_material(NULL),_he(NULL),_p(NULL),
   _fss_T(0.2),_fss_EffVisc(0.2),_gss_t(1e-6),_maxSSIts_effVisc(50),_maxSSIts_tau(75),_maxSSIts_timesteps(2e4),
   _atolSS_effVisc(1e-3)
@@ -38,6 +40,9 @@ StrikeSlip_PowerLaw_qd_fd::StrikeSlip_PowerLaw_qd_fd(Domain&D)
 
   loadSettings(D._file);
   checkInput();
+  _outSched1D = new OutputScheduler(D._file,_delim,"1D");
+  _outSched2D = new OutputScheduler(D._file,_delim,"2D");
+  _regimeSwitch = new RegimeSwitch(D._file,_delim,_outputDir,D._outFileMode);
   parseBCs();
 
   // initiate momentum balance equation
@@ -123,6 +128,11 @@ StrikeSlip_PowerLaw_qd_fd::~StrikeSlip_PowerLaw_qd_fd()
 
   delete _quadImex;    _quadImex = NULL;
   delete _quadEx;      _quadEx = NULL;
+  delete _quadImex_step;  _quadImex_step = NULL;
+  delete _quadEx_step;    _quadEx_step = NULL;
+  delete _outSched1D;  _outSched1D = NULL;
+  delete _outSched2D;  _outSched2D = NULL;
+  delete _regimeSwitch; _regimeSwitch = NULL;
   delete _material;    _material = NULL;
   delete _fault_qd;    _fault_qd = NULL;
   delete _fault_fd;    _fault_fd = NULL;
@@ -236,6 +246,9 @@ PetscErrorCode StrikeSlip_PowerLaw_qd_fd::loadSettings(const char *file)
 
     else if (var.compare("deltaT_fd")==0) { _deltaT_fd = atof( rhs.c_str() ); }
     else if (var.compare("CFL")==0) { _CFL = atof( rhs.c_str() ); }
+    else if (var.compare("localTimeStepRatio")==0) { _ltsRatio = atoi( rhs.c_str() ); }
+    else if (var.compare("fdWindowMargin")==0) { _fdWindowMargin = atof( rhs.c_str() ); }
+    else if (var.compare("fdWindowTol")==0) { _fdWindowTol = atof( rhs.c_str() ); }
     else if (var.compare("maxNumCycles")==0) { _maxNumCycles = atoi( rhs.c_str() ); }
   }
 
@@ -297,6 +310,10 @@ PetscErrorCode StrikeSlip_PowerLaw_qd_fd::checkInput()
   assert(_fd_bcTType.compare("freeSurface")==0 || _fd_bcTType.compare("outGoingCharacteristics")==0 );
   assert(_fd_bcLType.compare("symmFault")==0 || _fd_bcLType.compare("rigidFault")==0 );
   assert(_fd_bcBType.compare("freeSurface")==0 || _fd_bcBType.compare("outGoingCharacteristics")==0 );
+  assert(_ltsRatio >= 1);
+  assert(_ltsRatio == 1 || _fdWindowMargin <= 0); // the window is not used with local time stepping
+  assert(_fdWindowTol > 0);
+  assert(_ltsRatio == 1 || _D->_gridSpacingType.compare("variableGridSpacing")==0); // on a constant grid every node would be fine (this also rules out matrix-free operators, which have no rows of D2)
 
   if (_stateLaw.compare("flashHeating")==0) {
     assert(_thermalCoupling.compare("no")!=0);
@@ -356,11 +373,12 @@ PetscErrorCode StrikeSlip_PowerLaw_qd_fd::parseBCs()
   return ierr;
 }
 
-// returns true if it's time to switch from qd to fd, or fd to qd, or if
-// the maximum time or step count has been reached
-bool StrikeSlip_PowerLaw_qd_fd::checkSwitchRegime(const Fault* _fault)
+// sets mustSwitch to true if it's time to switch from qd to fd, or fd to qd,
+// or if the maximum time or step count has been reached
+PetscErrorCode StrikeSlip_PowerLaw_qd_fd::checkSwitchRegime(const Fault* _fault, bool& mustSwitch)
 {
-  bool mustSwitch = false;
+  PetscErrorCode ierr = 0;
+  mustSwitch = false;
 
   // if using max slip velocity as switching criteria
   //~ Vec absSlipVel;
@@ -372,18 +390,17 @@ bool StrikeSlip_PowerLaw_qd_fd::checkSwitchRegime(const Fault* _fault)
   //~ VecDestroy(&absSlipVel);
 
   // if using R = eta*V / tauQS
-  Vec R; VecDuplicate(_fault->_slipVel,&R);
+  Vec R; _work.get("checkSwitchRegime_R",_fault->_slipVel,R);
   VecPointwiseMult(R,_fault_qd->_eta_rad,_fault->_slipVel);
   VecPointwiseDivide(R,R,_fault->_tauQSP);
   PetscScalar maxV;
   VecMax(R,NULL,&maxV);
-  VecDestroy(&R);
 
 
   // if integrating past allowed time or step count, force switching now
   if(_currTime > _maxTime || _stepCount > _maxStepCount){
     mustSwitch = true;
-    return mustSwitch;
+    return ierr;
   }
 
   // Otherwise, first check if switching from qd to fd, or from fd to qd, is allowed:
@@ -401,6 +418,9 @@ bool StrikeSlip_PowerLaw_qd_fd::checkSwitchRegime(const Fault* _fault)
   // switching from qd to fd happens if maxV > _trigger_qd2fd
   if (!_inDynamic && _allowed && maxV > _trigger_qd2fd) { mustSwitch = true; }
 
+  // the regime switch controller may delay the switch (regimeSwitchType = predictive)
+  ierr = _regimeSwitch->checkSwitch(_inDynamic,_cycleCount,_currTime,_stepCount,_deltaT,_deltaT_fd,maxV,mustSwitch); CHKERRQ(ierr);
+
 
   // also change stride for IO to avoid writing out too many time steps
   // at the end of an earthquake
@@ -409,7 +429,7 @@ bool StrikeSlip_PowerLaw_qd_fd::checkSwitchRegime(const Fault* _fault)
     _stride2D = _stride2D_fd_end;
   }
 
-  return mustSwitch;
+  return ierr;
 }
 
 
@@ -454,6 +474,12 @@ PetscErrorCode StrikeSlip_PowerLaw_qd_fd::computeTimeStep()
   VecMin(ts_dy,NULL,&min_ts_dy);
   VecMin(ts_dz,NULL,&min_ts_dz);
 
+  // local time stepping: the nodes that cannot take a step of localTimeStepRatio
+  // times the global CFL limit form the fine region, which takes substeps
+  if (_ltsRatio > 1) {
+    ierr = _waveOp.setLocalTimeStepping(_ltsRatio,ts_dy,ts_dz); CHKERRQ(ierr);
+  }
+
   // clean up memory usage
   VecDestroy(&dy);
   VecDestroy(&dz);
@@ -494,6 +520,11 @@ PetscErrorCode StrikeSlip_PowerLaw_qd_fd::computeTimeStep()
     }
   }
 
+  // with local time stepping, deltaT above is the step in the fine region
+  if (_ltsRatio > 1) {
+    _deltaT = _ltsRatio * _deltaT;
+  }
+
   _deltaT_fd = _deltaT;
 
   #if VERBOSE > 1
@@ -605,7 +636,17 @@ double startTime = MPI_Wtime();
   _deltaT = deltaT;
   _currTime = time;
 
-  if ( (_stride1D>0 && _currTime == _maxTime) || (_stride1D>0 && stepCount % _stride1D == 0) ) {
+  // decide whether to write output at this step
+  Fault *fault = _fault_qd;
+  if (_inDynamic) { fault = _fault_fd; }
+  bool write1D = false, write2D = false;
+  map<string,Vec> outputFields;
+  outputFields["slip"] = fault->_slip;
+  outputFields["tauP"] = fault->_tauP;
+  ierr = _outSched1D->checkWrite(stepCount,_stride1D,_currTime,_maxTime,fault->_slipVel,outputFields,write1D); CHKERRQ(ierr);
+  ierr = _outSched2D->checkWrite(stepCount,_stride2D,_currTime,_maxTime,fault->_slipVel,outputFields,write2D); CHKERRQ(ierr);
+
+  if (write1D) {
     ierr = writeStep1D(stepCount,time,_outputDir); CHKERRQ(ierr);
     ierr = _material->writeStep1D(_outputDir); CHKERRQ(ierr);
     if(_inDynamic){ ierr = _fault_fd->writeStep(_stepCount,_outputDir); CHKERRQ(ierr); }
@@ -614,7 +655,7 @@ double startTime = MPI_Wtime();
     if (_thermalCoupling.compare("no")!=0) { ierr =  _he->writeStep1D(_stepCount,time,_outputDir); CHKERRQ(ierr); }
   }
 
-  if ( (_stride2D>0 &&_currTime == _maxTime) || (_stride2D>0 && stepCount % _stride2D == 0) ) {
+  if (write2D) {
     ierr = writeStep2D(stepCount,time,_outputDir); CHKERRQ(ierr);
     ierr = _material->writeStep2D(_outputDir);CHKERRQ(ierr);
     if (_thermalCoupling.compare("no")!=0) { ierr =  _he->writeStep2D(_stepCount,time,_outputDir);CHKERRQ(ierr); }
@@ -640,9 +681,17 @@ double startTime = MPI_Wtime();
     else { VecMax(_fault_qd->_slipVel,NULL,&maxVel); }
     if (maxVel < 1.2e-9 && time > 1e11) { stopIntegration = 1; }
   }
-  else if(_inDynamic){ if(checkSwitchRegime(_fault_fd)){ stopIntegration = 1; } }
-  else { if(checkSwitchRegime(_fault_qd)){ stopIntegration = 1; } }
+  else {
+    bool mustSwitch = false;
+    if(_inDynamic){ ierr = checkSwitchRegime(_fault_fd,mustSwitch); CHKERRQ(ierr); }
+    else { ierr = checkSwitchRegime(_fault_qd,mustSwitch); CHKERRQ(ierr); }
+    if (mustSwitch) { stopIntegration = 1; }
+  }
 
+  // report any scratch Vecs allocated during this step
+  ierr = _work.endStep(stepCount); CHKERRQ(ierr);
+  if (_thermalCoupling.compare("no")!=0) { ierr = _he->_work.endStep(stepCount); CHKERRQ(ierr); }
+  if (_hydraulicCoupling.compare("no")!=0) { ierr = _p->endStep(stepCount); CHKERRQ(ierr); }
 
   #if VERBOSE > 0
     //~ double _currIntegrateTime = MPI_Wtime() - _startIntegrateTime;
@@ -665,26 +714,33 @@ PetscErrorCode StrikeSlip_PowerLaw_qd_fd::writeStep1D(PetscInt stepCount, PetscS
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
 
-  if (_timeV1D == NULL ) {
-    ierr = initiateWriteASCII(outputDir, "med_time1D.txt", _D->_outFileMode, _timeV1D, "%.15e\n", time);
-    CHKERRQ(ierr);
+  if (_D->_outputFormat.compare("hdf5") == 0) {
+    ierr = _D->_hdf5Writer.appendScalar(time,"med_time1D"); CHKERRQ(ierr);
+    ierr = _D->_hdf5Writer.appendScalar(_deltaT,"med_dt1D"); CHKERRQ(ierr);
+    ierr = _D->_hdf5Writer.appendScalar(_inDynamic,"regime1D"); CHKERRQ(ierr);
   }
   else {
-    ierr = PetscViewerASCIIPrintf(_timeV1D, "%.15e\n", time); CHKERRQ(ierr);
-  }
+    if (_timeV1D == NULL ) {
+      ierr = initiateWriteASCII(outputDir, "med_time1D.txt", _D->_outFileMode, _timeV1D, "%.15e\n", time);
+      CHKERRQ(ierr);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_timeV1D, "%.15e\n", time); CHKERRQ(ierr);
+    }
 
-  if (_dtimeV1D == NULL ) {
-    initiateWriteASCII(outputDir, "med_dt1D.txt", _D->_outFileMode, _dtimeV1D, "%.15e\n", _deltaT);
-  }
-  else {
-    ierr = PetscViewerASCIIPrintf(_dtimeV1D, "%.15e\n", _deltaT); CHKERRQ(ierr);
-  }
+    if (_dtimeV1D == NULL ) {
+      initiateWriteASCII(outputDir, "med_dt1D.txt", _D->_outFileMode, _dtimeV1D, "%.15e\n", _deltaT);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_dtimeV1D, "%.15e\n", _deltaT); CHKERRQ(ierr);
+    }
 
-  if (_regime1DV == NULL ) {
-    initiateWriteASCII(outputDir, "regime1D.txt", _D->_outFileMode, _regime1DV, "%i\n", (int)_inDynamic);
-  }
-  else {
-    ierr = PetscViewerASCIIPrintf(_regime1DV, "%i\n",_inDynamic);CHKERRQ(ierr);
+    if (_regime1DV == NULL ) {
+      initiateWriteASCII(outputDir, "regime1D.txt", _D->_outFileMode, _regime1DV, "%i\n", (int)_inDynamic);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_regime1DV, "%i\n",_inDynamic);CHKERRQ(ierr);
+    }
   }
 
   #if VERBOSE > 1
@@ -701,25 +757,32 @@ PetscErrorCode StrikeSlip_PowerLaw_qd_fd::writeStep2D(PetscInt stepCount, PetscS
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
 
-  if (_timeV2D == NULL ) {
-    ierr = initiateWriteASCII(outputDir, "med_time2D.txt", _D->_outFileMode, _timeV2D, "%.15e\n", time);
-    CHKERRQ(ierr);
-  }
-  else {
-    ierr = PetscViewerASCIIPrintf(_timeV2D, "%.15e\n", time); CHKERRQ(ierr);
-  }
-  if (_dtimeV2D == NULL ) {
-    initiateWriteASCII(outputDir, "med_dt2D.txt", _D->_outFileMode, _dtimeV2D, "%.15e\n", _deltaT);
+  if (_D->_outputFormat.compare("hdf5") == 0) {
+    ierr = _D->_hdf5Writer.appendScalar(time,"med_time2D"); CHKERRQ(ierr);
+    ierr = _D->_hdf5Writer.appendScalar(_deltaT,"med_dt2D"); CHKERRQ(ierr);
+    ierr = _D->_hdf5Writer.appendScalar(_inDynamic,"regime2D"); CHKERRQ(ierr);
   }
   else {
-    ierr = PetscViewerASCIIPrintf(_dtimeV2D, "%.15e\n", _deltaT); CHKERRQ(ierr);
-  }
+    if (_timeV2D == NULL ) {
+      ierr = initiateWriteASCII(outputDir, "med_time2D.txt", _D->_outFileMode, _timeV2D, "%.15e\n", time);
+      CHKERRQ(ierr);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_timeV2D, "%.15e\n", time); CHKERRQ(ierr);
+    }
+    if (_dtimeV2D == NULL ) {
+      initiateWriteASCII(outputDir, "med_dt2D.txt", _D->_outFileMode, _dtimeV2D, "%.15e\n", _deltaT);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_dtimeV2D, "%.15e\n", _deltaT); CHKERRQ(ierr);
+    }
 
-  if (_regime2DV == NULL ) {
-    initiateWriteASCII(outputDir, "regime2D.txt", _D->_outFileMode, _regime2DV, "%i\n", (int)_inDynamic);
-  }
-  else {
-    ierr = PetscViewerASCIIPrintf(_regime2DV, "%i\n",_inDynamic);CHKERRQ(ierr);
+    if (_regime2DV == NULL ) {
+      initiateWriteASCII(outputDir, "regime2D.txt", _D->_outFileMode, _regime2DV, "%i\n", (int)_inDynamic);
+    }
+    else {
+      ierr = PetscViewerASCIIPrintf(_regime2DV, "%i\n",_inDynamic);CHKERRQ(ierr);
+    }
   }
 
   #if VERBOSE > 1
@@ -747,7 +810,17 @@ PetscErrorCode StrikeSlip_PowerLaw_qd_fd::view()
   ierr = PetscPrintf(PETSC_COMM_WORLD,"StrikeSlip_PowerLaw_qd_fd Runtime Summary:\n");CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent in integration (s): %g\n",_integrateTime);CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent writing output (s): %g\n",_writeTime);CHKERRQ(ierr);
+  if (_D->_asyncOutput == 1) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent staging output for writing (s): %g\n",_D->_asyncWriter._stageTime);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent waiting for output writer (s): %g\n",_D->_asyncWriter._waitTime);CHKERRQ(ierr);
+  }
+  if (_D->_outputFormat.compare("hdf5") == 0) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   time spent writing HDF5 output (s): %g\n",_D->_hdf5Writer._writeTime);CHKERRQ(ierr);
+  }
   ierr = PetscPrintf(PETSC_COMM_WORLD,"   %% integration time spent writing output: %g\n",_writeTime/totRunTime*100.);CHKERRQ(ierr);
+  ierr = _work.view();CHKERRQ(ierr);
+  ierr = _regimeSwitch->view();CHKERRQ(ierr);
+  ierr = _waveOp.view();CHKERRQ(ierr);
   return ierr;
 }
 
@@ -776,7 +849,7 @@ PetscErrorCode StrikeSlip_PowerLaw_qd_fd::writeContext()
   ierr = PetscViewerASCIIPrintf(viewer,"timeIntegrator = %s\n",_timeIntegrator.c_str());CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"timeControlType = %s\n",_timeControlType.c_str());CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"stride1D = %i\n",_stride1D);CHKERRQ(ierr);
-  ierr = PetscViewerASCIIPrintf(viewer,"stride2D = %i\n",_stride1D);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"stride2D = %i\n",_stride2D);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"maxStepCount = %i\n",_maxStepCount);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"initTime = %.15e # (s)\n",_initTime);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"maxTime = %.15e # (s)\n",_maxTime);CHKERRQ(ierr);
@@ -798,6 +871,8 @@ PetscErrorCode StrikeSlip_PowerLaw_qd_fd::writeContext()
   ierr = PetscViewerASCIIPrintf(viewer,"stride2D_fd = %i\n",_stride2D_fd);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"stride1D_fd_end = %i\n",_stride1D_fd_end);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"stride2D_fd_end = %i\n",_stride2D_fd_end);CHKERRQ(ierr);
+  ierr = _outSched1D->writeContext(viewer);CHKERRQ(ierr);
+  ierr = _outSched2D->writeContext(viewer);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"\n");CHKERRQ(ierr);
 
   ierr = PetscViewerASCIIPrintf(viewer,"trigger_qd2fd = %.15e\n",_trigger_qd2fd);CHKERRQ(ierr);
@@ -805,7 +880,11 @@ PetscErrorCode StrikeSlip_PowerLaw_qd_fd::writeContext()
   ierr = PetscViewerASCIIPrintf(viewer,"limit_qd = %.15e\n",_limit_qd);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"limit_fd = %.15e\n",_limit_fd);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"limit_stride_fd = %.15e\n",_limit_stride_fd);CHKERRQ(ierr);
+  ierr = _regimeSwitch->writeContext(viewer);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"CFL = %.15e\n",_CFL);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"localTimeStepRatio = %i\n",_ltsRatio);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"fdWindowMargin = %.15e # (m)\n",_fdWindowMargin);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPrintf(viewer,"fdWindowTol = %.15e\n",_fdWindowTol);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"deltaT_fd = %.15e\n",_deltaT_fd);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"\n");CHKERRQ(ierr);
 
@@ -998,7 +1077,7 @@ PetscErrorCode StrikeSlip_PowerLaw_qd_fd::integrate_fd()
 
   ierr = quadWaveEx->integrate(this);CHKERRQ(ierr);
 
-  std::map<string,Vec> varOut = quadWaveEx->_var;
+  std::map<string,Vec>& varOut = quadWaveEx->getVar();
   for (map<string,Vec>::iterator it = varOut.begin(); it != varOut.end(); it++ ) {
     VecCopy(varOut[it->first],_varFD[it->first]);
   }
@@ -1046,6 +1125,7 @@ PetscErrorCode StrikeSlip_PowerLaw_qd_fd::prepare_fd2qd()
 
   // update momentum balance equation boundary conditions
   _material->changeBCTypes(_mat_qd_bcRType,_mat_qd_bcTType,_mat_qd_bcLType,_mat_qd_bcBType);
+  _waveOp.invalidate();
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -1118,6 +1198,12 @@ PetscErrorCode StrikeSlip_PowerLaw_qd_fd::prepare_qd2fd()
 
   // update momentum balance equation boundary conditions
   _material->changeBCTypes(_mat_fd_bcRType,_mat_fd_bcTType,_mat_fd_bcLType,_mat_fd_bcBType);
+  _waveOp.invalidate();
+
+  // the fd window starts at the fault and grows with the shear wave front
+  if (_fdWindowMargin > 0) {
+    ierr = _waveOp.startWindow(*_y,_material->_cs,_fdWindowMargin,_fdWindowTol,_currTime); CHKERRQ(ierr);
+  }
 
 
   #if VERBOSE > 1
@@ -1135,57 +1221,51 @@ PetscErrorCode StrikeSlip_PowerLaw_qd_fd::integrate_singleQDTimeStep()
     PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
   #endif
 
-  OdeSolver      *quadEx = NULL; // explicit time stepping
-  OdeSolverImex  *quadImex = NULL; // implicit time stepping
+  // the time integrator is set up on the first call and kept for later
+  // calls, so that its stage Vecs are only allocated once
+  if (_quadEx_step == NULL && _quadImex_step == NULL) {
+    if (_timeIntegrator.compare("FEuler")==0) {
+      _quadEx_step = new FEuler(1,_maxTime,_deltaT_fd,_timeControlType);
+    }
+    else if (_timeIntegrator.compare("RK32")==0) {
+      _quadEx_step = new RK32(1,_maxTime,_deltaT_fd,_timeControlType);
+    }
+    else if (_timeIntegrator.compare("RK43")==0) {
+      _quadEx_step = new RK43(1,_maxTime,_deltaT_fd,_timeControlType);
+    }
+    else if (_timeIntegrator.compare("RK32_WBE")==0) {
+      _quadImex_step = new RK32_WBE(1,_maxTime,_deltaT_fd,_timeControlType);
+    }
+    else if (_timeIntegrator.compare("RK43_WBE")==0) {
+      _quadImex_step = new RK43_WBE(1,_maxTime,_deltaT_fd,_timeControlType);
+    }
+    else {
+      PetscPrintf(PETSC_COMM_WORLD,"ERROR: timeIntegrator type not understood\n");
+      assert(0); // automatically fail
+    }
 
-  // initialize time integrator
-  if (_timeIntegrator.compare("FEuler")==0) {
-    quadEx = new FEuler(1,_maxTime,_deltaT_fd,_timeControlType);
-  }
-  else if (_timeIntegrator.compare("RK32")==0) {
-    quadEx = new RK32(1,_maxTime,_deltaT_fd,_timeControlType);
-  }
-  else if (_timeIntegrator.compare("RK43")==0) {
-    quadEx = new RK43(1,_maxTime,_deltaT_fd,_timeControlType);
-  }
-  else if (_timeIntegrator.compare("RK32_WBE")==0) {
-    quadImex = new RK32_WBE(1,_maxTime,_deltaT_fd,_timeControlType);
-  }
-  else if (_timeIntegrator.compare("RK43_WBE")==0) {
-    quadImex = new RK43_WBE(1,_maxTime,_deltaT_fd,_timeControlType);
-  }
-  else {
-    PetscPrintf(PETSC_COMM_WORLD,"ERROR: timeIntegrator type not understood\n");
-    assert(0); // automatically fail
+    if (_quadImex_step != NULL) {
+      ierr = _quadImex_step->setTolerance(_timeStepTol);CHKERRQ(ierr);
+      ierr = _quadImex_step->setToleranceType(_normType);CHKERRQ(ierr);
+      ierr = _quadImex_step->setErrInds(_timeIntInds,_scale);CHKERRQ(ierr);
+    }
+    else {
+      ierr = _quadEx_step->setTolerance(_timeStepTol);CHKERRQ(ierr);
+      ierr = _quadEx_step->setToleranceType(_normType);CHKERRQ(ierr);
+      ierr = _quadEx_step->setErrInds(_timeIntInds,_scale);CHKERRQ(ierr);
+    }
   }
 
   // integrate
-  if (_timeIntegrator.compare("RK32_WBE")==0 || _timeIntegrator.compare("RK43_WBE")==0) {
-    quadImex->setTolerance(_timeStepTol);CHKERRQ(ierr);
-    quadImex->setTimeStepBounds(_deltaT_fd,_deltaT_fd);
-    quadImex->setTimeRange(_currTime,_currTime+_deltaT_fd);
-    quadImex->setInitialStepCount(_stepCount);
-    quadImex->setInitialConds(_varQSEx,_varIm);
-    quadImex->setToleranceType(_normType);
-    quadImex->setErrInds(_timeIntInds,_scale);
-
-    ierr = quadImex->integrate(this); CHKERRQ(ierr);
+  if (_quadImex_step != NULL) {
+    ierr = _quadImex_step->setInitialConds(_varQSEx,_varIm);CHKERRQ(ierr);
+    ierr = _quadImex_step->step(this,_currTime,_stepCount,_deltaT_fd); CHKERRQ(ierr);
   }
   else {
-    quadEx->setTolerance(_timeStepTol);CHKERRQ(ierr);
-    quadEx->setTimeStepBounds(_deltaT_fd,_deltaT_fd);
-    quadEx->setTimeRange(_currTime,_currTime+_deltaT_fd);
-    quadEx->setInitialStepCount(_stepCount);
-    quadEx->setToleranceType(_normType);
-    quadEx->setInitialConds(_varQSEx);
-    quadEx->setErrInds(_timeIntInds,_scale);
-
-    ierr = quadEx->integrate(this); CHKERRQ(ierr);
+    ierr = _quadEx_step->setInitialConds(_varQSEx);CHKERRQ(ierr);
+    ierr = _quadEx_step->step(this,_currTime,_stepCount,_deltaT_fd); CHKERRQ(ierr);
   }
 
-  delete quadEx;
-  delete quadImex;
-
 
   #if VERBOSE > 1
     PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
@@ -1195,6 +1275,16 @@ PetscErrorCode StrikeSlip_PowerLaw_qd_fd::integrate_singleQDTimeStep()
 
 
 
+// called by the integrator before each evaluation of d_dt
+// the fault uses the stage to warm start the slip velocity solve
+PetscErrorCode StrikeSlip_PowerLaw_qd_fd::setStage(const PetscInt stage)
+{
+  PetscErrorCode ierr = 0;
+  ierr = _fault_qd->setStage(stage);CHKERRQ(ierr);
+  return ierr;
+}
+
+
 // purely explicit adaptive time stepping
 // note that the heat equation never appears here because it is only ever solved implicitly
 PetscErrorCode StrikeSlip_PowerLaw_qd_fd::d_dt(const PetscScalar time,const map<string,Vec>& varEx,map<string,Vec>& dvarEx)
@@ -1498,59 +1588,18 @@ PetscErrorCode StrikeSlip_PowerLaw_qd_fd::propagateWaves(const PetscScalar time,
 
 double startPropagation = MPI_Wtime();
 
-  // compute D2u = (Dyy+Dzz)*u
-  Vec D2u, temp;
-  VecDuplicate(*_y, &D2u);
-  VecDuplicate(*_y, &temp);
-  Mat A; _material->_sbp->getA(A);
-  ierr = MatMult(A, var.find("u")->second, temp);
-  //~ ierr = VecAXPY(temp, 1.0, _Fhat); // !!! Fhat term
-  ierr = _material->_sbp->Hinv(temp, D2u);
-  VecDestroy(&temp);
-  if (_D->_gridSpacingType.compare("variableGridSpacing")==0) {
-      Mat J,Jinv,qy,rz,yq,zr;
-      ierr = _material->_sbp->getCoordTrans(J,Jinv,qy,rz,yq,zr); CHKERRQ(ierr);
-      Vec temp;
-      VecDuplicate(D2u, &temp);
-      MatMult(Jinv, D2u, temp);
-      VecCopy(temp, D2u);
-      VecDestroy(&temp);
+  // K depends on deltaT and on the material's boundary conditions
+  if (!_waveOp.isSetUp(deltaT)) {
+    bool isVariableGridSpacing = _D->_gridSpacingType.compare("variableGridSpacing")==0;
+    ierr = _waveOp.setUp(_material->_sbp,_material->_rho,_ay,_fault_fd->_d2u,isVariableGridSpacing,deltaT); CHKERRQ(ierr);
   }
-  ierr = VecScatterBegin(*_body2fault, D2u, _fault_fd->_d2u, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
-  ierr = VecScatterEnd(*_body2fault, D2u, _fault_fd->_d2u, INSERT_VALUES, SCATTER_FORWARD); CHKERRQ(ierr);
 
+  // keep the window (if any) ahead of the waves
+  ierr = _waveOp.updateWindow(time); CHKERRQ(ierr);
 
   // Propagate waves and compute displacement at the next time step
-  // includes boundary conditions except for fault
-
-  PetscInt       Ii,Istart,Iend;
-  PetscScalar   *uNextA; // changed in this loop
-  const PetscScalar   *u, *uPrev, *d2u, *ay, *rho; // unchchanged in this loop
-  ierr = VecGetArray(varNext["u"], &uNextA);
-  ierr = VecGetArrayRead(var.find("u")->second, &u);
-  ierr = VecGetArrayRead(varPrev.find("u")->second, &uPrev);
-  ierr = VecGetArrayRead(_ay, &ay);
-  ierr = VecGetArrayRead(D2u, &d2u);
-  ierr = VecGetArrayRead(_material->_rho, &rho);
-
-  ierr = VecGetOwnershipRange(varNext["u"],&Istart,&Iend);CHKERRQ(ierr);
-  PetscInt       Jj = 0;
-  for (Ii = Istart; Ii < Iend; Ii++){
-    PetscScalar c1 = deltaT*deltaT / rho[Jj];
-    PetscScalar c2 = deltaT*ay[Jj] - 1.0;
-    PetscScalar c3 = deltaT*ay[Jj] + 1.0;
-
-    uNextA[Jj] = (c1*d2u[Jj] + 2.*u[Jj] + c2*uPrev[Jj]) / c3;
-    Jj++;
-  }
-  ierr = VecRestoreArray(varNext["u"], &uNextA);
-  ierr = VecRestoreArrayRead(var.find("u")->second, &u);
-  ierr = VecRestoreArrayRead(varPrev.find("u")->second, &uPrev);
-  ierr = VecRestoreArrayRead(_ay, &ay);
-  ierr = VecRestoreArrayRead(D2u, &d2u);
-  ierr = VecRestoreArrayRead(_material->_rho, &rho);
-
-  VecDestroy(&D2u);
+  // includes boundary conditions except for fault, and D2u on the fault
+  ierr = _waveOp.apply(var.find("u")->second,varPrev.find("u")->second,varNext["u"],_fault_fd->_d2u); CHKERRQ(ierr);
 
 _propagateTime += MPI_Wtime() - startPropagation;
 
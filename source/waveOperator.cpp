@@ -0,0 +1,688 @@
+#include "waveOperator.hpp"
+
+#define FILENAME "waveOperator.cpp"
+
+using namespace std;
+
+
+WaveOperator::WaveOperator()
+: _deltaT(0),_isSetUp(false),_ltsRatio(1),_numFine(0),_numActive(0),
+  _windowWidth(-1),_numWindow(0),_windowEdgeRatio(0),
+  _windowMargin(-1),_windowTol(0),_windowStartTime(0),_windowCsMax(0),_windowSetUpCount(0),
+  _setUpTime(0),_applyTime(0),_setUpCount(0),
+  _K(NULL),_D2fault(NULL),_b(NULL),
+  _fineMask(NULL),_L(NULL),_Lactive(NULL),_R(NULL),_isActive(NULL),_body2active(NULL),
+  _s(NULL),_d(NULL),_rhoFault(NULL),_acc(NULL),
+  _uA(NULL),_aA(NULL),_zA(NULL),_wPrev(NULL),_w(NULL),_wNext(NULL),
+  _windowY(NULL),_windowCs(NULL),_Kwindow(NULL),_uW(NULL),_nLocalWindow(0),_nLocalInner(0),_h11y(0),
+  _A(NULL),_hinv(NULL)
+{ }
+
+
+WaveOperator::~WaveOperator()
+{
+  destroyOps();
+  VecDestroy(&_fineMask);
+  VecDestroy(&_windowY);
+  VecDestroy(&_windowCs);
+}
+
+
+PetscErrorCode WaveOperator::destroyOps()
+{
+  PetscErrorCode ierr = 0;
+  ierr = MatDestroy(&_K); CHKERRQ(ierr);
+  ierr = MatDestroy(&_D2fault); CHKERRQ(ierr);
+  ierr = VecDestroy(&_b); CHKERRQ(ierr);
+
+  ierr = MatDestroy(&_L); CHKERRQ(ierr);
+  ierr = MatDestroy(&_Lactive); CHKERRQ(ierr);
+  ierr = MatDestroy(&_R); CHKERRQ(ierr);
+  ierr = ISDestroy(&_isActive); CHKERRQ(ierr);
+  ierr = VecScatterDestroy(&_body2active); CHKERRQ(ierr);
+  ierr = VecDestroy(&_s); CHKERRQ(ierr);
+  ierr = VecDestroy(&_d); CHKERRQ(ierr);
+  ierr = VecDestroy(&_rhoFault); CHKERRQ(ierr);
+  ierr = VecDestroy(&_acc); CHKERRQ(ierr);
+  ierr = VecDestroy(&_uA); CHKERRQ(ierr);
+  ierr = VecDestroy(&_aA); CHKERRQ(ierr);
+  ierr = VecDestroy(&_zA); CHKERRQ(ierr);
+  ierr = VecDestroy(&_wPrev); CHKERRQ(ierr);
+  ierr = VecDestroy(&_w); CHKERRQ(ierr);
+  ierr = VecDestroy(&_wNext); CHKERRQ(ierr);
+  ierr = MatDestroy(&_Kwindow); CHKERRQ(ierr);
+  ierr = VecDestroy(&_uW); CHKERRQ(ierr);
+  _A = NULL; // owned by the SbpOps
+  ierr = VecDestroy(&_hinv); CHKERRQ(ierr);
+  _isSetUp = false;
+  return ierr;
+}
+
+
+// The CFL limit at each node is proportional to min(tsy,tsz), and the time
+// step to the smallest of these. The nodes that cannot take ratio times the
+// time step form the fine region, so the rest are stable with the coarse step.
+PetscErrorCode WaveOperator::setLocalTimeStepping(const PetscInt ratio, const Vec& tsy, const Vec& tsz)
+{
+  PetscErrorCode ierr = 0;
+  assert(ratio >= 1);
+  _ltsRatio = ratio;
+  if (_fineMask == NULL) { ierr = VecDuplicate(tsy,&_fineMask); CHKERRQ(ierr); }
+
+  PetscScalar minY,minZ;
+  ierr = VecMin(tsy,NULL,&minY); CHKERRQ(ierr);
+  ierr = VecMin(tsz,NULL,&minZ); CHKERRQ(ierr);
+  const PetscScalar limit = ratio * min(abs(minY),abs(minZ));
+
+  PetscInt n;
+  PetscScalar *mask;
+  const PetscScalar *y,*z;
+  ierr = VecGetLocalSize(_fineMask,&n); CHKERRQ(ierr);
+  ierr = VecGetArray(_fineMask,&mask); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(tsy,&y); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(tsz,&z); CHKERRQ(ierr);
+  for (PetscInt Jj = 0; Jj < n; Jj++) { mask[Jj] = (min(y[Jj],z[Jj]) < limit) ? 1.0 : 0.0; }
+  ierr = VecRestoreArray(_fineMask,&mask); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(tsy,&y); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(tsz,&z); CHKERRQ(ierr);
+
+  _isSetUp = false;
+  return ierr;
+}
+
+
+PetscErrorCode WaveOperator::setWindow(const Vec& y, const Vec& cs, const PetscScalar width)
+{
+  PetscErrorCode ierr = 0;
+  if (_windowY == NULL) { ierr = VecDuplicate(y,&_windowY); CHKERRQ(ierr); }
+  if (_windowCs == NULL) { ierr = VecDuplicate(cs,&_windowCs); CHKERRQ(ierr); }
+  ierr = VecCopy(y,_windowY); CHKERRQ(ierr);
+  ierr = VecCopy(cs,_windowCs); CHKERRQ(ierr);
+  _windowWidth = width;
+  if (_isSetUp) { ierr = setUpWindow(); CHKERRQ(ierr); }
+  return ierr;
+}
+
+
+// the window is off until the first updateWindow, which sizes it for the front
+PetscErrorCode WaveOperator::startWindow(const Vec& y, const Vec& cs, const PetscScalar margin, const PetscScalar tol, const PetscScalar startTime)
+{
+  PetscErrorCode ierr = 0;
+  assert(tol > 0);
+  _windowMargin = margin;
+  _windowTol = tol;
+  _windowStartTime = startTime;
+  ierr = VecMax(cs,NULL,&_windowCsMax); CHKERRQ(ierr);
+  ierr = setWindow(y,cs,-1); CHKERRQ(ierr);
+  return ierr;
+}
+
+
+// Growing by 2*margin instead of just enough means the window is rebuilt at
+// most once per margin/cs from the front alone. The edge check catches waves
+// that run ahead of the estimated front.
+PetscErrorCode WaveOperator::updateWindow(const PetscScalar time)
+{
+  PetscErrorCode ierr = 0;
+  if (_windowMargin <= 0) { return ierr; }
+
+  PetscScalar width = max(_windowWidth,(PetscScalar) 0.0);
+  if (_windowEdgeRatio > _windowTol) { width += 2.0 * _windowMargin; }
+  const PetscScalar front = _windowCsMax * (time - _windowStartTime);
+  if (front + _windowMargin > width) { width = front + 2.0 * _windowMargin; }
+
+  if (width != _windowWidth) {
+    _windowWidth = width;
+    if (_isSetUp) { ierr = setUpWindow(); CHKERRQ(ierr); }
+  }
+  return ierr;
+}
+
+
+PetscErrorCode WaveOperator::setUp(SbpOps* sbp, const Vec& rho, const Vec& ay, const Vec& faultProto,
+  const bool isVariableGridSpacing, const PetscScalar deltaT)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    std::string funcName = "WaveOperator::setUp";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  double startTime = MPI_Wtime();
+
+  ierr = destroyOps(); CHKERRQ(ierr);
+
+  PetscScalar h11z;
+  ierr = sbp->geth11(_h11y,h11z); CHKERRQ(ierr);
+
+  // D2 = Hinv * A, H is diagonal
+  Mat A; sbp->getA(A);
+  Mat H; sbp->getH(H);
+  Vec diag;
+  ierr = VecDuplicate(rho,&diag); CHKERRQ(ierr);
+  ierr = MatGetDiagonal(H,diag); CHKERRQ(ierr);
+  ierr = VecReciprocal(diag); CHKERRQ(ierr);
+
+  // matrix-free operators only support MatMult, so A is applied every step instead
+  MatType type;
+  PetscBool isShell = PETSC_FALSE;
+  ierr = MatGetType(A,&type); CHKERRQ(ierr);
+  ierr = PetscStrcmp(type,MATSHELL,&isShell); CHKERRQ(ierr);
+  Mat D2 = NULL;
+  if (isShell) {
+    assert(!isVariableGridSpacing); // matrix-free operators are constant grid spacing only
+    assert(_ltsRatio == 1); // local time stepping needs the rows of D2
+    _A = A;
+    ierr = VecDuplicate(diag,&_hinv); CHKERRQ(ierr);
+    ierr = VecCopy(diag,_hinv); CHKERRQ(ierr);
+  }
+  else {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&D2); CHKERRQ(ierr);
+    ierr = MatDiagonalScale(D2,diag,NULL); CHKERRQ(ierr);
+  }
+
+  // D2 = Jinv * Hinv * A
+  if (isVariableGridSpacing) {
+    Mat J,Jinv,qy,rz,yq,zr;
+    ierr = sbp->getCoordTrans(J,Jinv,qy,rz,yq,zr); CHKERRQ(ierr);
+    Mat JinvD2;
+    ierr = MatMatMult(Jinv,D2,MAT_INITIAL_MATRIX,PETSC_DEFAULT,&JinvD2); CHKERRQ(ierr);
+    ierr = MatDestroy(&D2); CHKERRQ(ierr);
+    D2 = JinvD2;
+  }
+
+  // fault rows of D2: fault point Ii is body point Ii (y = 0)
+  {
+    PetscInt nFault,NFault,nBody,NBody,Istart,Iend;
+    ierr = VecGetLocalSize(faultProto,&nFault); CHKERRQ(ierr);
+    ierr = VecGetSize(faultProto,&NFault); CHKERRQ(ierr);
+    ierr = VecGetLocalSize(rho,&nBody); CHKERRQ(ierr);
+    ierr = VecGetSize(rho,&NBody); CHKERRQ(ierr);
+    ierr = VecGetOwnershipRange(faultProto,&Istart,&Iend); CHKERRQ(ierr);
+
+    ierr = MatCreate(PETSC_COMM_WORLD,&_R); CHKERRQ(ierr);
+    ierr = MatSetSizes(_R,nFault,nBody,NFault,NBody); CHKERRQ(ierr);
+    ierr = MatSetFromOptions(_R); CHKERRQ(ierr);
+    ierr = MatMPIAIJSetPreallocation(_R,1,NULL,1,NULL); CHKERRQ(ierr);
+    ierr = MatSeqAIJSetPreallocation(_R,1,NULL); CHKERRQ(ierr);
+    ierr = MatSetUp(_R); CHKERRQ(ierr);
+    for (PetscInt Ii = Istart; Ii < Iend; Ii++) {
+      ierr = MatSetValue(_R,Ii,Ii,1.0,INSERT_VALUES); CHKERRQ(ierr);
+    }
+    ierr = MatAssemblyBegin(_R,MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+    ierr = MatAssemblyEnd(_R,MAT_FINAL_ASSEMBLY); CHKERRQ(ierr);
+
+    if (_ltsRatio == 1 && !isShell) {
+      ierr = MatMatMult(_R,D2,MAT_INITIAL_MATRIX,PETSC_DEFAULT,&_D2fault); CHKERRQ(ierr);
+    }
+  }
+
+  // fold rho, ay and deltaT into the diagonal scalings
+  Vec scale;
+  ierr = VecDuplicate(rho,&scale); CHKERRQ(ierr);
+  ierr = VecDuplicate(rho,&_b); CHKERRQ(ierr);
+  PetscInt       Ii,Istart,Iend;
+  PetscScalar   *s, *b, *d;
+  const PetscScalar   *r, *a;
+  ierr = VecGetOwnershipRange(rho,&Istart,&Iend); CHKERRQ(ierr);
+  ierr = VecGetArray(scale,&s); CHKERRQ(ierr);
+  ierr = VecGetArray(_b,&b); CHKERRQ(ierr);
+  ierr = VecGetArray(diag,&d); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(rho,&r); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(ay,&a); CHKERRQ(ierr);
+  PetscInt Jj = 0;
+  for (Ii = Istart; Ii < Iend; Ii++) {
+    PetscScalar c1 = deltaT*deltaT / r[Jj];
+    PetscScalar c2 = deltaT*a[Jj] - 1.0;
+    PetscScalar c3 = deltaT*a[Jj] + 1.0;
+
+    s[Jj] = (_ltsRatio == 1) ? c1 / c3 : deltaT*deltaT / c3;
+    d[Jj] = 2.0 / c3;
+    b[Jj] = c2 / c3;
+    Jj++;
+  }
+  ierr = VecRestoreArray(scale,&s); CHKERRQ(ierr);
+  ierr = VecRestoreArray(_b,&b); CHKERRQ(ierr);
+  ierr = VecRestoreArray(diag,&d); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(rho,&r); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(ay,&a); CHKERRQ(ierr);
+
+  if (isShell) {
+    // uNext = s.*(Hinv*A*u) + d.*u + b.*uPrev, s = c1/c3, d = 2/c3
+    _s = scale;
+    _d = diag;
+    ierr = VecDuplicate(rho,&_acc); CHKERRQ(ierr);
+  }
+  else if (_ltsRatio == 1) {
+    // K = diag(c1/c3) * D2 + diag(2/c3), the diagonal of A is always in its nonzero structure
+    ierr = MatDiagonalScale(D2,scale,NULL); CHKERRQ(ierr);
+    ierr = MatDiagonalSet(D2,diag,ADD_VALUES); CHKERRQ(ierr);
+    _K = D2;
+    VecDestroy(&scale);
+    VecDestroy(&diag);
+  }
+  else {
+    // uNext = s.*(effective L*u) + d.*u + b.*uPrev, s = dt^2/c3, d = 2/c3
+    _s = scale;
+    _d = diag;
+    _deltaT = deltaT;
+    ierr = setUpLocalTimeStepping(D2,rho,faultProto); CHKERRQ(ierr);
+  }
+
+  _deltaT = deltaT;
+  _isSetUp = true;
+  ierr = setUpWindow(); CHKERRQ(ierr);
+  _setUpCount++;
+  _setUpTime += MPI_Wtime() - startTime;
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+
+bool WaveOperator::isSetUp(const PetscScalar deltaT) const
+{
+  return _isSetUp && _deltaT == deltaT;
+}
+
+
+PetscErrorCode WaveOperator::invalidate()
+{
+  _isSetUp = false;
+  return 0;
+}
+
+
+PetscErrorCode WaveOperator::apply(const Vec& u, const Vec& uPrev, Vec& uNext, Vec& faultD2u)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    std::string funcName = "WaveOperator::apply";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  assert(_isSetUp);
+
+  double startTime = MPI_Wtime();
+
+  if (_A != NULL) {
+    ierr = applyShell(u,uPrev,uNext,faultD2u); CHKERRQ(ierr);
+  }
+  else if (_ltsRatio > 1) {
+    ierr = applyLocalTimeStepping(u,uPrev,uNext,faultD2u); CHKERRQ(ierr);
+  }
+  else if (_Kwindow != NULL) {
+    ierr = applyWindow(u,uPrev,uNext,faultD2u); CHKERRQ(ierr);
+  }
+  else {
+    ierr = MatMult(_D2fault,u,faultD2u); CHKERRQ(ierr);
+    ierr = VecPointwiseMult(uNext,_b,uPrev); CHKERRQ(ierr);
+    ierr = MatMultAdd(_K,u,uNext,uNext); CHKERRQ(ierr);
+  }
+
+  _applyTime += MPI_Wtime() - startTime;
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+
+// rows of K at the nodes with y <= _windowWidth
+PetscErrorCode WaveOperator::setUpWindow()
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    std::string funcName = "WaveOperator::setUpWindow";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  ierr = MatDestroy(&_Kwindow); CHKERRQ(ierr);
+  ierr = VecDestroy(&_uW); CHKERRQ(ierr);
+  _nLocalWindow = 0;
+  _nLocalInner = 0;
+  _numWindow = 0;
+  _windowEdgeRatio = 0;
+  _edgeK.clear();
+  _edgeB.clear();
+  if (_windowWidth <= 0 || _ltsRatio > 1 || _windowY == NULL) { return ierr; }
+  if (_A != NULL) { return ierr; } // no rows of K to restrict, so every node is advanced
+
+  double startTime = MPI_Wtime();
+
+  // y does not decrease with the row index, so the window is a prefix of the local rows
+  PetscInt Istart,Iend;
+  const PetscScalar *y;
+  ierr = VecGetOwnershipRange(_windowY,&Istart,&Iend); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_windowY,&y); CHKERRQ(ierr);
+  while (_nLocalWindow < Iend - Istart && y[_nLocalWindow] <= _windowWidth) { _nLocalWindow++; }
+
+  PetscInt N = 0;
+  ierr = VecGetSize(_windowY,&N); CHKERRQ(ierr);
+  ierr = MPI_Allreduce(&_nLocalWindow,&_numWindow,1,MPIU_INT,MPI_SUM,PETSC_COMM_WORLD); CHKERRQ(ierr);
+  if (_numWindow == N) { // the window covers the whole body
+    ierr = VecRestoreArrayRead(_windowY,&y); CHKERRQ(ierr);
+    return ierr;
+  }
+
+  // the edge of the window is its last column of nodes, which are the last
+  // rows of the prefix on each processor
+  PetscScalar yEdgeLoc = (_nLocalWindow > 0) ? y[_nLocalWindow-1] : -1.0, yEdge = 0;
+  ierr = MPI_Allreduce(&yEdgeLoc,&yEdge,1,MPIU_SCALAR,MPI_MAX,PETSC_COMM_WORLD); CHKERRQ(ierr);
+  _nLocalInner = _nLocalWindow;
+  while (_nLocalInner > 0 && y[_nLocalInner-1] >= yEdge) { _nLocalInner--; }
+  ierr = VecRestoreArrayRead(_windowY,&y); CHKERRQ(ierr);
+
+  // damp the edge with the outgoing characteristic penalty, ay = 0.5*cs/h11y,
+  // i.e. c3 -> c3 + dt*ay and c2 -> c2 + dt*ay in the edge rows, with
+  // c3 = 2/(1-b) and c2 = c3 - 2 recovered from b
+  const PetscScalar *cs, *b;
+  ierr = VecGetArrayRead(_windowCs,&cs); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_b,&b); CHKERRQ(ierr);
+  for (PetscInt Jj = _nLocalInner; Jj < _nLocalWindow; Jj++) {
+    PetscScalar c3 = 2.0 / (1.0 - b[Jj]);
+    PetscScalar c2 = c3 - 2.0;
+    PetscScalar damp = _deltaT * 0.5 * cs[Jj] / _h11y;
+    _edgeK.push_back(c3 / (c3 + damp));
+    _edgeB.push_back((c2 + damp) / (c3 + damp));
+  }
+  ierr = VecRestoreArrayRead(_windowCs,&cs); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(_b,&b); CHKERRQ(ierr);
+
+  // the columns keep the layout of u
+  IS isRows,isCols;
+  ierr = ISCreateStride(PETSC_COMM_WORLD,_nLocalWindow,Istart,1,&isRows); CHKERRQ(ierr);
+  ierr = ISCreateStride(PETSC_COMM_WORLD,Iend-Istart,Istart,1,&isCols); CHKERRQ(ierr);
+  #if PETSC_VERSION_GE(3,8,0)
+    ierr = MatCreateSubMatrix(_K,isRows,isCols,MAT_INITIAL_MATRIX,&_Kwindow); CHKERRQ(ierr);
+  #else
+    ierr = MatGetSubMatrix(_K,isRows,isCols,MAT_INITIAL_MATRIX,&_Kwindow); CHKERRQ(ierr);
+  #endif
+  ISDestroy(&isRows);
+  ISDestroy(&isCols);
+  ierr = VecCreateMPI(PETSC_COMM_WORLD,_nLocalWindow,PETSC_DETERMINE,&_uW); CHKERRQ(ierr);
+
+  _windowSetUpCount++;
+  _setUpTime += MPI_Wtime() - startTime;
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+
+// uNext = K*u + b.*uPrev in the window, with the edge rows damped, uNext = u outside it
+// also sets _windowEdgeRatio = max |uNext-u| at the edge / max |uNext-u| in the window
+PetscErrorCode WaveOperator::applyWindow(const Vec& u, const Vec& uPrev, Vec& uNext, Vec& faultD2u)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    std::string funcName = "WaveOperator::applyWindow";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  ierr = MatMult(_D2fault,u,faultD2u); CHKERRQ(ierr);
+  ierr = MatMult(_Kwindow,u,_uW); CHKERRQ(ierr);
+
+  PetscInt       Jj,nLocal;
+  PetscScalar   *uNextA;
+  const PetscScalar   *uW, *uA, *uPrevA, *b;
+  ierr = VecGetLocalSize(uNext,&nLocal); CHKERRQ(ierr);
+  ierr = VecGetArray(uNext,&uNextA); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_uW,&uW); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(u,&uA); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(uPrev,&uPrevA); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_b,&b); CHKERRQ(ierr);
+  PetscScalar maxDu[2] = {0,0}; // in the window, at its edge
+  for (Jj = 0; Jj < _nLocalInner; Jj++) {
+    uNextA[Jj] = uW[Jj] + b[Jj]*uPrevA[Jj];
+    maxDu[0] = max(maxDu[0],PetscAbsScalar(uNextA[Jj] - uA[Jj]));
+  }
+  for (Jj = _nLocalInner; Jj < _nLocalWindow; Jj++) {
+    uNextA[Jj] = _edgeK[Jj-_nLocalInner]*uW[Jj] + _edgeB[Jj-_nLocalInner]*uPrevA[Jj];
+    maxDu[1] = max(maxDu[1],PetscAbsScalar(uNextA[Jj] - uA[Jj]));
+  }
+  maxDu[0] = max(maxDu[0],maxDu[1]);
+  for (Jj = _nLocalWindow; Jj < nLocal; Jj++) {
+    uNextA[Jj] = uA[Jj];
+  }
+  ierr = VecRestoreArray(uNext,&uNextA); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(_uW,&uW); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(u,&uA); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(uPrev,&uPrevA); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(_b,&b); CHKERRQ(ierr);
+
+  PetscScalar maxDuAll[2] = {0,0};
+  ierr = MPI_Allreduce(maxDu,maxDuAll,2,MPIU_SCALAR,MPI_MAX,PETSC_COMM_WORLD); CHKERRQ(ierr);
+  _windowEdgeRatio = (maxDuAll[0] > 0) ? maxDuAll[1] / maxDuAll[0] : 0;
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+
+// uNext = s.*(Hinv*A*u) + d.*u + b.*uPrev, for matrix-free A
+PetscErrorCode WaveOperator::applyShell(const Vec& u, const Vec& uPrev, Vec& uNext, Vec& faultD2u)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    std::string funcName = "WaveOperator::applyShell";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  ierr = MatMult(_A,u,_acc); CHKERRQ(ierr);
+  ierr = VecPointwiseMult(_acc,_acc,_hinv); CHKERRQ(ierr);
+  ierr = MatMult(_R,_acc,faultD2u); CHKERRQ(ierr);
+
+  PetscInt       Jj,nLocal;
+  PetscScalar   *uNextA;
+  const PetscScalar   *acc, *uA, *uPrevA, *s, *d, *b;
+  ierr = VecGetLocalSize(uNext,&nLocal); CHKERRQ(ierr);
+  ierr = VecGetArray(uNext,&uNextA); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_acc,&acc); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(u,&uA); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(uPrev,&uPrevA); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_s,&s); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_d,&d); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_b,&b); CHKERRQ(ierr);
+  for (Jj = 0; Jj < nLocal; Jj++) {
+    uNextA[Jj] = s[Jj]*acc[Jj] + d[Jj]*uA[Jj] + b[Jj]*uPrevA[Jj];
+  }
+  ierr = VecRestoreArray(uNext,&uNextA); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(_acc,&acc); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(u,&uA); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(uPrev,&uPrevA); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(_s,&s); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(_d,&d); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(_b,&b); CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+
+// L = D2/rho, the active nodes, and the rows and columns of L*P at them
+PetscErrorCode WaveOperator::setUpLocalTimeStepping(Mat& D2, const Vec& rho, const Vec& faultProto)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    std::string funcName = "WaveOperator::setUpLocalTimeStepping";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  assert(_fineMask != NULL);
+
+  // L = D2/rho
+  Vec rhoInv;
+  ierr = VecDuplicate(rho,&rhoInv); CHKERRQ(ierr);
+  ierr = VecCopy(rho,rhoInv); CHKERRQ(ierr);
+  ierr = VecReciprocal(rhoInv); CHKERRQ(ierr);
+  ierr = MatDiagonalScale(D2,rhoInv,NULL); CHKERRQ(ierr);
+  VecDestroy(&rhoInv);
+  _L = D2;
+
+  // the fault needs rho to turn L*u back into D2*u
+  ierr = VecDuplicate(faultProto,&_rhoFault); CHKERRQ(ierr);
+  ierr = MatMult(_R,rho,_rhoFault); CHKERRQ(ierr);
+
+  // active nodes: fine nodes, and nodes whose row of L has a fine column
+  // the mask is gathered onto every processor since the columns may be off-processor
+  VecScatter scatter;
+  Vec maskAll;
+  ierr = VecScatterCreateToAll(_fineMask,&scatter,&maskAll); CHKERRQ(ierr);
+  ierr = VecScatterBegin(scatter,_fineMask,maskAll,INSERT_VALUES,SCATTER_FORWARD); CHKERRQ(ierr);
+  ierr = VecScatterEnd(scatter,_fineMask,maskAll,INSERT_VALUES,SCATTER_FORWARD); CHKERRQ(ierr);
+
+  PetscInt Istart,Iend;
+  ierr = MatGetOwnershipRange(_L,&Istart,&Iend); CHKERRQ(ierr);
+  vector<PetscInt> active;
+  const PetscScalar *mask;
+  ierr = VecGetArrayRead(maskAll,&mask); CHKERRQ(ierr);
+  for (PetscInt Ii = Istart; Ii < Iend; Ii++) {
+    PetscInt ncols;
+    const PetscInt *cols;
+    ierr = MatGetRow(_L,Ii,&ncols,&cols,NULL); CHKERRQ(ierr);
+    bool isActive = mask[Ii] > 0.5;
+    for (PetscInt Jj = 0; Jj < ncols && !isActive; Jj++) {
+      if (mask[cols[Jj]] > 0.5) { isActive = true; }
+    }
+    ierr = MatRestoreRow(_L,Ii,&ncols,&cols,NULL); CHKERRQ(ierr);
+    if (isActive) { active.push_back(Ii); }
+  }
+  ierr = VecRestoreArrayRead(maskAll,&mask); CHKERRQ(ierr);
+  VecScatterDestroy(&scatter);
+  VecDestroy(&maskAll);
+
+  PetscInt nActive = active.size();
+  ierr = ISCreateGeneral(PETSC_COMM_WORLD,nActive,active.empty() ? NULL : &active[0],PETSC_COPY_VALUES,&_isActive); CHKERRQ(ierr);
+  ierr = VecCreateMPI(PETSC_COMM_WORLD,nActive,PETSC_DETERMINE,&_uA); CHKERRQ(ierr);
+  ierr = VecGetSize(_uA,&_numActive); CHKERRQ(ierr);
+  ierr = VecDuplicate(_uA,&_aA); CHKERRQ(ierr);
+  ierr = VecDuplicate(_uA,&_zA); CHKERRQ(ierr);
+  ierr = VecDuplicate(_uA,&_wPrev); CHKERRQ(ierr);
+  ierr = VecDuplicate(_uA,&_w); CHKERRQ(ierr);
+  ierr = VecDuplicate(_uA,&_wNext); CHKERRQ(ierr);
+  ierr = VecDuplicate(rho,&_acc); CHKERRQ(ierr);
+  ierr = VecScatterCreate(rho,_isActive,_uA,NULL,&_body2active); CHKERRQ(ierr);
+
+  PetscScalar numFine = 0;
+  ierr = VecSum(_fineMask,&numFine); CHKERRQ(ierr);
+  _numFine = (PetscInt) (numFine + 0.5);
+
+  // L*P restricted to the active nodes, every fine node is active
+  #if PETSC_VERSION_GE(3,8,0)
+    ierr = MatCreateSubMatrix(_L,_isActive,_isActive,MAT_INITIAL_MATRIX,&_Lactive); CHKERRQ(ierr);
+  #else
+    ierr = MatGetSubMatrix(_L,_isActive,_isActive,MAT_INITIAL_MATRIX,&_Lactive); CHKERRQ(ierr);
+  #endif
+  Vec maskA;
+  ierr = VecDuplicate(_uA,&maskA); CHKERRQ(ierr);
+  ierr = VecScatterBegin(_body2active,_fineMask,maskA,INSERT_VALUES,SCATTER_FORWARD); CHKERRQ(ierr);
+  ierr = VecScatterEnd(_body2active,_fineMask,maskA,INSERT_VALUES,SCATTER_FORWARD); CHKERRQ(ierr);
+  ierr = MatDiagonalScale(_Lactive,NULL,maskA); CHKERRQ(ierr);
+  VecDestroy(&maskA);
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+
+// one step of the local time stepping leapfrog scheme
+PetscErrorCode WaveOperator::applyLocalTimeStepping(const Vec& u, const Vec& uPrev, Vec& uNext, Vec& faultD2u)
+{
+  PetscErrorCode ierr = 0;
+  #if VERBOSE > 1
+    std::string funcName = "WaveOperator::applyLocalTimeStepping";
+    PetscPrintf(PETSC_COMM_WORLD,"Starting %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+
+  // acc = L*u, which is exact away from the active nodes
+  ierr = MatMult(_L,u,_acc); CHKERRQ(ierr);
+  ierr = VecScatterBegin(_body2active,u,_uA,INSERT_VALUES,SCATTER_FORWARD); CHKERRQ(ierr);
+  ierr = VecScatterEnd(_body2active,u,_uA,INSERT_VALUES,SCATTER_FORWARD); CHKERRQ(ierr);
+  ierr = VecScatterBegin(_body2active,_acc,_aA,INSERT_VALUES,SCATTER_FORWARD); CHKERRQ(ierr);
+  ierr = VecScatterEnd(_body2active,_acc,_aA,INSERT_VALUES,SCATTER_FORWARD); CHKERRQ(ierr);
+
+  // z = L*(I-P)*u at the active nodes
+  ierr = MatMult(_Lactive,_uA,_zA); CHKERRQ(ierr);
+  ierr = VecAYPX(_zA,-1.0,_aA); CHKERRQ(ierr);
+
+  // first substep: w1 = w0 + 0.5*dtau^2 * L*w0, with w0 = u
+  PetscScalar dtau = _deltaT/_ltsRatio;
+  ierr = VecCopy(_uA,_wPrev); CHKERRQ(ierr);
+  ierr = VecWAXPY(_w,0.5*dtau*dtau,_aA,_uA); CHKERRQ(ierr);
+
+  // remaining substeps: wNext = 2*w - wPrev + dtau^2 * (z + L*P*w)
+  for (PetscInt m = 1; m < _ltsRatio; m++) {
+    ierr = MatMultAdd(_Lactive,_w,_zA,_wNext); CHKERRQ(ierr);
+    ierr = VecAXPBYPCZ(_wNext,2.0,-1.0,dtau*dtau,_w,_wPrev); CHKERRQ(ierr);
+    std::swap(_wPrev,_w);
+    std::swap(_w,_wNext);
+  }
+
+  // effective L*u at the active nodes: 2*(w(dt) - u)/dt^2
+  ierr = VecWAXPY(_aA,-1.0,_uA,_w); CHKERRQ(ierr);
+  ierr = VecScale(_aA,2.0/(_deltaT*_deltaT)); CHKERRQ(ierr);
+  ierr = VecScatterBegin(_body2active,_aA,_acc,INSERT_VALUES,SCATTER_REVERSE); CHKERRQ(ierr);
+  ierr = VecScatterEnd(_body2active,_aA,_acc,INSERT_VALUES,SCATTER_REVERSE); CHKERRQ(ierr);
+
+  // uNext = s.*acc + d.*u + b.*uPrev
+  PetscInt       Ii,Istart,Iend;
+  PetscScalar   *uNextA;
+  const PetscScalar   *acc, *uA, *uPrevA, *s, *d, *b;
+  ierr = VecGetOwnershipRange(uNext,&Istart,&Iend); CHKERRQ(ierr);
+  ierr = VecGetArray(uNext,&uNextA); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_acc,&acc); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(u,&uA); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(uPrev,&uPrevA); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_s,&s); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_d,&d); CHKERRQ(ierr);
+  ierr = VecGetArrayRead(_b,&b); CHKERRQ(ierr);
+  PetscInt Jj = 0;
+  for (Ii = Istart; Ii < Iend; Ii++) {
+    uNextA[Jj] = s[Jj]*acc[Jj] + d[Jj]*uA[Jj] + b[Jj]*uPrevA[Jj];
+    Jj++;
+  }
+  ierr = VecRestoreArray(uNext,&uNextA); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(_acc,&acc); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(u,&uA); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(uPrev,&uPrevA); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(_s,&s); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(_d,&d); CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(_b,&b); CHKERRQ(ierr);
+
+  // D2*u at the fault = rho * effective L*u
+  ierr = MatMult(_R,_acc,faultD2u); CHKERRQ(ierr);
+  ierr = VecPointwiseMult(faultD2u,faultD2u,_rhoFault); CHKERRQ(ierr);
+
+  #if VERBOSE > 1
+    PetscPrintf(PETSC_COMM_WORLD,"Ending %s in %s\n",funcName.c_str(),FILENAME);
+  #endif
+  return ierr;
+}
+
+
+PetscErrorCode WaveOperator::view()
+{
+  PetscErrorCode ierr = 0;
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   wave operator setup time (s): %g\n",_setUpTime);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   # of wave operator setups: %i\n",_setUpCount);CHKERRQ(ierr);
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   wave operator apply time (s): %g\n",_applyTime);CHKERRQ(ierr);
+  if (_ltsRatio > 1) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   local time stepping: %i substeps at %i fine nodes (%i active nodes)\n",
+      _ltsRatio,_numFine,_numActive);CHKERRQ(ierr);
+  }
+  if (_windowSetUpCount > 0) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"   window: %i window setups, %i nodes in the last window\n",
+      _windowSetUpCount,_numWindow);CHKERRQ(ierr);
+  }
+  return ierr;
+}
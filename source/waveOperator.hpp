@@ -0,0 +1,166 @@
+#ifndef WAVEOPERATOR_HPP_INCLUDED
+#define WAVEOPERATOR_HPP_INCLUDED
+
+#include <petscksp.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <assert.h>
+#include "sbpOps.hpp"
+
+using namespace std;
+
+/*
+ * Precomputed update operator for the off-fault portion of the fully dynamic
+ * momentum balance equation. With
+ *   D2 = Jinv * Hinv * A,  c1 = dt^2/rho,  c2 = dt*ay - 1,  c3 = dt*ay + 1,
+ * the leapfrog update
+ *   uNext = (c1*D2*u + 2*u + c2*uPrev) / c3
+ * is rewritten as
+ *   uNext = K*u + b.*uPrev,  K = diag(c1/c3)*D2 + diag(2/c3),  b = c2/c3,
+ * so that each time step takes one pointwise pass and one mat-vec, instead of
+ * two or three mat-vecs, a copy, and a pointwise pass.
+ *
+ * The fault still needs D2*u at y = 0, which is computed from the rows of D2
+ * that belong to the fault (the first Nz rows of the body). The caller then
+ * overwrites the fault values of uNext with the fault's own update.
+ *
+ * Local time stepping (setLocalTimeStepping with ratio p > 1): the nodes in
+ * the fine region, whose own CFL limit is smaller than the time step dt, take
+ * p substeps of dt/p while the rest of the body takes one step of dt. This is
+ * the local time stepping leapfrog scheme of Diaz and Grote (2009): with
+ * L = D2/rho and P the projection onto the fine nodes, each step integrates
+ *   w'' = L*(I-P)*u + L*P*w,  w(0) = u,  w'(0) = 0
+ * over [0,dt] with p leapfrog substeps, and replaces dt^2*L*u in the update
+ * above by 2*(w(dt) - u). For p = 1 this is the usual leapfrog update. Since
+ * D2 is self-adjoint in the rho*J*H inner product and P is diagonal, the
+ * scheme conserves a discrete energy, so the SBP energy estimate carries over
+ * across the interface between the two regions. Only the active nodes, the
+ * fine nodes and those whose stencil reaches them, are updated in the
+ * substeps, so these cost a mat-vec with the active rows only. The fault
+ * still takes one step of dt, using the effective D2*u from the substeps.
+ *
+ * Window (setWindow with width > 0): only the nodes with y <= width, which
+ * with the body's y-major ordering are a prefix of every processor's rows,
+ * are advanced. The rest are held at their current values, so a step costs a
+ * mat-vec with the rows of K in the window. Holding the nodes outside adds a
+ * constant forcing to the nodes inside, and restricts D2 to the window, which
+ * is still self-adjoint in the rho*J*H inner product, so the scheme in the
+ * window conserves a discrete energy. The last column of the window is also
+ * damped with the outgoing characteristic penalty used at the outer
+ * boundaries, ay = 0.5*cs/h11y, which only removes energy, so the scheme
+ * stays stable. The interface still reflects part of an incoming wave, so the
+ * window must be kept ahead of the waves. startWindow starts it at the fault,
+ * and updateWindow, called before each step, grows it by 2*margin when the
+ * shear wave front (max cs times the elapsed time) comes within margin of its
+ * edge, or when the largest change of u in the edge column relative to that
+ * in the window (windowEdgeRatio) exceeded tol in the last step. The window
+ * is not used with local time stepping.
+ *
+ * Matrix-free operators (A is a MATSHELL): K cannot be formed, so each step
+ * applies A to u and then does the pointwise update, the same work as the
+ * update before K was introduced. Local time stepping is not available, and
+ * the window is ignored, so every node is advanced.
+ *
+ * K depends on the time step and on the material's boundary conditions, so
+ * it must be rebuilt (setUp) when either changes.
+ *
+ */
+
+class WaveOperator
+{
+public:
+
+  PetscScalar   _deltaT; // time step K was built for
+  bool          _isSetUp;
+  PetscInt      _ltsRatio; // # of substeps in the fine region, 1 = no local time stepping
+  PetscInt      _numFine,_numActive; // global # of fine and active nodes
+  PetscScalar   _windowWidth; // (m) <= 0 = no window
+  PetscInt      _numWindow; // global # of nodes in the window
+  PetscScalar   _windowEdgeRatio; // max |uNext-u| at the window's edge / in the window, last step
+  PetscScalar   _windowMargin,_windowTol; // (m) distance kept ahead of the front (<= 0 = not tracked), max windowEdgeRatio
+  PetscScalar   _windowStartTime,_windowCsMax; // time the front left the fault, max shear wave speed
+  PetscInt      _windowSetUpCount;
+  double        _setUpTime,_applyTime;
+  PetscInt      _setUpCount;
+
+  WaveOperator();
+  ~WaveOperator();
+
+  // use local time stepping with ratio substeps in the fine region, given the
+  // time for a shear wave to cross one grid spacing in y and z at each node
+  // (takes effect at the next setUp)
+  PetscErrorCode setLocalTimeStepping(const PetscInt ratio, const Vec& tsy, const Vec& tsz);
+
+  // advance only the nodes with y <= width, width <= 0 turns the window off,
+  // cs sets the damping at the window's edge (collective)
+  PetscErrorCode setWindow(const Vec& y, const Vec& cs, const PetscScalar width);
+
+  // track the shear wave front that leaves the fault at startTime with a
+  // window, kept margin ahead of it by updateWindow (collective)
+  PetscErrorCode startWindow(const Vec& y, const Vec& cs, const PetscScalar margin, const PetscScalar tol, const PetscScalar startTime);
+
+  // grow the window for the step starting at time, if needed (collective)
+  PetscErrorCode updateWindow(const PetscScalar time);
+
+  // build K, b and the fault rows of D2 (collective)
+  // faultProto has the parallel layout of the fault Vecs
+  PetscErrorCode setUp(SbpOps* sbp, const Vec& rho, const Vec& ay, const Vec& faultProto,
+    const bool isVariableGridSpacing, const PetscScalar deltaT);
+
+  // whether K is up to date for time step deltaT
+  bool isSetUp(const PetscScalar deltaT) const;
+
+  // mark K as out of date, e.g. after the material's boundary conditions change
+  PetscErrorCode invalidate();
+
+  // uNext = K*u + b.*uPrev (or the local time stepping update), and
+  // faultD2u = D2*u at the fault (collective)
+  PetscErrorCode apply(const Vec& u, const Vec& uPrev, Vec& uNext, Vec& faultD2u);
+
+  PetscErrorCode view();
+
+private:
+  // disable default copy constructor and assignment operator
+  WaveOperator(const WaveOperator& that);
+  WaveOperator& operator=(const WaveOperator& rhs);
+
+  Mat   _K; // update operator
+  Mat   _D2fault; // rows of D2 at the fault
+  Vec   _b; // coefficient of uPrev
+
+  // local time stepping
+  Vec          _fineMask; // 1 at the fine nodes, 0 elsewhere
+  Mat          _L; // D2/rho
+  Mat          _Lactive; // rows and columns of L at the active nodes, times P
+  Mat          _R; // restriction from the body to the fault
+  IS           _isActive;
+  VecScatter   _body2active;
+  Vec          _s,_d; // coefficients of dt^2*L*u and u
+  Vec          _rhoFault;
+  Vec          _acc; // (effective) L*u
+  Vec          _uA,_aA,_zA,_wPrev,_w,_wNext; // active nodes only
+
+  // window
+  Vec          _windowY; // y coordinate of each node
+  Vec          _windowCs; // shear wave speed
+  Mat          _Kwindow; // rows of K in the window
+  Vec          _uW; // window rows only
+  PetscInt     _nLocalWindow; // # of local rows in the window
+  PetscInt     _nLocalInner; // # of local rows in the window before its edge
+  PetscScalar  _h11y; // first entry of Hy
+  vector<PetscScalar>  _edgeK,_edgeB; // damped coefficients of K*u and uPrev at the edge rows
+
+  // matrix-free operators
+  Mat          _A; // the SbpOps' A, not owned, NULL if K is formed
+  Vec          _hinv; // diagonal of Hinv
+
+  PetscErrorCode destroyOps();
+  PetscErrorCode setUpWindow();
+  PetscErrorCode applyWindow(const Vec& u, const Vec& uPrev, Vec& uNext, Vec& faultD2u);
+  PetscErrorCode applyShell(const Vec& u, const Vec& uPrev, Vec& uNext, Vec& faultD2u);
+  PetscErrorCode setUpLocalTimeStepping(Mat& D2, const Vec& rho, const Vec& faultProto);
+  PetscErrorCode applyLocalTimeStepping(const Vec& u, const Vec& uPrev, Vec& uNext, Vec& faultD2u);
+};
+
+#endif
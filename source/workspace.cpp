@@ -0,0 +1,72 @@
+#include "workspace.hpp"
+
+#define FILENAME "workspace.cpp"
+
+using namespace std;
+
+
+Workspace::Workspace(const string name)
+: _name(name),_numAllocs(0),_stepAllocs(0)
+{ }
+
+
+Workspace::~Workspace()
+{
+  for (map<string,Vec>::iterator it = _vecs.begin(); it != _vecs.end(); it++) {
+    VecDestroy(&it->second);
+  }
+}
+
+
+// allocation is collective on the first request for key, so every processor
+// must request the same keys in the same order
+PetscErrorCode Workspace::get(const string& key, const Vec& proto, Vec& vec)
+{
+  PetscErrorCode ierr = 0;
+
+  map<string,Vec>::iterator it = _vecs.find(key);
+  if (it != _vecs.end()) {
+    vec = it->second;
+
+    #if VERBOSE > 1
+      // the same key must always be used with the same layout
+      PetscInt n = 0, nProto = 0;
+      VecGetLocalSize(vec,&n);
+      VecGetLocalSize(proto,&nProto);
+      assert(n == nProto);
+    #endif
+
+    return ierr;
+  }
+
+  ierr = VecDuplicate(proto,&vec); CHKERRQ(ierr);
+  _vecs[key] = vec;
+  _numAllocs++;
+  _stepAllocs++;
+
+  return ierr;
+}
+
+
+PetscErrorCode Workspace::endStep(const PetscInt stepCount)
+{
+  PetscErrorCode ierr = 0;
+
+  #if VERBOSE > 1
+    if (_stepAllocs > 0) {
+      ierr = PetscPrintf(PETSC_COMM_WORLD,"%s workspace: allocated %i Vecs in step %i (%i in total)\n",
+        _name.c_str(),_stepAllocs,stepCount,_numAllocs); CHKERRQ(ierr);
+    }
+  #endif
+  _stepAllocs = 0;
+
+  return ierr;
+}
+
+
+PetscErrorCode Workspace::view()
+{
+  PetscErrorCode ierr = 0;
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"   # of scratch Vecs in %s workspace: %i\n",_name.c_str(),_numAllocs);CHKERRQ(ierr);
+  return ierr;
+}
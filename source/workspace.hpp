@@ -0,0 +1,54 @@
+#ifndef WORKSPACE_HPP_INCLUDED
+#define WORKSPACE_HPP_INCLUDED
+
+#include <petscvec.h>
+#include <string>
+#include <map>
+#include <assert.h>
+
+using namespace std;
+
+/*
+ * Pool of scratch Vecs owned by one object, so that functions called every
+ * time step do not create and destroy their temporary Vecs on each call.
+ *
+ * Each scratch Vec is named by a key, and is duplicated from a prototype
+ * Vec the first time that key is requested. Later requests return the same
+ * Vec, whose contents are whatever the last user left in it. Keys must be
+ * unique within the object (e.g. prefixed by the function name), so that a
+ * function never gets a Vec that one of its callers is still using.
+ *
+ * The pool counts the Vecs it allocates. Once every hot path has run once,
+ * a time step should allocate nothing, which endStep reports on for
+ * VERBOSE > 1.
+ *
+ */
+
+class Workspace
+{
+public:
+
+  string     _name; // used when reporting allocations
+  PetscInt   _numAllocs; // total # of Vecs allocated
+  PetscInt   _stepAllocs; // # of Vecs allocated since the last call to endStep
+
+  Workspace(const string name);
+  ~Workspace();
+
+  // scratch Vec for key, with the same parallel layout as proto
+  PetscErrorCode get(const string& key, const Vec& proto, Vec& vec);
+
+  // end of time step stepCount: report and reset the # of allocations in this step
+  PetscErrorCode endStep(const PetscInt stepCount);
+
+  PetscErrorCode view();
+
+private:
+  // disable default copy constructor and assignment operator
+  Workspace(const Workspace& that);
+  Workspace& operator=(const Workspace& rhs);
+
+  map<string,Vec>  _vecs;
+};
+
+#endif
@@ -0,0 +1,256 @@
+#include <petscksp.h>
+#include <string>
+#include <cmath>
+#include <vector>
+
+#include "sbpOps.hpp"
+#include "sbpOps_m_constGrid.hpp"
+#include "sbpOps_mf_constGrid.hpp"
+
+using namespace std;
+
+/*
+ * Compares the matrix-free SBP operators (SbpOps_mf_constGrid) against the
+ * matrix-based ones (SbpOps_m_constGrid) for a variable coefficient, both
+ * orders, both compatibility types, and several sets of boundary condition
+ * types, including a switch with changeBCTypes. Every operator is applied
+ * to the same random input with both, and the relative difference (max
+ * norm) must be below tol.
+ *
+ * Run on one processor: with more than one, the 4th order matrix-based A
+ * depends on the partitioning (see SbpOps_mf_constGrid::updateMuLoc).
+ *
+ * Usage: ./test_sbpOps_mf [-Ny 21] [-Nz 17]
+ */
+
+typedef PetscErrorCode (SbpOps::*BodyOp)(const Vec &in, Vec &out);
+
+const PetscScalar tol = 1e-10;
+PetscInt numFailed = 0, numChecked = 0;
+
+
+// relative difference between out_m (matrix-based) and out_mf (matrix-free)
+PetscErrorCode compare(const string name, const Vec& out_m, const Vec& out_mf)
+{
+  PetscErrorCode ierr = 0;
+
+  Vec diff;
+  ierr = VecDuplicate(out_m,&diff); CHKERRQ(ierr);
+  ierr = VecWAXPY(diff,-1.0,out_mf,out_m); CHKERRQ(ierr);
+  PetscReal normDiff = 0, norm = 0;
+  ierr = VecNorm(diff,NORM_INFINITY,&normDiff); CHKERRQ(ierr);
+  ierr = VecNorm(out_m,NORM_INFINITY,&norm); CHKERRQ(ierr);
+  VecDestroy(&diff);
+
+  PetscReal err = (norm > 0) ? normDiff/norm : normDiff;
+  numChecked++;
+  if (err > tol || err != err) {
+    numFailed++;
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"    %-10s rel. error = %.3e  FAILED\n",name.c_str(),err); CHKERRQ(ierr);
+  }
+  #if VERBOSE > 1
+  else {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"    %-10s rel. error = %.3e\n",name.c_str(),err); CHKERRQ(ierr);
+  }
+  #endif
+
+  return ierr;
+}
+
+
+PetscErrorCode createVec(const PetscInt N, PetscRandom& rand, Vec& vec)
+{
+  PetscErrorCode ierr = 0;
+  ierr = VecCreate(PETSC_COMM_WORLD,&vec); CHKERRQ(ierr);
+  ierr = VecSetSizes(vec,PETSC_DECIDE,N); CHKERRQ(ierr);
+  ierr = VecSetFromOptions(vec); CHKERRQ(ierr);
+  ierr = VecSetRandom(vec,rand); CHKERRQ(ierr);
+  return ierr;
+}
+
+
+// smooth variable coefficient with a step in y, so that mu3 differs from mu
+PetscErrorCode setMu(const PetscInt Ny, const PetscInt Nz, Vec& mu)
+{
+  PetscErrorCode ierr = 0;
+
+  PetscInt Istart,Iend;
+  PetscScalar *m;
+  ierr = VecGetOwnershipRange(mu,&Istart,&Iend); CHKERRQ(ierr);
+  ierr = VecGetArray(mu,&m); CHKERRQ(ierr);
+  for (PetscInt Ii = Istart; Ii < Iend; Ii++) {
+    PetscScalar y = (Ii/Nz) / (Ny - 1.0);
+    PetscScalar z = (Ii%Nz) / (Nz - 1.0);
+    m[Ii-Istart] = 30.0 + 5.0*sin(3.0*y)*cos(2.0*z) + 3.0*z*z;
+    if (y > 0.5) { m[Ii-Istart] += 10.0; }
+  }
+  ierr = VecRestoreArray(mu,&m); CHKERRQ(ierr);
+
+  return ierr;
+}
+
+
+PetscErrorCode setUpOps(SbpOps* sbp, const string compatibilityType, const vector<string>& bcs)
+{
+  PetscErrorCode ierr = 0;
+  ierr = sbp->setCompatibilityType(compatibilityType); CHKERRQ(ierr);
+  ierr = sbp->setBCTypes(bcs[0],bcs[1],bcs[2],bcs[3]); CHKERRQ(ierr);
+  ierr = sbp->setMultiplyByH(1); CHKERRQ(ierr);
+  ierr = sbp->setLaplaceType("yz"); CHKERRQ(ierr);
+  ierr = sbp->computeMatrices(); CHKERRQ(ierr);
+  return ierr;
+}
+
+
+// A and the right-hand side from boundary data, which depend on the boundary condition types
+PetscErrorCode compareBCDependent(SbpOps* m, SbpOps* mf, const Vec& x, Vec& bcL, Vec& bcR, Vec& bcT, Vec& bcB)
+{
+  PetscErrorCode ierr = 0;
+
+  Vec out_m,out_mf;
+  ierr = VecDuplicate(x,&out_m); CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&out_mf); CHKERRQ(ierr);
+
+  Mat A_m,A_mf;
+  ierr = m->getA(A_m); CHKERRQ(ierr);
+  ierr = mf->getA(A_mf); CHKERRQ(ierr);
+  ierr = MatMult(A_m,x,out_m); CHKERRQ(ierr);
+  ierr = MatMult(A_mf,x,out_mf); CHKERRQ(ierr);
+  ierr = compare("A",out_m,out_mf); CHKERRQ(ierr);
+
+  ierr = MatGetDiagonal(A_m,out_m); CHKERRQ(ierr);
+  ierr = MatGetDiagonal(A_mf,out_mf); CHKERRQ(ierr);
+  ierr = compare("diag(A)",out_m,out_mf); CHKERRQ(ierr);
+
+  ierr = m->setRhs(out_m,bcL,bcR,bcT,bcB); CHKERRQ(ierr);
+  ierr = mf->setRhs(out_mf,bcL,bcR,bcT,bcB); CHKERRQ(ierr);
+  ierr = compare("setRhs",out_m,out_mf); CHKERRQ(ierr);
+
+  VecDestroy(&out_m);
+  VecDestroy(&out_mf);
+  return ierr;
+}
+
+
+PetscErrorCode runCase(const PetscInt order, const PetscInt Ny, const PetscInt Nz, const string compatibilityType,
+  const vector<string>& bcs, const vector<string>& bcs2, PetscRandom& rand)
+{
+  PetscErrorCode ierr = 0;
+
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"order %i, %s, bcR/T/L/B = %s/%s/%s/%s, then %s/%s/%s/%s\n",
+    order,compatibilityType.c_str(),bcs[0].c_str(),bcs[1].c_str(),bcs[2].c_str(),bcs[3].c_str(),
+    bcs2[0].c_str(),bcs2[1].c_str(),bcs2[2].c_str(),bcs2[3].c_str()); CHKERRQ(ierr);
+
+  const PetscScalar Ly = 10, Lz = 8;
+  Vec mu;
+  ierr = createVec(Ny*Nz,rand,mu); CHKERRQ(ierr);
+  ierr = setMu(Ny,Nz,mu); CHKERRQ(ierr);
+
+  SbpOps *m = new SbpOps_m_constGrid(order,Ny,Nz,Ly,Lz,mu);
+  SbpOps *mf = new SbpOps_mf_constGrid(order,Ny,Nz,Ly,Lz,mu);
+  ierr = setUpOps(m,compatibilityType,bcs); CHKERRQ(ierr);
+  ierr = setUpOps(mf,compatibilityType,bcs); CHKERRQ(ierr);
+
+  Vec x,bcL,bcR,bcT,bcB,out_m,out_mf;
+  ierr = createVec(Ny*Nz,rand,x); CHKERRQ(ierr);
+  ierr = createVec(Nz,rand,bcL); CHKERRQ(ierr);
+  ierr = createVec(Nz,rand,bcR); CHKERRQ(ierr);
+  ierr = createVec(Ny,rand,bcT); CHKERRQ(ierr);
+  ierr = createVec(Ny,rand,bcB); CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&out_m); CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&out_mf); CHKERRQ(ierr);
+
+  // operators on body Vecs
+  const BodyOp ops[] = { &SbpOps::Dy, &SbpOps::muxDy, &SbpOps::Dyxmu,
+    &SbpOps::Dz, &SbpOps::muxDz, &SbpOps::Dzxmu, &SbpOps::H, &SbpOps::Hinv,
+    &SbpOps::HyinvxE0y, &SbpOps::HyinvxENy, &SbpOps::HzinvxE0z, &SbpOps::HzinvxENz };
+  const char *names[] = { "Dy", "muxDy", "Dyxmu", "Dz", "muxDz", "Dzxmu", "H", "Hinv",
+    "HyinvxE0y", "HyinvxENy", "HzinvxE0z", "HzinvxENz" };
+  for (size_t Ii = 0; Ii < sizeof(ops)/sizeof(ops[0]); Ii++) {
+    ierr = (m->*ops[Ii])(x,out_m); CHKERRQ(ierr);
+    ierr = (mf->*ops[Ii])(x,out_mf); CHKERRQ(ierr);
+    ierr = compare(names[Ii],out_m,out_mf); CHKERRQ(ierr);
+  }
+
+  // operators from the boundaries y = 0 and y = Ly to the body
+  ierr = m->Hyinvxe0y(bcL,out_m); CHKERRQ(ierr);
+  ierr = mf->Hyinvxe0y(bcL,out_mf); CHKERRQ(ierr);
+  ierr = compare("Hyinvxe0y",out_m,out_mf); CHKERRQ(ierr);
+  ierr = m->HyinvxeNy(bcR,out_m); CHKERRQ(ierr);
+  ierr = mf->HyinvxeNy(bcR,out_mf); CHKERRQ(ierr);
+  ierr = compare("HyinvxeNy",out_m,out_mf); CHKERRQ(ierr);
+
+  // matrices
+  Mat H_m,H_mf,Dy_m,Dz_m,Dy_mf,Dz_mf;
+  ierr = m->getH(H_m); CHKERRQ(ierr);
+  ierr = mf->getH(H_mf); CHKERRQ(ierr);
+  ierr = MatMult(H_m,x,out_m); CHKERRQ(ierr);
+  ierr = MatMult(H_mf,x,out_mf); CHKERRQ(ierr);
+  ierr = compare("getH",out_m,out_mf); CHKERRQ(ierr);
+  ierr = m->getDs(Dy_m,Dz_m); CHKERRQ(ierr);
+  ierr = mf->getDs(Dy_mf,Dz_mf); CHKERRQ(ierr);
+  ierr = MatMult(Dy_m,x,out_m); CHKERRQ(ierr);
+  ierr = MatMult(Dy_mf,x,out_mf); CHKERRQ(ierr);
+  ierr = compare("getDs: Dy",out_m,out_mf); CHKERRQ(ierr);
+  ierr = MatMult(Dz_m,x,out_m); CHKERRQ(ierr);
+  ierr = MatMult(Dz_mf,x,out_mf); CHKERRQ(ierr);
+  ierr = compare("getDs: Dz",out_m,out_mf); CHKERRQ(ierr);
+
+  ierr = compareBCDependent(m,mf,x,bcL,bcR,bcT,bcB); CHKERRQ(ierr);
+
+  // switch boundary condition types, as the qd_fd mediators do
+  ierr = m->changeBCTypes(bcs2[0],bcs2[1],bcs2[2],bcs2[3]); CHKERRQ(ierr);
+  ierr = mf->changeBCTypes(bcs2[0],bcs2[1],bcs2[2],bcs2[3]); CHKERRQ(ierr);
+  ierr = compareBCDependent(m,mf,x,bcL,bcR,bcT,bcB); CHKERRQ(ierr);
+
+  VecDestroy(&x);
+  VecDestroy(&bcL);
+  VecDestroy(&bcR);
+  VecDestroy(&bcT);
+  VecDestroy(&bcB);
+  VecDestroy(&out_m);
+  VecDestroy(&out_mf);
+  delete m;
+  delete mf;
+  VecDestroy(&mu);
+
+  return ierr;
+}
+
+
+int main(int argc, char **argv)
+{
+  PetscErrorCode ierr = 0;
+  PetscInitialize(&argc,&argv,NULL,NULL);
+
+  PetscInt Ny = 21, Nz = 17;
+  PetscOptionsGetInt(NULL,NULL,"-Ny",&Ny,NULL);
+  PetscOptionsGetInt(NULL,NULL,"-Nz",&Nz,NULL);
+
+  PetscRandom rand;
+  ierr = PetscRandomCreate(PETSC_COMM_WORLD,&rand); CHKERRQ(ierr);
+  ierr = PetscRandomSetFromOptions(rand); CHKERRQ(ierr);
+
+  vector<string> traction(4,"Neumann"), dirichlet(4,"Dirichlet"), mixed(4,"Dirichlet");
+  mixed[1] = "Neumann"; mixed[3] = "Neumann"; // bcT, bcB
+
+  const PetscInt orders[] = {2,4};
+  const char *compatibilityTypes[] = {"fullyCompatible","compatible"};
+  for (int Ii = 0; Ii < 2; Ii++) {
+    for (int Jj = 0; Jj < 2; Jj++) {
+      ierr = runCase(orders[Ii],Ny,Nz,compatibilityTypes[Jj],mixed,traction,rand); CHKERRQ(ierr);
+      ierr = runCase(orders[Ii],Ny,Nz,compatibilityTypes[Jj],dirichlet,mixed,rand); CHKERRQ(ierr);
+    }
+  }
+
+  if (numFailed > 0) {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"FAILED: %i of %i comparisons\n",numFailed,numChecked); CHKERRQ(ierr);
+  }
+  else {
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"passed: %i comparisons\n",numChecked); CHKERRQ(ierr);
+  }
+
+  PetscRandomDestroy(&rand);
+  PetscFinalize();
+  return numFailed > 0;
+}